@@ -0,0 +1,158 @@
+#!/usr/bin/env python3
+"""Run the GBA benchmark ROM under mGBA and write its results as JSON.
+
+Build the ROM first with `make BENCH=1` (plus any other options being
+compared). mGBA runs it with its GDB stub open; GDB stops at bench_done(),
+dumps gba_bench_report (main_gba.c) and ends the session. The figures are
+CPU cycles counted by the ROM's own timers, so a run gives the same numbers
+every time and builds can be compared without hardware. Scenario and phase
+names are read from hyperspace_bench.h and hyperspace_phases.h.
+
+usage: bench_gba.py [--elf hyperspace.elf] [--out bench.json] [--compare old.json]
+       bench_gba.py --dump report.bin ...   (parse a dump, no emulator)
+"""
+
+import argparse
+import json
+import os
+import re
+import struct
+import subprocess
+import sys
+import tempfile
+
+SUPPORTED_VERSION = 2
+MAGIC = 0x4E425348              # "HSBN", GBA_BENCH_MAGIC
+HEADER = struct.Struct('<5I')   # magic, version, clock_hz, num_scenarios, num_phases
+RESULT_FIELDS = ('min', 'avg', 'p99', 'max', 'update', 'draw', 'present', 'hash')
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+ROOT = os.path.dirname(HERE)
+
+
+def read_names():
+    with open(os.path.join(ROOT, 'hyperspace_phases.h')) as f:
+        phases = re.findall(r'X\(PHASE_\w+,\s*"([^"]+)"\)', f.read())
+    with open(os.path.join(ROOT, 'hyperspace_bench.h')) as f:
+        scenarios = re.findall(r'\{"([^"]+)",\s*BENCH_\w+', f.read())
+    return scenarios, phases
+
+
+def run_emulator(args, dump_path):
+    """Boot the ROM in mGBA and let GDB dump the report at bench_done()."""
+    env = dict(os.environ)
+    env.setdefault('SDL_VIDEODRIVER', 'dummy')
+    env.setdefault('SDL_AUDIODRIVER', 'dummy')
+    # Unthrottled: the ROM times itself, so emulation speed does not matter
+    emu_cmd = args.mgba.split() + ['-C', 'videoSync=0', '-C', 'audioSync=0', '-g', args.rom]
+    gdb_cmd = [args.gdb, '-batch', '-nx',
+               '-ex', 'set tcp auto-retry on',
+               '-ex', 'set tcp connect-timeout 30',
+               '-ex', f'target remote localhost:{args.port}',
+               '-ex', 'break bench_done',
+               '-ex', 'continue',
+               '-ex', f'dump binary value {dump_path} gba_bench_report',
+               '-ex', 'kill',
+               args.elf]
+
+    emu = subprocess.Popen(emu_cmd, env=env, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+    try:
+        gdb = subprocess.run(gdb_cmd, capture_output=True, text=True, timeout=args.timeout)
+    except subprocess.TimeoutExpired:
+        sys.exit(f"Error: no result within {args.timeout} s")
+    finally:
+        emu.terminate()
+        try:
+            emu.wait(5)
+        except subprocess.TimeoutExpired:
+            emu.kill()
+    if not os.path.exists(dump_path) or os.path.getsize(dump_path) == 0:
+        sys.exit("Error: GDB did not dump gba_bench_report\n" + gdb.stdout + gdb.stderr)
+
+
+def parse_report(data, scenarios, phases):
+    magic, version, clock_hz, num_scenarios, num_phases = HEADER.unpack_from(data)
+    if magic != MAGIC:
+        sys.exit(f"Error: bad magic {magic:08x}; the run did not complete")
+    if version != SUPPORTED_VERSION:
+        sys.exit(f"Error: bench format {version}, expected {SUPPORTED_VERSION}")
+    if num_scenarios != len(scenarios) or num_phases != len(phases):
+        sys.exit(f"Error: ROM has {num_scenarios} scenarios and {num_phases} phases, "
+                 f"the headers {len(scenarios)} and {len(phases)}; rebuild the ROM")
+
+    fields = len(RESULT_FIELDS) + num_phases
+    expected = HEADER.size + num_scenarios * fields * 4
+    if len(data) < expected:
+        sys.exit(f"Error: report is {len(data)} bytes, expected {expected}")
+
+    out = []
+    for i, name in enumerate(scenarios):
+        values = struct.unpack_from(f'<{fields}I', data, HEADER.size + i * fields * 4)
+        result = {'name': name}
+        result.update(zip(RESULT_FIELDS, values))
+        result['hash'] = f"{result['hash']:08x}"
+        result['avg_ms'] = round(result['avg'] * 1000 / clock_hz, 3)
+        result['phases'] = dict(zip(phases, values[len(RESULT_FIELDS):]))
+        out.append(result)
+    return {'version': version, 'clock_hz': clock_hz, 'units': 'cycles', 'scenarios': out}
+
+
+def print_table(report, baseline=None):
+    old = {s['name']: s for s in baseline['scenarios']} if baseline else {}
+    print(f"{'scenario':10} {'avg':>9} {'ms':>6} {'update':>9} {'draw':>9} {'present':>9}"
+          + ("  change" if old else ""))
+    for s in report['scenarios']:
+        line = (f"{s['name']:10} {s['avg']:9} {s['avg_ms']:6.2f} "
+                f"{s['update']:9} {s['draw']:9} {s['present']:9}")
+        prev = old.get(s['name'])
+        if prev and prev['avg']:
+            line += f"  {(s['avg'] - prev['avg']) * 100 / prev['avg']:+6.1f}%"
+            if prev['hash'] != s['hash']:
+                line += "  (different frames)"
+        print(line)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument('--elf', default=os.path.join(HERE, 'hyperspace.elf'), help='ELF with symbols')
+    parser.add_argument('--rom', help='ROM to run (default: the ELF with .gba)')
+    parser.add_argument('--mgba', default='mgba', help='mGBA SDL frontend command')
+    parser.add_argument('--gdb', default=os.path.join(os.environ.get('DEVKITARM', ''), 'bin', 'arm-none-eabi-gdb'),
+                        help='GDB for ARM (default: devkitARM\'s, or gdb-multiarch)')
+    parser.add_argument('--port', type=int, default=2345, help='mGBA GDB stub port')
+    parser.add_argument('--timeout', type=int, default=1800, help='seconds before giving up')
+    parser.add_argument('--dump', help='parse this report dump instead of running the emulator')
+    parser.add_argument('--out', default='bench_gba.json', help='JSON output')
+    parser.add_argument('--compare', help='earlier JSON output to compare with')
+    args = parser.parse_args()
+    if not args.rom:
+        args.rom = os.path.splitext(args.elf)[0] + '.gba'
+    if not os.path.exists(args.gdb):
+        args.gdb = 'gdb-multiarch'
+
+    scenarios, phases = read_names()
+    if args.dump:
+        with open(args.dump, 'rb') as f:
+            data = f.read()
+    else:
+        with tempfile.TemporaryDirectory() as tmp:
+            dump_path = os.path.join(tmp, 'report.bin')
+            run_emulator(args, dump_path)
+            with open(dump_path, 'rb') as f:
+                data = f.read()
+
+    report = parse_report(data, scenarios, phases)
+    report['rom'] = os.path.basename(args.rom)
+    baseline = None
+    if args.compare:
+        with open(args.compare) as f:
+            baseline = json.load(f)
+
+    with open(args.out, 'w') as f:
+        json.dump(report, f, indent=2)
+    print_table(report, baseline)
+    print(f"Wrote {args.out}")
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,13 @@
+/*
+ * libfixmath for the GBA build
+ *
+ * The shared core calls fix16_mul()/fix16_div() in its inner loops, so the
+ * library is built from here: the .iwram.c suffix makes devkitARM compile
+ * it as ARM code and link it into IWRAM. Configured like the core with
+ * FIXMATH_NO_OVERFLOW (and FIXMATH_NO_CACHE, whose tables would not fit
+ * in IWRAM) from the Makefile.
+ */
+
+#include "../libfixmath/fix16.c"
+#include "../libfixmath/fix16_sqrt.c"
+#include "../libfixmath/fix16_trig.c"
@@ -0,0 +1,202 @@
+/*
+ * Hyperspace - GBA Backends
+ * Shared by the GBA build (main_gba.c) and the host build's GBA
+ * configuration, so the host can check them against the reference core
+ *
+ * Replacements for the core's hot paths (see hyperspace_game.h), enabled
+ * by gba_config.h:
+ * - platform_raster_div(): reciprocal table and one multiply for divisors
+ *   of 1.0 and up, fix16_div() below that
+ * - platform_raster_span(): affine spans, with perspective-correct UVs at
+ *   both ends from a normalized reciprocal table (or every 16 pixels with
+ *   GBA_SUBDIV_SPANS) stepped linearly in between, and the light dither
+ *   chosen per span instead of per pixel
+ * - platform_mat_mul_pos(): the multiplies inlined, rounded exactly as
+ *   libfixmath's fix16_mul() so the simulation is unchanged
+ *
+ * Include after hyperspace_game.h. With GBA_SPAN_ASM the span's pixel loop
+ * is render_span_arm (raster_arm.s); otherwise the C loop below, which
+ * gives the same pixels.
+ */
+
+#ifndef GBA_BACKEND_H
+#define GBA_BACKEND_H
+
+#ifdef MATH_FLOAT
+#error "the GBA backends are Q16.16; the GBA has no FPU"
+#endif
+
+// fix16_mul() with libfixmath's rounding (FIXMATH_NO_OVERFLOW), inlined
+static inline fix16_t gba_mul(fix16_t a, fix16_t b) {
+    int64_t product = (int64_t)a * b;
+    if (product < 0) product--;
+    return (fix16_t)(product >> 16) + (fix16_t)((product & 0x8000) >> 15);
+}
+
+// Reciprocal LUT: entry i = 65536 / i, 1/i in Q16.16 for i = 1..512
+static const uint32_t recip_lut[TARGET_RECIP_LUT_SIZE] = TARGET_RECIP_LUT;
+
+// 1/x for x >= 1.0: table entries at the integer parts, interpolated on the
+// top 8 bits of the fraction
+static inline fix16_t fast_recip(fix16_t x) {
+    int ix = x >> 16;
+    if (ix > 511) return recip_lut[512];
+    uint32_t base = recip_lut[ix];
+    uint32_t next = recip_lut[ix + 1];
+    int frac = (x >> 8) & 0xFF;
+    return base - (((base - next) * frac) >> 8);
+}
+
+static GAME_HOT fix16_t platform_raster_div(fix16_t a, fix16_t b) {
+    fix16_t mag = b < 0 ? -b : b;
+    if (mag < fix16_one) return fix16_div(a, b);
+    fix16_t q = gba_mul(a, fast_recip(mag));
+    return b < 0 ? -q : q;
+}
+
+static GAME_HOT void platform_mat_mul_pos(Vec3* res, const Mat34* m, const Vec3* v) {
+    fix16_t x = v->x, y = v->y, z = v->z;
+    res->x = gba_mul(x, m->m[0]) + gba_mul(y, m->m[1]) + gba_mul(z, m->m[2]) + m->m[3];
+    res->y = gba_mul(x, m->m[4]) + gba_mul(y, m->m[5]) + gba_mul(z, m->m[6]) + m->m[7];
+    res->z = gba_mul(x, m->m[8]) + gba_mul(y, m->m[9]) + gba_mul(z, m->m[10]) + m->m[11];
+}
+
+#ifdef GBA_SPAN_ASM
+// raster_arm.s: count pixels from dst, texel ((u >> 16) + tex_x) & 127,
+// ((v >> 16) + tex_y) & 127 through the palette map
+extern void render_span_arm(uint8_t* dst, int count, fix16_t u, fix16_t v, fix16_t du, fix16_t dv,
+                            const uint8_t* tex, const uint8_t* pal, int tex_x, int tex_y);
+#endif
+
+// With GBA_SUBDIV_SPANS, perspective correction every GBA_SPAN_SUBDIV
+// pixels and affine steps in between, which keeps close-up boss and ship
+// faces straight. Opt-in (make SUBDIV=1) until make BENCH=1 has measured
+// its cost against the affine spans
+#ifndef GBA_SPAN_SUBDIV_SHIFT
+#define GBA_SPAN_SUBDIV_SHIFT 4
+#endif
+#define GBA_SPAN_SUBDIV (1 << GBA_SPAN_SUBDIV_SHIFT)
+
+// 2^31 / (256 + j), rounded: 1/m for a mantissa m in [256, 512), ~23 bits.
+// recip_lut's entries only keep 8 bits that far up
+#define GBA_RECIP_NORM(j) ((uint32_t)((((1ull << 32) / (256 + (j))) + 1) >> 1))
+static const uint32_t recip_norm_lut[257] = { TARGET_GEN_256(GBA_RECIP_NORM, 0), GBA_RECIP_NORM(256) };
+
+// 1/d in Q16.16 for 0.001 <= d < 32768: d shifted left until bit 30 is
+// its top bit (no CLZ on the ARM7), then the table with linear interpolation
+static inline fix16_t gba_recip(fix16_t d) {
+    uint32_t m = d;
+    int s = 0;
+    if (m < (1u << 15)) { m <<= 16; s += 16; }
+    if (m < (1u << 23)) { m <<= 8; s += 8; }
+    if (m < (1u << 27)) { m <<= 4; s += 4; }
+    if (m < (1u << 29)) { m <<= 2; s += 2; }
+    if (m < (1u << 30)) { m <<= 1; s += 1; }
+    int j = (m >> 22) - 256;
+    uint32_t frac = (m >> 14) & 0xFF;
+    uint32_t r = recip_norm_lut[j] - (((recip_norm_lut[j] - recip_norm_lut[j + 1]) * frac) >> 8);
+    // r = 2^53 / m and 1/d = 2^(32 + s) / m in Q16.16
+    return s >= 21 ? (fix16_t)(r << (s - 21)) : (fix16_t)(r >> (21 - s));
+}
+
+// d = b0 * z0 + b1 * z1 + b2 * z2 and the UVs weighted by the same terms;
+// all three are linear in the weights, so this also gives their steps
+static inline void gba_span_uvd(const RasterTri* t, fix16_t b0, fix16_t b1, fix16_t b2,
+                                fix16_t* ud, fix16_t* vd, fix16_t* d) {
+    fix16_t w0 = gba_mul(b0, t->z0);
+    fix16_t w1 = gba_mul(b1, t->z1);
+    fix16_t w2 = gba_mul(b2, t->z2);
+    *d = w0 + w1 + w2;
+    *ud = gba_mul(w0, t->uv0x) + gba_mul(w1, t->uv1x) + gba_mul(w2, t->uv2x);
+    *vd = gba_mul(w0, t->uv0y) + gba_mul(w1, t->uv1y) + gba_mul(w2, t->uv2y);
+}
+
+// u = ud / d, v = vd / d. Where d degenerates (the reference skips pixels
+// with |d| below 0.001) it is held at 0.001, so only the texels next to
+// that point run off and wrap, as the reference's own do near it
+static inline void gba_persp_uv(fix16_t ud, fix16_t vd, fix16_t d, fix16_t* u, fix16_t* v) {
+    fix16_t mag = d < 0 ? -d : d;
+    if (mag < F16(0.001)) mag = F16(0.001);
+    fix16_t inv = gba_recip(mag);
+    if (d < 0) inv = -inv;
+    *u = gba_mul(ud, inv);
+    *v = gba_mul(vd, inv);
+}
+
+// count pixels of row py from x, stepping u and v
+static inline void gba_span_pixels(GameContext* ctx, int py, int x, int count, fix16_t u, fix16_t v,
+                                   fix16_t du, fix16_t dv, int tex_x, int tex_y) {
+#ifdef GBA_SPAN_ASM
+    render_span_arm(&ctx->p8.screen[py][x], count, u, v, du, dv, &spritesheet[0][0], ctx->p8.palette_map, tex_x, tex_y);
+#else
+    for (int end = x + count; x < end; x++) {
+        PSET_FAST(&ctx->p8, x, py, SGET_FAST(((u >> 16) + tex_x) & 127, ((v >> 16) + tex_y) & 127));
+        u += du;
+        v += dv;
+    }
+#endif
+}
+
+static GAME_HOT void platform_raster_span(GameContext* ctx, const RasterTri* t, const RasterSpan* s) {
+    int xl = fix16_to_int(s->xfirst);
+    int xr = fix16_to_int(s->xlast);
+    if (xl > xr) return;
+
+    // The reference dither switches between 7.0 and 8.875; in between,
+    // alternate spans in a checkerboard of rows and start columns
+    int tex_x = t->tex_x;
+    if (t->light <= F16(7.0) || (t->light <= F16(8.875) && ((s->py ^ xl) & 1))) {
+        tex_x += t->tex_lit_x;
+    }
+
+    // d, u * d and v * d at xl
+    fix16_t ud, vd, d, u, v;
+    gba_span_uvd(t, s->b0, s->b1, fix16_one - s->b0 - s->b1, &ud, &vd, &d);
+    gba_persp_uv(ud, vd, d, &u, &v);
+
+#ifndef GBA_SUBDIV_SPANS
+    // One affine step from xl to xr
+    int n = xr - xl;
+    fix16_t u1 = u, v1 = v, du = 0, dv = 0;
+    if (n) {
+        fix16_t b0 = s->b0 + s->db0_dx * n;
+        fix16_t b1 = s->b1 + s->db1_dx * n;
+        gba_span_uvd(t, b0, b1, fix16_one - b0 - b1, &ud, &vd, &d);
+        gba_persp_uv(ud, vd, d, &u1, &v1);
+        du = gba_mul(u1 - u, recip_lut[n]);
+        dv = gba_mul(v1 - v, recip_lut[n]);
+    }
+    gba_span_pixels(ctx, s->py, xl, n + 1, u, v, du, dv, tex_x, t->tex_y);
+#else
+    // All three are linear along the row: their steps over one subdivision
+    fix16_t dud, dvd, dd;
+    gba_span_uvd(t, s->db0_dx << GBA_SPAN_SUBDIV_SHIFT, s->db1_dx << GBA_SPAN_SUBDIV_SHIFT,
+                 -((s->db0_dx + s->db1_dx) << GBA_SPAN_SUBDIV_SHIFT), &dud, &dvd, &dd);
+
+    for (int x = xl, left = xr - xl + 1; left > 0; x += GBA_SPAN_SUBDIV, left -= GBA_SPAN_SUBDIV) {
+        fix16_t u1 = u, v1 = v, du = 0, dv = 0;
+        if (left > GBA_SPAN_SUBDIV) {
+            d += dd;
+            ud += dud;
+            vd += dvd;
+            gba_persp_uv(ud, vd, d, &u1, &v1);
+            du = (u1 - u) >> GBA_SPAN_SUBDIV_SHIFT;
+            dv = (v1 - v) >> GBA_SPAN_SUBDIV_SHIFT;
+        } else if (left > 1) {
+            // The last segment ends on xr, n pixels on: resolving the next
+            // subdivision point instead could land past the horizon
+            int n = left - 1;
+            fix16_t f = n << (16 - GBA_SPAN_SUBDIV_SHIFT);
+            gba_persp_uv(ud + gba_mul(dud, f), vd + gba_mul(dvd, f), d + gba_mul(dd, f), &u1, &v1);
+            du = gba_mul(u1 - u, recip_lut[n]);
+            dv = gba_mul(v1 - v, recip_lut[n]);
+        }
+        gba_span_pixels(ctx, s->py, x, left < GBA_SPAN_SUBDIV ? left : GBA_SPAN_SUBDIV, u, v, du, dv,
+                        tex_x, t->tex_y);
+        u = u1;
+        v = v1;
+    }
+#endif
+}
+
+#endif // GBA_BACKEND_H
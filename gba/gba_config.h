@@ -0,0 +1,26 @@
+/*
+ * Hyperspace - GBA Configuration
+ * Shared by the GBA build (main_gba.c) and the host build's GBA
+ * configuration (host_platform.h with HOST_GBA_CONFIG)
+ *
+ * Include before pico8_api.h and hyperspace_game.h; gba_backend.h then
+ * provides the backends enabled here. Placement (IWRAM/EWRAM) and the
+ * hardware-only hooks are left to main_gba.c.
+ */
+
+#ifndef GBA_CONFIG_H
+#define GBA_CONFIG_H
+
+// Mode 5 framebuffer, scaled to 240x160 by the BG2 affine registers
+#define TARGET_GBA
+#include "hyperspace_target.h"
+
+#define GAME_PORT_CREDIT "GBA Port by itsmeterada"
+#define GAME_START_PROMPT "PRESS START"
+
+// Backends in gba_backend.h
+#define PLATFORM_RASTER_SPAN
+#define PLATFORM_RASTER_DIV
+#define PLATFORM_MAT_MUL_POS
+
+#endif // GBA_CONFIG_H
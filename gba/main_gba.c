@@ -3,15 +3,26 @@
  * Original game by J-Fry for PICO-8
  * GBA port by itsmeterada
  * Mode 5: 160x128, 15-bit color, double buffered
+ * (GBA_MODE4: Mode 4, 8-bit paletted pages, same 160x128 area; GBA_OBJ
+ * on top of it shows the stars, sun, flare, aim and life bar as OBJs;
+ * GBA_DSOUND: sound mixed in software and played by Direct Sound;
+ * GBA_OVERLAY: simulation and drawing code swapped through IWRAM;
+ * GBA_BENCH: the bench scenarios at boot, timed in cycles)
+ *
+ * This file contains the GBA-specific code: hardware registers, sound,
+ * SRAM saves, input, presentation and the VBlank-paced frame loop. The
+ * game is the shared core (hyperspace_game.h) with the GBA configuration
+ * of gba_config.h and the backends of gba_backend.h; the span loop,
+ * screen clear and palette conversion are ARM code in raster_arm.s.
  */
 
 #include <string.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <stdio.h>
 
-// Include sprite data early (needed for SGET_FAST macro)
-#include "../hyperspace_data.h"
+#include "libfixmath/fixmath.h"
 
 // GBA hardware definitions
 typedef unsigned char u8;
@@ -25,10 +36,12 @@ typedef unsigned long long u64;
 
 // Place large data in EWRAM (256KB) instead of IWRAM (32KB)
 #define EWRAM_DATA __attribute__((section(".ewram")))
+#define EWRAM_BSS __attribute__((section(".sbss")))
 // Place hot code/data in IWRAM (32KB, fast)
 #define IWRAM_CODE __attribute__((section(".iwram"), long_call))
 #define IWRAM_DATA __attribute__((section(".iwram")))
 
+
 #define REG_DISPCNT     (*(volatile u16*)0x04000000)
 #define REG_KEYINPUT    (*(volatile u16*)0x04000130)
 #define REG_VCOUNT      (*(volatile u16*)0x04000006)
@@ -51,9 +64,13 @@ typedef unsigned long long u64;
 #define REG_BG2X        (*(volatile u32*)0x04000028)
 #define REG_BG2Y        (*(volatile u32*)0x0400002C)
 
+#define DCNT_MODE4      0x0004
 #define DCNT_MODE5      0x0005
 #define DCNT_BG2        0x0400
 #define DCNT_PAGE       0x0010
+#define DCNT_OBJ        0x1000
+
+#define REG_BG2CNT      (*(volatile u16*)0x0400000C)
 
 #define KEY_A           0x0001
 #define KEY_B           0x0002
@@ -69,6 +86,10 @@ typedef unsigned long long u64;
 #define VRAM_PAGE1      ((volatile u16*)0x06000000)
 #define VRAM_PAGE2      ((volatile u16*)0x0600A000)
 #define SRAM            ((volatile u8*)0x0E000000)
+#define BG_PALETTE      ((volatile u16*)0x05000000)
+#define OBJ_PALETTE     ((volatile u16*)0x05000200)
+#define OBJ_VRAM        ((volatile u32*)0x06014000)  // tiles 512-1023 in bitmap modes
+#define OAM             ((volatile u32*)0x07000000)
 
 #define RGB15(r,g,b)    (((r)&31) | (((g)&31)<<5) | (((b)&31)<<10))
 
@@ -114,425 +135,158 @@ typedef unsigned long long u64;
 #define SOUND4_L        0x0800
 #define SOUND4_R        0x8000
 
-// Mode 5 framebuffer dimensions (scaled to fill 240x160 screen)
-#define SCREEN_WIDTH    160
-#define SCREEN_HEIGHT   128
-
-// Fixed-point math
-typedef s32 fix16_t;
-#define fix16_one       0x00010000
-#define fix16_pi        0x0003243F
-#define F16(x)          ((fix16_t)((x) * 65536.0f))
-
-// ARM assembly optimized functions (in raster_arm.s)
-extern fix16_t fix16_mul_arm(fix16_t a, fix16_t b);
-extern void render_scanline_arm(volatile u16* row, int xl, int xr, fix16_t u,
-                                 fix16_t v, fix16_t du_dx, fix16_t dv_dx,
-                                 const u8* spritesheet, const u16* palette,
-                                 int tex_offset_x, int tex_y);
-extern void fast_memset16_arm(volatile u16* dest, u16 value, u32 count);
-
-// Use ARM assembly for critical multiply
-#define fix16_mul(a, b) fix16_mul_arm(a, b)
-
-// Optimized division - avoid when possible, use reciprocal multiply instead
-static inline fix16_t fix16_div(fix16_t a, fix16_t b) {
-    if (b == 0) return 0;
-    return (fix16_t)(((s64)a << 16) / b);
-}
-
-// Reciprocal LUT: 1/x for x = 1..512 (covers screen width spans)
-// Entry i = 65536 / i (for integer i)
-static const u32 recip_lut[513] = {
-    0xFFFFFFFF, // 0: unused
-    0x10000, 0x8000, 0x5555, 0x4000, 0x3333, 0x2AAA, 0x2492, 0x2000, // 1-8
-    0x1C71, 0x1999, 0x1745, 0x1555, 0x13B1, 0x1249, 0x1111, 0x1000, // 9-16
-    0x0F0F, 0x0E38, 0x0D79, 0x0CCC, 0x0C30, 0x0BA2, 0x0B21, 0x0AAA, // 17-24
-    0x0A3D, 0x09D8, 0x097B, 0x0924, 0x08D3, 0x0888, 0x0842, 0x0800, // 25-32
-    0x07C1, 0x0787, 0x0750, 0x071C, 0x06EB, 0x06BC, 0x0690, 0x0666, // 33-40
-    0x063E, 0x0618, 0x05F4, 0x05D1, 0x05B0, 0x0590, 0x0572, 0x0555, // 41-48
-    0x0539, 0x051E, 0x0505, 0x04EC, 0x04D4, 0x04BD, 0x04A7, 0x0492, // 49-56
-    0x047D, 0x0469, 0x0456, 0x0444, 0x0432, 0x0421, 0x0410, 0x0400, // 57-64
-    0x03F0, 0x03E0, 0x03D2, 0x03C3, 0x03B5, 0x03A8, 0x039B, 0x038E, // 65-72
-    0x0381, 0x0375, 0x0369, 0x035E, 0x0353, 0x0348, 0x033D, 0x0333, // 73-80
-    0x0329, 0x031F, 0x0315, 0x030C, 0x0303, 0x02FA, 0x02F1, 0x02E8, // 81-88
-    0x02E0, 0x02D8, 0x02D0, 0x02C8, 0x02C0, 0x02B9, 0x02B1, 0x02AA, // 89-96
-    0x02A3, 0x029C, 0x0295, 0x028F, 0x0288, 0x0282, 0x027C, 0x0276, // 97-104
-    0x0270, 0x026A, 0x0264, 0x025E, 0x0259, 0x0253, 0x024E, 0x0249, // 105-112
-    0x0243, 0x023E, 0x0239, 0x0234, 0x0230, 0x022B, 0x0226, 0x0222, // 113-120
-    0x021D, 0x0219, 0x0214, 0x0210, 0x020C, 0x0208, 0x0204, 0x0200, // 121-128
-    0x01FC, 0x01F8, 0x01F4, 0x01F0, 0x01EC, 0x01E9, 0x01E5, 0x01E1, // 129-136
-    0x01DE, 0x01DA, 0x01D7, 0x01D4, 0x01D0, 0x01CD, 0x01CA, 0x01C7, // 137-144
-    0x01C3, 0x01C0, 0x01BD, 0x01BA, 0x01B7, 0x01B4, 0x01B2, 0x01AF, // 145-152
-    0x01AC, 0x01A9, 0x01A6, 0x01A4, 0x01A1, 0x019E, 0x019C, 0x0199, // 153-160
-    0x0197, 0x0194, 0x0192, 0x018F, 0x018D, 0x018A, 0x0188, 0x0186, // 161-168
-    0x0183, 0x0181, 0x017F, 0x017D, 0x017A, 0x0178, 0x0176, 0x0174, // 169-176
-    0x0172, 0x0170, 0x016E, 0x016C, 0x016A, 0x0168, 0x0166, 0x0164, // 177-184
-    0x0162, 0x0160, 0x015E, 0x015C, 0x015A, 0x0158, 0x0157, 0x0155, // 185-192
-    0x0153, 0x0151, 0x0150, 0x014E, 0x014C, 0x014A, 0x0149, 0x0147, // 193-200
-    0x0146, 0x0144, 0x0142, 0x0141, 0x013F, 0x013E, 0x013C, 0x013B, // 201-208
-    0x0139, 0x0138, 0x0136, 0x0135, 0x0133, 0x0132, 0x0130, 0x012F, // 209-216
-    0x012E, 0x012C, 0x012B, 0x0129, 0x0128, 0x0127, 0x0125, 0x0124, // 217-224
-    0x0123, 0x0121, 0x0120, 0x011F, 0x011E, 0x011C, 0x011B, 0x011A, // 225-232
-    0x0119, 0x0118, 0x0116, 0x0115, 0x0114, 0x0113, 0x0112, 0x0111, // 233-240
-    0x010F, 0x010E, 0x010D, 0x010C, 0x010B, 0x010A, 0x0109, 0x0108, // 241-248
-    0x0107, 0x0106, 0x0105, 0x0104, 0x0103, 0x0102, 0x0101, 0x0100, // 249-256
-    0x00FF, 0x00FE, 0x00FD, 0x00FC, 0x00FB, 0x00FA, 0x00F9, 0x00F8, // 257-264
-    0x00F8, 0x00F7, 0x00F6, 0x00F5, 0x00F4, 0x00F3, 0x00F2, 0x00F2, // 265-272
-    0x00F1, 0x00F0, 0x00EF, 0x00EE, 0x00EE, 0x00ED, 0x00EC, 0x00EB, // 273-280
-    0x00EB, 0x00EA, 0x00E9, 0x00E8, 0x00E8, 0x00E7, 0x00E6, 0x00E5, // 281-288
-    0x00E5, 0x00E4, 0x00E3, 0x00E3, 0x00E2, 0x00E1, 0x00E1, 0x00E0, // 289-296
-    0x00DF, 0x00DF, 0x00DE, 0x00DD, 0x00DD, 0x00DC, 0x00DB, 0x00DB, // 297-304
-    0x00DA, 0x00DA, 0x00D9, 0x00D8, 0x00D8, 0x00D7, 0x00D7, 0x00D6, // 305-312
-    0x00D5, 0x00D5, 0x00D4, 0x00D4, 0x00D3, 0x00D3, 0x00D2, 0x00D1, // 313-320
-    0x00D1, 0x00D0, 0x00D0, 0x00CF, 0x00CF, 0x00CE, 0x00CE, 0x00CD, // 321-328
-    0x00CD, 0x00CC, 0x00CC, 0x00CB, 0x00CB, 0x00CA, 0x00CA, 0x00C9, // 329-336
-    0x00C9, 0x00C8, 0x00C8, 0x00C7, 0x00C7, 0x00C6, 0x00C6, 0x00C5, // 337-344
-    0x00C5, 0x00C4, 0x00C4, 0x00C3, 0x00C3, 0x00C3, 0x00C2, 0x00C2, // 345-352
-    0x00C1, 0x00C1, 0x00C0, 0x00C0, 0x00BF, 0x00BF, 0x00BF, 0x00BE, // 353-360
-    0x00BE, 0x00BD, 0x00BD, 0x00BD, 0x00BC, 0x00BC, 0x00BB, 0x00BB, // 361-368
-    0x00BB, 0x00BA, 0x00BA, 0x00B9, 0x00B9, 0x00B9, 0x00B8, 0x00B8, // 369-376
-    0x00B7, 0x00B7, 0x00B7, 0x00B6, 0x00B6, 0x00B6, 0x00B5, 0x00B5, // 377-384
-    0x00B5, 0x00B4, 0x00B4, 0x00B3, 0x00B3, 0x00B3, 0x00B2, 0x00B2, // 385-392
-    0x00B2, 0x00B1, 0x00B1, 0x00B1, 0x00B0, 0x00B0, 0x00B0, 0x00AF, // 393-400
-    0x00AF, 0x00AF, 0x00AE, 0x00AE, 0x00AE, 0x00AD, 0x00AD, 0x00AD, // 401-408
-    0x00AC, 0x00AC, 0x00AC, 0x00AB, 0x00AB, 0x00AB, 0x00AB, 0x00AA, // 409-416
-    0x00AA, 0x00AA, 0x00A9, 0x00A9, 0x00A9, 0x00A8, 0x00A8, 0x00A8, // 417-424
-    0x00A8, 0x00A7, 0x00A7, 0x00A7, 0x00A6, 0x00A6, 0x00A6, 0x00A6, // 425-432
-    0x00A5, 0x00A5, 0x00A5, 0x00A4, 0x00A4, 0x00A4, 0x00A4, 0x00A3, // 433-440
-    0x00A3, 0x00A3, 0x00A3, 0x00A2, 0x00A2, 0x00A2, 0x00A2, 0x00A1, // 441-448
-    0x00A1, 0x00A1, 0x00A0, 0x00A0, 0x00A0, 0x00A0, 0x009F, 0x009F, // 449-456
-    0x009F, 0x009F, 0x009E, 0x009E, 0x009E, 0x009E, 0x009E, 0x009D, // 457-464
-    0x009D, 0x009D, 0x009D, 0x009C, 0x009C, 0x009C, 0x009C, 0x009B, // 465-472
-    0x009B, 0x009B, 0x009B, 0x009A, 0x009A, 0x009A, 0x009A, 0x009A, // 473-480
-    0x0099, 0x0099, 0x0099, 0x0099, 0x0098, 0x0098, 0x0098, 0x0098, // 481-488
-    0x0098, 0x0097, 0x0097, 0x0097, 0x0097, 0x0097, 0x0096, 0x0096, // 489-496
-    0x0096, 0x0096, 0x0096, 0x0095, 0x0095, 0x0095, 0x0095, 0x0095, // 497-504
-    0x0094, 0x0094, 0x0094, 0x0094, 0x0094, 0x0093, 0x0093, 0x0093, // 505-512
-};
-
-// Fast reciprocal using LUT - returns 1/x where x is fix16
-// For span calculations in rasterizer (x typically 0.5 to 160)
-IWRAM_CODE static inline fix16_t fast_recip(fix16_t x) {
-    if (x <= 0) return 0;
-    // For small values (< 1.0), fall back to accurate division
-    if (x < fix16_one) {
-        return fix16_div(fix16_one, x);
-    }
-    // For values >= 1.0, use LUT with linear interpolation
-    int ix = x >> 16;  // Integer part
-    if (ix > 511) return recip_lut[512];
-    // Get base value from LUT
-    u32 base = recip_lut[ix];
-    u32 next = recip_lut[ix + 1];
-    // Linear interpolation using fractional part
-    int frac = (x >> 8) & 0xFF;  // 8-bit fractional part
-    return base - (((base - next) * frac) >> 8);
-}
-
-static inline fix16_t fix16_from_int(int a) { return a << 16; }
-static inline int fix16_to_int(fix16_t a) { return a >> 16; }
-static inline fix16_t fix16_floor(fix16_t x) { return x & 0xFFFF0000; }
-static inline fix16_t fix16_abs(fix16_t x) { return x < 0 ? -x : x; }
-static inline fix16_t fix16_min(fix16_t a, fix16_t b) { return a < b ? a : b; }
-static inline fix16_t fix16_max(fix16_t a, fix16_t b) { return a > b ? a : b; }
-
-// Sin/Cos LUT (256 entries)
-static const s16 sin_lut[256] = {
-    0,402,804,1205,1606,2006,2404,2801,3196,3590,3981,4370,4756,5139,5520,5897,
-    6270,6639,7005,7366,7723,8076,8423,8765,9102,9434,9760,10080,10394,10702,11003,11297,
-    11585,11866,12140,12406,12665,12916,13160,13395,13623,13842,14053,14256,14449,14635,14811,14978,
-    15137,15286,15426,15557,15679,15791,15893,15986,16069,16143,16207,16261,16305,16340,16364,16379,
-    16384,16379,16364,16340,16305,16261,16207,16143,16069,15986,15893,15791,15679,15557,15426,15286,
-    15137,14978,14811,14635,14449,14256,14053,13842,13623,13395,13160,12916,12665,12406,12140,11866,
-    11585,11297,11003,10702,10394,10080,9760,9434,9102,8765,8423,8076,7723,7366,7005,6639,
-    6270,5897,5520,5139,4756,4370,3981,3590,3196,2801,2404,2006,1606,1205,804,402,
-    0,-402,-804,-1205,-1606,-2006,-2404,-2801,-3196,-3590,-3981,-4370,-4756,-5139,-5520,-5897,
-    -6270,-6639,-7005,-7366,-7723,-8076,-8423,-8765,-9102,-9434,-9760,-10080,-10394,-10702,-11003,-11297,
-    -11585,-11866,-12140,-12406,-12665,-12916,-13160,-13395,-13623,-13842,-14053,-14256,-14449,-14635,-14811,-14978,
-    -15137,-15286,-15426,-15557,-15679,-15791,-15893,-15986,-16069,-16143,-16207,-16261,-16305,-16340,-16364,-16379,
-    -16384,-16379,-16364,-16340,-16305,-16261,-16207,-16143,-16069,-15986,-15893,-15791,-15679,-15557,-15426,-15286,
-    -15137,-14978,-14811,-14635,-14449,-14256,-14053,-13842,-13623,-13395,-13160,-12916,-12665,-12406,-12140,-11866,
-    -11585,-11297,-11003,-10702,-10394,-10080,-9760,-9434,-9102,-8765,-8423,-8076,-7723,-7366,-7005,-6639,
-    -6270,-5897,-5520,-5139,-4756,-4370,-3981,-3590,-3196,-2801,-2404,-2006,-1606,-1205,-804,-402,
-};
-
-static inline fix16_t fix16_sin(fix16_t angle) {
-    int idx = ((angle * 256) / 411775) & 255;
-    return (fix16_t)sin_lut[idx] << 2;  // Standard sin (same as libfixmath)
-}
-
-static inline fix16_t fix16_cos(fix16_t angle) {
-    int idx = (((angle * 256) / 411775) + 64) & 255;
-    return (fix16_t)sin_lut[idx] << 2;
-}
-
-// Fast integer square root (for initial guess)
-static inline u32 isqrt(u32 n) {
-    u32 x = n, y = (x + 1) >> 1;
-    while (y < x) { x = y; y = (x + n / x) >> 1; }
-    return x;
-}
-
-// Optimized fixed-point sqrt using better initial guess
-static inline fix16_t fix16_sqrt(fix16_t x) {
-    if (x <= 0) return 0;
-    // sqrt(x) in Q16.16 = sqrt(x * 65536) / 256 * 65536 = sqrt(x) * 256
-    // Use integer sqrt for speed
-    u32 val = (u32)x;
-    u32 root = isqrt(val << 8);  // Shift for more precision
-    return (fix16_t)(root << 4);
-}
-
-// PICO-8 palette in RGB555 (accurate conversion from 8-bit)
-// Formula: 5-bit = round(8-bit * 31 / 255)
-static const u16 PICO8_PALETTE[16] = {
-    RGB15(0,0,0),      //  0: #000000 black
-    RGB15(4,5,10),     //  1: #1D2B53 dark blue
-    RGB15(15,5,10),    //  2: #7E2553 dark purple
-    RGB15(0,16,10),    //  3: #008751 dark green
-    RGB15(21,10,7),    //  4: #AB5236 brown
-    RGB15(12,11,10),   //  5: #5F574F dark gray
-    RGB15(24,24,24),   //  6: #C2C3C7 light gray
-    RGB15(31,29,28),   //  7: #FFF1E8 white
-    RGB15(31,0,9),     //  8: #FF004D red
-    RGB15(31,20,0),    //  9: #FFA300 orange
-    RGB15(31,29,5),    // 10: #FFEC27 yellow
-    RGB15(0,28,7),     // 11: #00E436 green
-    RGB15(5,21,31),    // 12: #29ADFF blue
-    RGB15(16,14,19),   // 13: #83769C indigo
-    RGB15(31,14,20),   // 14: #FF77A8 pink
-    RGB15(31,25,21),   // 15: #FFCCAA peach
-};
-
-// Render directly to VRAM in RGB555 format (no intermediate buffer)
-EWRAM_DATA static u8 map_memory[0x1000];
-static u16 palette_map[16];  // Now stores RGB555 colors directly
-static u16 draw_color_rgb = 0x7FFF;
-static u32 rnd_state = 1;
-static bool btn_state[7] = {false};
-static bool btn_prev[7] = {false};
-EWRAM_DATA static s32 cart_data[64];
-static int current_page = 0;
-static volatile u16* vram_buffer;  // Points to back buffer
-
-// Dither pattern in IWRAM for fast access
-IWRAM_DATA static u8 dither_pattern[8][8];
-
-// Spritesheet stays in ROM (const) for faster access
-// Will be accessed via hyperspace_spritesheet directly
-
-// Fast inline macros for pixel operations (no function call overhead)
-#define SGET_FAST(x, y) (hyperspace_spritesheet[y][x])
-#define VRAM_PSET(x, y, c) do { \
-    if ((unsigned)(x) < SCREEN_WIDTH && (unsigned)(y) < SCREEN_HEIGHT) \
-        vram_buffer[(y) * SCREEN_WIDTH + (x)] = (c); \
-} while(0)
-#define VRAM_PSET_FAST(x, y, c) (vram_buffer[(y) * SCREEN_WIDTH + (x)] = (c))
-
-#define FIX_HALF F16(0.5)
-#define FIX_TWO F16(2.0)
-#define FIX_TWO_PI F16(6.28318530718)
-// Screen center for 160x128
-#define FIX_SCREEN_CENTER_X F16(80.0)
-#define FIX_SCREEN_CENTER_Y F16(64.0)
-#define FIX_PROJ_CONST F16(-75.0)
-
-// Clipping region
-static int clip_x1 = 0, clip_y1 = 0, clip_x2 = SCREEN_WIDTH - 1, clip_y2 = SCREEN_HEIGHT - 1;
-
-// Fast DMA copy (from mode5.c)
-static inline void DMAFastCopy(void* source, void* dest, u32 count, u32 mode) {
-    REG_DMA3SAD = (u32)source;
-    REG_DMA3DAD = (u32)dest;
-    REG_DMA3CNT = count | mode;
-}
-
-// Clear color for DMA fill
-static u16 clear_color = 0;
-
-// PICO-8 API - Optimized for direct VRAM rendering
-static void cls(void) {
-    // Fast clear using DMA with fixed source (fill mode)
-    DMAFastCopy(&clear_color, (void*)vram_buffer, SCREEN_WIDTH * SCREEN_HEIGHT,
-                DMA_SRC_FIXED | DMA_DST_INC | DMA_16BIT | DMA_ENABLE);
-}
-
-static inline void pset(int x, int y, int c) {
-    if ((unsigned)x < (unsigned)SCREEN_WIDTH && (unsigned)y < (unsigned)SCREEN_HEIGHT)
-        vram_buffer[y * SCREEN_WIDTH + x] = palette_map[c & 15];
-}
-
-static inline u16 pget_rgb(int x, int y) {
-    if ((unsigned)x < (unsigned)SCREEN_WIDTH && (unsigned)y < (unsigned)SCREEN_HEIGHT)
-        return vram_buffer[y * SCREEN_WIDTH + x];
-    return 0;
-}
-
-// sget returns palette index from ROM spritesheet
-static inline u8 sget(int x, int y) {
-    return SGET_FAST(x, y);
-}
-
-static void line(int x0, int y0, int x1, int y1, int c) {
-    u16 col = palette_map[c & 15];
-    int dx = x1 - x0, dy = y1 - y0;
-    int sx = dx < 0 ? -1 : 1, sy = dy < 0 ? -1 : 1;
-    dx = dx < 0 ? -dx : dx; dy = dy < 0 ? -dy : dy;
-    int err = dx - dy;
-    while (1) {
-        VRAM_PSET(x0, y0, col);
-        if (x0 == x1 && y0 == y1) break;
-        int e2 = 2 * err;
-        if (e2 > -dy) { err -= dy; x0 += sx; }
-        if (e2 < dx) { err += dx; y0 += sy; }
-    }
-}
-
-static void rectfill(int x0, int y0, int x1, int y1, int c) {
-    u16 col = palette_map[c & 15];
-    if (x0 > x1) { int t = x0; x0 = x1; x1 = t; }
-    if (y0 > y1) { int t = y0; y0 = y1; y1 = t; }
-    if (x0 < 0) x0 = 0; if (x1 >= SCREEN_WIDTH) x1 = SCREEN_WIDTH - 1;
-    if (y0 < 0) y0 = 0; if (y1 >= SCREEN_HEIGHT) y1 = SCREEN_HEIGHT - 1;
-    for (int y = y0; y <= y1; y++) {
-        volatile u16* row = &vram_buffer[y * SCREEN_WIDTH];
-        for (int x = x0; x <= x1; x++) row[x] = col;
-    }
-}
-
-static void circfill(int cx, int cy, int r, int c) {
-    u16 col = palette_map[c & 15];
-    int r2 = r * r;
-    for (int dy = -r; dy <= r; dy++) {
-        int py = cy + dy;
-        if ((unsigned)py >= (unsigned)SCREEN_HEIGHT) continue;
-        int max_x = 0;
-        while (max_x <= r && max_x * max_x + dy * dy <= r2) max_x++;
-        max_x--;
-        int x0 = cx - max_x, x1 = cx + max_x;
-        if (x0 < 0) x0 = 0; if (x1 >= SCREEN_WIDTH) x1 = SCREEN_WIDTH - 1;
-        volatile u16* row = &vram_buffer[py * SCREEN_WIDTH];
-        for (int px = x0; px <= x1; px++) row[px] = col;
-    }
-}
-
-static void spr(int n, int x, int y, int w, int h) {
-    int sx = (n & 15) * 8, sy = (n >> 4) * 8;
-    int pw = w * 8, ph = h * 8;
-    for (int py = 0; py < ph; py++) {
-        int dy = y + py;
-        if (dy < clip_y1 || dy > clip_y2) continue;
-        if ((unsigned)dy >= (unsigned)SCREEN_HEIGHT) continue;
-        volatile u16* row = &vram_buffer[dy * SCREEN_WIDTH];
-        for (int px = 0; px < pw; px++) {
-            int dx = x + px;
-            if (dx < clip_x1 || dx > clip_x2) continue;
-            if ((unsigned)dx >= (unsigned)SCREEN_WIDTH) continue;
-            u8 c = SGET_FAST(sx + px, sy + py);
-            if (c != 0) row[dx] = palette_map[c];
-        }
-    }
-}
-
-static void pal_reset(void) { for (int i = 0; i < 16; i++) palette_map[i] = PICO8_PALETTE[i]; }
-static void pal(int c0, int c1) { palette_map[c0 & 15] = PICO8_PALETTE[c1 & 15]; }
-static void clip_set(int x, int y, int w, int h) { clip_x1 = x; clip_y1 = y; clip_x2 = x + w - 1; clip_y2 = y + h - 1; }
-static void clip_reset(void) { clip_x1 = 0; clip_y1 = 0; clip_x2 = SCREEN_WIDTH - 1; clip_y2 = SCREEN_HEIGHT - 1; }
-static void color(int c) { draw_color_rgb = palette_map[c & 15]; }
-
-// Font data (3x5)
-static const u8 font_data[96][5] = {
-    {0,0,0,0,0},{2,2,2,0,2},{5,5,0,0,0},{5,7,5,7,5},{6,3,6,3,6},{1,4,2,1,4},{2,5,2,5,3},{2,2,0,0,0},
-    {1,2,2,2,1},{4,2,2,2,4},{5,2,5,0,0},{0,2,7,2,0},{0,0,0,2,4},{0,0,7,0,0},{0,0,0,0,2},{1,1,2,4,4},
-    {2,5,5,5,2},{2,6,2,2,7},{6,1,2,4,7},{6,1,2,1,6},{5,5,7,1,1},{7,4,6,1,6},{3,4,6,5,2},{7,1,2,2,2},
-    {2,5,2,5,2},{2,5,3,1,6},{0,2,0,2,0},{0,2,0,2,4},{1,2,4,2,1},{0,7,0,7,0},{4,2,1,2,4},{2,5,1,0,2},
-    {2,5,5,4,3},{2,5,7,5,5},{6,5,6,5,6},{3,4,4,4,3},{6,5,5,5,6},{7,4,6,4,7},{7,4,6,4,4},{3,4,5,5,3},
-    {5,5,7,5,5},{7,2,2,2,7},{1,1,1,5,2},{5,5,6,5,5},{4,4,4,4,7},{5,7,5,5,5},{5,7,7,5,5},{2,5,5,5,2},
-    {6,5,6,4,4},{2,5,5,6,3},{6,5,6,5,5},{3,4,2,1,6},{7,2,2,2,2},{5,5,5,5,2},{5,5,5,5,2},{5,5,5,7,5},
-    {5,5,2,5,5},{5,5,2,2,2},{7,1,2,4,7},{3,2,2,2,3},{4,4,2,1,1},{6,2,2,2,6},{2,5,0,0,0},{0,0,0,0,7},
-    {4,2,0,0,0},{0,3,5,5,3},{4,6,5,5,6},{0,3,4,4,3},{1,3,5,5,3},{0,2,5,6,3},{1,2,7,2,2},{0,3,5,3,6},
-    {4,6,5,5,5},{2,0,2,2,2},{1,0,1,1,6},{4,5,6,5,5},{2,2,2,2,1},{0,5,7,5,5},{0,6,5,5,5},{0,2,5,5,2},
-    {0,6,5,6,4},{0,3,5,3,1},{0,3,4,4,4},{0,3,6,1,6},{2,7,2,2,1},{0,5,5,5,3},{0,5,5,5,2},{0,5,5,7,5},
-    {0,5,2,2,5},{0,5,5,3,6},{0,7,1,4,7},{1,2,6,2,1},{2,2,2,2,2},{4,2,3,2,4},{5,2,0,0,0},{0,0,0,0,0},
-};
-
-static void print_char(char c, int x, int y, int col) {
-    if (c < 32 || c > 127) return;
-    int idx = c - 32;
-    for (int row = 0; row < 5; row++) {
-        u8 bits = font_data[idx][row];
-        for (int i = 0; i < 3; i++)
-            if (bits & (0x4 >> i)) pset(x + i, y + row, col);
-    }
-}
-
-static void print_str(const char* str, int x, int y, int col) {
-    int cx = x;
-    while (*str) {
-        if (*str == '\n') { y += 6; cx = x; }
-        else { print_char(*str, cx, y, col); cx += 4; }
-        str++;
-    }
-}
-
-static fix16_t rnd_fix(fix16_t max) {
-    rnd_state = rnd_state * 1103515245 + 12345;
-    u16 frac = (rnd_state >> 16) & 0xFFFF;
-    return (fix16_t)(((s64)max * frac) >> 16);
-}
-
-static int flr_fix(fix16_t x) {
-    if (x >= 0) return x >> 16;
-    return (x >> 16) - ((x & 0xFFFF) ? 1 : 0);
-}
-
-static fix16_t mid_fix(fix16_t a, fix16_t b, fix16_t c) {
-    if (a > b) { fix16_t t = a; a = b; b = t; }
-    if (b > c) b = c;
-    if (a > b) b = a;
-    return b;
-}
-
-static fix16_t sgn_fix(fix16_t x) {
-    if (x > 0) return fix16_one;
-    if (x < 0) return -fix16_one;
-    return 0;
-}
-
-static bool btn(int n) { return btn_state[n]; }
-static bool btnp(int n) { return btn_state[n] && !btn_prev[n]; }
+// Direct Sound A (GBA_DSOUND): timer 0 paces FIFO A, DMA1 refills it
+#define REG_FIFO_A      0x040000A0
+#define REG_DMA1SAD     (*(volatile u32*)0x040000BC)
+#define REG_DMA1DAD     (*(volatile u32*)0x040000C0)
+#define REG_DMA1CNT     (*(volatile u32*)0x040000C4)
+#define DMA_DST_FIXED   0x00400000
+#define DMA_REPEAT      0x02000000
+#define DMA_START_FIFO  0x30000000
+#define REG_TM0D        (*(volatile u16*)0x04000100)
+#define REG_TM0CNT      (*(volatile u16*)0x04000102)
+#define TIMER_ENABLE    0x0080
+#define DSA_FULL_VOLUME 0x0004
+#define DSA_RIGHT       0x0100
+#define DSA_LEFT        0x0200
+#define DSA_FIFO_RESET  0x0800
+
+// Timers 2 and 3, cascaded into a 32-bit cycle counter
+#define REG_TM2D        (*(volatile u16*)0x04000108)
+#define REG_TM2CNT      (*(volatile u16*)0x0400010A)
+#define REG_TM3D        (*(volatile u16*)0x0400010C)
+#define REG_TM3CNT      (*(volatile u16*)0x0400010E)
+#define TIMER_CASCADE   0x0004
+
+// Interrupts
+#define REG_DISPSTAT    (*(volatile u16*)0x04000004)
+#define REG_IE          (*(volatile u16*)0x04000200)
+#define REG_IF          (*(volatile u16*)0x04000202)
+#define REG_IME         (*(volatile u16*)0x04000208)
+#define REG_IFBIOS      (*(volatile u16*)0x03007FF8)  // acknowledged for the BIOS waits
+#define REG_ISR_MAIN    (*(void (**)(void))0x03007FFC)
+#define DSTAT_VBL_IRQ   0x0008
+#define IRQ_VBLANK      0x0001
+
+// ============================================================================
+// Screen and Core Configuration
+// ============================================================================
+
+#include "gba_config.h"
+
+// Transform and rasterizer in IWRAM as ARM code (Thumb is slower for
+// math-heavy code); the sprite sheet and map stay in EWRAM
+#define GAME_HOT IWRAM_CODE __attribute__((target("arm")))
+#define PICO8_BSS EWRAM_BSS
+#define PLATFORM_CLS
+#define GBA_SPAN_ASM
+#define GAME_LOG(...) ((void)0)
+
+#ifdef GBA_OVERLAY
+// The simulation and the rest of the drawing (game_draw()'s loops, lasers,
+// explosions, HUD) as ARM code in two overlays that share one IWRAM window:
+// devkitARM's linker script links .iwram0-9 at the same address and keeps
+// their contents in ROM. GAME_OVERLAY() copies the phase's overlay in at
+// the start of game_update() and game_draw(). The mixer runs from the VBlank
+// interrupt at any point of the frame, so it stays resident.
+#define GAME_SIM __attribute__((section(".iwram0"), long_call, target("arm")))
+#define GAME_DRAW __attribute__((section(".iwram1"), long_call, target("arm")))
+#define GAME_OVERLAY(overlay) overlay_load(overlay)
+
+extern u32 __iwram_overlay_start[];
+extern u32 __load_start_iwram0[], __load_stop_iwram0[];
+extern u32 __load_start_iwram1[], __load_stop_iwram1[];
+
+static int overlay_current = -1;
+// Words copied since boot, to weigh the copies against the time saved
+volatile u32 overlay_copy_words;
+
+static void overlay_load(int overlay) {
+    if (overlay == overlay_current) return;
+    u32 *start = overlay ? __load_start_iwram1 : __load_start_iwram0;
+    u32 *stop = overlay ? __load_stop_iwram1 : __load_stop_iwram0;
+    u32 words = stop - start;
+    REG_DMA3SAD = (u32)start;
+    REG_DMA3DAD = (u32)__iwram_overlay_start;
+    REG_DMA3CNT = words | DMA_32BIT | DMA_DST_INC | DMA_ENABLE;
+    overlay_copy_words += words;
+    overlay_current = overlay;
+}
+#endif
+
+#ifdef GBA_OBJ
+#ifndef GBA_MODE4
+#error "GBA_OBJ needs GBA_MODE4: background OBJs show through palette index 0"
+#endif
+#define PLATFORM_OBJ
+// Index 0 of the page is where background OBJs show, so drawn black is
+// this opaque copy of colour 0 instead
+#define PICO8_DRAWN_BLACK 16
+#endif
+
+// PICO-8 palette in RGB555 (hyperspace_target.h)
+static const u16 PICO8_PALETTE[16] = TARGET_PICO8_PALETTE;
+
+// ============================================================================
+// Buffers, State and Pico-8 API (required by hyperspace_game.h)
+// ============================================================================
+
+#include "pico8_api.h"
+
+// ============================================================================
+// SRAM Save/Load
+// ============================================================================
 
-// SRAM save/load
 #define SRAM_MAGIC 0x48595045
-static void load_cart_data(void) {
+static void load_cart_data(Pico8* p8) {
     u32 magic = SRAM[0] | (SRAM[1]<<8) | (SRAM[2]<<16) | (SRAM[3]<<24);
     if (magic == SRAM_MAGIC) {
         for (int i = 0; i < 64; i++) {
-            cart_data[i] = SRAM[4+i*4] | (SRAM[5+i*4]<<8) | (SRAM[6+i*4]<<16) | (SRAM[7+i*4]<<24);
+            p8->cart_data[i] = SRAM[4+i*4] | (SRAM[5+i*4]<<8) | (SRAM[6+i*4]<<16) | (SRAM[7+i*4]<<24);
         }
     }
 }
 
-static void save_cart_data(void) {
+static void save_cart_data(Pico8* p8) {
+    if (!p8->cart_data_dirty) return;
     SRAM[0] = SRAM_MAGIC & 0xFF; SRAM[1] = (SRAM_MAGIC>>8)&0xFF;
     SRAM[2] = (SRAM_MAGIC>>16)&0xFF; SRAM[3] = (SRAM_MAGIC>>24)&0xFF;
     for (int i = 0; i < 64; i++) {
-        SRAM[4+i*4] = cart_data[i]&0xFF; SRAM[5+i*4] = (cart_data[i]>>8)&0xFF;
-        SRAM[6+i*4] = (cart_data[i]>>16)&0xFF; SRAM[7+i*4] = (cart_data[i]>>24)&0xFF;
+        s32 v = p8->cart_data[i];
+        SRAM[4+i*4] = v&0xFF; SRAM[5+i*4] = (v>>8)&0xFF;
+        SRAM[6+i*4] = (v>>16)&0xFF; SRAM[7+i*4] = (v>>24)&0xFF;
     }
+    p8->cart_data_dirty = false;
 }
 
-static s32 dget(int n) { if (n >= 0 && n < 64) return cart_data[n]; return 0; }
-static void dset(int n, s32 v) { if (n >= 0 && n < 64 && cart_data[n] != v) cart_data[n] = v; }
+// =============================================================================
+// Cycle Counter
+// =============================================================================
+
+// Timer 2 counts CPU cycles and timer 3 its overflows: 32 bits, wrapping
+// after 256 seconds
+static void timer_init(void) {
+    REG_TM2CNT = 0;
+    REG_TM3CNT = 0;
+    REG_TM2D = 0;
+    REG_TM3D = 0;
+    REG_TM3CNT = TIMER_CASCADE | TIMER_ENABLE;
+    REG_TM2CNT = TIMER_ENABLE;
+}
+
+static inline u32 cycle_now(void) {
+    u16 hi, lo;
+    do {
+        hi = REG_TM3D;
+        lo = REG_TM2D;
+    } while (hi != REG_TM3D);
+    return ((u32)hi << 16) | lo;
+}
 
 // =============================================================================
 // GBA Sound System (PICO-8 Compatible)
 // =============================================================================
 
-// Forward declaration - sound is optional and off by default
-static int sound_enabled;
-
 // PICO-8 frequency table (Hz) for notes 0-63
 static const u16 p8_freq_table[64] = {
     65, 69, 73, 78, 82, 87, 92, 98,
@@ -659,6 +413,214 @@ static const P8SFX hyperspace_sfx[] = {
 
 #define NUM_GBA_SFX (sizeof(hyperspace_sfx) / sizeof(hyperspace_sfx[0]))
 
+#ifdef GBA_DSOUND
+// =============================================================================
+// Direct Sound Mixer
+// =============================================================================
+//
+// All four channels are synthesized in software and played through Direct
+// Sound A. Timer 0 overflows once per sample and pulls the next byte from
+// FIFO A; DMA1 refills the FIFO from the buffer playing. 224 samples at
+// 13379 Hz are exactly one frame (224 * 1254 = 280896 cycles), so the VBlank
+// interrupt restarts DMA1 on the buffer mixed during the previous VBlank and
+// mixes the other one (dsound_swap(), then dsound_fill()). Playback runs one
+// frame behind sfx() and does not depend on the game's frame rate.
+//
+// The mixer is ARM code in IWRAM, one channel at a time into a 16-bit
+// accumulator, which is clamped to 8 bits at the end. Its cost in CPU
+// cycles is kept in dsound_mix_cycles and dsound_mix_peak.
+
+#define DSOUND_RATE         13379
+#define DSOUND_SAMPLES      224                     // per frame, a multiple of 16
+#define DSOUND_TIMER_RELOAD (65536 - 1254)          // 16.78 MHz / 1254
+// PICO-8 notes last speed * 183 samples at 22050 Hz
+#define DSOUND_NOTE_SAMPLES (183 * DSOUND_RATE / 22050)
+
+// Waveform tables, amplitude -32..31: 64 entries for the tonal waveforms,
+// 256 for noise so it repeats less audibly
+#define DSOUND_WAVE_SIZE    64
+#define DSOUND_NOISE_SIZE   256
+#define DSOUND_WAVE_NOISE   6
+
+typedef struct {
+    const P8SFX *sfx;
+    const s8 *wave;
+    u32 phase;
+    u32 step;           // phase per sample, 2^32 = one period
+    u32 shift;          // phase to table index
+    s32 volume;         // 0-7
+    s32 remain;         // samples left in the note
+    u8 note_index;
+    bool active;
+} DSoundChannel;
+
+IWRAM_DATA static DSoundChannel dsound_channels[4];
+IWRAM_DATA static s8 dsound_waves[7 * DSOUND_WAVE_SIZE + DSOUND_NOISE_SIZE];
+IWRAM_DATA static s16 dsound_mix_buf[DSOUND_SAMPLES];
+IWRAM_DATA static s8 dsound_buffer[2][DSOUND_SAMPLES] __attribute__((aligned(4)));
+static u32 dsound_steps[64];
+static u32 dsound_page;
+static bool sound_initialized = false;
+
+// Mixer cost in CPU cycles: last VBlank and the highest so far
+volatile u32 dsound_mix_cycles;
+volatile u32 dsound_mix_peak;
+
+static const s8 *dsound_wave(int waveform) {
+    if (waveform == DSOUND_WAVE_NOISE) return &dsound_waves[7 * DSOUND_WAVE_SIZE];
+    if (waveform > DSOUND_WAVE_NOISE) waveform--;
+    return &dsound_waves[waveform * DSOUND_WAVE_SIZE];
+}
+
+// One period of PICO-8 waveform 0-7 (except noise), t = 0..63
+static int dsound_wave_sample(int waveform, int t) {
+    int tri = t < 32 ? t * 2 - 32 : 95 - t * 2;
+    int tri3 = (t * 3) & 63;
+    tri3 = tri3 < 32 ? tri3 * 2 - 32 : 95 - tri3 * 2;
+    switch (waveform) {
+    case 0: return tri;                                                 // triangle
+    case 1: return t < 56 ? -32 + t * 63 / 56 : 31 - (t - 56) * 63 / 8;  // tilted saw
+    case 2: return t - 32;                                              // saw
+    case 3: return t < 32 ? 31 : -32;                                   // square
+    case 4: return t < 20 ? 31 : -32;                                   // pulse
+    case 5: {                                                           // organ
+        int t2 = (t * 2) & 63;
+        return (tri + (t2 < 32 ? t2 * 2 - 32 : 95 - t2 * 2)) / 2;
+    }
+    default: return (tri * 3 + tri3) / 4;                               // phaser
+    }
+}
+
+// Start the next note, or end the sfx at a silent note or after note 31
+static GAME_HOT void dsound_next_note(DSoundChannel *ch) {
+    if (++ch->note_index >= 32 || ch->sfx->notes[ch->note_index][2] == 0) {
+        ch->active = false;
+        return;
+    }
+    const u8 *note = ch->sfx->notes[ch->note_index];
+    u8 pitch = note[0] < 64 ? note[0] : 63;
+    ch->wave = dsound_wave(note[1] & 7);
+    ch->shift = (note[1] & 7) == DSOUND_WAVE_NOISE ? 24 : 26;
+    ch->step = dsound_steps[pitch];
+    ch->volume = note[2] & 7;
+    ch->remain = (ch->sfx->speed ? ch->sfx->speed : 1) * DSOUND_NOTE_SAMPLES;
+}
+
+// Mix DSOUND_SAMPLES of every active channel into out
+static GAME_HOT void dsound_mix(s8 *out) {
+    s16 *mix = dsound_mix_buf;
+    for (int i = 0; i < DSOUND_SAMPLES; i++) mix[i] = 0;
+
+    for (int c = 0; c < 4; c++) {
+        DSoundChannel *ch = &dsound_channels[c];
+        int pos = 0;
+        while (ch->active && pos < DSOUND_SAMPLES) {
+            int n = DSOUND_SAMPLES - pos;
+            if (n > ch->remain) n = ch->remain;
+            const s8 *wave = ch->wave;
+            u32 phase = ch->phase, step = ch->step, shift = ch->shift;
+            s32 volume = ch->volume;
+            s16 *m = mix + pos;
+            for (int i = 0; i < n; i++) {
+                m[i] += wave[phase >> shift] * volume;
+                phase += step;
+            }
+            ch->phase = phase;
+            ch->remain -= n;
+            pos += n;
+            if (ch->remain == 0) dsound_next_note(ch);
+        }
+    }
+
+    // 4 channels * 31 * 7 peaks at 868; /8 rarely needs the clamp
+    for (int i = 0; i < DSOUND_SAMPLES; i++) {
+        s32 v = mix[i] >> 3;
+        if (v > 127) v = 127;
+        if (v < -128) v = -128;
+        out[i] = (s8)v;
+    }
+}
+
+// First thing in VBlank: play the buffer mixed last time
+static GAME_HOT void dsound_swap(void) {
+    REG_DMA1CNT = 0;
+    REG_DMA1SAD = (u32)dsound_buffer[dsound_page];
+    REG_DMA1CNT = DMA_DST_FIXED | DMA_REPEAT | DMA_32BIT | DMA_START_FIFO | DMA_ENABLE;
+    dsound_page ^= 1;
+}
+
+// Later in the same VBlank: mix the other one
+static GAME_HOT void dsound_fill(void) {
+    u32 t0 = cycle_now();
+    dsound_mix(dsound_buffer[dsound_page]);
+    u32 cycles = cycle_now() - t0;
+    dsound_mix_cycles = cycles;
+    if (cycles > dsound_mix_peak) dsound_mix_peak = cycles;
+}
+
+static void sound_init(void) {
+    if (sound_initialized) return;
+
+    for (int w = 0; w < 8; w++) {
+        if (w == DSOUND_WAVE_NOISE) continue;
+        s8 *wave = (s8 *)dsound_wave(w);
+        for (int t = 0; t < DSOUND_WAVE_SIZE; t++) wave[t] = dsound_wave_sample(w, t);
+    }
+    u32 seed = 0x2545F491;
+    s8 *noise = (s8 *)dsound_wave(DSOUND_WAVE_NOISE);
+    for (int t = 0; t < DSOUND_NOISE_SIZE; t++) {
+        seed ^= seed << 13; seed ^= seed >> 17; seed ^= seed << 5;
+        noise[t] = (s8)((seed >> 24) & 63) - 32;
+    }
+    for (int p = 0; p < 64; p++) {
+        dsound_steps[p] = (u32)(((u64)p8_freq_table[p] << 32) / DSOUND_RATE);
+    }
+    memset(dsound_channels, 0, sizeof(dsound_channels));
+    memset(dsound_buffer, 0, sizeof(dsound_buffer));
+
+    // Direct Sound A at full volume on both sides, timer 0; PSG off
+    REG_SOUNDCNT_X = SOUND_ENABLE;
+    REG_SOUNDCNT_L = 0;
+    REG_SOUNDCNT_H = DSA_FULL_VOLUME | DSA_RIGHT | DSA_LEFT | DSA_FIFO_RESET;
+    REG_DMA1DAD = REG_FIFO_A;
+    REG_TM0D = DSOUND_TIMER_RELOAD;
+    REG_TM0CNT = TIMER_ENABLE;
+
+    sound_initialized = true;
+}
+
+// Called by the core's sfx(), which checks the sound option. The channels
+// are the mixer's, so the VBlank interrupt is held off while they change.
+void platform_sfx(int n, int channel) {
+    if (!sound_initialized) sound_init();
+    if (channel < 0 || channel >= 4) return;
+    if (n >= (int)NUM_GBA_SFX) return;
+
+    u16 ime = REG_IME;
+    REG_IME = 0;
+    if (n == -2) {
+        for (int i = 0; i < 4; i++) dsound_channels[i].active = false;
+    } else if (n < 0) {
+        dsound_channels[channel].active = false;
+    } else {
+        DSoundChannel *ch = &dsound_channels[channel];
+        ch->sfx = &hyperspace_sfx[n];
+        ch->note_index = 0xFF;  // dsound_next_note() starts at note 0
+        ch->active = true;
+        dsound_next_note(ch);
+    }
+    REG_IME = ime;
+}
+
+// Notes are sequenced by the mixer, sample-accurately
+static void sound_update(void) {
+}
+
+#else
+// =============================================================================
+// PSG Sound
+// =============================================================================
+
 // Sound channel state
 typedef struct {
     const P8SFX *sfx;
@@ -759,10 +721,8 @@ static void play_p8_note(int hw_channel, u8 pitch, u8 waveform, u8 volume) {
     }
 }
 
-static void sfx(int n, int channel) {
-    // Check if sound is enabled
-    if (!sound_enabled) return;
-
+// Called by the core's sfx(), which checks the sound option
+void platform_sfx(int n, int channel) {
     if (!sound_initialized) sound_init();
 
     if (channel < 0 || channel >= 4) return;
@@ -807,7 +767,7 @@ static void sfx(int n, int channel) {
 
 // Call this every frame to advance SFX playback
 static void sound_update(void) {
-    if (!sound_enabled || !sound_initialized) return;
+    if (!sound_initialized) return;
 
     for (int i = 0; i < 4; i++) {
         SoundChannel *ch = &sound_channels[i];
@@ -841,982 +801,339 @@ static void sound_update(void) {
         }
     }
 }
-static fix16_t sym_random_fix(fix16_t f) { return f - rnd_fix(fix16_mul(f, FIX_TWO)); }
-static int get_random_idx(int max) { return flr_fix(rnd_fix(fix16_from_int(max))); }
-
-// 3D Types
-typedef struct { fix16_t x, y, z; } Vec3;
-typedef struct { fix16_t m[12]; } Mat34;
-typedef struct { Vec3 pos; int tri[3]; fix16_t uv[3][2]; Vec3 normal; fix16_t z; } Triangle;
-typedef struct { Vec3* vertices; Vec3* projected; Triangle* triangles; int num_vertices; int num_triangles; } Mesh;
-typedef struct { int x, y, light_x; } Texture;
-typedef struct { Vec3 pos0, pos1, spd; } Laser;
-typedef struct { Vec3 pos0, pos1; fix16_t spd; int col; } Trail;
-typedef struct { Vec3 pos; fix16_t spd; int index; } Background;
-typedef struct {
-    Vec3 pos; int type; Vec3* proj; int life; Vec3 light_dir; int hit_t; Vec3 hit_pos;
-    fix16_t rot_x, rot_y, rot_x_spd, rot_y_spd; Vec3 spd, waypoint;
-    fix16_t laser_t, stop_laser_t, next_laser_t, laser_offset_x[2], laser_offset_y[2];
-} Enemy;
-
-// Game state
-static Mesh ship_mesh;
-static Texture ship_tex, ship_tex_laser_lit;
-static Mesh nme_meshes[4];
-static Texture nme_tex[4], nme_tex_hit;
-static fix16_t nme_scale[4] = {F16(1.0), F16(2.5), F16(3.0), F16(5.0)};
-static int nme_life[4] = {1, 3, 10, 80};
-static int nme_score[4] = {1, 10, 10, 100};
-static fix16_t nme_radius[4] = {F16(3.25), F16(6.0), F16(8.0), F16(16.0)};
-static fix16_t nme_bounds[3] = {F16(-50.0), F16(-50.0), F16(-100.0)};
-static fix16_t nme_rot[3] = {F16(0.18), F16(0.24), F16(0.06)};
-static fix16_t nme_spd[3] = {F16(1.0), F16(0.5), F16(0.6)};
-
-#define MAX_TRAILS 32
-#define MAX_BGS 32
-#define MAX_LASERS 50
-#define MAX_NME_LASERS 20
-#define MAX_ENEMIES 16
-
-EWRAM_DATA static Trail trails[MAX_TRAILS];
-static int trail_color[5] = {7, 7, 6, 13, 1};
-EWRAM_DATA static Background bgs[MAX_BGS];
-static int bg_color[3] = {12, 13, 6};
-EWRAM_DATA static Laser lasers[MAX_LASERS];
-static int num_lasers = 0;
-EWRAM_DATA static Laser nme_lasers[MAX_NME_LASERS];
-static int num_nme_lasers = 0;
-EWRAM_DATA static Enemy enemies[MAX_ENEMIES];
-static int num_enemies = 0;
-
-static fix16_t cam_x = 0, cam_y = 0, cam_angle_x = 0, cam_angle_z = F16(-0.4), cam_depth = F16(22.5);
-static Mat34 cam_mat;
-static fix16_t ship_x = 0, ship_y = 0, ship_spd_x = 0, ship_spd_y = 0;
-static fix16_t roll_angle = 0, roll_spd = 0, roll_f = 0;
-static fix16_t pitch_angle = 0, pitch_spd = 0, pitch_f = 0;
-static Mat34 ship_mat, ship_pos_mat, inv_ship_mat, light_mat;
-static Vec3 light_dir, ship_light_dir;
-static int cur_mode = 0, score = 0, best_score = 0, life = 4, hit_t = -1;
-static Vec3 hit_pos;
-static bool laser_on = false, laser_spawned = false;
-static fix16_t global_t = 0, game_spd = F16(1.0);
-static int barrel_dir = 0;
-static fix16_t barrel_cur_t = F16(-1.0), cur_thrust = 0, cur_nme_t = 0;
-static int cur_sequencer_x = 96, cur_sequencer_y = 96;
-static fix16_t next_sequencer_t = 0, aim_z = F16(-200.0);
-static Vec3* tgt_pos = 0;
-static Vec3 interp_tgt_pos, aim_proj, star_proj;
-static bool star_visible = false;
-static fix16_t aim_life_ratio = F16(-1.0);
-static int nb_nme_ship = 0;
-static bool waiting_nme_clear = false, spawn_asteroids = false;
-static fix16_t fade_ratio = F16(-1.0);
-static int manual_fire = 1, non_inverted_y = 0;
-static fix16_t cur_laser_t = 0;
-static int cur_laser_side = -1;
-static Texture* cur_tex = 0;
-static Vec3* t_light_dir = 0;
-static fix16_t old_noise_roll = 0, cur_noise_roll = 0, old_noise_pitch = 0, cur_noise_pitch = 0;
-static fix16_t cur_noise_t = 0, tgt_noise_t = 0;
-static fix16_t src_cam_x, src_cam_y, src_cam_angle_x, src_cam_angle_z;
-static fix16_t dst_cam_x, dst_cam_y, dst_cam_angle_x, dst_cam_angle_z;
-static fix16_t interpolation_ratio = 0, interpolation_spd = 0, asteroid_mul_t = F16(1.0);
-static int explosion_color[4] = {9, 10, 15, 7};
-// PICO-8 original: ngn_colors = {13,12,7,12}
-static int ngn_colors[4] = {13, 12, 7, 12};
-// PICO-8 original: laser_ngn_colors = {3,11,7,11}
-static int laser_ngn_colors[4] = {3, 11, 7, 11};
-static fix16_t ngn_col_idx = 0, ngn_laser_col_idx = 0;
-static int flare_offset = 0;
-static int mem_pos = 0;
-
-// Vector/Matrix functions
-static void vec3_copy(Vec3* dst, const Vec3* src) { dst->x = src->x; dst->y = src->y; dst->z = src->z; }
-static void vec3_set(Vec3* v, fix16_t x, fix16_t y, fix16_t z) { v->x = x; v->y = y; v->z = z; }
-static void vec3_mul(Vec3* v, fix16_t f) { v->x = fix16_mul(v->x, f); v->y = fix16_mul(v->y, f); v->z = fix16_mul(v->z, f); }
-static Vec3 vec3_minus(const Vec3* v0, const Vec3* v1) { Vec3 r = {v0->x - v1->x, v0->y - v1->y, v0->z - v1->z}; return r; }
-IWRAM_CODE static fix16_t vec3_dot(const Vec3* v0, const Vec3* v1) { return fix16_mul(v0->x, v1->x) + fix16_mul(v0->y, v1->y) + fix16_mul(v0->z, v1->z); }
-static fix16_t vec3_length(const Vec3* v) { return fix16_sqrt(vec3_dot(v, v)); }
-static void vec3_normalize(Vec3* v) { fix16_t len = vec3_length(v); if (len > 0) { fix16_t invl = fix16_div(fix16_one, len); vec3_mul(v, invl); } }
-
-static void mat_rotx(Mat34* m, fix16_t a) {
-    fix16_t angle = fix16_mul(a, FIX_TWO_PI);
-    fix16_t cos_a = fix16_cos(angle), sin_a = fix16_sin(angle);
-    m->m[0] = fix16_one; m->m[1] = 0; m->m[2] = 0; m->m[3] = 0;
-    m->m[4] = 0; m->m[5] = cos_a; m->m[6] = -sin_a; m->m[7] = 0;
-    m->m[8] = 0; m->m[9] = sin_a; m->m[10] = cos_a; m->m[11] = 0;
-}
-
-static void mat_roty(Mat34* m, fix16_t a) {
-    fix16_t angle = fix16_mul(a, FIX_TWO_PI);
-    fix16_t cos_a = fix16_cos(angle), sin_a = fix16_sin(angle);
-    m->m[0] = cos_a; m->m[1] = 0; m->m[2] = -sin_a; m->m[3] = 0;
-    m->m[4] = 0; m->m[5] = fix16_one; m->m[6] = 0; m->m[7] = 0;
-    m->m[8] = sin_a; m->m[9] = 0; m->m[10] = cos_a; m->m[11] = 0;
-}
-
-static void mat_rotz(Mat34* m, fix16_t a) {
-    fix16_t angle = fix16_mul(a, FIX_TWO_PI);
-    fix16_t cos_a = fix16_cos(angle), sin_a = fix16_sin(angle);
-    m->m[0] = cos_a; m->m[1] = -sin_a; m->m[2] = 0; m->m[3] = 0;
-    m->m[4] = sin_a; m->m[5] = cos_a; m->m[6] = 0; m->m[7] = 0;
-    m->m[8] = 0; m->m[9] = 0; m->m[10] = fix16_one; m->m[11] = 0;
-}
-
-static void mat_translation(Mat34* m, fix16_t x, fix16_t y, fix16_t z) {
-    m->m[0] = fix16_one; m->m[1] = 0; m->m[2] = 0; m->m[3] = x;
-    m->m[4] = 0; m->m[5] = fix16_one; m->m[6] = 0; m->m[7] = y;
-    m->m[8] = 0; m->m[9] = 0; m->m[10] = fix16_one; m->m[11] = z;
-}
+#endif // GBA_DSOUND
 
-static void mat_mul(Mat34* res, const Mat34* m0, const Mat34* m1) {
-    fix16_t r[12];
-    r[0] = fix16_mul(m0->m[0], m1->m[0]) + fix16_mul(m0->m[1], m1->m[4]) + fix16_mul(m0->m[2], m1->m[8]);
-    r[1] = fix16_mul(m0->m[0], m1->m[1]) + fix16_mul(m0->m[1], m1->m[5]) + fix16_mul(m0->m[2], m1->m[9]);
-    r[2] = fix16_mul(m0->m[0], m1->m[2]) + fix16_mul(m0->m[1], m1->m[6]) + fix16_mul(m0->m[2], m1->m[10]);
-    r[3] = fix16_mul(m0->m[0], m1->m[3]) + fix16_mul(m0->m[1], m1->m[7]) + fix16_mul(m0->m[2], m1->m[11]) + m0->m[3];
-    r[4] = fix16_mul(m0->m[4], m1->m[0]) + fix16_mul(m0->m[5], m1->m[4]) + fix16_mul(m0->m[6], m1->m[8]);
-    r[5] = fix16_mul(m0->m[4], m1->m[1]) + fix16_mul(m0->m[5], m1->m[5]) + fix16_mul(m0->m[6], m1->m[9]);
-    r[6] = fix16_mul(m0->m[4], m1->m[2]) + fix16_mul(m0->m[5], m1->m[6]) + fix16_mul(m0->m[6], m1->m[10]);
-    r[7] = fix16_mul(m0->m[4], m1->m[3]) + fix16_mul(m0->m[5], m1->m[7]) + fix16_mul(m0->m[6], m1->m[11]) + m0->m[7];
-    r[8] = fix16_mul(m0->m[8], m1->m[0]) + fix16_mul(m0->m[9], m1->m[4]) + fix16_mul(m0->m[10], m1->m[8]);
-    r[9] = fix16_mul(m0->m[8], m1->m[1]) + fix16_mul(m0->m[9], m1->m[5]) + fix16_mul(m0->m[10], m1->m[9]);
-    r[10] = fix16_mul(m0->m[8], m1->m[2]) + fix16_mul(m0->m[9], m1->m[6]) + fix16_mul(m0->m[10], m1->m[10]);
-    r[11] = fix16_mul(m0->m[8], m1->m[3]) + fix16_mul(m0->m[9], m1->m[7]) + fix16_mul(m0->m[10], m1->m[11]) + m0->m[11];
-    for (int i = 0; i < 12; i++) res->m[i] = r[i];
-}
+// ============================================================================
+// Include Shared Game Logic
+// ============================================================================
 
-static void mat_mul_vec(Vec3* res, const Mat34* m, const Vec3* v) {
-    res->x = fix16_mul(v->x, m->m[0]) + fix16_mul(v->y, m->m[1]) + fix16_mul(v->z, m->m[2]);
-    res->y = fix16_mul(v->x, m->m[4]) + fix16_mul(v->y, m->m[5]) + fix16_mul(v->z, m->m[6]);
-    res->z = fix16_mul(v->x, m->m[8]) + fix16_mul(v->y, m->m[9]) + fix16_mul(v->z, m->m[10]);
-}
+#define PLATFORM_SFX
+#include "hyperspace_game.h"
+#include "gba_backend.h"
+#ifdef GBA_BENCH
+#include "hyperspace_bench.h"
+#endif
 
-IWRAM_CODE __attribute__((target("arm")))
-static void mat_mul_pos(Vec3* res, const Mat34* m, const Vec3* v) {
-    res->x = fix16_mul(v->x, m->m[0]) + fix16_mul(v->y, m->m[1]) + fix16_mul(v->z, m->m[2]) + m->m[3];
-    res->y = fix16_mul(v->x, m->m[4]) + fix16_mul(v->y, m->m[5]) + fix16_mul(v->z, m->m[6]) + m->m[7];
-    res->z = fix16_mul(v->x, m->m[8]) + fix16_mul(v->y, m->m[9]) + fix16_mul(v->z, m->m[10]) + m->m[11];
-}
+// The single game instance; with the 20 KB framebuffer it lives in EWRAM
+static EWRAM_BSS GameContext game;
 
-static void mat_transpose_rot(Mat34* res, const Mat34* m) {
-    res->m[0] = m->m[0]; res->m[1] = m->m[4]; res->m[2] = m->m[8]; res->m[3] = 0;
-    res->m[4] = m->m[1]; res->m[5] = m->m[5]; res->m[6] = m->m[9]; res->m[7] = 0;
-    res->m[8] = m->m[2]; res->m[9] = m->m[6]; res->m[10] = m->m[10]; res->m[11] = 0;
-}
-
-static fix16_t normalize_angle(fix16_t a) {
-    while (a > FIX_HALF) a -= fix16_one;
-    while (a < -FIX_HALF) a += fix16_one;
-    return a;
-}
-
-static fix16_t smoothstep(fix16_t ratio) {
-    fix16_t x2 = fix16_mul(ratio, ratio);
-    return fix16_mul(F16(3.0), x2) - fix16_mul(FIX_TWO, fix16_mul(x2, ratio));
-}
+// ARM routines in raster_arm.s
+extern void fast_memset16_arm(volatile u16* dest, u16 value, u32 count);
+extern void present_mode5_arm(volatile u16* dst, const u8* src, const u16* palette, u32 count);
 
-// Mesh decoding
-static fix16_t decode_byte(void) {
-    int res = map_memory[mem_pos++];
-    if (res >= 128) res -= 256;
-    return fix16_from_int(res) >> 1;
-}
+#ifdef GBA_OBJ
+// ============================================================================
+// Hardware Sprites
+// ============================================================================
 
-static int decode_byte_int(void) {
-    int res = map_memory[mem_pos++];
-    if (res >= 128) res -= 256;
-    return res / 2;
-}
+// OBJ tiles in bitmap modes start at tile 512, in a 2D matrix 32 tiles
+// wide: sheet sprite n sits at row n / 16, column n % 16, and the life bar
+// for each life count at row life, columns 16-23
+#define OBJ_TILE(col, row) (512 + (row) * 32 + (col))
 
-static void decode_mesh(Mesh* mesh, fix16_t scale) {
-    int nb_vert = decode_byte_int();
-    if (nb_vert < 0) nb_vert = 0;
-    if (nb_vert > 256) nb_vert = 256;
-    mesh->num_vertices = nb_vert;
-    mesh->vertices = (Vec3*)calloc(nb_vert > 0 ? nb_vert : 1, sizeof(Vec3));
-    mesh->projected = (Vec3*)calloc(nb_vert > 0 ? nb_vert : 1, sizeof(Vec3));
-    for (int i = 0; i < nb_vert; i++) {
-        mesh->vertices[i].x = fix16_mul(decode_byte(), scale);
-        mesh->vertices[i].y = fix16_mul(decode_byte(), scale);
-        mesh->vertices[i].z = fix16_mul(decode_byte(), scale);
-    }
-    int nb_tri = decode_byte_int();
-    if (nb_tri < 0) nb_tri = 0;
-    if (nb_tri > 256) nb_tri = 256;
-    mesh->num_triangles = nb_tri;
-    mesh->triangles = (Triangle*)calloc(nb_tri > 0 ? nb_tri : 1, sizeof(Triangle));
-    for (int i = 0; i < nb_tri; i++) {
-        Triangle* tri = &mesh->triangles[i];
-        tri->tri[0] = decode_byte_int() - 1; tri->normal.x = fix16_div(decode_byte(), F16(63.5));
-        tri->uv[0][0] = decode_byte(); tri->uv[0][1] = decode_byte();
-        tri->tri[1] = decode_byte_int() - 1; tri->normal.y = fix16_div(decode_byte(), F16(63.5));
-        tri->uv[1][0] = decode_byte(); tri->uv[1][1] = decode_byte();
-        tri->tri[2] = decode_byte_int() - 1; tri->normal.z = fix16_div(decode_byte(), F16(63.5));
-        tri->uv[2][0] = decode_byte(); tri->uv[2][1] = decode_byte();
-    }
-}
+#define ATTR0_AFFINE    0x0100
+#define ATTR0_DOUBLE    0x0200
+#define ATTR0_HIDE      0x0200  // without ATTR0_AFFINE
+#define ATTR0_WIDE      0x4000
 
-IWRAM_CODE __attribute__((target("arm")))
-static void transform_pos(Vec3* proj, const Mat34* mat, const Vec3* pos) {
-    mat_mul_pos(proj, mat, pos);
-    // Perspective projection: c = -75 / z
-    // When z < 0 (in front of camera): c = -75 / z = 75 / |z| (positive)
-    fix16_t c;
-    if (proj->z < -fix16_one && proj->z > -F16(512.0)) {
-        // z is negative, so -z is positive, c = 75 / |z|
-        c = fix16_mul(F16(75.0), fast_recip(-proj->z));
-    } else if (proj->z != 0) {
-        c = fix16_div(FIX_PROJ_CONST, proj->z);
-    } else {
-        c = 0;
-    }
-    proj->x = FIX_SCREEN_CENTER_X + fix16_mul(proj->x, c);
-    proj->y = FIX_SCREEN_CENTER_Y - fix16_mul(proj->y, c);
-    if (c > 0 && c <= F16(10.0)) proj->z = c; else proj->z = 0;
-}
+// BG2 draws at priority 1: background OBJs behind it, foreground in front
+#define OBJ_PRIO_BG     2
+#define OBJ_PRIO_FG     0
 
-// Optimized rasterization using scanline interpolation (no per-pixel division)
-// Uses affine texture mapping with edge walking
-// ARM mode for faster execution (Thumb is slower for math-heavy code)
-IWRAM_CODE __attribute__((target("arm")))
-static void rasterize_flat_tri(Vec3* v0, Vec3* v1, Vec3* v2, fix16_t* uv0, fix16_t* uv1, fix16_t* uv2, fix16_t light) {
-    // v0 is tip vertex, v1 and v2 are base vertices at same y
-    fix16_t y0 = v0->y, y1 = v1->y;
-    if (y0 == y1) return;
-
-    // Determine direction: flat-bottom (y0 < y1) or flat-top (y0 > y1)
-    fix16_t y_top, y_bot;
-    int direction;
-    if (y0 < y1) {
-        y_top = y0; y_bot = y1;
-        direction = 1;
-    } else {
-        y_top = y1; y_bot = y0;
-        direction = -1;
-    }
-
-    // Determine scanline range
-    int y_start = fix16_to_int(y_top + FIX_HALF);
-    int y_end = fix16_to_int(y_bot - FIX_HALF);
-    if (y_start < 0) y_start = 0;
-    if (y_end >= SCREEN_HEIGHT) y_end = SCREEN_HEIGHT - 1;
-    if (y_start > y_end) return;
-
-    // Pre-calculate edge gradients using fast reciprocal LUT
-    fix16_t dy = y_bot - y_top;
-    if (dy < F16(0.5)) return;
-    fix16_t inv_dy = fast_recip(dy);
-
-    fix16_t dx_left, dz_left, du_left, dv_left;
-    fix16_t dx_right, dz_right, du_right, dv_right;
-    fix16_t x_left, x_right, z_left, z_right, u_left, u_right, v_left_val, v_right_val;
-    fix16_t prestep;
-
-    if (direction > 0) {
-        // Flat-bottom: v0 at top, v1/v2 at bottom
-        // Left edge gradients (v0 to v1)
-        dx_left = fix16_mul(v1->x - v0->x, inv_dy);
-        dz_left = fix16_mul(v1->z - v0->z, inv_dy);
-        du_left = fix16_mul(uv1[0] - uv0[0], inv_dy);
-        dv_left = fix16_mul(uv1[1] - uv0[1], inv_dy);
-        // Right edge gradients (v0 to v2)
-        dx_right = fix16_mul(v2->x - v0->x, inv_dy);
-        dz_right = fix16_mul(v2->z - v0->z, inv_dy);
-        du_right = fix16_mul(uv2[0] - uv0[0], inv_dy);
-        dv_right = fix16_mul(uv2[1] - uv0[1], inv_dy);
-        // Starting values (prestep to first scanline from v0)
-        prestep = fix16_from_int(y_start) + FIX_HALF - y_top;
-        x_left = v0->x + fix16_mul(prestep, dx_left);
-        x_right = v0->x + fix16_mul(prestep, dx_right);
-        z_left = v0->z + fix16_mul(prestep, dz_left);
-        z_right = v0->z + fix16_mul(prestep, dz_right);
-        u_left = uv0[0] + fix16_mul(prestep, du_left);
-        u_right = uv0[0] + fix16_mul(prestep, du_right);
-        v_left_val = uv0[1] + fix16_mul(prestep, dv_left);
-        v_right_val = uv0[1] + fix16_mul(prestep, dv_right);
-    } else {
-        // Flat-top: v0 at bottom, v1/v2 at top
-        // Left edge gradients (v1 to v0)
-        dx_left = fix16_mul(v0->x - v1->x, inv_dy);
-        dz_left = fix16_mul(v0->z - v1->z, inv_dy);
-        du_left = fix16_mul(uv0[0] - uv1[0], inv_dy);
-        dv_left = fix16_mul(uv0[1] - uv1[1], inv_dy);
-        // Right edge gradients (v2 to v0)
-        dx_right = fix16_mul(v0->x - v2->x, inv_dy);
-        dz_right = fix16_mul(v0->z - v2->z, inv_dy);
-        du_right = fix16_mul(uv0[0] - uv2[0], inv_dy);
-        dv_right = fix16_mul(uv0[1] - uv2[1], inv_dy);
-        // Starting values (prestep to first scanline from v1/v2)
-        prestep = fix16_from_int(y_start) + FIX_HALF - y_top;
-        x_left = v1->x + fix16_mul(prestep, dx_left);
-        x_right = v2->x + fix16_mul(prestep, dx_right);
-        z_left = v1->z + fix16_mul(prestep, dz_left);
-        z_right = v2->z + fix16_mul(prestep, dz_right);
-        u_left = uv1[0] + fix16_mul(prestep, du_left);
-        u_right = uv2[0] + fix16_mul(prestep, du_right);
-        v_left_val = uv1[1] + fix16_mul(prestep, dv_left);
-        v_right_val = uv2[1] + fix16_mul(prestep, dv_right);
+typedef struct {
+    u16 attr0, attr1, attr2;
+    s16 affine;  // one of the four parameters of a matrix, every 4 entries
+} ObjAttr;
+
+#define OBJ_MAX 128
+IWRAM_DATA static ObjAttr obj_shadow[OBJ_MAX];
+static int obj_count;
+
+// 8 pixels of the sheet as one 4bpp tile row
+static u32 obj_tile_row(const u8* p) {
+    u32 row = 0;
+    for (int i = 0; i < 8; i++) row |= (u32)(p[i] & 15) << (i * 4);
+    return row;
+}
+
+// After load_embedded_data(): the sheet and the composed life bars as
+// tiles, and matrix 0 with BG2's scale
+static void obj_init(void) {
+    for (int n = 0; n < 256; n++) {
+        volatile u32* tile = OBJ_VRAM + (OBJ_TILE(n & 15, n >> 4) - 512) * 8;
+        for (int r = 0; r < 8; r++) tile[r] = obj_tile_row(&spritesheet[(n >> 4) * 8 + r][(n & 15) * 8]);
     }
 
-    // Texture info
-    int tex_x = cur_tex->x, tex_y = cur_tex->y, tex_lit_x = cur_tex->light_x;
-    // Pre-calculate light threshold (avoid per-pixel calculation)
-    int use_lit = (light <= F16(11.0)) ? 1 : 0;  // Simplified dithering
-
-    // Scanline loop
-    for (int y = y_start; y <= y_end; y++) {
-        int xl = fix16_to_int(x_left + FIX_HALF);
-        int xr = fix16_to_int(x_right - FIX_HALF);
-
-        if (xl < 0) xl = 0;
-        if (xr >= SCREEN_WIDTH) xr = SCREEN_WIDTH - 1;
-
-        if (xl <= xr) {
-            // Calculate horizontal gradients using fast reciprocal LUT
-            fix16_t span = x_right - x_left;
-            if (span > FIX_HALF) {
-                fix16_t inv_span = fast_recip(span);
-                fix16_t du_dx = fix16_mul(u_right - u_left, inv_span);
-                fix16_t dv_dx = fix16_mul(v_right_val - v_left_val, inv_span);
-
-                // Prestep to first pixel
-                fix16_t x_prestep = fix16_from_int(xl) + FIX_HALF - x_left;
-                fix16_t u = u_left + fix16_mul(x_prestep, du_dx);
-                fix16_t v = v_left_val + fix16_mul(x_prestep, dv_dx);
-
-                // Dither pattern for lighting
-                int offset_x = tex_x;
-                if (use_lit && ((y ^ xl) & 1)) offset_x += tex_lit_x;
-
-                // Use ARM assembly optimized scanline renderer
-                volatile u16* row = &vram_buffer[y * SCREEN_WIDTH];
-                render_scanline_arm(row, xl, xr, u, v, du_dx, dv_dx,
-                                    (const u8*)hyperspace_spritesheet, palette_map,
-                                    offset_x, tex_y);
+    // As the software life bar: the empty bar (sprites 16-23) with the full
+    // one (sprites 0-7) over it, clipped to 15 pixels per life and 7 rows
+    for (int life = 0; life <= 4; life++) {
+        for (int t = 0; t < 8; t++) {
+            volatile u32* tile = OBJ_VRAM + (OBJ_TILE(16 + t, life) - 512) * 8;
+            for (int r = 0; r < 8; r++) {
+                u8 px[8];
+                for (int i = 0; i < 8; i++) {
+                    int x = t * 8 + i;
+                    u8 full = spritesheet[r][x];
+                    px[i] = spritesheet[8 + r][x];
+                    if (x < life * 15 && r < 7 && full) px[i] = full;
+                }
+                tile[r] = obj_tile_row(px);
             }
         }
-
-        // Step to next scanline
-        x_left += dx_left;
-        x_right += dx_right;
-        z_left += dz_left;
-        z_right += dz_right;
-        u_left += du_left;
-        u_right += du_right;
-        v_left_val += dv_left;
-        v_right_val += dv_right;
     }
-}
 
-IWRAM_CODE __attribute__((target("arm")))
-static void rasterize_tri(int index, Triangle* tris, Vec3* projs) {
-    Triangle* tri = &tris[index];
-    if (tri->tri[0] < 0 || tri->tri[1] < 0 || tri->tri[2] < 0 || !cur_tex) return;
-    Vec3* v0 = &projs[tri->tri[0]], *v1 = &projs[tri->tri[1]], *v2 = &projs[tri->tri[2]];
-
-    // Early z-culling: skip if all vertices behind camera
-    if (v0->z <= 0 && v1->z <= 0 && v2->z <= 0) return;
-
-    // Early screen bounds culling
-    fix16_t min_x = fix16_min(v0->x, fix16_min(v1->x, v2->x));
-    fix16_t max_x = fix16_max(v0->x, fix16_max(v1->x, v2->x));
-    fix16_t min_y = fix16_min(v0->y, fix16_min(v1->y, v2->y));
-    fix16_t max_y = fix16_max(v0->y, fix16_max(v1->y, v2->y));
-    if (max_x < 0 || min_x >= F16(SCREEN_WIDTH)) return;
-    if (max_y < 0 || min_y >= F16(SCREEN_HEIGHT)) return;
-
-    // Early rejection for tiny triangles (< 1 pixel in any dimension)
-    if (max_x - min_x < fix16_one && max_y - min_y < fix16_one) return;
-
-    // Backface culling
-    fix16_t nz = fix16_mul(v1->x - v0->x, v2->y - v0->y) - fix16_mul(v1->y - v0->y, v2->x - v0->x);
-    if (nz < 0) return;
-    Vec3 *tv0 = v0, *tv1 = v1, *tv2 = v2;
-    fix16_t *tuv0 = tri->uv[0], *tuv1 = tri->uv[1], *tuv2 = tri->uv[2];
-    if (tv1->y < tv0->y) { Vec3* t = tv1; tv1 = tv0; tv0 = t; fix16_t* tu = tuv1; tuv1 = tuv0; tuv0 = tu; }
-    if (tv2->y < tv0->y) { Vec3* t = tv2; tv2 = tv0; tv0 = t; fix16_t* tu = tuv2; tuv2 = tuv0; tuv0 = tu; }
-    if (tv2->y < tv1->y) { Vec3* t = tv2; tv2 = tv1; tv1 = t; fix16_t* tu = tuv2; tuv2 = tuv1; tuv1 = tu; }
-    fix16_t total_dy = tv2->y - tv0->y;
-    if (total_dy < fix16_one) return;
-    fix16_t light = fix16_mul(F16(15.0), vec3_dot(t_light_dir, &tri->normal));
-    // Use fast reciprocal for vertex interpolation
-    fix16_t c = fix16_mul(tv1->y - tv0->y, fast_recip(total_dy));
-    Vec3 v3 = {tv0->x + fix16_mul(c, tv2->x - tv0->x), tv1->y, tv0->z + fix16_mul(c, tv2->z - tv0->z)};
-    fix16_t b0 = fix16_mul(fix16_one - c, tv0->z), b1 = fix16_mul(c, tv2->z);
-    fix16_t sum = b0 + b1, invd = (sum > F16(0.01)) ? fast_recip(sum) : 0;
-    fix16_t uv3[2] = {fix16_mul(fix16_mul(b0, tuv0[0]) + fix16_mul(b1, tuv2[0]), invd), fix16_mul(fix16_mul(b0, tuv0[1]) + fix16_mul(b1, tuv2[1]), invd)};
-    if (tv1->x <= v3.x) { rasterize_flat_tri(tv0, tv1, &v3, tuv0, tuv1, uv3, light); rasterize_flat_tri(tv2, tv1, &v3, tuv2, tuv1, uv3, light); }
-    else { rasterize_flat_tri(tv0, &v3, tv1, tuv0, uv3, tuv1, light); rasterize_flat_tri(tv2, &v3, tv1, tuv2, uv3, tuv1, light); }
+    for (int i = 0; i < OBJ_MAX; i++) obj_shadow[i].attr0 = ATTR0_HIDE;
+    obj_shadow[0].affine = 171;  // pa, pd: BG2's 160/240 and 128/160
+    obj_shadow[1].affine = 0;
+    obj_shadow[2].affine = 0;
+    obj_shadow[3].affine = 205;
 }
 
-// Insertion sort - faster than qsort for small arrays (< 20 elements)
-static void sort_tris(Triangle* tris, int num, Vec3* projs) {
-    // Calculate z values
-    for (int i = 0; i < num; i++) {
-        tris[i].z = projs[tris[i].tri[0]].z + projs[tris[i].tri[1]].z + projs[tris[i].tri[2]].z;
-    }
-    // Insertion sort (stable, fast for small n, no function call overhead)
-    for (int i = 1; i < num; i++) {
-        Triangle temp = tris[i];
-        int j = i - 1;
-        while (j >= 0 && tris[j].z > temp.z) {
-            tris[j + 1] = tris[j];
-            j--;
-        }
-        tris[j + 1] = temp;
-    }
-}
+// A pw x ph sprite at game position (x, y): scaled by matrix 0 around its
+// centre, in a double-size box so the scaled pixels are not cut off
+static void obj_put(int tile, int prio, int x, int y, int pw, int ph, u16 shape, u16 size) {
+    if (obj_count >= OBJ_MAX) return;
+    int cx = ((2 * x + pw) * 3) >> 2;  // centre, x 1.5 and y 1.25
+    int cy = ((2 * y + ph) * 5) >> 3;
+    int bx = cx - pw, by = cy - ph;
+    if (bx >= 240 || by >= 160 || bx + 2 * pw <= 0 || by + 2 * ph <= 0) return;
 
-// Game initialization
-static void init_ship(void) {
-    mem_pos = 0;
-    decode_mesh(&ship_mesh, fix16_one);
-    ship_tex.x = 0; ship_tex.y = 96; ship_tex.light_x = 48;
-    ship_tex_laser_lit.x = 0; ship_tex_laser_lit.y = 64; ship_tex_laser_lit.light_x = 48;
+    ObjAttr* o = &obj_shadow[obj_count++];
+    o->attr0 = (by & 255) | ATTR0_AFFINE | ATTR0_DOUBLE | shape;
+    o->attr1 = (bx & 511) | (size << 14);
+    o->attr2 = tile | (prio << 10);
 }
 
-static void init_nme(void) {
-    for (int i = 0; i < 4; i++) {
-        decode_mesh(&nme_meshes[i], nme_scale[i]);
-        nme_tex[i].x = i * 32; nme_tex[i].y = 32; nme_tex[i].light_x = 16;
-    }
-    nme_tex_hit.x = 96; nme_tex_hit.y = 64; nme_tex_hit.light_x = 16;
+static void platform_obj(GameContext* ctx, int layer, int n, int x, int y, int w, int h) {
+    int prio = layer == OBJ_LAYER_BG ? OBJ_PRIO_BG : OBJ_PRIO_FG;
+    int tile = OBJ_TILE(n & 15, n >> 4);
+    if (w == 1 && h == 1) obj_put(tile, prio, x, y, 8, 8, 0, 0);
+    else if (w == 2 && h == 2) obj_put(tile, prio, x, y, 16, 16, 0, 1);
+    else spr(&ctx->p8, n, x, y, w, h);  // no such shape in use
 }
 
-static void init_single_trail(Trail* trail, fix16_t z) {
-    vec3_set(&trail->pos0, sym_random_fix(F16(100.0)) + ship_x, sym_random_fix(F16(100.0)) + ship_y, z);
-    trail->spd = fix16_mul(F16(2.5) + rnd_fix(F16(5.0)), game_spd);
-    trail->col = flr_fix(rnd_fix(F16(4.0))) + 1;
+// 64x8 as two 32x8 OBJs
+static void platform_obj_life_bar(GameContext* ctx, int x, int y, int life) {
+    (void)ctx;
+    if (life < 0) life = 0;
+    if (life > 4) life = 4;
+    obj_put(OBJ_TILE(16, life), OBJ_PRIO_FG, x, y, 32, 8, ATTR0_WIDE, 1);
+    obj_put(OBJ_TILE(20, life), OBJ_PRIO_FG, x + 32, y, 32, 8, ATTR0_WIDE, 1);
 }
 
-static void init_trail(void) {
-    for (int i = 0; i < MAX_TRAILS; i++) init_single_trail(&trails[i], sym_random_fix(F16(150.0)));
+// Before VBlank: hide the entries this frame left unused
+static void obj_finish(void) {
+    for (int i = obj_count; i < OBJ_MAX; i++) obj_shadow[i].attr0 = ATTR0_HIDE;
 }
+#endif
 
-static void init_single_bg(Background* bg, fix16_t z) {
-    fix16_t a = rnd_fix(fix16_one), r = F16(150.0) + rnd_fix(F16(150.0));
-    fix16_t angle = fix16_mul(a, FIX_TWO_PI);
-    vec3_set(&bg->pos, fix16_mul(r, fix16_cos(angle)), fix16_mul(r, -fix16_sin(angle)), z);
-    bg->spd = F16(0.05) + rnd_fix(F16(0.05));
-    if (flr_fix(rnd_fix(F16(6.0))) == 0) bg->index = 8 + (int)rnd_fix(F16(8.0));
-    else bg->index = -bg_color[get_random_idx(3)];
-}
+// Display palette: read by present_mode5_arm in Mode 5, uploaded to BG
+// palette RAM at VBlank in Mode 4. Copied to IWRAM at boot
+IWRAM_DATA static u16 screen_palette[16];
+static bool screen_palette_dirty = true;
 
-static void init_bg(void) {
-    for (int i = 0; i < MAX_BGS; i++) init_single_bg(&bgs[i], sym_random_fix(F16(400.0)));
+// Change a display colour from the next frame on, without touching pixels
+static void set_screen_palette(int index, u16 color) {
+    screen_palette[index & 15] = color;
+    screen_palette_dirty = true;
 }
 
-static void init_main(void) {
-    save_cart_data();
-    cur_mode = 0; cam_angle_z = F16(-0.4);
-    cam_angle_x = fix16_mul(fix16_from_int(flr_fix(rnd_fix(FIX_TWO)) * 2 - 1), F16(0.03) + rnd_fix(F16(0.1)));
-    ship_x = ship_y = cam_x = cam_y = ship_spd_x = ship_spd_y = 0;
-    life = 4; hit_t = -1; barrel_cur_t = F16(-1.0); laser_on = false;
-    global_t = 0; game_spd = fix16_one; cur_nme_t = 0;
-    cur_sequencer_x = cur_sequencer_y = 96; next_sequencer_t = 0;
-    // Free all enemy projection arrays before resetting count
-    for (int i = 0; i < num_enemies; i++) { if (enemies[i].proj) free(enemies[i].proj); enemies[i].proj = 0; }
-    num_lasers = num_nme_lasers = num_enemies = nb_nme_ship = 0;
-    waiting_nme_clear = spawn_asteroids = false; fade_ratio = F16(-1.0);
-    roll_angle = roll_spd = roll_f = pitch_angle = pitch_spd = pitch_f = cur_thrust = 0;
-    aim_z = F16(-200.0); tgt_pos = 0; aim_life_ratio = F16(-1.0);
-    old_noise_roll = cur_noise_roll = old_noise_pitch = cur_noise_pitch = cur_noise_t = tgt_noise_t = 0;
-    asteroid_mul_t = fix16_one; best_score = dget(0);
+static void platform_cls(Pico8* p8) {
+#ifdef GBA_OBJ
+    obj_count = 0;
+#endif
+    fast_memset16_arm((volatile u16*)p8->screen, 0, sizeof(p8->screen) / 2);
 }
 
-static Laser* spawn_laser(Laser* arr, int* count, Vec3 pos) {
-    if (*count >= MAX_LASERS) return 0;
-    Laser* l = &arr[*count]; vec3_copy(&l->pos0, &pos); vec3_copy(&l->pos1, &pos); (*count)++; return l;
-}
+// ============================================================================
+// Input Handling
+// ============================================================================
 
-static void remove_laser(Laser* arr, int* count, int idx) {
-    if (idx < 0 || idx >= *count) return;
-    for (int i = idx; i < *count - 1; i++) arr[i] = arr[i + 1];
-    (*count)--;
-}
-
-static Enemy* spawn_nme(int type, Vec3 pos) {
-    if (num_enemies >= MAX_ENEMIES) return 0;
-    Enemy* nme = &enemies[num_enemies];
-    vec3_copy(&nme->pos, &pos); nme->type = type;
-    // Allocate individual projection array for each enemy (fixes disappearing bug)
-    int num_verts = nme_meshes[type - 1].num_vertices;
-    nme->proj = (Vec3*)calloc(num_verts > 0 ? num_verts : 1, sizeof(Vec3));
-    nme->life = nme_life[type - 1]; nme->hit_t = -1;
-    nme->rot_x = nme->rot_y = 0; num_enemies++; return nme;
+static void update_input(Pico8* p8) {
+    u16 keys = ~REG_KEYINPUT;
+    memcpy(p8->btn_prev, p8->btn_state, sizeof(p8->btn_prev));
+    p8->btn_state[0] = (keys & KEY_LEFT) != 0; p8->btn_state[1] = (keys & KEY_RIGHT) != 0;
+    p8->btn_state[2] = (keys & KEY_UP) != 0; p8->btn_state[3] = (keys & KEY_DOWN) != 0;
+    // A and B fire; L and R barrel roll, START (or L/R) leaves the title
+    p8->btn_state[4] = (keys & (KEY_A | KEY_B)) != 0;
+    p8->btn_state[5] = (keys & (KEY_L | KEY_R | KEY_START)) != 0;
 }
 
-static void spawn_nme_ship(int type) {
-    nb_nme_ship++; next_sequencer_t = global_t + F16(0.25);
-    fix16_t desc_bounds = fix16_mul(nme_bounds[type - 2], FIX_TWO);
-    Vec3 pos = {mid_fix(F16(-100.0), sym_random_fix(F16(50.0)) + ship_x, F16(100.0)),
-                mid_fix(F16(-100.0), sym_random_fix(F16(50.0)) + ship_y, F16(100.0)), desc_bounds - F16(200.0)};
-    Enemy* nme = spawn_nme(type, pos);
-    if (nme) { vec3_set(&nme->spd, 0, 0, F16(8.0)); vec3_copy(&nme->waypoint, &nme->pos); nme->waypoint.z = desc_bounds; }
-    if (type == 4) sfx(6, 1);  // Boss spawn sound (square channel)
-}
+// ============================================================================
+// Screen Flip
+// ============================================================================
 
-static void hit_ship(Vec3* pos, fix16_t sqr_size) {
-    if (hit_t == -1 && barrel_cur_t < 0) {
-        fix16_t dx = fix16_mul(pos->x - ship_x, F16(0.2)), dy = fix16_mul(pos->y - ship_y, F16(0.2));
-        fix16_t sqrd = fix16_mul(dx, dx) + fix16_mul(dy, dy);
-        if (sqrd < sqr_size) {
-            fix16_t n = fix16_div(fix16_one, fix16_sqrt(sqrd + F16(0.001)));
-            roll_f += fix16_mul(fix16_mul(dx, n), F16(0.05));
-            pitch_f -= fix16_mul(fix16_mul(dy, n), F16(0.02));
-            hit_t = 0; vec3_copy(&hit_pos, pos); life--;
-            sfx(1, 0);  // Player hit sound
-            if (life == 0) fade_ratio = 0;
-        }
-    }
-}
+static int current_page = 0;
+static volatile u16* vram_buffer;  // Points to back buffer
 
-// Update functions (abbreviated for space - full implementation)
-static void update_enemies(void);
-static void update_nme_lasers(void);
-static void update_lasers(void);
-static void update_trail(void);
-static void update_collisions(void);
-
-static void update_trail(void) {
-    for (int i = 0; i < MAX_TRAILS; i++) {
-        Trail* t = &trails[i];
-        if (t->pos0.z >= F16(150.0)) init_single_trail(t, F16(-150.0));
-        vec3_copy(&t->pos1, &t->pos0); t->pos0.z += t->spd;
-    }
-    for (int i = 0; i < MAX_BGS; i++) {
-        Background* bg = &bgs[i];
-        bg->pos.z += fix16_mul(bg->spd, game_spd);
-        if (bg->pos.z >= F16(400.0)) init_single_bg(bg, F16(-400.0));
-    }
+// Fast DMA copy (from mode5.c)
+static inline void DMAFastCopy(void* source, void* dest, u32 count, u32 mode) {
+    REG_DMA3SAD = (u32)source;
+    REG_DMA3DAD = (u32)dest;
+    REG_DMA3CNT = count | mode;
 }
 
-static void update_nme_lasers(void) {
-    for (int i = 0; i < num_nme_lasers; i++) {
-        Laser* l = &nme_lasers[i];
-        vec3_copy(&l->pos1, &l->pos0);
-        l->pos0.x += l->spd.x; l->pos0.y += l->spd.y; l->pos0.z += l->spd.z;
-        if (l->pos0.z >= 0) { hit_ship(&l->pos0, F16(1.5)); hit_ship(&l->pos1, F16(1.5)); remove_laser(nme_lasers, &num_nme_lasers, i); i--; }
-    }
-}
+#ifdef GBA_OBJ
+#define DCNT_LAYERS (DCNT_BG2 | DCNT_OBJ)
+#else
+#define DCNT_LAYERS DCNT_BG2
+#endif
 
-static void update_lasers(void) {
-    cur_laser_t += fix16_one; laser_spawned = false;
-    if (laser_on && cur_laser_t > FIX_TWO) {
-        cur_laser_t = 0; laser_spawned = true;
-        Vec3 pos = {fix16_from_int(cur_laser_side), F16(-1.5), F16(-8.0)}, world_pos;
-        mat_mul_pos(&world_pos, &ship_mat, &pos);
-        spawn_laser(lasers, &num_lasers, world_pos);
-        cur_laser_side = -cur_laser_side;
-    }
-    for (int i = 0; i < num_lasers; i++) {
-        Laser* l = &lasers[i]; vec3_copy(&l->pos1, &l->pos0); l->pos0.z -= F16(5.0);
-        if (l->pos0.z <= F16(-200.0)) { remove_laser(lasers, &num_lasers, i); i--; }
-    }
-}
+#ifdef GBA_MODE4
+#define DCNT_MODE DCNT_MODE4
+// Mode 4 pages are 240 bytes per row. The screen fills their top-left
+// 160x128, which BG2 scales like a Mode 5 page. VRAM takes no byte
+// writes, so rows go over as words: half of Mode 5's bytes, no lookups
+#define MODE4_ROW_BYTES 240
 
-static void update_enemies(void) {
-    for (int i = 0; i < num_enemies; i++) {
-        Enemy* nme = &enemies[i];
-        nme->pos.x += fix16_mul(nme->spd.x, game_spd);
-        nme->pos.y += fix16_mul(nme->spd.y, game_spd);
-        nme->pos.z += fix16_mul(nme->spd.z, game_spd);
-        nme->rot_x += nme->rot_x_spd; nme->rot_y += nme->rot_y_spd;
-        int type = nme->type;
-        if (type > 1) {
-            int sub_type = type - 1;
-            if (sub_type >= 1 && sub_type <= 3) {
-                fix16_t desc_bounds = nme_bounds[sub_type - 1], desc_spd = nme_spd[sub_type - 1];
-                Vec3 dir = vec3_minus(&nme->waypoint, &nme->pos); vec3_mul(&dir, F16(0.1));
-                fix16_t dist = vec3_dot(&dir, &dir);
-                if (dist < fix16_mul(game_spd, game_spd) || nme->hit_t == 0)
-                    vec3_set(&nme->waypoint, sym_random_fix(F16(100.0)), sym_random_fix(F16(100.0)), desc_bounds - rnd_fix(-desc_bounds));
-                vec3_normalize(&dir);
-                nme->spd.x += fix16_mul(fix16_mul(dir.x, desc_spd), F16(0.1));
-                nme->spd.y += fix16_mul(fix16_mul(dir.y, desc_spd), F16(0.1));
-                nme->spd.z += fix16_mul(fix16_mul(dir.z, desc_spd), F16(0.1));
-                if (nme->pos.z >= fix16_mul(desc_bounds, FIX_TWO)) {
-                    fix16_t spd_len = vec3_length(&nme->spd);
-                    if (spd_len > desc_spd) vec3_mul(&nme->spd, fix16_div(desc_spd, spd_len));
-                    nme->rot_x = fix16_mul(F16(-0.08), nme->spd.y);
-                    nme->rot_y = fix16_mul(-nme_rot[sub_type - 1], nme->spd.x);
-
-                    // Enemy laser spawning logic
-                    int nb_lasers = type - 2;
-
-                    if ((type == 4 || nme->hit_t == 0) && nme->laser_t < 0) {
-                        nme->laser_t = 0;
-                    }
-
-                    nme->laser_t += fix16_one;
-
-                    if (nme->laser_t > nme->stop_laser_t) {
-                        nme->laser_t = -fix16_div(F16(60.0) + rnd_fix(F16(60.0)), game_spd);
-                        nme->stop_laser_t = F16(60.0) + rnd_fix(F16(60.0));
-                        fix16_t c = fix16_mul(F16(-0.5), fix16_div(nme->pos.z, game_spd));
-                        for (int j = 0; j < nb_lasers && j < 2; j++) {
-                            nme->laser_offset_x[j] = sym_random_fix(F16(30.0)) + fix16_mul(ship_spd_x, c);
-                            nme->laser_offset_y[j] = sym_random_fix(F16(30.0)) + fix16_mul(ship_spd_y, c);
-                        }
-                    }
-
-                    fix16_t laser_t_val = nme->laser_t;
-                    fix16_t t = fix16_div(F16(6.0), game_spd);
-                    if (laser_t_val > 0) {
-                        nme->next_laser_t += fix16_one;
-
-                        if (nme->next_laser_t >= t) {
-                            nme->next_laser_t -= t;
-
-                            if (type != 2) {
-                                fix16_t angle = fix16_mul(fix16_div(laser_t_val, F16(120.0)), FIX_TWO_PI);
-                                fix16_t ratio = fix16_cos(angle);
-
-                                for (int j = 0; j < nb_lasers && j < 2; j++) {
-                                    Vec3 laser_pos;
-                                    Mesh* mesh = &nme_meshes[type - 1];
-                                    if (j < mesh->num_vertices) {
-                                        laser_pos.x = nme->pos.x + mesh->vertices[j].x;
-                                        laser_pos.y = nme->pos.y;
-                                        laser_pos.z = nme->pos.z + mesh->vertices[j].z;
-                                    } else {
-                                        laser_pos = nme->pos;
-                                    }
-
-                                    Laser* laser = spawn_laser(nme_lasers, &num_nme_lasers, laser_pos);
-                                    if (laser) {
-                                        Vec3 target = {
-                                            ship_x + fix16_mul(nme->laser_offset_x[j], ratio) + sym_random_fix(F16(5.0)),
-                                            ship_y + fix16_mul(nme->laser_offset_y[j], ratio) + sym_random_fix(F16(5.0)),
-                                            0
-                                        };
-                                        Vec3 ldir = vec3_minus(&target, &laser_pos);
-                                        vec3_mul(&ldir, F16(0.1));
-                                        fix16_t len = vec3_length(&ldir);
-                                        fix16_t v = (len > F16(0.001)) ? fix16_div(fix16_mul(FIX_TWO, game_spd), len) : fix16_mul(FIX_TWO, game_spd);
-                                        laser->spd.x = fix16_mul(ldir.x, v);
-                                        laser->spd.y = fix16_mul(ldir.y, v);
-                                        laser->spd.z = fix16_mul(ldir.z, v);
-                                    }
-                                }
-                            } else {
-                                Vec3 laser_pos = {nme->pos.x, nme->pos.y, nme->pos.z + F16(12.0)};
-                                Laser* laser = spawn_laser(nme_lasers, &num_nme_lasers, laser_pos);
-                                if (laser) {
-                                    laser->spd.x = sym_random_fix(F16(0.05));
-                                    laser->spd.y = sym_random_fix(F16(0.05));
-                                    laser->spd.z = fix16_mul(FIX_TWO, game_spd);
-                                }
-                            }
-                        }
-                    }
-                }
-            }
-        }
-        bool del = false;
-        if (nme->pos.z > 0) { hit_ship(&nme->pos, F16(2.5)); del = true; }
-        if (nme->life <= 0) { nme->life--; if (nme->life < -15) del = true; }
-        if (nme->hit_t > -1) { nme->hit_t++; if (nme->hit_t > 5) nme->hit_t = -1; }
-        if (del) {
-            if (nme->type > 1) nb_nme_ship--;
-            if (nme->proj) free(nme->proj);  // Free projection array before replacing
-            enemies[i] = enemies[num_enemies - 1];
-            num_enemies--; i--;
-        }
-    }
-    cur_nme_t -= fix16_one;
-    if (spawn_asteroids && cur_nme_t <= 0) {
-        cur_nme_t = fix16_div(fix16_mul(F16(30.0) + rnd_fix(F16(60.0)), asteroid_mul_t), game_spd);
-        Vec3 pos = {mid_fix(F16(-100.0), ship_x + sym_random_fix(F16(30.0)), F16(100.0)),
-                    mid_fix(F16(-100.0), ship_y + sym_random_fix(F16(30.0)), F16(100.0)), F16(-50.0)};
-        Enemy* nme = spawn_nme(1, pos);
-        if (nme) { vec3_set(&nme->spd, sym_random_fix(F16(0.25)), sym_random_fix(F16(0.25)), F16(0.25));
-            nme->rot_x_spd = sym_random_fix(F16(0.015)); nme->rot_y_spd = sym_random_fix(F16(0.015)); }
+static void present_screen(volatile u16* dst, const Pico8* p8) {
+    for (int y = 0; y < SCREEN_HEIGHT; y++) {
+        DMAFastCopy((void*)p8->screen[y], (void*)(dst + y * (MODE4_ROW_BYTES / 2)), SCREEN_WIDTH / 4,
+                    DMA_32BIT | DMA_DST_INC | DMA_ENABLE);
     }
 }
 
-static void update_collisions(void) {
-    int laser_idx = 0, nme_idx = num_enemies - 1;
-    while (laser_idx < num_lasers && nme_idx >= 0) {
-        Vec3* lp0 = &lasers[laser_idx].pos0, *lp1 = &lasers[laser_idx].pos1;
-        Enemy* nme = &enemies[nme_idx];
-        if (nme->pos.z > lp1->z) laser_idx++;
-        else {
-            if (nme->life > 0 && nme->pos.z >= lp0->z) {
-                fix16_t dx = fix16_mul(lp0->x - nme->pos.x, F16(0.2)), dy = fix16_mul(lp0->y - nme->pos.y, F16(0.2));
-                fix16_t radius = nme_radius[nme->type - 1];
-                if (fix16_mul(dx, dx) + fix16_mul(dy, dy) <= fix16_mul(fix16_mul(radius, radius), F16(0.04))) {
-                    nme->life--;
-                    sfx(2, 2);  // Hit/explosion sound (noise channel)
-                    if (nme->life == 0) { nme->hit_t = -1; score += nme_score[nme->type - 1]; sfx(5, 1); }  // Bonus sound on kill
-                    else { vec3_copy(&nme->hit_pos, lp0); nme->hit_t = 0; if (nme->type == 4) sfx(7, 2); }  // Boss damage
-                    remove_laser(lasers, &num_lasers, laser_idx); continue;
-                }
-            }
-            nme_idx--;
-        }
-    }
-}
-
-// Main game update
-static void game_update(void) {
-    fix16_t dx = 0, dy = 0;
-    if (btn(0)) dx -= fix16_one; if (btn(1)) dx += fix16_one;
-    if (btn(2)) dy -= fix16_one; if (btn(3)) dy += fix16_one;
-
-    if (cur_mode == 2) {
-        global_t += F16(0.033); game_spd = fix16_one + fix16_mul(global_t, F16(0.002));
-        if (dx == 0 && dy == 0) cur_thrust = 0; else cur_thrust = fix16_min(FIX_HALF, cur_thrust + F16(0.1));
-        fix16_t mul_spd = cur_thrust;
-        if (non_inverted_y) dy = -dy;
-        if (barrel_cur_t > F16(-1.0) || life <= 0) { dx = dy = 0; }
-        if (btn(5) && dx != 0 && barrel_cur_t < 0) { barrel_cur_t = 0; barrel_dir = dx > 0 ? 1 : -1; sfx(4, 1); }
-        if (barrel_cur_t >= 0) { barrel_cur_t += fix16_one; dx = fix16_from_int(barrel_dir * 9); dy = 0; mul_spd = F16(0.1); if (barrel_cur_t > F16(5.0)) barrel_cur_t = F16(-20.0); }
-        if (fix16_abs(ship_x) > F16(100.0)) dx = fix16_mul(-sgn_fix(ship_x), F16(0.4));
-        if (fix16_abs(ship_y) > F16(100.0)) dy = fix16_mul(-sgn_fix(ship_y), F16(0.4));
-        ship_spd_x += fix16_mul(dx, mul_spd); ship_spd_y += fix16_mul(dy, mul_spd);
-        roll_f -= fix16_mul(F16(0.003), dx); pitch_f += fix16_mul(F16(0.0008), dy);
-        ship_spd_x = fix16_mul(ship_spd_x, F16(0.85)); ship_spd_y = fix16_mul(ship_spd_y, F16(0.85));
-        ship_x += ship_spd_x; ship_y += ship_spd_y;
-        cam_x = fix16_mul(F16(1.05), ship_x); cam_y = ship_y + F16(11.5);
-        if (hit_t != -1) { cam_x += sym_random_fix(FIX_TWO); cam_y += sym_random_fix(FIX_TWO); }
-        else if (life <= 0) { hit_t = 0; vec3_set(&hit_pos, ship_x, ship_y, 0); }
-        cam_angle_z = fix16_mul(cam_x, F16(0.0005)); cam_angle_x = fix16_mul(cam_y, F16(0.0003));
-        if (waiting_nme_clear) { if (nb_nme_ship == 0) { next_sequencer_t = 0; waiting_nme_clear = false; } else next_sequencer_t = F16(32767.0); }
-        if (global_t >= next_sequencer_t) {
-            int value = sget(cur_sequencer_x, cur_sequencer_y); cur_sequencer_x++;
-            if (cur_sequencer_x > 127) { cur_sequencer_x = 96; cur_sequencer_y++; }
-            if (value == 1) spawn_nme_ship(3); else if (value == 13) spawn_nme_ship(4);
-            else if (value == 2) spawn_nme_ship(2); else if (value == 6) { spawn_asteroids = true; asteroid_mul_t = fix16_one; }
-            else if (value == 7) { spawn_asteroids = true; asteroid_mul_t = FIX_HALF; } else if (value == 5) spawn_asteroids = false;
-            else if (value == 10) next_sequencer_t = global_t + fix16_one; else if (value == 9) next_sequencer_t = global_t + F16(10.0);
-            else if (value == 11) waiting_nme_clear = true; else { cur_sequencer_x = 96; cur_sequencer_y = 96; }
-        }
-    } else if (cur_mode == 0) {
-        if (dx == 0 && dy == 0) dx = F16(-0.25);
-        cam_angle_z += fix16_mul(dx, F16(0.007)); cam_angle_x -= fix16_mul(dy, F16(0.007));
-        if (btnp(6)) { cur_mode = 3; manual_fire = dget(1); non_inverted_y = dget(2); sound_enabled = dget(3); }
-    } else if (cur_mode == 3) {
-        cam_angle_z -= F16(0.00175);
-        if (btnp(0) || btnp(1)) { manual_fire = 1 - manual_fire; dset(1, manual_fire); }
-        if (btnp(2) || btnp(3)) { non_inverted_y = 1 - non_inverted_y; dset(2, non_inverted_y); }
-        if (btnp(4)) { sound_enabled = 1 - sound_enabled; dset(3, sound_enabled); }
-        if (btnp(6)) {
-            src_cam_angle_z = normalize_angle(cam_angle_z); src_cam_angle_x = normalize_angle(cam_angle_x);
-            src_cam_x = cam_x; src_cam_y = cam_y;
-            dst_cam_x = fix16_mul(F16(1.05), ship_x); dst_cam_y = ship_y + F16(11.5);
-            dst_cam_angle_z = fix16_mul(dst_cam_x, F16(0.0005)); dst_cam_angle_x = fix16_mul(dst_cam_y, F16(0.0003));
-            Vec3 src = {src_cam_x, src_cam_y, F16(26.0)}, dst = {dst_cam_x, dst_cam_y, F16(22.5)};
-            Vec3 diff = vec3_minus(&src, &dst); fix16_t len = vec3_length(&diff);
-            interpolation_spd = (len > F16(0.01)) ? fix16_div(F16(0.25), len) : fix16_one;
-            interpolation_ratio = 0; cur_mode = 1;
-        }
-    } else {
-        interpolation_ratio += interpolation_spd;
-        if (interpolation_ratio >= fix16_one) { cur_mode = 2; score = 0; }
-        else {
-            fix16_t r = smoothstep(interpolation_ratio);
-            cam_x = src_cam_x + fix16_mul(r, dst_cam_x - src_cam_x);
-            cam_y = src_cam_y + fix16_mul(r, dst_cam_y - src_cam_y);
-            cam_depth = F16(22.5) + fix16_mul(r, F16(3.5));
-            cam_angle_z = src_cam_angle_z + fix16_mul(r, dst_cam_angle_z - src_cam_angle_z);
-            cam_angle_x = src_cam_angle_x + fix16_mul(r, dst_cam_angle_x - src_cam_angle_x);
-        }
-    }
-
-    bool prev_laser_on = laser_on;
-    laser_on = (cur_mode != 2 && btn(4)) || ((btn(4) || (manual_fire != 1 && tgt_pos)) && barrel_cur_t < 0 && hit_t == -1);
-    // Laser sound effects
-    if (laser_on && !prev_laser_on) sfx(0, 0);
-    else if (!laser_on && prev_laser_on) sfx(-2, 0);
-    Mat34 trans, rot;
-    mat_translation(&trans, 0, 0, -cam_depth); mat_rotx(&rot, cam_angle_x); mat_mul(&cam_mat, &trans, &rot);
-    mat_roty(&rot, cam_angle_z); mat_mul(&cam_mat, &cam_mat, &rot);
-    mat_translation(&trans, -cam_x, -cam_y, 0); mat_mul(&cam_mat, &cam_mat, &trans);
-    roll_f -= fix16_mul(roll_angle, F16(0.02)); roll_spd = fix16_mul(roll_spd, F16(0.8)) + roll_f; roll_angle += roll_spd;
-    pitch_f -= fix16_mul(pitch_angle, F16(0.02)); pitch_spd = fix16_mul(pitch_spd, F16(0.8)) + pitch_f; pitch_angle += pitch_spd;
-    roll_f = pitch_f = 0; roll_angle = normalize_angle(roll_angle);
-    mat_translation(&ship_pos_mat, ship_x, ship_y, 0); mat_rotx(&rot, normalize_angle(pitch_angle)); mat_mul(&ship_mat, &ship_pos_mat, &rot);
-    mat_rotz(&rot, normalize_angle(roll_angle)); mat_mul(&ship_mat, &ship_mat, &rot);
-    mat_transpose_rot(&inv_ship_mat, &ship_mat);
-    update_trail(); if (cur_mode == 2) update_enemies();
-    update_lasers(); update_nme_lasers(); update_collisions();
-    if (hit_t != -1) { hit_t++; if (hit_t > 15) hit_t = -1; }
-    mat_mul(&ship_mat, &cam_mat, &ship_mat); mat_mul(&ship_pos_mat, &cam_mat, &ship_pos_mat);
-    mat_rotx(&light_mat, F16(0.14)); mat_roty(&rot, F16(0.34) + fix16_mul(global_t, F16(0.003)));
-    mat_mul(&light_mat, &light_mat, &rot);
-    Vec3 light_src = {0, 0, -fix16_one}; mat_mul_vec(&light_dir, &light_mat, &light_src);
-    mat_mul_vec(&ship_light_dir, &inv_ship_mat, &light_dir);
-    if (fade_ratio >= 0) {
-        if (cur_mode == 2) fade_ratio += FIX_TWO; else fade_ratio -= FIX_TWO;
-        if (fade_ratio >= F16(100.0)) { if (score > best_score) { best_score = score; dset(0, best_score); } init_main(); }
-    }
+// In VBlank: palette RAM is only safe to write outside the active display
+static void upload_screen_palette(void) {
+    if (!screen_palette_dirty) return;
+    for (int i = 0; i < 16; i++) BG_PALETTE[i] = screen_palette[i];
+#ifdef GBA_OBJ
+    BG_PALETTE[PICO8_DRAWN_BLACK] = screen_palette[0];
+    for (int i = 0; i < 16; i++) OBJ_PALETTE[i] = screen_palette[i];
+#endif
+    screen_palette_dirty = false;
+}
+#else
+#define DCNT_MODE DCNT_MODE5
+
+static void present_screen(volatile u16* dst, const Pico8* p8) {
+    present_mode5_arm(dst, &p8->screen[0][0], screen_palette, SCREEN_WIDTH * SCREEN_HEIGHT);
+}
+
+// Colours are resolved by present_screen(); nothing to upload
+static void upload_screen_palette(void) {
+    screen_palette_dirty = false;
+}
+#endif
+
+// ============================================================================
+// Frame Pacing
+// ============================================================================
+//
+// The VBlank interrupt shows finished frames: the main loop draws into the
+// back page, hands it over with frame_submit() and halts in the BIOS until
+// the interrupt has uploaded the palette and OAM and flipped the pages. A
+// frame is shown GBA_FRAME_VBLANKS VBlanks after the previous one at the
+// earliest; one that misses that VBlank is shown at the next one and the
+// pacing slots it missed are counted as dropped.
+
+// 2: PICO-8's 30 fps, which the game logic is written for; 1: 60 fps
+#ifndef GBA_FRAME_VBLANKS
+#define GBA_FRAME_VBLANKS 2
+#endif
+#define VBLANK_CYCLES 280896    // 228 lines of 1232 cycles
+#define FRAME_CYCLES (GBA_FRAME_VBLANKS * VBLANK_CYCLES)
+
+static volatile u32 vblank_count;
+static volatile u32 frame_due;      // earliest VBlank for the next frame
+static volatile bool frame_ready;   // back page finished, not yet shown
+
+// Frame statistics, readable from an emulator's memory viewer. Busy cycles
+// are update, draw and present; the headroom is FRAME_CYCLES minus them.
+volatile u32 frames_shown;
+volatile u32 frames_dropped;
+volatile u32 frame_busy_cycles;
+volatile u32 frame_busy_peak;
+
+// BIOS IntrWait (SWI 4): halt until one of the interrupts in flags. With
+// discard 0 it returns at once for a flag raised since it last returned;
+// VBlankIntrWait() is IntrWait(1, IRQ_VBLANK), which would sleep through a
+// VBlank taken just before the call.
+#ifdef __thumb__
+#define SWI_INTR_WAIT "swi 0x04"
+#else
+#define SWI_INTR_WAIT "swi 0x040000"    // ARM takes the number in bits 16-23
+#endif
+
+static inline void intr_wait(u32 discard, u32 flags) {
+    register u32 r0 __asm__("r0") = discard;
+    register u32 r1 __asm__("r1") = flags;
+    __asm__ volatile (SWI_INTR_WAIT : "+r"(r0), "+r"(r1) : : "r2", "r3", "memory");
+}
+
+// In VBlank: palette, OAM, then the page flip
+static void show_frame(void) {
+    upload_screen_palette();
+#ifdef GBA_OBJ
+    DMAFastCopy(obj_shadow, (void*)OAM, sizeof(obj_shadow) / 4, DMA_32BIT | DMA_DST_INC | DMA_ENABLE);
+#endif
+    // Swap display page
+    // When DCNT_PAGE is set: display page 2 (0x0600A000), draw to page 1
+    // When DCNT_PAGE is clear: display page 1 (0x06000000), draw to page 2
+    current_page = 1 - current_page;
+    REG_DISPCNT = DCNT_MODE | DCNT_LAYERS | (current_page ? DCNT_PAGE : 0);
+    // Point vram_buffer to the back buffer (opposite of displayed page)
+    vram_buffer = current_page ? VRAM_PAGE1 : VRAM_PAGE2;
 }
 
-// Drawing functions
-static void transform_vert(void) {
-    for (int i = 0; i < ship_mesh.num_vertices; i++) transform_pos(&ship_mesh.projected[i], &ship_mat, &ship_mesh.vertices[i]);
-    Vec3 aim_pos = {ship_x, ship_y - F16(1.5), aim_z}; transform_pos(&aim_proj, &cam_mat, &aim_pos);
-    fix16_t auto_aim_dist = F16(30.0); tgt_pos = 0; aim_life_ratio = F16(-1.0);
-    if (cur_mode == 2) {
-        for (int i = 0; i < num_enemies; i++) {
-            Enemy* nme = &enemies[i]; Mat34 nme_mat, nme_rot_x, nme_rot_z, inv_nme_mat;
-            mat_translation(&nme_mat, nme->pos.x, nme->pos.y, nme->pos.z);
-            mat_rotx(&nme_rot_x, nme->rot_x); mat_mul(&nme_mat, &nme_mat, &nme_rot_x);
-            mat_rotz(&nme_rot_z, nme->rot_y); mat_mul(&nme_mat, &nme_mat, &nme_rot_z);
-            mat_transpose_rot(&inv_nme_mat, &nme_mat); mat_mul_vec(&nme->light_dir, &inv_nme_mat, &light_dir);
-            Mat34 final_nme_mat; mat_mul(&final_nme_mat, &cam_mat, &nme_mat);
-            Mesh* mesh = &nme_meshes[nme->type - 1];
-            for (int j = 0; j < mesh->num_vertices; j++) transform_pos(&nme->proj[j], &final_nme_mat, &mesh->vertices[j]);
-            if (nme->life > 0) {
-                fix16_t ddx = fix16_mul(nme->proj[0].x - aim_proj.x, F16(0.1)), ddy = fix16_mul(nme->proj[0].y - aim_proj.y, F16(0.1));
-                fix16_t sqr_dist = fix16_mul(ddx, ddx) + fix16_mul(ddy, ddy);
-                if (sqr_dist < auto_aim_dist) { auto_aim_dist = sqr_dist; tgt_pos = &nme->pos; }
-            }
+static GAME_HOT void vblank_irq(void) {
+    u16 flags = REG_IF;
+    if (flags & IRQ_VBLANK) {
+        u32 now = vblank_count + 1;
+        vblank_count = now;
+#ifdef GBA_DSOUND
+        dsound_swap();
+#endif
+        if (frame_ready && (s32)(now - frame_due) >= 0) {
+            show_frame();
+            frames_dropped += (now - frame_due + GBA_FRAME_VBLANKS - 1) / GBA_FRAME_VBLANKS;
+            frames_shown++;
+            frame_due = now + GBA_FRAME_VBLANKS;
+            frame_ready = false;
         }
+#ifdef GBA_DSOUND
+        dsound_fill();
+#endif
     }
-    fix16_t tgt_z = F16(-200.0); if (tgt_pos) tgt_z = tgt_pos->z;
-    aim_z += fix16_mul(tgt_z - aim_z, F16(0.2));
-    Vec3 star_pos = {fix16_mul(light_mat.m[2], F16(100.0)), fix16_mul(light_mat.m[6], F16(100.0)), fix16_mul(light_mat.m[10], F16(100.0))};
-    transform_pos(&star_proj, &ship_pos_mat, &star_pos);
-}
-
-static void draw_explosion(Vec3* proj, fix16_t size) {
-    fix16_t invz = proj->z; int col = explosion_color[get_random_idx(4)];
-    circfill(fix16_to_int(proj->x + fix16_mul(sym_random_fix(fix16_mul(size, FIX_HALF)), invz)),
-             fix16_to_int(proj->y + fix16_mul(sym_random_fix(fix16_mul(size, FIX_HALF)), invz)),
-             fix16_to_int(fix16_mul(invz, size + rnd_fix(size))), col);
-}
-
-static void print_3d(const char* str, int x, int y) {
-    print_str(str, x + 2, y + 2, 1); print_str(str, x + 1, y + 1, 13); print_str(str, x, y, 7);
-}
-
-static void draw_lasers(Laser* arr, int count, int col) {
-    Vec3 p0, p1;
-    for (int i = 0; i < count; i++) {
-        transform_pos(&p0, &cam_mat, &arr[i].pos0); transform_pos(&p1, &cam_mat, &arr[i].pos1);
-        if (p0.z > 0 && p1.z > 0) line(fix16_to_int(p0.x), fix16_to_int(p0.y), fix16_to_int(p1.x), fix16_to_int(p1.y), col);
-    }
-}
-
-static void set_ngn_pal(void) {
-    // Fast wrap-around without division
-    ngn_col_idx += fix16_one;
-    if (ngn_col_idx >= F16(4.0)) ngn_col_idx -= F16(4.0);
-    ngn_laser_col_idx += F16(0.2);
-    if (ngn_laser_col_idx >= F16(4.0)) ngn_laser_col_idx -= F16(4.0);
-    pal(12, ngn_colors[fix16_to_int(ngn_col_idx)]);
-    int idx = fix16_to_int(ngn_laser_col_idx);
-    pal(8, laser_ngn_colors[idx]); pal(14, laser_ngn_colors[(idx + 1) & 3]); pal(15, laser_ngn_colors[(idx + 2) & 3]);
-}
-
-static void draw_lens_flare(void) {
-    // Draw lens flare sprites along the line from star to screen center
-    fix16_t vx = FIX_SCREEN_CENTER_X - star_proj.x;
-    fix16_t vy = FIX_SCREEN_CENTER_Y - star_proj.y;
-
-    fix16_t factors[] = {F16(-0.3), F16(0.4), F16(0.5), F16(0.9), F16(1.0)};
-    // Sprite indices for each flare element (swapped 0 and 1 to match original)
-    int sprite_map[] = {1, 0, 2, 3, 2};
-
-    // Use flare_offset to alternate between sprite sets 40-43 and 44-47
-    int base_sprite = 40 + flare_offset * 4;
-
-    for (int i = 0; i < 5; i++) {
-        int px = fix16_to_int(FIX_SCREEN_CENTER_X + fix16_mul(vx, factors[i]));
-        int py = fix16_to_int(FIX_SCREEN_CENTER_Y + fix16_mul(vy, factors[i]));
-        // Center the 8x8 sprite by offsetting -4
-        spr(base_sprite + sprite_map[i], px - 4, py - 4, 1, 1);
-    }
-
-    flare_offset = 1 - flare_offset;
+    REG_IF = flags;
+    REG_IFBIOS |= flags;
 }
 
-static void game_draw(void) {
-    Vec3 p0, p1; cls(); transform_vert();
-    for (int i = 0; i < MAX_BGS; i++) {
-        Background* bg = &bgs[i]; transform_pos(&p0, &ship_pos_mat, &bg->pos);
-        if (p0.z > 0) { int idx = bg->index; if (idx > 0) spr(idx + 16 * flr_fix(rnd_fix(FIX_TWO)), fix16_to_int(p0.x), fix16_to_int(p0.y), 1, 1);
-            else { int c = 7; if (rnd_fix(fix16_one) > FIX_HALF) c = -idx; pset(fix16_to_int(p0.x), fix16_to_int(p0.y), c); } }
-    }
-    star_visible = star_proj.z > 0 && star_proj.x >= 0 && star_proj.x < F16(SCREEN_WIDTH) && star_proj.y >= 0 && star_proj.y < F16(SCREEN_HEIGHT);
-    if (star_visible) { int idx = 32 + flr_fix(rnd_fix(F16(4.0))) * 2; spr(idx, fix16_to_int(star_proj.x) - 7, fix16_to_int(star_proj.y) - 7, 2, 2); }
-    fix16_t trail_coef = F16(2.25);
-    for (int i = 0; i < MAX_TRAILS; i++) {
-        Trail* t = &trails[i]; transform_pos(&p0, &cam_mat, &t->pos0); transform_pos(&p1, &cam_mat, &t->pos1);
-        if (p0.z > 0 && p1.z > 0) { int idx = fix16_to_int(mid_fix(fix16_from_int(t->col), fix16_div(trail_coef, p0.z) + fix16_one, F16(5.0))) - 1;
-            if (idx < 0) idx = 0; if (idx > 4) idx = 4; line(fix16_to_int(p0.x), fix16_to_int(p0.y), fix16_to_int(p1.x), fix16_to_int(p1.y), trail_color[idx]); }
-    }
-    if (cur_mode == 2) {
-        for (int i = num_enemies - 1; i >= 0; i--) {
-            Enemy* nme = &enemies[i]; Mesh* mesh = &nme_meshes[nme->type - 1]; cur_tex = &nme_tex[nme->type - 1];
-            if (nme->life < 0 || nme->hit_t > -1) {
-                if (nme->life < 0) { fix16_t r = FIX_HALF + fix16_div(F16(15.0) + fix16_from_int(nme->life), F16(30.0));
-                    fix16_t sz = fix16_mul(fix16_mul(r, nme_radius[nme->type - 1]), F16(0.8));
-                    if (((-nme->life) & 1) == 0) cur_tex = &nme_tex_hit;
-                    for (int j = 0; j < 3; j++) draw_explosion(&nme->proj[get_random_idx(mesh->num_vertices)], sz);
-                } else { fix16_t r = FIX_HALF + fix16_div(F16(6.0) - fix16_from_int(nme->hit_t), F16(12.0));
-                    if ((nme->hit_t & 1) == 0) cur_tex = &nme_tex_hit; transform_pos(&p0, &cam_mat, &nme->hit_pos); draw_explosion(&p0, fix16_mul(r, F16(3.0))); }
-            }
-            if (cur_tex) { t_light_dir = &nme->light_dir; for (int j = 0; j < mesh->num_triangles; j++) rasterize_tri(j, mesh->triangles, nme->proj); }
-        }
-    }
-    draw_lasers(nme_lasers, num_nme_lasers, 8); draw_lasers(lasers, num_lasers, 11);
-    if (cur_mode == 2) { int idx = 97; if (tgt_pos) idx = 98; spr(idx, fix16_to_int(aim_proj.x) - 3, fix16_to_int(aim_proj.y) - 3, 1, 1); }
-    if (laser_spawned) cur_tex = &ship_tex_laser_lit; else cur_tex = &ship_tex;
-    sort_tris(ship_mesh.triangles, ship_mesh.num_triangles, ship_mesh.projected);
-    if (hit_t != -1) { transform_pos(&p0, &cam_mat, &hit_pos); draw_explosion(&p0, F16(3.0));
-        if ((hit_t & 1) == 0) { pal(0, 2); pal(1, 8); pal(6, 14); pal(9, 8); pal(10, 14); pal(13, 14); } }
-    t_light_dir = &ship_light_dir; set_ngn_pal();
-    for (int i = 0; i < ship_mesh.num_triangles; i++) rasterize_tri(i, ship_mesh.triangles, ship_mesh.projected);
-    pal_reset();
-    // Draw lens flare after ship rendering
-    if (star_visible) draw_lens_flare();
-    if (cur_mode == 2) { char buf[32]; snprintf(buf, 32, "SCORE %d", score); print_3d(buf, 1, 1);
-        spr(16, 99, 1, 8, 1); clip_set(99, 1, life * 15, 7); spr(0, 99, 1, 8, 1); clip_reset();
-    } else if (cur_mode != 1) { print_3d("HYPERSPACE", 58, 1); print_3d("GBA Port by itsmeterada", 34, 8);
-        if (cur_mode == 0) { print_3d("PRESS START", 54, 100); char buf[32]; snprintf(buf, 32, "BEST %d", best_score); print_3d(buf, 1, 120); }
-        else { print_3d("PRESS START", 46, 55); print_3d("DPAD:OPT A:SND", 38, 65);
-            const char* opt[] = {"AUTO", "MANUAL", "INV Y", "NORM Y", "SND OFF", "SND ON"};
-            print_3d(opt[manual_fire], 9, 100); print_3d(opt[non_inverted_y + 2], 9, 110); print_3d(opt[sound_enabled + 4], 9, 120); } }
-    if (fade_ratio > 0) { Vec3 center = {FIX_SCREEN_CENTER_X, FIX_SCREEN_CENTER_Y, fix16_one}; draw_explosion(&center, fade_ratio); }
+static void irq_init(void) {
+    REG_IME = 0;
+    REG_ISR_MAIN = vblank_irq;
+    REG_DISPSTAT |= DSTAT_VBL_IRQ;
+    REG_IE |= IRQ_VBLANK;
+    REG_IME = 1;
 }
 
-// GBA-specific - optimized
-static void vsync(void) { while (REG_VCOUNT >= 160); while (REG_VCOUNT < 160); }
-
-static void flip_screen(void) {
-    // Swap display page
-    // When DCNT_PAGE is set: display page 2 (0x0600A000), draw to page 1
-    // When DCNT_PAGE is clear: display page 1 (0x06000000), draw to page 2
-    current_page = 1 - current_page;
-    REG_DISPCNT = DCNT_MODE5 | DCNT_BG2 | (current_page ? DCNT_PAGE : 0);
-    // Point vram_buffer to the back buffer (opposite of displayed page)
-    vram_buffer = current_page ? VRAM_PAGE1 : VRAM_PAGE2;
+// Start pacing: the first frame is due GBA_FRAME_VBLANKS VBlanks from now,
+// so the VBlanks of boot (and of the benchmark) count as no drops
+static void frame_pacing_start(void) {
+    frame_due = vblank_count + GBA_FRAME_VBLANKS;
 }
 
-static void update_input(void) {
-    u16 keys = ~REG_KEYINPUT;
-    for (int i = 0; i < 7; i++) btn_prev[i] = btn_state[i];
-    btn_state[0] = (keys & KEY_LEFT) != 0; btn_state[1] = (keys & KEY_RIGHT) != 0;
-    btn_state[2] = (keys & KEY_UP) != 0; btn_state[3] = (keys & KEY_DOWN) != 0;
-    btn_state[4] = (keys & (KEY_A | KEY_B)) != 0; btn_state[5] = (keys & (KEY_L | KEY_R)) != 0;
-    btn_state[6] = (keys & KEY_START) != 0;
+// Hand the finished back page to the VBlank interrupt and halt until it is
+// shown; the next frame then draws into the page just taken off screen
+static void frame_submit(void) {
+    REG_IME = 0;
+    REG_IFBIOS &= ~IRQ_VBLANK;
+    frame_ready = true;
+    REG_IME = 1;
+    while (frame_ready) intr_wait(0, IRQ_VBLANK);
 }
 
-static void load_embedded_data(void) {
-    // Spritesheet is accessed directly from ROM (hyperspace_spritesheet)
-    // Only copy map data to RAM
-    memcpy(map_memory, hyperspace_map, sizeof(map_memory));
-
-    // Initialize dither pattern in IWRAM for fast access
-    for (int y = 0; y < 8; y++) {
-        for (int x = 0; x < 8; x++) {
-            dither_pattern[y][x] = SGET_FAST(x, 56 + y);
-        }
-    }
+// Write the 8-bit screen into the back page, then show it at its VBlank.
+// frame_start is cycle_now() at the start of the frame's update.
+static void flip_screen(const Pico8* p8, u32 frame_start) {
+    present_screen(vram_buffer, p8);
+#ifdef GBA_OBJ
+    obj_finish();
+#endif
+    u32 busy = cycle_now() - frame_start;
+    frame_busy_cycles = busy;
+    if (busy > frame_busy_peak) frame_busy_peak = busy;
+    frame_submit();
 }
 
 static void clear_vram(void) {
@@ -1828,20 +1145,81 @@ static void clear_vram(void) {
                 DMA_SRC_FIXED | DMA_DST_INC | DMA_16BIT | DMA_ENABLE);
 }
 
-static void game_init(void) {
-    // Initialize: display page 1, draw to page 2
-    current_page = 0;
-    vram_buffer = VRAM_PAGE2;
+#ifdef GBA_BENCH
+// ============================================================================
+// Benchmark
+// ============================================================================
+//
+// make BENCH=1 runs the scenarios of hyperspace_bench.h at boot, timed by
+// the cycle counter, so every result is in CPU cycles (PROFILE_BUILD adds
+// the per-phase averages). The results are copied to gba_bench_report and
+// bench_done() is called, where gba/bench_gba.py stops the ROM through an
+// emulator's GDB stub and reads them; the ROM then shows the table.
 
-    clear_vram();
-    pal_reset();
-    load_cart_data();
-    load_embedded_data();
-    init_main(); init_ship(); init_nme(); init_trail(); init_bg();
+#define GBA_BENCH_MAGIC 0x4E425348  // "HSBN"
+
+typedef struct {
+    u32 magic;              // GBA_BENCH_MAGIC once the run is complete
+    u32 version;            // BENCH_FORMAT_VERSION
+    u32 clock_hz;
+    u32 num_scenarios;
+    u32 num_phases;
+    BenchResult results[BENCH_NUM_SCENARIOS];
+} GbaBenchReport;
+
+EWRAM_BSS GbaBenchReport gba_bench_report;
+
+// Breakpoint for the runner; the empty asm keeps the call
+__attribute__((noinline)) void bench_done(void) {
+    __asm__ volatile ("");
+}
+
+// Frames run unpaced: present and flip at once, tearing included
+static void bench_present(GameContext* ctx) {
+    PHASE_BEGIN(PHASE_FLIP);
+    present_screen(vram_buffer, &ctx->p8);
+#ifdef GBA_OBJ
+    obj_finish();
+#endif
+    show_frame();
+    PHASE_END(PHASE_FLIP);
+}
+
+static void bench_wait_key(void) {
+    while (~REG_KEYINPUT & 0x03FF) intr_wait(1, IRQ_VBLANK);
+    while (!(~REG_KEYINPUT & 0x03FF)) intr_wait(1, IRQ_VBLANK);
+}
+
+// Run the scenarios, publish the results, then show them; any button turns
+// the page, and after the last page the game starts
+static void run_benchmark(void) {
+    const BenchPlatform plat = {cycle_now, bench_present, 16, 16777};
+    prof_init(cycle_now);
+    bench_run(&game, &plat);
+
+    memcpy(gba_bench_report.results, bench_results, sizeof(bench_results));
+    gba_bench_report.version = BENCH_FORMAT_VERSION;
+    gba_bench_report.clock_hz = 16777216;
+    gba_bench_report.num_scenarios = BENCH_NUM_SCENARIOS;
+    gba_bench_report.num_phases = PHASE_COUNT;
+    gba_bench_report.magic = GBA_BENCH_MAGIC;
+    bench_done();
+
+    for (int page = 0; page < BENCH_PAGES; page++) {
+        bench_draw_results(&game, page);
+        bench_present(&game);
+        bench_wait_key();
+    }
 }
+#endif
+
+// ============================================================================
+// Main
+// ============================================================================
 
 int main(void) {
-    REG_DISPCNT = DCNT_MODE5 | DCNT_BG2;
+    REG_DISPCNT = DCNT_MODE | DCNT_LAYERS;
+    REG_BG2CNT = 1;  // priority 1, between the OBJ layers
 
     // Set up BG2 affine transformation for scaling 160x128 → 240x160
     // Scale factors: X = 160/240 = 0.6667, Y = 128/160 = 0.8
@@ -1853,15 +1231,34 @@ int main(void) {
     REG_BG2X = 0;           // Start from left edge
     REG_BG2Y = 0;           // Start from top edge
 
-    game_init();
+    // Initialize: display page 1, draw to page 2
+    current_page = 0;
+    vram_buffer = VRAM_PAGE2;
+    clear_vram();
+    memcpy(screen_palette, PICO8_PALETTE, sizeof(screen_palette));
+    upload_screen_palette();
+
+    // No clock to seed from; the first game always starts the same
+    load_embedded_data();
+#ifdef GBA_OBJ
+    obj_init();
+#endif
     sound_init();  // Initialize sound system
+    timer_init();
+    irq_init();
+#ifdef GBA_BENCH
+    run_benchmark();
+#endif
+    frame_pacing_start();
+    game_init(&game, 1);
+
     while (1) {
-        update_input();
-        game_update();
+        u32 frame_start = cycle_now();
+        update_input(&game.p8);
+        game_update(&game);
         sound_update();  // Update sound playback
-        game_draw();
-        vsync();        // Wait for VBlank
-        flip_screen();  // Flip during VBlank to avoid tearing
+        game_draw(&game);
+        flip_screen(&game.p8, frame_start);
     }
     return 0;
 }
@@ -3,7 +3,8 @@
 @  raster_arm.s - hand-tuned ARM routines for Hyperspace GBA
 @
 @  put the hot stuff in IWRAM for speed
-@  ~12 cycles/pixel in the inner loop, not bad for ARM7
+@  the core draws into an 8-bit screen (pico8_api.h); these fill its
+@  spans, clear it and turn it into RGB555 for Mode 5
 @
 @  itsmeterada / takehiko.terada@gmail.com
 @
@@ -15,200 +16,106 @@
 
 
 @-----------------------------------------------------------------------------
-@  fix16_mul_arm
+@  render_span_arm
 @
-@  Q16.16 fixed point multiply using SMULL
-@  this is way faster than the C version with shifts
+@  draws one horizontal span of affine textured pixels
+@  the workhorse of the whole rasterizer (called by platform_raster_span
+@  in gba_backend.h, which has the same loop in C for the host)
 @
-@  in:   r0, r1 = operands
-@  out:  r0 = (r0 * r1) >> 16
-@-----------------------------------------------------------------------------
-    .global fix16_mul_arm
-    .type   fix16_mul_arm, %function
-fix16_mul_arm:
-    smull   r2, r1, r0, r1      @ 64-bit result in r1:r2
-    mov     r0, r2, lsr #16     @ grab middle 32 bits
-    orr     r0, r0, r1, lsl #16
-    bx      lr
-
-
-@-----------------------------------------------------------------------------
-@  render_scanline_arm
-@
-@  draws one horizontal span of textured pixels
-@  the workhorse of the whole rasterizer
+@  texel = tex[((v >> 16) + offy) & 127][((u >> 16) + offx) & 127],
+@  written through the palette map
 @
-@  args (see C prototype for details):
-@    r0 = vram row ptr
-@    r1 = xl, r2 = xr, r3 = u_start
-@    stack: v, dudx, dvdx, tex, pal, offx, offy
+@  args:
+@    r0 = dst (8-bit screen), r1 = count, r2 = u, r3 = v
+@    stack: dudx, dvdx, tex, pal, offx, offy
 @-----------------------------------------------------------------------------
-    .global render_scanline_arm
-    .type   render_scanline_arm, %function
+    .global render_span_arm
+    .type   render_span_arm, %function
 
-render_scanline_arm:
-    push    {r4-r11, lr}
+render_span_arm:
+    push    {r4-r9, lr}
 
     @ fish out the rest of the params from stack
-    @ 9 regs pushed = 36 bytes, so args start at sp+36
-    ldr     r4, [sp, #36]       @ v
-    ldr     r5, [sp, #40]       @ dudx
-    ldr     r6, [sp, #44]       @ dvdx
-    ldr     r7, [sp, #48]       @ tex ptr
-    ldr     r8, [sp, #52]       @ palette
-    ldr     r9, [sp, #56]       @ tex_ox
-    ldr     r10,[sp, #60]       @ tex_oy
-
-    @ advance row ptr to starting pixel
-    add     r0, r0, r1, lsl #1
-
-    @ how many pixels?
-    subs    r11, r2, r1
-    blt     9f                  @ bail if span is empty
-    add     r11, r11, #1        @ inclusive range
+    @ 7 regs pushed = 28 bytes, so args start at sp+28
+    ldr     r4, [sp, #28]       @ dudx
+    ldr     r5, [sp, #32]       @ dvdx
+    ldr     r6, [sp, #36]       @ tex ptr (128x128 bytes)
+    ldr     r7, [sp, #40]       @ palette map (16 bytes)
+    ldr     r8, [sp, #44]       @ tex_ox
+    ldr     r9, [sp, #48]       @ tex_oy
+
+    cmp     r1, #0
+    ble     9f                  @ bail if span is empty
+
+    @ fold the offsets into u and v; only bits 16-22 are used
+    add     r2, r2, r8, lsl #16
+    add     r3, r3, r9, lsl #16
 
     @ register map at this point:
     @   r0  = dst ptr (advances)
-    @   r3  = u (16.16)
-    @   r4  = v (16.16)
-    @   r5  = du/dx
-    @   r6  = dv/dx
-    @   r7  = texture base
-    @   r8  = palette base
-    @   r9  = tex offset x
-    @   r10 = tex offset y
-    @   r11 = pixel count
+    @   r1  = pixel count
+    @   r2  = u (16.16), r3 = v (16.16)
+    @   r4  = du/dx, r5 = dv/dx
+    @   r6  = texture base, r7 = palette map
     @   r12, lr = scratch
 
 1:  @ --- pixel loop ---
-    mov     r12, r3, asr #16    @ tu = u >> 16
-    add     r12, r12, r9        @ + offset
-
-    mov     lr, r4, asr #16     @ tv = v >> 16
-    add     lr, lr, r10         @ + offset
+    mov     r12, r2, lsl #9     @ tu = (u >> 16) & 127
+    mov     r12, r12, lsr #25
+    mov     lr, r3, lsl #9      @ tv = (v >> 16) & 127
+    mov     lr, lr, lsr #25
 
     @ tex is 128 wide
     add     r12, r12, lr, lsl #7
 
-    ldrb    r12, [r7, r12]      @ fetch texel (palette index)
-    mov     r12, r12, lsl #1    @ *2 for u16 lookup
-    ldrh    r12, [r8, r12]      @ palette lookup
-    strh    r12, [r0], #2       @ store & advance
+    ldrb    r12, [r6, r12]      @ fetch texel (palette index, 0-15)
+    ldrb    r12, [r7, r12]      @ palette map
+    strb    r12, [r0], #1       @ store & advance
 
-    add     r3, r3, r5          @ u += dudx
-    add     r4, r4, r6          @ v += dvdx
+    add     r2, r2, r4          @ u += dudx
+    add     r3, r3, r5          @ v += dvdx
 
-    subs    r11, r11, #1
+    subs    r1, r1, #1
     bgt     1b
 
 9:  @ done
-    pop     {r4-r11, pc}
+    pop     {r4-r9, pc}
 
 
 @-----------------------------------------------------------------------------
-@  render_scanline_arm_unrolled
+@  present_mode5_arm
 @
-@  same thing but unrolled 4x
-@  a bit faster for long spans, about the same for short ones
+@  8-bit screen -> RGB555 page, 4 pixels per word read
+@
+@  r0 = dst (VRAM page), r1 = src (8-bit screen, word-aligned)
+@  r2 = palette (16 x u16), r3 = pixel count (multiple of 4)
 @-----------------------------------------------------------------------------
-    .global render_scanline_arm_unrolled
-    .type   render_scanline_arm_unrolled, %function
+    .global present_mode5_arm
+    .type   present_mode5_arm, %function
 
-render_scanline_arm_unrolled:
-    push    {r4-r11, lr}
+present_mode5_arm:
+    push    {r4-r8, lr}
+    mov     r12, #0x1e          @ (index & 15) * 2
 
-    ldr     r4, [sp, #36]
-    ldr     r5, [sp, #40]
-    ldr     r6, [sp, #44]
-    ldr     r7, [sp, #48]
-    ldr     r8, [sp, #52]
-    ldr     r9, [sp, #56]
-    ldr     r10,[sp, #60]
+1:  ldr     r4, [r1], #4        @ four indices
 
-    add     r0, r0, r1, lsl #1
+    and     r5, r12, r4, lsl #1
+    ldrh    r5, [r2, r5]
+    and     r6, r12, r4, lsr #7
+    ldrh    r6, [r2, r6]
+    orr     r5, r5, r6, lsl #16
 
-    subs    r11, r2, r1
-    blt     9f
-    add     r11, r11, #1
+    and     r7, r12, r4, lsr #15
+    ldrh    r7, [r2, r7]
+    and     r8, r12, r4, lsr #23
+    ldrh    r8, [r2, r8]
+    orr     r6, r7, r8, lsl #16
 
-    @ try to do 4 at a time
-4:  cmp     r11, #4
-    blt     1f
-
-    @ pixel 0
-    mov     r12, r3, asr #16
-    add     r12, r12, r9
-    mov     lr, r4, asr #16
-    add     lr, lr, r10
-    add     r12, r12, lr, lsl #7
-    ldrb    r12, [r7, r12]
-    mov     r12, r12, lsl #1
-    ldrh    r12, [r8, r12]
-    strh    r12, [r0], #2
-    add     r3, r3, r5
-    add     r4, r4, r6
-
-    @ pixel 1
-    mov     r12, r3, asr #16
-    add     r12, r12, r9
-    mov     lr, r4, asr #16
-    add     lr, lr, r10
-    add     r12, r12, lr, lsl #7
-    ldrb    r12, [r7, r12]
-    mov     r12, r12, lsl #1
-    ldrh    r12, [r8, r12]
-    strh    r12, [r0], #2
-    add     r3, r3, r5
-    add     r4, r4, r6
-
-    @ pixel 2
-    mov     r12, r3, asr #16
-    add     r12, r12, r9
-    mov     lr, r4, asr #16
-    add     lr, lr, r10
-    add     r12, r12, lr, lsl #7
-    ldrb    r12, [r7, r12]
-    mov     r12, r12, lsl #1
-    ldrh    r12, [r8, r12]
-    strh    r12, [r0], #2
-    add     r3, r3, r5
-    add     r4, r4, r6
-
-    @ pixel 3
-    mov     r12, r3, asr #16
-    add     r12, r12, r9
-    mov     lr, r4, asr #16
-    add     lr, lr, r10
-    add     r12, r12, lr, lsl #7
-    ldrb    r12, [r7, r12]
-    mov     r12, r12, lsl #1
-    ldrh    r12, [r8, r12]
-    strh    r12, [r0], #2
-    add     r3, r3, r5
-    add     r4, r4, r6
-
-    sub     r11, r11, #4
-    b       4b
-
-    @ leftovers
-1:  cmp     r11, #0
-    ble     9f
+    stmia   r0!, {r5, r6}
+    subs    r3, r3, #4
+    bgt     1b
 
-2:  mov     r12, r3, asr #16
-    add     r12, r12, r9
-    mov     lr, r4, asr #16
-    add     lr, lr, r10
-    add     r12, r12, lr, lsl #7
-    ldrb    r12, [r7, r12]
-    mov     r12, r12, lsl #1
-    ldrh    r12, [r8, r12]
-    strh    r12, [r0], #2
-    add     r3, r3, r5
-    add     r4, r4, r6
-    subs    r11, r11, #1
-    bgt     2b
-
-9:  pop     {r4-r11, pc}
+    pop     {r4-r8, pc}
 
 
 @-----------------------------------------------------------------------------
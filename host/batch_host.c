@@ -0,0 +1,158 @@
+/*
+ * Hyperspace - Host Batch Driver
+ * Lockstep batch stepping vs. one game at a time, on a single core
+ *
+ * Every game i uses seed i + 1 and its own bot, as in hyperspace_soak.
+ * The "single" row steps each game alone with game_update(); the "batch"
+ * row runs the same games through hyperspace_batch.h. Rendering is
+ * optional: --render-every K draws every K-th game. The state digest
+ * covers every game's simulation state and the frame digest the last
+ * frame of every drawn game; both must match the single row. The state
+ * digest is also independent of K.
+ */
+
+#include "hyperspace_batch.h"
+
+typedef struct {
+    int num_games;
+    uint32_t frames;
+    int render_every;   // 0 = no rendering
+} BatchConfig;
+
+typedef struct {
+    double seconds;
+    uint32_t state_digest;
+    uint32_t frame_digest;
+} BatchResult;
+
+static bool batch_renders(const BatchConfig* cfg, int k) {
+    return cfg->render_every > 0 && k % cfg->render_every == 0;
+}
+
+static void batch_digest(const BatchConfig* cfg, const GameContext* games, BatchResult* res) {
+    res->state_digest = HOST_HASH_INIT;
+    res->frame_digest = HOST_HASH_INIT;
+    for (int k = 0; k < cfg->num_games; k++) {
+        res->state_digest = (res->state_digest ^ hash_state(&games[k], HOST_HASH_INIT)) * 16777619u;
+        if (batch_renders(cfg, k)) {
+            res->frame_digest = (res->frame_digest ^ hash_screen(&games[k].p8, HOST_HASH_INIT)) * 16777619u;
+        }
+    }
+}
+
+// Reference: each game stepped to the end on its own
+static bool run_single(const BatchConfig* cfg, BatchResult* res) {
+    GameContext* games = (GameContext*)calloc(cfg->num_games, sizeof(GameContext));
+    if (!games) return false;
+
+    double t0 = host_time_s();
+    for (int k = 0; k < cfg->num_games; k++) {
+        GameContext* ctx = &games[k];
+        HostBot bot;
+        game_init(ctx, k + 1);
+        bot_init(&bot, HOST_BOT_SEED + k);
+        bool render = batch_renders(cfg, k);
+        for (uint32_t frame = 0; frame < cfg->frames; frame++) {
+            update_input(&ctx->p8, bot_buttons(&bot, ctx, frame));
+            game_update(ctx);
+            if (render) game_draw(ctx);
+        }
+    }
+    res->seconds = host_time_s() - t0;
+
+    batch_digest(cfg, games, res);
+    for (int k = 0; k < cfg->num_games; k++) game_destroy(&games[k]);
+    free(games);
+    return true;
+}
+
+static bool run_batch(const BatchConfig* cfg, BatchResult* res) {
+    Batch* b = batch_create(cfg->num_games);
+    HostBot* bots = (HostBot*)calloc(cfg->num_games, sizeof(HostBot));
+    if (!b || !bots) {
+        batch_destroy(b);
+        free(bots);
+        return false;
+    }
+
+    double t0 = host_time_s();
+    for (int k = 0; k < cfg->num_games; k++) {
+        batch_init_game(b, k, k + 1);
+        bot_init(&bots[k], HOST_BOT_SEED + k);
+    }
+    for (uint32_t frame = 0; frame < cfg->frames; frame++) {
+        for (int k = 0; k < cfg->num_games; k++) {
+            GameContext* ctx = &b->games[k];
+            update_input(&ctx->p8, bot_buttons(&bots[k], ctx, frame));
+        }
+        batch_step(b);
+        for (int k = 0; k < cfg->num_games; k++) {
+            if (!batch_renders(cfg, k)) continue;
+            batch_sync(b, k);
+            game_draw(&b->games[k]);
+        }
+    }
+    res->seconds = host_time_s() - t0;
+
+    for (int k = 0; k < cfg->num_games; k++) batch_sync(b, k);
+    batch_digest(cfg, b->games, res);
+    batch_destroy(b);
+    free(bots);
+    return true;
+}
+
+static void usage(const char* prog) {
+    fprintf(stderr,
+        "usage: %s [options]\n"
+        "  --games N         number of games stepped together (default 256)\n"
+        "  --frames N        frames per game (default 600)\n"
+        "  --render-every K  draw every K-th game, 0 for none (default 0)\n"
+        , prog);
+}
+
+static void print_row(const char* name, const BatchConfig* cfg, const BatchResult* res,
+                      const BatchResult* ref) {
+    double steps = (double)cfg->num_games * cfg->frames;
+    double rate = res->seconds > 0 ? steps / res->seconds : 0.0;
+    bool match = res->state_digest == ref->state_digest && res->frame_digest == ref->frame_digest;
+    printf("%8s %10.2f %14.0f %8.2fx   %08x   %08x%s\n", name, res->seconds, rate,
+           res->seconds > 0 ? ref->seconds / res->seconds : 0.0,
+           res->state_digest, res->frame_digest, match ? "" : "  MISMATCH");
+}
+
+int main(int argc, char** argv) {
+    BatchConfig cfg = {256, 600, 0};
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* val = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if (strcmp(arg, "--games") == 0 && val) { cfg.num_games = atoi(val); i++; }
+        else if (strcmp(arg, "--frames") == 0 && val) { cfg.frames = strtoul(val, NULL, 0); i++; }
+        else if (strcmp(arg, "--render-every") == 0 && val) { cfg.render_every = atoi(val); i++; }
+        else { usage(argv[0]); return 1; }
+    }
+    if (cfg.num_games <= 0 || cfg.render_every < 0) { usage(argv[0]); return 1; }
+
+    load_embedded_data();
+
+    printf("\n%d games x %u frames, ", cfg.num_games, cfg.frames);
+    if (cfg.render_every > 0) printf("drawing 1 in %d, ", cfg.render_every);
+    else printf("no drawing, ");
+    printf("one core\n");
+    printf("%8s %10s %14s %9s %10s %10s\n", "mode", "seconds", "steps/s/core", "speedup", "state", "frames");
+
+    BatchResult ref;
+    if (!run_single(&cfg, &ref)) {
+        fprintf(stderr, "out of memory for %d games\n", cfg.num_games);
+        return 1;
+    }
+    print_row("single", &cfg, &ref, &ref);
+
+    BatchResult res;
+    if (!run_batch(&cfg, &res)) {
+        fprintf(stderr, "out of memory for %d games\n", cfg.num_games);
+        return 1;
+    }
+    print_row("batch", &cfg, &res, &ref);
+    return res.state_digest != ref.state_digest || res.frame_digest != ref.frame_digest;
+}
@@ -0,0 +1,228 @@
+/*
+ * Hyperspace - Host Platform Layer
+ * Shared by the host drivers (main_host.c, soak_host.c, batch_host.c)
+ *
+ * Screen and fixed-point constants, an in-memory save slot, the scripted
+ * bot and the button/hash helpers. Every piece of per-game state lives in
+ * the GameContext or the HostBot passed in, so a driver can run as many
+ * games as it likes.
+ *
+ * HOST_GBA_CONFIG builds the GBA port's configuration instead: its screen
+ * size and the backends of gba/gba_backend.h (in C; the ARM span loop is
+ * device-only). `make check-gba` compares its simulation with the plain
+ * build's.
+ *
+ * Otherwise RASTER_SPAN_AFFINE or RASTER_SPAN_SUBDIV draws with the spans
+ * of raster_thumb.h, in C, as the PicoSystem build with the same option.
+ */
+
+#ifndef HOST_PLATFORM_H
+#define HOST_PLATFORM_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "libfixmath/fixmath.h"
+
+// ============================================================================
+// Screen and Fixed-Point Constants (same as the PicoSystem or GBA build)
+// ============================================================================
+
+#ifdef HOST_GBA_CONFIG
+#include "gba/gba_config.h"
+#else
+#include "hyperspace_target.h"
+#endif
+
+// ============================================================================
+// Buffers, State and Pico-8 API (required by hyperspace_game.h)
+// ============================================================================
+
+#include "pico8_api.h"
+
+// Cart data lives in memory only; every run starts from an empty save
+static void load_cart_data(Pico8* p8) {
+    (void)p8;
+}
+
+static void save_cart_data(Pico8* p8) {
+    p8->cart_data_dirty = false;
+}
+
+#if !defined(HOST_GBA_CONFIG) && (defined(RASTER_SPAN_AFFINE) || defined(RASTER_SPAN_SUBDIV))
+#define PLATFORM_RASTER_SPAN
+#endif
+
+#include "hyperspace_game.h"
+
+#ifdef HOST_GBA_CONFIG
+#include "gba/gba_backend.h"
+#else
+#include "raster_thumb.h"
+#endif
+
+// ============================================================================
+// Input
+// ============================================================================
+
+// Button bits, one byte per frame in replay files
+#define HOST_BTN_LEFT   (1 << 0)
+#define HOST_BTN_RIGHT  (1 << 1)
+#define HOST_BTN_UP     (1 << 2)
+#define HOST_BTN_DOWN   (1 << 3)
+#define HOST_BTN_FIRE   (1 << 4)
+#define HOST_BTN_ROLL   (1 << 5)
+
+// Scripted player: starts the game from the title screen and flies with
+// the fire button held, changing direction at random intervals. It has its
+// own LCG so the game's RNG sequence is not disturbed.
+typedef struct {
+    uint32_t state;
+    int hold;
+    uint8_t dir;
+} HostBot;
+
+#define HOST_BOT_SEED 0x1234567
+
+static void bot_init(HostBot* bot, uint32_t seed) {
+    bot->state = seed;
+    bot->hold = 0;
+    bot->dir = 0;
+}
+
+static uint32_t bot_rand(HostBot* bot, uint32_t n) {
+    bot->state = bot->state * 1664525 + 1013904223;
+    return (bot->state >> 16) % n;
+}
+
+static uint8_t bot_buttons(HostBot* bot, const GameContext* ctx, uint32_t frame) {
+    if (ctx->cur_mode != 2) {
+        // Tap X to leave the title and option screens
+        return (frame % 20) == 0 ? HOST_BTN_ROLL : 0;
+    }
+
+    if (--bot->hold <= 0) {
+        static const uint8_t dirs[] = {
+            0, HOST_BTN_LEFT, HOST_BTN_RIGHT, HOST_BTN_UP, HOST_BTN_DOWN,
+            HOST_BTN_LEFT | HOST_BTN_UP, HOST_BTN_RIGHT | HOST_BTN_DOWN,
+        };
+        bot->dir = dirs[bot_rand(bot, sizeof(dirs))];
+        bot->hold = 15 + bot_rand(bot, 30);
+    }
+
+    uint8_t buttons = bot->dir | HOST_BTN_FIRE;
+    if (bot->dir && bot_rand(bot, 100) == 0) buttons |= HOST_BTN_ROLL;
+    return buttons;
+}
+
+static void update_input(Pico8* p8, uint8_t buttons) {
+    memcpy(p8->btn_prev, p8->btn_state, sizeof(p8->btn_prev));
+    for (int i = 0; i < 6; i++) {
+        p8->btn_state[i] = (buttons >> i) & 1;
+    }
+}
+
+// ============================================================================
+// Helpers
+// ============================================================================
+
+static double host_time_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Microsecond timer with the device's wrap-around (picosystem_time_us())
+static uint32_t host_time_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)(ts.tv_sec * 1000000u + ts.tv_nsec / 1000);
+}
+
+#define HOST_HASH_INIT 2166136261u
+
+// FNV-1a over the framebuffer
+static uint32_t hash_screen(const Pico8* p8, uint32_t h) {
+    const uint8_t* p = &p8->screen[0][0];
+    for (size_t i = 0; i < sizeof(p8->screen); i++) {
+        h = (h ^ p[i]) * 16777619u;
+    }
+    return h;
+}
+
+static uint32_t hash_words(uint32_t h, const void* data, size_t size) {
+    const uint8_t* p = (const uint8_t*)data;
+    for (size_t i = 0; i < size; i++) {
+        h = (h ^ p[i]) * 16777619u;
+    }
+    return h;
+}
+
+#define HASH_FIELD(h, v) hash_words(h, &(v), sizeof(v))
+
+// FNV-1a over the simulation state: everything game_update() reads back on
+// the next frame. Drawing scratch (projections, effects RNG) is left out, so
+// the hash is the same whether or not the frames were drawn.
+static uint32_t hash_state(const GameContext* ctx, uint32_t h) {
+    int tgt = ctx->tgt_pos ? (int)((const Enemy*)ctx->tgt_pos - ctx->enemies) : -1;
+    h = HASH_FIELD(h, ctx->cur_mode);
+    h = HASH_FIELD(h, ctx->life);
+    h = HASH_FIELD(h, ctx->score);
+    h = HASH_FIELD(h, ctx->global_t);
+    h = HASH_FIELD(h, ctx->game_spd);
+    h = HASH_FIELD(h, ctx->hit_t);
+    h = HASH_FIELD(h, ctx->barrel_cur_t);
+    h = HASH_FIELD(h, ctx->aim_z);
+    h = HASH_FIELD(h, tgt);
+    h = HASH_FIELD(h, ctx->ship_x);
+    h = HASH_FIELD(h, ctx->ship_y);
+    h = HASH_FIELD(h, ctx->roll_angle);
+    h = HASH_FIELD(h, ctx->pitch_angle);
+    h = HASH_FIELD(h, ctx->cam_x);
+    h = HASH_FIELD(h, ctx->cam_y);
+    h = HASH_FIELD(h, ctx->p8.rnd_state);
+
+    for (int i = 0; i < MAX_TRAILS; i++) {
+        const Trail* trail = &ctx->trails[i];
+        h = HASH_FIELD(h, trail->pos0);
+        h = HASH_FIELD(h, trail->pos1);
+        h = HASH_FIELD(h, trail->spd);
+        h = HASH_FIELD(h, trail->col);
+    }
+    for (int i = 0; i < MAX_BGS; i++) {
+        const Background* bg = &ctx->bgs[i];
+        h = HASH_FIELD(h, bg->pos);
+        h = HASH_FIELD(h, bg->spd);
+        h = HASH_FIELD(h, bg->index);
+    }
+
+    h = HASH_FIELD(h, ctx->num_lasers);
+    for (int i = 0; i < ctx->num_lasers; i++) {
+        h = HASH_FIELD(h, ctx->lasers[i].pos0);
+        h = HASH_FIELD(h, ctx->lasers[i].spd);
+    }
+    h = HASH_FIELD(h, ctx->num_nme_lasers);
+    for (int i = 0; i < ctx->num_nme_lasers; i++) {
+        h = HASH_FIELD(h, ctx->nme_lasers[i].pos0);
+        h = HASH_FIELD(h, ctx->nme_lasers[i].spd);
+    }
+    h = HASH_FIELD(h, ctx->num_enemies);
+    for (int i = 0; i < ctx->num_enemies; i++) {
+        const Enemy* nme = &ctx->enemies[i];
+        h = HASH_FIELD(h, nme->pos);
+        h = HASH_FIELD(h, nme->type);
+        h = HASH_FIELD(h, nme->life);
+        h = HASH_FIELD(h, nme->hit_t);
+        h = HASH_FIELD(h, nme->spd);
+        h = HASH_FIELD(h, nme->rot_x);
+        h = HASH_FIELD(h, nme->rot_y);
+        h = HASH_FIELD(h, nme->laser_t);
+    }
+    return h;
+}
+
+#endif // HOST_PLATFORM_H
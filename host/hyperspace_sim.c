@@ -0,0 +1,195 @@
+/*
+ * Hyperspace - Embeddable Simulator API
+ * hyperspace_sim.h on top of the lockstep batch (hyperspace_batch.h)
+ *
+ * Built as libhyperspace_sim with hidden visibility, so only the hs_*
+ * functions are exported. Instances step through batch_step(); the ones
+ * with drawing enabled are synced and drawn afterwards, which is what
+ * makes hs_set_render() free of side effects on the game.
+ */
+
+#define HS_BUILDING_LIBRARY
+#define GAME_LOG(...) ((void)0)
+
+#include <pthread.h>
+
+#include "hyperspace_batch.h"
+#include "hyperspace_snapshot.h"
+#include "hyperspace_sim.h"
+
+_Static_assert(HS_SCREEN_WIDTH == SCREEN_WIDTH && HS_SCREEN_HEIGHT == SCREEN_HEIGHT, "screen size");
+_Static_assert(HS_MAX_ENEMIES == MAX_ENEMIES && HS_MAX_LASERS == MAX_LASERS, "entity limits");
+_Static_assert(HS_BTN_LEFT == HOST_BTN_LEFT && HS_BTN_ROLL == HOST_BTN_ROLL, "button bits");
+
+struct HsSim {
+    Batch* batch;
+    uint8_t* render;        // per instance
+    int32_t* frames;        // per instance, steps since reset
+    HsTiming timing;
+};
+
+// Meshes and sprite data are shared by every instance in the process
+static pthread_once_t hs_data_once = PTHREAD_ONCE_INIT;
+
+static uint64_t hs_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+static bool hs_valid(const HsSim* sim, int index) {
+    return sim && index >= 0 && index < sim->batch->count;
+}
+
+HS_API uint32_t hs_api_version(void) {
+    return HS_API_VERSION;
+}
+
+HS_API HsSim* hs_create(int count) {
+    if (count <= 0) return NULL;
+    pthread_once(&hs_data_once, load_embedded_data);
+
+    HsSim* sim = (HsSim*)calloc(1, sizeof(HsSim));
+    if (!sim) return NULL;
+    sim->batch = batch_create(count);
+    sim->render = (uint8_t*)malloc(count);
+    sim->frames = (int32_t*)calloc(count, sizeof(int32_t));
+    if (!sim->batch || !sim->render || !sim->frames) {
+        hs_destroy(sim);
+        return NULL;
+    }
+    memset(sim->render, 1, count);
+    for (int k = 0; k < count; k++) {
+        batch_init_game(sim->batch, k, k + 1);
+    }
+    return sim;
+}
+
+HS_API void hs_destroy(HsSim* sim) {
+    if (!sim) return;
+    batch_destroy(sim->batch);
+    free(sim->render);
+    free(sim->frames);
+    free(sim);
+}
+
+HS_API int hs_count(const HsSim* sim) {
+    return sim ? sim->batch->count : 0;
+}
+
+HS_API void hs_reset(HsSim* sim, int index, uint32_t seed) {
+    if (!hs_valid(sim, index)) return;
+    game_destroy(&sim->batch->games[index]);
+    batch_init_game(sim->batch, index, seed);
+    sim->frames[index] = 0;
+}
+
+HS_API void hs_set_render(HsSim* sim, int index, int enabled) {
+    if (!hs_valid(sim, index)) return;
+    sim->render[index] = enabled != 0;
+}
+
+HS_API void hs_step(HsSim* sim, const uint8_t* buttons) {
+    if (!sim) return;
+    Batch* b = sim->batch;
+
+    uint64_t t0 = hs_now_ns();
+    for (int k = 0; k < b->count; k++) {
+        update_input(&b->games[k].p8, buttons ? buttons[k] : 0);
+    }
+    batch_step(b);
+
+    uint64_t t1 = hs_now_ns();
+    for (int k = 0; k < b->count; k++) {
+        sim->frames[k]++;
+        if (!sim->render[k]) continue;
+        batch_sync(b, k);
+        game_draw(&b->games[k]);
+    }
+    uint64_t t2 = hs_now_ns();
+
+    sim->timing.last_update_ns = t1 - t0;
+    sim->timing.last_draw_ns = t2 - t1;
+    sim->timing.total_update_ns += t1 - t0;
+    sim->timing.total_draw_ns += t2 - t1;
+    sim->timing.instance_steps += b->count;
+}
+
+HS_API const uint8_t* hs_framebuffer(const HsSim* sim, int index) {
+    if (!hs_valid(sim, index)) return NULL;
+    return &sim->batch->games[index].p8.screen[0][0];
+}
+
+static HsVec3 hs_vec3(const Vec3* v) {
+    HsVec3 r = {v->x, v->y, v->z};
+    return r;
+}
+
+static void hs_laser(HsLaser* out, const Laser* laser, int hostile) {
+    out->pos = hs_vec3(&laser->pos0);
+    out->spd = hs_vec3(&laser->spd);
+    out->hostile = hostile;
+}
+
+HS_API void hs_observe(const HsSim* sim, int index, HsObservation* out) {
+    if (!hs_valid(sim, index) || !out) return;
+    const GameContext* ctx = &sim->batch->games[index];
+
+    memset(out, 0, sizeof(*out));
+    out->mode = ctx->cur_mode;
+    out->life = ctx->life;
+    out->score = ctx->score;
+    out->best_score = ctx->best_score;
+    out->frame = sim->frames[index];
+    out->ship_pos.x = ctx->ship_x;
+    out->ship_pos.y = ctx->ship_y;
+    out->ship_roll = ctx->roll_angle;
+    out->ship_pitch = ctx->pitch_angle;
+    out->barrel_roll = ctx->barrel_cur_t >= 0;
+    out->target = ctx->tgt_pos ? (int32_t)((const Enemy*)ctx->tgt_pos - ctx->enemies) : -1;
+
+    out->num_enemies = ctx->num_enemies;
+    for (int i = 0; i < ctx->num_enemies; i++) {
+        const Enemy* nme = &ctx->enemies[i];
+        HsEnemy* e = &out->enemies[i];
+        e->pos = hs_vec3(&nme->pos);
+        e->spd = hs_vec3(&nme->spd);
+        e->type = nme->type;
+        e->life = nme->life;
+    }
+
+    int n = 0;
+    for (int i = 0; i < ctx->num_lasers; i++) hs_laser(&out->lasers[n++], &ctx->lasers[i], 0);
+    for (int i = 0; i < ctx->num_nme_lasers; i++) hs_laser(&out->lasers[n++], &ctx->nme_lasers[i], 1);
+    out->num_lasers = n;
+}
+
+HS_API void hs_timing(const HsSim* sim, HsTiming* out) {
+    if (!sim || !out) return;
+    *out = sim->timing;
+}
+
+HS_API size_t hs_snapshot_max_size(void) {
+    return SNAPSHOT_MAX_SIZE;
+}
+
+HS_API size_t hs_snapshot(HsSim* sim, int index, void* buf, size_t cap) {
+    if (!hs_valid(sim, index) || !buf) return 0;
+    batch_sync(sim->batch, index);
+    return game_snapshot(&sim->batch->games[index], (uint8_t*)buf, cap);
+}
+
+HS_API int hs_restore(HsSim* sim, int index, const void* buf, size_t size) {
+    if (!hs_valid(sim, index) || !buf) return 0;
+    if (!game_restore(&sim->batch->games[index], (const uint8_t*)buf, size)) return 0;
+    batch_load(sim->batch, index);
+    return 1;
+}
+
+HS_API const uint32_t* hs_palette(void) {
+    static const uint32_t palette[16] = {
+        0x000000, 0x1D2B53, 0x7E2553, 0x008751, 0xAB5236, 0x5F574F, 0xC2C3C7, 0xFFF1E8,
+        0xFF004D, 0xFFA300, 0xFFEC27, 0x00E436, 0x29ADFF, 0x83769C, 0xFF77A8, 0xFFCCAA,
+    };
+    return palette;
+}
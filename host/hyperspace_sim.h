@@ -0,0 +1,154 @@
+/*
+ * Hyperspace - Embeddable Simulator API
+ * Stable C ABI for external harnesses (libhyperspace_sim)
+ *
+ * A simulator holds one or more game instances that step together in
+ * lockstep, one button mask per instance per step. Each instance exposes
+ * its 120x120 framebuffer without copying, and a compact entity list
+ * (ship, enemies, lasers) for harnesses that do not want pixels.
+ * Drawing can be switched off per instance; the game plays out the same
+ * either way.
+ *
+ * Threading: calls on one HsSim must not overlap, but different HsSim
+ * handles can be stepped on different threads.
+ *
+ * Positions, speeds and angles are Q16.16 fixed point, exactly as the
+ * game stores them (divide by 65536.0 for real values).
+ *
+ * This header depends only on <stddef.h> and <stdint.h>; bump
+ * HS_API_VERSION whenever a struct or function below changes or is added.
+ */
+
+#ifndef HYPERSPACE_SIM_H
+#define HYPERSPACE_SIM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define HS_API_VERSION 2
+
+#if defined(HS_BUILDING_LIBRARY)
+#define HS_API __attribute__((visibility("default")))
+#else
+#define HS_API
+#endif
+
+#define HS_SCREEN_WIDTH 120
+#define HS_SCREEN_HEIGHT 120
+#define HS_MAX_ENEMIES 25
+#define HS_MAX_LASERS 50
+
+// Button mask bits (same as the host replay files)
+#define HS_BTN_LEFT   (1 << 0)
+#define HS_BTN_RIGHT  (1 << 1)
+#define HS_BTN_UP     (1 << 2)
+#define HS_BTN_DOWN   (1 << 3)
+#define HS_BTN_FIRE   (1 << 4)
+#define HS_BTN_ROLL   (1 << 5)
+
+// HsObservation.mode
+#define HS_MODE_TITLE    0
+#define HS_MODE_START    1  // camera moving behind the ship
+#define HS_MODE_PLAYING  2
+#define HS_MODE_OPTIONS  3
+
+typedef struct HsSim HsSim;
+
+typedef struct {
+    int32_t x, y, z;
+} HsVec3;
+
+typedef struct {
+    HsVec3 pos;
+    HsVec3 spd;
+    int32_t type;       // 1 asteroid, 2 small ship, 3 medium ship, 4 boss
+    int32_t life;       // hits left; negative while exploding
+} HsEnemy;
+
+typedef struct {
+    HsVec3 pos;
+    HsVec3 spd;
+    int32_t hostile;    // 1 for enemy lasers
+} HsLaser;
+
+typedef struct {
+    int32_t mode;           // HS_MODE_*
+    int32_t life;
+    int32_t score;
+    int32_t best_score;
+    int32_t frame;          // steps since the last reset
+    HsVec3 ship_pos;
+    int32_t ship_roll;
+    int32_t ship_pitch;
+    int32_t barrel_roll;    // 1 while a barrel roll is in progress
+    int32_t target;         // index into enemies[] of the auto-aim target, or -1
+
+    int32_t num_enemies;
+    int32_t num_lasers;
+    HsEnemy enemies[HS_MAX_ENEMIES];
+    HsLaser lasers[2 * HS_MAX_LASERS];  // player lasers first, then enemy lasers
+} HsObservation;
+
+// Wall time spent in the most recent hs_step() call, and totals since
+// hs_create(). instance_steps counts one per instance per step.
+typedef struct {
+    uint64_t last_update_ns;
+    uint64_t last_draw_ns;
+    uint64_t total_update_ns;
+    uint64_t total_draw_ns;
+    uint64_t instance_steps;
+} HsTiming;
+
+// Returns HS_API_VERSION of the library actually loaded
+HS_API uint32_t hs_api_version(void);
+
+// Create count instances, instance i reset with seed i + 1 and drawing
+// enabled. Returns NULL on failure.
+HS_API HsSim* hs_create(int count);
+HS_API void hs_destroy(HsSim* sim);
+HS_API int hs_count(const HsSim* sim);
+
+// Restart instance index from power-on with the given seed
+HS_API void hs_reset(HsSim* sim, int index, uint32_t seed);
+
+// Enable or disable drawing for instance index (enabled by default). While
+// disabled its framebuffer keeps the last drawn frame.
+HS_API void hs_set_render(HsSim* sim, int index, int enabled);
+
+// Advance every instance by one frame. buttons holds one HS_BTN_* mask per
+// instance; NULL means no buttons pressed.
+HS_API void hs_step(HsSim* sim, const uint8_t* buttons);
+
+// Palette indices (low 4 bits: PICO-8 color), row-major, HS_SCREEN_WIDTH
+// bytes per row. Points into the instance; valid until hs_destroy().
+HS_API const uint8_t* hs_framebuffer(const HsSim* sim, int index);
+
+// Fill out with the current entity state of instance index
+HS_API void hs_observe(const HsSim* sim, int index, HsObservation* out);
+
+HS_API void hs_timing(const HsSim* sim, HsTiming* out);
+
+// Game-state snapshots (hyperspace_snapshot.h): a versioned, position-
+// independent blob of at most hs_snapshot_max_size() bytes. Restoring it
+// into any instance continues bit-identically from the next hs_step().
+// The frame counter is not part of the snapshot.
+HS_API size_t hs_snapshot_max_size(void);
+
+// Returns the blob size, or 0 if cap is too small
+HS_API size_t hs_snapshot(HsSim* sim, int index, void* buf, size_t cap);
+
+// Returns 1 on success; 0 leaves the instance unchanged
+HS_API int hs_restore(HsSim* sim, int index, const void* buf, size_t size);
+
+// PICO-8 palette as 0xRRGGBB, indexed by framebuffer value & 15
+HS_API const uint32_t* hs_palette(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HYPERSPACE_SIM_H
@@ -0,0 +1,326 @@
+/*
+ * Hyperspace - Host Build
+ * Runs the shared game core headless on a desktop machine
+ *
+ * Runs one game from a deterministic input source (scripted bot or a
+ * replay file) in a frame loop without a display. It is used to drive the
+ * instrumentation builds (OPCOUNT_BUILD, RANGE_BUILD, PROFILE_BUILD,
+ * TRACE_BUILD, OVERDRAW_BUILD) and for quick
+ * regression runs; the final frame hash makes two runs with the same seed
+ * and input easy to compare. The platform layer is in host_platform.h.
+ *
+ * The state digest folds hash_state() over every frame. It does not depend
+ * on the screen or the rasterizer, so the GBA configuration
+ * (hyperspace_gbacore) must print the same one as the plain build.
+ *
+ * --bench runs the benchmark scenarios of hyperspace_bench.h instead, for
+ * comparison with the device table; --rastbench runs the rasterizer
+ * microbenchmark of hyperspace_rastbench.h. --mathcheck and --mathbench
+ * print and time the math of hyperspace_mathbench.h; hyperspace_float is
+ * this program with the MATH_FLOAT backend.
+ *
+ * --snapshot-at N saves the game after frame N, finishes the run, then
+ * restores the snapshot and plays the rest again; both continuations must
+ * end on the same hash.
+ */
+
+#define TRACE_IMPLEMENTATION
+#include "host_platform.h"
+#include "hyperspace_bench.h"
+#include "hyperspace_rastbench.h"
+#include "hyperspace_mathbench.h"
+#include "hyperspace_snapshot.h"
+
+// ============================================================================
+// Main
+// ============================================================================
+
+// The game instance driven by this program
+static GameContext game;
+
+// Input source and running frame hash
+typedef struct {
+    FILE* replay;
+    FILE* record;
+    HostBot bot;
+    uint32_t hash;
+    uint32_t state;
+} HostRun;
+
+// Run frames [first, last); returns the frame it stopped at (early when
+// the replay runs out)
+static uint32_t run_frames(HostRun* run, uint32_t first, uint32_t last) {
+    uint32_t frame;
+    for (frame = first; frame < last; frame++) {
+        uint8_t buttons;
+        if (run->replay) {
+            int c = fgetc(run->replay);
+            if (c == EOF) break;
+            buttons = (uint8_t)c;
+        } else {
+            buttons = bot_buttons(&run->bot, &game, frame);
+        }
+        if (run->record) fputc(buttons, run->record);
+
+#ifdef OPCOUNT_BUILD
+        opc_frame_begin();
+#endif
+#ifdef PROFILE_BUILD
+        prof_frame_begin();
+#endif
+        TRACE_INSTANT(MAIN, TRACE_FRAME);
+        PHASE_BEGIN(PHASE_INPUT);
+        update_input(&game.p8, buttons);
+        PHASE_END(PHASE_INPUT);
+
+        game_update(&game);
+        game_draw(&game);
+
+        run->hash = hash_screen(&game.p8, run->hash);
+        run->state = hash_state(&game, run->state);
+#ifdef PROFILE_BUILD
+        // After hashing, so the overlay does not change the frame hash
+        prof_draw_overlay(&game.p8);
+        prof_frame_end();
+#endif
+#ifdef OPCOUNT_BUILD
+        opc_frame_end();
+#endif
+#ifdef OVERDRAW_BUILD
+        ovd_frame_end();
+#endif
+    }
+    return frame;
+}
+
+// Snapshot taken by --snapshot-at, with the input state at that point
+static uint8_t snapshot[SNAPSHOT_MAX_SIZE];
+static size_t snapshot_size;
+static HostRun snapshot_run;
+static long snapshot_replay_pos;
+
+// Restore the snapshot taken after frame `at` and play to the end again;
+// the final hash must equal the original run's. Returns 0 when identical.
+static int verify_snapshot(uint32_t at, uint32_t frames, uint32_t expect_hash) {
+    // Time both directions over many repetitions
+    static uint8_t scratch[SNAPSHOT_MAX_SIZE];
+    const int reps = 10000;
+    double t0 = host_time_s();
+    for (int i = 0; i < reps; i++) game_snapshot(&game, scratch, sizeof(scratch));
+    double t1 = host_time_s();
+    bool ok = true;
+    for (int i = 0; i < reps; i++) ok &= game_restore(&game, snapshot, snapshot_size);
+    double t2 = host_time_s();
+    if (!ok) {
+        fprintf(stderr, "snapshot rejected on restore\n");
+        return 1;
+    }
+
+    HostRun run = snapshot_run;
+    run.record = NULL;
+    if (run.replay) fseek(run.replay, snapshot_replay_pos, SEEK_SET);
+    run_frames(&run, at, frames);
+
+    printf("snapshot at frame %u: %zu bytes (max %d), save %.2f us, restore %.2f us\n",
+           at, snapshot_size, SNAPSHOT_MAX_SIZE, (t1 - t0) * 1e6 / reps, (t2 - t1) * 1e6 / reps);
+    printf("restored continuation: hash %08x, %s\n", run.hash,
+           run.hash == expect_hash ? "identical" : "DIFFERS");
+    return run.hash != expect_hash;
+}
+
+static void usage(const char* prog) {
+    fprintf(stderr,
+        "usage: %s [options]\n"
+        "  --frames N      number of frames to run (default 1800)\n"
+        "  --seed S        initial RNG state (default 1)\n"
+        "  --replay FILE   read one button byte per frame instead of the bot\n"
+        "  --record FILE   write the button bytes that were used\n"
+        "  --snapshot-at N snapshot after frame N and verify the restored continuation\n"
+        "  --bench         run the benchmark scenarios and print the table\n"
+        "  --rastbench [N] run the rasterizer microbenchmark, N reps (default 20)\n"
+        "  --mathcheck     print the math check values (make check-math compares them)\n"
+        "  --mathbench [N] time the math backend, N reps (default 20000)\n"
+#ifdef TRACE_BUILD
+        "  --trace FILE    write the last %d trace events for trace_to_chrome.py\n"
+#endif
+#ifdef OVD_HEATMAP
+        "  --heatmap FILE  write the average writes per pixel as a PPM\n"
+#endif
+#ifdef OPCOUNT_BUILD
+        "  --mhz N         clock used for the prediction (default 250)\n"
+        "  --cycles SPEC   cycle table, e.g. mul=42,div=190 (as printed by the device)\n"
+#endif
+        , prog
+#ifdef TRACE_BUILD
+        , TRACE_CAPACITY
+#endif
+        );
+}
+
+int main(int argc, char** argv) {
+    uint32_t frames = 1800;
+    uint32_t seed = 1;
+    const char* replay_path = NULL;
+    const char* record_path = NULL;
+    uint32_t snapshot_at = 0;
+    bool bench = false;
+    int rastbench_reps = 0;
+    bool mathcheck = false;
+    int mathbench_reps = 0;
+#ifdef TRACE_BUILD
+    const char* trace_path = NULL;
+#endif
+#ifdef OVD_HEATMAP
+    const char* heatmap_path = NULL;
+#endif
+#ifdef OPCOUNT_BUILD
+    uint32_t mhz = 250;
+#endif
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* val = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if (strcmp(arg, "--frames") == 0 && val) { frames = strtoul(val, NULL, 0); i++; }
+        else if (strcmp(arg, "--seed") == 0 && val) { seed = strtoul(val, NULL, 0); i++; }
+        else if (strcmp(arg, "--replay") == 0 && val) { replay_path = val; i++; }
+        else if (strcmp(arg, "--record") == 0 && val) { record_path = val; i++; }
+        else if (strcmp(arg, "--snapshot-at") == 0 && val) { snapshot_at = strtoul(val, NULL, 0); i++; }
+        else if (strcmp(arg, "--bench") == 0) { bench = true; }
+        else if (strcmp(arg, "--rastbench") == 0) {
+            rastbench_reps = 20;
+            if (val && val[0] != '-') { rastbench_reps = atoi(val); i++; }
+        }
+        else if (strcmp(arg, "--mathcheck") == 0) { mathcheck = true; }
+        else if (strcmp(arg, "--mathbench") == 0) {
+            mathbench_reps = 20000;
+            if (val && val[0] != '-') { mathbench_reps = atoi(val); i++; }
+        }
+#ifdef TRACE_BUILD
+        else if (strcmp(arg, "--trace") == 0 && val) { trace_path = val; i++; }
+#endif
+#ifdef OVD_HEATMAP
+        else if (strcmp(arg, "--heatmap") == 0 && val) { heatmap_path = val; i++; }
+#endif
+#ifdef OPCOUNT_BUILD
+        else if (strcmp(arg, "--mhz") == 0 && val) { mhz = strtoul(val, NULL, 0); i++; }
+        else if (strcmp(arg, "--cycles") == 0 && val) {
+            if (opc_parse_cycles(val) != 0) {
+                fprintf(stderr, "bad cycle table: %s\n", val);
+                return 1;
+            }
+            i++;
+        }
+#endif
+        else { usage(argv[0]); return 1; }
+    }
+
+    if (bench) {
+        // clock_mhz 0: the host has no fixed clock to report
+        const BenchPlatform plat = {host_time_us, NULL, 0, 0};
+        load_embedded_data();
+#ifdef PROFILE_BUILD
+        prof_init(host_time_us);
+#endif
+        bench_run(&game, &plat);
+        return 0;
+    }
+    if (rastbench_reps > 0) {
+        const RastBenchPlatform plat = {host_time_us, 0, rastbench_reps};
+        load_embedded_data();
+        rastbench_run(&game, &plat);
+        return 0;
+    }
+    if (mathcheck) {
+        load_embedded_data();
+        mathbench_check(stdout);
+        return 0;
+    }
+    if (mathbench_reps > 0) {
+        const MathBenchPlatform plat = {host_time_us, mathbench_reps};
+        load_embedded_data();
+        mathbench_run(&game, &plat);
+        return 0;
+    }
+
+    HostRun run = {NULL, NULL, {0}, HOST_HASH_INIT, HOST_HASH_INIT};
+    if (replay_path && !(run.replay = fopen(replay_path, "rb"))) {
+        perror(replay_path);
+        return 1;
+    }
+    if (record_path && !(run.record = fopen(record_path, "wb"))) {
+        perror(record_path);
+        return 1;
+    }
+
+    load_embedded_data();
+    game_init(&game, seed);
+    bot_init(&run.bot, HOST_BOT_SEED);
+
+#ifdef OPCOUNT_BUILD
+    // Loading and mesh decoding are not part of a frame
+    opc_reset();
+#endif
+#ifdef PROFILE_BUILD
+    // One report over the whole run; there is no button combo here
+    prof_init(host_time_us);
+    prof_toggle();
+#endif
+#ifdef TRACE_BUILD
+    trace_init(host_time_us);
+#endif
+#ifdef OVERDRAW_BUILD
+    ovd_reset();
+#endif
+
+    double t0 = host_time_s();
+    uint32_t frame = 0;
+    if (snapshot_at > 0 && snapshot_at < frames) {
+        frame = run_frames(&run, 0, snapshot_at);
+        snapshot_size = game_snapshot(&game, snapshot, sizeof(snapshot));
+        snapshot_run = run;
+        snapshot_replay_pos = run.replay ? ftell(run.replay) : 0;
+    }
+    frame = run_frames(&run, frame, frames);
+    double elapsed = host_time_s() - t0;
+
+    printf("frames %u  seed %u  score %d  mode %d  hash %08x  state %08x  %.1f fps (host)\n",
+           frame, seed, game.score, game.cur_mode, run.hash, run.state, elapsed > 0 ? frame / elapsed : 0.0);
+
+    int status = 0;
+    if (snapshot_size) status = verify_snapshot(snapshot_at, frames, run.hash);
+
+    if (run.replay) fclose(run.replay);
+    if (run.record) fclose(run.record);
+
+#ifdef OPCOUNT_BUILD
+    opc_report(mhz);
+#endif
+#ifdef RANGE_BUILD
+    range_report(stdout);
+#endif
+#ifdef PROFILE_BUILD
+    prof_report();
+#endif
+#ifdef TRACE_BUILD
+    if (trace_path) {
+        FILE* out = fopen(trace_path, "w");
+        if (!out) {
+            perror(trace_path);
+            return 1;
+        }
+        trace_dump(out);
+        fclose(out);
+    }
+#endif
+#ifdef OVERDRAW_BUILD
+    ovd_report(stdout);
+#endif
+#ifdef OVD_HEATMAP
+    if (heatmap_path && ovd_write_heatmap(heatmap_path) != 0) {
+        perror(heatmap_path);
+        return 1;
+    }
+#endif
+    game_destroy(&game);
+    return status;
+}
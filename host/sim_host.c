@@ -0,0 +1,114 @@
+/*
+ * Hyperspace - Simulator API Driver
+ * Drives libhyperspace_sim through hyperspace_sim.h only
+ *
+ * Steps N instances in one hs_step() call per frame. Input comes from a
+ * replay file (the same format hyperspace_host --record writes, applied
+ * to every instance) or from a minimal player that reads hs_observe():
+ * tap roll until the game starts, then hold fire. Instance 0 is seeded
+ * like hyperspace_host, so with the same replay the printed frame hash
+ * must match it.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hyperspace_sim.h"
+
+static void usage(const char* prog) {
+    fprintf(stderr,
+        "usage: %s [options]\n"
+        "  --games N       instances stepped per call (default 1)\n"
+        "  --frames N      number of frames to run (default 1800)\n"
+        "  --seed S        seed of instance 0; instance i uses S + i (default 1)\n"
+        "  --replay FILE   one button byte per frame, for every instance\n"
+        "  --no-render     observe entities only, do not draw\n"
+        , prog);
+}
+
+int main(int argc, char** argv) {
+    int num_games = 1;
+    uint32_t frames = 1800;
+    uint32_t seed = 1;
+    const char* replay_path = NULL;
+    int render = 1;
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* val = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if (strcmp(arg, "--games") == 0 && val) { num_games = atoi(val); i++; }
+        else if (strcmp(arg, "--frames") == 0 && val) { frames = strtoul(val, NULL, 0); i++; }
+        else if (strcmp(arg, "--seed") == 0 && val) { seed = strtoul(val, NULL, 0); i++; }
+        else if (strcmp(arg, "--replay") == 0 && val) { replay_path = val; i++; }
+        else if (strcmp(arg, "--no-render") == 0) { render = 0; }
+        else { usage(argv[0]); return 1; }
+    }
+    if (num_games <= 0) { usage(argv[0]); return 1; }
+
+    if (hs_api_version() != HS_API_VERSION) {
+        fprintf(stderr, "library API version %u, expected %u\n", hs_api_version(), HS_API_VERSION);
+        return 1;
+    }
+
+    FILE* replay = NULL;
+    if (replay_path && !(replay = fopen(replay_path, "rb"))) {
+        perror(replay_path);
+        return 1;
+    }
+
+    HsSim* sim = hs_create(num_games);
+    uint8_t* buttons = (uint8_t*)calloc(num_games, 1);
+    HsObservation* obs = (HsObservation*)malloc(sizeof(HsObservation));
+    if (!sim || !buttons || !obs) {
+        fprintf(stderr, "out of memory for %d instances\n", num_games);
+        return 1;
+    }
+    for (int k = 0; k < num_games; k++) {
+        hs_reset(sim, k, seed + k);
+        hs_set_render(sim, k, render);
+    }
+
+    uint32_t hash = 2166136261u;
+    uint32_t frame;
+    for (frame = 0; frame < frames; frame++) {
+        if (replay) {
+            int c = fgetc(replay);
+            if (c == EOF) break;
+            memset(buttons, c, num_games);
+        } else {
+            for (int k = 0; k < num_games; k++) {
+                hs_observe(sim, k, obs);
+                if (obs->mode == HS_MODE_PLAYING) buttons[k] = HS_BTN_FIRE;
+                else buttons[k] = (frame % 20) == 0 ? HS_BTN_ROLL : 0;
+            }
+        }
+
+        hs_step(sim, buttons);
+
+        if (render) {
+            const uint8_t* fb = hs_framebuffer(sim, 0);
+            for (int i = 0; i < HS_SCREEN_WIDTH * HS_SCREEN_HEIGHT; i++) {
+                hash = (hash ^ fb[i]) * 16777619u;
+            }
+        }
+    }
+
+    HsTiming timing;
+    hs_timing(sim, &timing);
+    hs_observe(sim, 0, obs);
+    double steps = timing.instance_steps ? (double)timing.instance_steps : 1.0;
+
+    printf("frames %u  seed %u  score %d  mode %d  enemies %d  lasers %d",
+           frame, seed, obs->score, obs->mode, obs->num_enemies, obs->num_lasers);
+    if (render) printf("  hash %08x", hash);
+    printf("\n%d instances: update %.1f us/step, draw %.1f us/step, %.0f steps/s\n",
+           num_games, timing.total_update_ns / steps / 1000.0, timing.total_draw_ns / steps / 1000.0,
+           steps * 1e9 / (double)(timing.total_update_ns + timing.total_draw_ns + 1));
+
+    if (replay) fclose(replay);
+    free(obs);
+    free(buttons);
+    hs_destroy(sim);
+    return 0;
+}
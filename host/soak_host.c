@@ -0,0 +1,164 @@
+/*
+ * Hyperspace - Host Soak Driver
+ * Runs thousands of independent games across a thread pool
+ *
+ * Every game has its own GameContext (RNG, framebuffer, state) and its own
+ * scripted bot, seeded from its index, so the results do not depend on how
+ * games are scheduled onto threads. The run is repeated for each thread
+ * count and reports aggregate simulated frames per second; the digest of
+ * all final frames must be identical for every thread count.
+ */
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <unistd.h>
+
+#include "host_platform.h"
+
+// Games handed to a worker at a time
+#define SOAK_CHUNK 4
+
+typedef struct {
+    GameContext* games;
+    uint32_t* hashes;
+    int num_games;
+    uint32_t frames;
+    atomic_int next;
+} SoakJob;
+
+// Play game i from power-on for the configured number of frames
+static void soak_run_game(SoakJob* job, int i) {
+    GameContext* ctx = &job->games[i];
+    HostBot bot;
+
+    game_init(ctx, i + 1);
+    bot_init(&bot, HOST_BOT_SEED + i);
+
+    for (uint32_t frame = 0; frame < job->frames; frame++) {
+        update_input(&ctx->p8, bot_buttons(&bot, ctx, frame));
+        game_update(ctx);
+        game_draw(ctx);
+    }
+
+    job->hashes[i] = hash_screen(&ctx->p8, HOST_HASH_INIT);
+    game_destroy(ctx);
+}
+
+static void* soak_worker(void* arg) {
+    SoakJob* job = (SoakJob*)arg;
+    for (;;) {
+        int first = atomic_fetch_add(&job->next, SOAK_CHUNK);
+        if (first >= job->num_games) break;
+        int last = first + SOAK_CHUNK;
+        if (last > job->num_games) last = job->num_games;
+        for (int i = first; i < last; i++) {
+            soak_run_game(job, i);
+        }
+    }
+    return NULL;
+}
+
+// Run all games on num_threads workers; returns elapsed seconds
+static double soak_run(SoakJob* job, int num_threads) {
+    pthread_t* threads = (pthread_t*)calloc(num_threads, sizeof(pthread_t));
+    atomic_store(&job->next, 0);
+
+    double t0 = host_time_s();
+    for (int t = 0; t < num_threads; t++) {
+        pthread_create(&threads[t], NULL, soak_worker, job);
+    }
+    for (int t = 0; t < num_threads; t++) {
+        pthread_join(threads[t], NULL);
+    }
+    double elapsed = host_time_s() - t0;
+
+    free(threads);
+    return elapsed;
+}
+
+static uint32_t soak_digest(const SoakJob* job) {
+    uint32_t h = HOST_HASH_INIT;
+    for (int i = 0; i < job->num_games; i++) {
+        h = (h ^ job->hashes[i]) * 16777619u;
+    }
+    return h;
+}
+
+static void usage(const char* prog) {
+    fprintf(stderr,
+        "usage: %s [options]\n"
+        "  --games N       number of independent games (default 1000)\n"
+        "  --frames N      frames per game (default 600)\n"
+        "  --threads LIST  comma-separated thread counts (default 1,2,4,.. up to the core count)\n"
+        , prog);
+}
+
+int main(int argc, char** argv) {
+    int num_games = 1000;
+    uint32_t frames = 600;
+    int thread_counts[32];
+    int num_counts = 0;
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* val = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if (strcmp(arg, "--games") == 0 && val) { num_games = atoi(val); i++; }
+        else if (strcmp(arg, "--frames") == 0 && val) { frames = strtoul(val, NULL, 0); i++; }
+        else if (strcmp(arg, "--threads") == 0 && val) {
+            for (const char* p = val; *p && num_counts < 32; ) {
+                int n = atoi(p);
+                if (n > 0) thread_counts[num_counts++] = n;
+                p = strchr(p, ',');
+                if (!p) break;
+                p++;
+            }
+            i++;
+        }
+        else { usage(argv[0]); return 1; }
+    }
+    if (num_games <= 0) { usage(argv[0]); return 1; }
+
+    int cores = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (cores < 1) cores = 1;
+    if (num_counts == 0) {
+        for (int n = 1; n < cores && num_counts < 31; n *= 2) thread_counts[num_counts++] = n;
+        thread_counts[num_counts++] = cores;
+    }
+
+    load_embedded_data();
+
+    SoakJob job;
+    job.games = (GameContext*)calloc(num_games, sizeof(GameContext));
+    job.hashes = (uint32_t*)calloc(num_games, sizeof(uint32_t));
+    job.num_games = num_games;
+    job.frames = frames;
+    if (!job.games || !job.hashes) {
+        fprintf(stderr, "out of memory for %d games\n", num_games);
+        return 1;
+    }
+
+    printf("\n%d games x %u frames, %d cores, %zu bytes per game\n",
+           num_games, frames, cores, sizeof(GameContext));
+    printf("%8s %10s %14s %9s %11s\n", "threads", "seconds", "frames/s", "speedup", "digest");
+
+    double base_rate = 0;
+    uint32_t base_digest = 0;
+    int mismatch = 0;
+    for (int c = 0; c < num_counts; c++) {
+        double elapsed = soak_run(&job, thread_counts[c]);
+        double rate = elapsed > 0 ? (double)num_games * frames / elapsed : 0.0;
+        uint32_t digest = soak_digest(&job);
+        if (c == 0) {
+            base_rate = rate;
+            base_digest = digest;
+        }
+        if (digest != base_digest) mismatch = 1;
+        printf("%8d %10.2f %14.0f %8.2fx   %08x%s\n", thread_counts[c], elapsed, rate,
+               base_rate > 0 ? rate / base_rate : 0.0, digest,
+               digest != base_digest ? "  MISMATCH" : "");
+    }
+
+    free(job.games);
+    free(job.hashes);
+    return mismatch;
+}
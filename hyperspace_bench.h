@@ -0,0 +1,281 @@
+/*
+ * Hyperspace Benchmark Mode
+ *
+ * Fixed scenarios with scripted input and a fixed RNG seed, so every run
+ * renders the same frames and builds or clock settings can be compared:
+ * - title:      the title screen camera orbit
+ * - asteroids:  a dense asteroid field
+ * - wave:       three medium ships
+ * - boss:       the boss
+ * - ships N:    N small ships kept alive, beyond what the sequencer spawns
+ * - lasers N:   N enemy lasers kept in flight
+ *
+ * The sequencer is parked and the ship cannot die, so each scenario keeps
+ * its load for the whole run. Frames run back to back without the 30 fps
+ * pacing; each one is timed as a whole and split into update (including
+ * the vertex transform), draw and present. PROFILE_BUILD adds the average
+ * of every phase (hyperspace_phases.h) to the results and a second table;
+ * the platform must have called prof_init() first.
+ *
+ * The platform supplies the timer and a present callback (flip and wait on
+ * the device, nothing on the host). The timer may count CPU cycles instead
+ * of microseconds, as on the GBA (cycles_per_ms set); every result is then
+ * in cycles, the printed tables say so and the drawn one converts to ms.
+ * bench_run() prints the results table and bench_draw_results() draws it
+ * into the framebuffer.
+ */
+
+#ifndef HYPERSPACE_BENCH_H
+#define HYPERSPACE_BENCH_H
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define BENCH_SEED 0x42454e43  // "BENC"
+#define BENCH_MAX_FRAMES 450
+#define BENCH_FORMAT_VERSION 2
+
+typedef struct {
+    uint32_t (*now_us)(void);
+    void (*present)(GameContext* ctx);  // may be NULL
+    uint32_t clock_mhz;                 // for the report header only
+    uint32_t cycles_per_ms;             // 0: now_us() counts microseconds
+} BenchPlatform;
+
+typedef enum {
+    BENCH_TITLE,
+    BENCH_ASTEROIDS,
+    BENCH_SHIPS,        // level ships of ship_type, respawned when lost
+    BENCH_LASERS,       // level enemy lasers in flight
+} BenchKind;
+
+typedef struct {
+    const char* name;
+    BenchKind kind;
+    int ship_type;
+    int level;
+    int warmup;         // frames run before timing starts
+    int frames;         // timed frames
+} BenchScenario;
+
+static const BenchScenario bench_scenarios[] = {
+    {"title",     BENCH_TITLE,     0,  0,   0, 300},
+    {"asteroids", BENCH_ASTEROIDS, 0,  0, 200, 450},
+    {"wave",      BENCH_SHIPS,     3,  3,  60, 450},
+    {"boss",      BENCH_SHIPS,     4,  1,  60, 450},
+    {"ships 5",   BENCH_SHIPS,     2,  5,  30, 150},
+    {"ships 10",  BENCH_SHIPS,     2, 10,  30, 150},
+    {"ships 15",  BENCH_SHIPS,     2, 15,  30, 150},
+    {"ships 20",  BENCH_SHIPS,     2, 20,  30, 150},
+    {"ships 25",  BENCH_SHIPS,     2, 25,  30, 150},
+    {"lasers 10", BENCH_LASERS,    0, 10,  30, 150},
+    {"lasers 20", BENCH_LASERS,    0, 20,  30, 150},
+    {"lasers 30", BENCH_LASERS,    0, 30,  30, 150},
+    {"lasers 40", BENCH_LASERS,    0, 40,  30, 150},
+    {"lasers 50", BENCH_LASERS,    0, 50,  30, 150},
+};
+#define BENCH_NUM_SCENARIOS ((int)(sizeof(bench_scenarios) / sizeof(bench_scenarios[0])))
+
+// Per-scenario results, all in microseconds
+typedef struct {
+    uint32_t min, avg, p99, max;
+    uint32_t update, draw, present;     // averages
+    uint32_t hash;                      // last frame, to compare runs
+#ifdef PROFILE_BUILD
+    uint32_t phase[PHASE_COUNT];        // averages
+#endif
+} BenchResult;
+
+static BenchResult bench_results[BENCH_NUM_SCENARIOS];
+static uint32_t bench_ticks_per_ms = 1000;  // of the timer the results came from
+static uint32_t bench_frame_us[BENCH_MAX_FRAMES];
+
+// Same mapping as the host replay bits: left, right, up, down, fire, roll
+static void bench_set_buttons(Pico8* p8, uint8_t buttons) {
+    memcpy(p8->btn_prev, p8->btn_state, sizeof(p8->btn_prev));
+    for (int i = 0; i < 6; i++) {
+        p8->btn_state[i] = (buttons >> i) & 1;
+    }
+}
+
+// Weave left/right and up/down on different periods, firing in fights
+static uint8_t bench_buttons(const BenchScenario* sc, int frame) {
+    if (sc->kind == BENCH_TITLE) return 0;
+    uint8_t b = (frame / 40) & 1 ? 0x02 : 0x01;
+    b |= (frame / 60) & 1 ? 0x08 : 0x04;
+    if (sc->kind == BENCH_SHIPS) b |= 0x10;
+    return b;
+}
+
+// spawn_nme_ship() schedules the next sequencer step; keep it parked
+static void bench_park_sequencer(GameContext* ctx) {
+    ctx->next_sequencer_t = SC(32767.0);
+    ctx->waiting_nme_clear = false;
+}
+
+// Skip the title and the camera move: the state at the end of mode 1
+static void bench_start_playing(GameContext* ctx) {
+    ctx->cur_mode = 2;
+    ctx->score = 0;
+    ctx->cam_depth = SC(26.0);
+    bench_park_sequencer(ctx);
+}
+
+static void bench_setup(GameContext* ctx, const BenchScenario* sc) {
+    game_init(ctx, BENCH_SEED);
+    if (sc->kind == BENCH_TITLE) return;
+    bench_start_playing(ctx);
+    if (sc->kind == BENCH_ASTEROIDS) {
+        ctx->spawn_asteroids = true;
+        ctx->asteroid_mul_t = SC(0.125);
+    }
+}
+
+// Before each update: undo damage and top the load back up to the level
+static void bench_sustain(GameContext* ctx, const BenchScenario* sc) {
+    if (sc->kind == BENCH_TITLE) return;
+    ctx->life = 4;
+
+    if (sc->kind == BENCH_SHIPS) {
+        while (ctx->nb_nme_ship < sc->level && ctx->num_enemies < MAX_ENEMIES) {
+            spawn_nme_ship(ctx, sc->ship_type);
+        }
+        bench_park_sequencer(ctx);
+    } else if (sc->kind == BENCH_LASERS) {
+        while (ctx->num_nme_lasers < sc->level) {
+            Vec3 pos = {sym_random_fix(ctx, SC(80.0)), sym_random_fix(ctx, SC(80.0)), SC(-150.0) + rnd_fix(ctx, SC(50.0))};
+            Laser* laser = spawn_laser(ctx->nme_lasers, &ctx->num_nme_lasers, pos);
+            if (!laser) break;
+            vec3_set(&laser->spd, sym_random_fix(ctx, SC(0.2)), sym_random_fix(ctx, SC(0.2)), FIX_TWO);
+        }
+    }
+}
+
+static int bench_cmp_u32(const void* a, const void* b) {
+    uint32_t x = *(const uint32_t*)a, y = *(const uint32_t*)b;
+    return (x > y) - (x < y);
+}
+
+static void bench_run_scenario(GameContext* ctx, const BenchPlatform* plat, const BenchScenario* sc, BenchResult* res) {
+    bench_setup(ctx, sc);
+    uint64_t update_sum = 0, draw_sum = 0, present_sum = 0, frame_sum = 0;
+
+    for (int f = 0; f < sc->warmup + sc->frames; f++) {
+#ifdef PROFILE_BUILD
+        if (f == sc->warmup) prof_reset_report();
+        prof_frame_begin();
+#endif
+        uint32_t t0 = plat->now_us();
+        bench_set_buttons(&ctx->p8, bench_buttons(sc, f));
+        bench_sustain(ctx, sc);
+        game_update(ctx);
+        uint32_t t1 = plat->now_us();
+        game_draw(ctx);
+        uint32_t t2 = plat->now_us();
+        if (plat->present) plat->present(ctx);
+        uint32_t t3 = plat->now_us();
+#ifdef PROFILE_BUILD
+        prof_frame_end();
+#endif
+
+        if (f < sc->warmup) continue;
+        bench_frame_us[f - sc->warmup] = t3 - t0;
+        frame_sum += t3 - t0;
+        update_sum += t1 - t0;
+        draw_sum += t2 - t1;
+        present_sum += t3 - t2;
+    }
+
+    uint32_t h = 2166136261u;
+    const uint8_t* p = &ctx->p8.screen[0][0];
+    for (size_t i = 0; i < sizeof(ctx->p8.screen); i++) {
+        h = (h ^ p[i]) * 16777619u;
+    }
+    game_destroy(ctx);
+
+    int n = sc->frames;
+    qsort(bench_frame_us, n, sizeof(uint32_t), bench_cmp_u32);
+    res->min = bench_frame_us[0];
+    res->max = bench_frame_us[n - 1];
+    res->p99 = bench_frame_us[(n * 99 - 1) / 100];
+    res->avg = (uint32_t)(frame_sum / n);
+    res->update = (uint32_t)(update_sum / n);
+    res->draw = (uint32_t)(draw_sum / n);
+    res->present = (uint32_t)(present_sum / n);
+    res->hash = h;
+#ifdef PROFILE_BUILD
+    for (int p = 0; p < PHASE_COUNT; p++) {
+        res->phase[p] = (uint32_t)(prof_rows[p].rep_sum / n);
+    }
+#endif
+}
+
+// Run every scenario in ctx (which is left destroyed) and print the table
+static void bench_run(GameContext* ctx, const BenchPlatform* plat) {
+#ifdef PROFILE_BUILD
+    bool prof_was_enabled = prof_enabled;
+    if (!prof_was_enabled) prof_toggle();
+#endif
+    const char* unit = plat->cycles_per_ms ? "cycles" : "us";
+    bench_ticks_per_ms = plat->cycles_per_ms ? plat->cycles_per_ms : 1000;
+    printf("\r\nbench %d: %d scenarios, %u MHz, %s per frame\r\n", BENCH_FORMAT_VERSION,
+           BENCH_NUM_SCENARIOS, (unsigned)plat->clock_mhz, unit);
+    printf("%-10s %6s %6s %6s %6s  %6s %6s %6s  %s\r\n",
+           "scenario", "min", "avg", "p99", "max", "update", "draw", "present", "hash");
+    for (int i = 0; i < BENCH_NUM_SCENARIOS; i++) {
+        const BenchResult* r = &bench_results[i];
+        bench_run_scenario(ctx, plat, &bench_scenarios[i], &bench_results[i]);
+        printf("%-10s %6u %6u %6u %6u  %6u %6u %6u  %08x\r\n", bench_scenarios[i].name,
+               (unsigned)r->min, (unsigned)r->avg, (unsigned)r->p99, (unsigned)r->max,
+               (unsigned)r->update, (unsigned)r->draw, (unsigned)r->present, (unsigned)r->hash);
+    }
+#ifdef PROFILE_BUILD
+    if (!prof_was_enabled) prof_toggle();
+
+    printf("\r\nbench phases: average %s per frame\r\n%-10s", unit, "scenario");
+    for (int p = 0; p < PHASE_COUNT; p++) printf(" %11s", phase_names[p]);
+    printf("\r\n");
+    for (int i = 0; i < BENCH_NUM_SCENARIOS; i++) {
+        printf("%-10s", bench_scenarios[i].name);
+        for (int p = 0; p < PHASE_COUNT; p++) printf(" %11u", (unsigned)bench_results[i].phase[p]);
+        printf("\r\n");
+    }
+#endif
+}
+
+// Milliseconds with one decimal, "12.3", from a result in timer ticks
+static void bench_fmt_ms(char* buf, uint32_t ticks) {
+    uint32_t tenths = (uint32_t)(((uint64_t)ticks * 10 + bench_ticks_per_ms / 2) / bench_ticks_per_ms);
+    snprintf(buf, 8, "%2u.%u", (unsigned)(tenths / 10), (unsigned)(tenths % 10));
+}
+
+// Page 0: min/avg/p99 frame time, page 1: average update/draw/present
+#define BENCH_PAGES 2
+static void bench_draw_results(GameContext* ctx, int page) {
+    static const char* const headers[BENCH_PAGES] = {
+        "scenario   min  avg  p99",
+        "scenario   upd  drw  prs",
+    };
+    Pico8* p8 = &ctx->p8;
+    pal_reset(p8);
+    cls(p8);
+    print_str(ctx, "benchmark, ms per frame", 1, 1, 7);
+    print_str(ctx, headers[page], 1, 9, 6);
+    for (int i = 0; i < BENCH_NUM_SCENARIOS; i++) {
+        const BenchResult* r = &bench_results[i];
+        uint32_t v[3] = {r->min, r->avg, r->p99};
+        if (page == 1) {
+            v[0] = r->update;
+            v[1] = r->draw;
+            v[2] = r->present;
+        }
+        char a[8], b[8], c[8], line[40];
+        bench_fmt_ms(a, v[0]);
+        bench_fmt_ms(b, v[1]);
+        bench_fmt_ms(c, v[2]);
+        snprintf(line, sizeof(line), "%-10s%s %s %s", bench_scenarios[i].name, a, b, c);
+        print_str(ctx, line, 1, 17 + i * 7, i < 4 ? 7 : 13);
+    }
+}
+
+#endif // HYPERSPACE_BENCH_H
@@ -1,22 +1,317 @@
 /*
  * Hyperspace Game Logic
- * Shared between PicoSystem and ThumbyColor ports
+ * Shared between the PicoSystem, ThumbyColor and GBA ports
  *
  * This file expects the following to be defined before inclusion:
  * - SCREEN_WIDTH, SCREEN_HEIGHT
- * - FIX_SCREEN_CENTER, FIX_PROJ_CONST
- * - screen[][], spritesheet[][], map_memory[], palette_map[]
+ * - FIX_SCREEN_CENTER (or FIX_SCREEN_CENTER_X/_Y), FIX_PROJ_CONST
+ * - Pico8 machine state, pico8_init()
+ * - spritesheet[][], map_memory[]
  * - cls(), pset(), pget(), sget(), line(), rectfill(), circfill()
  * - spr(), pal(), pal_reset(), clip_set(), clip_reset(), color()
- * - btn(), btnp(), dget(), dset(), sfx()
- * - rnd_state, cart_data_dirty
+ * - load_cart_data(), save_cart_data()
  * - PSET_FAST(), SGET_FAST() macros
- * - libfixmath functions
+ * - scalar_t and its operations (hyperspace_math.h, included by
+ *   hyperspace_target.h): Q16.16 fixed point, or float with MATH_FLOAT
+ *
+ * pico8_api.h provides everything above except the screen constants, which
+ * hyperspace_target.h derives from the target's traits, and the cart data
+ * functions.
+ *
+ * All mutable game state lives in a GameContext that every update and draw
+ * function takes, so one process can run many independent games. Meshes,
+ * textures and the sprite/map data are shared and read-only after
+ * load_embedded_data().
+ * Frame phases, OPCOUNT_BUILD counters, RANGE_BUILD value sites,
+ * PROFILE_BUILD timers, TRACE_BUILD events and OVERDRAW_BUILD fill counters
+ * come from hyperspace_phases.h, hyperspace_opcount.h, hyperspace_range.h,
+ * hyperspace_profiler.h, hyperspace_trace.h and hyperspace_overdraw.h.
+ *
+ * Platform backends: a port can replace the hot paths by defining these
+ * before inclusion and the platform_* functions after it (gba/gba_backend.h
+ * does all of them):
+ * - PLATFORM_RASTER_SPAN: platform_raster_span() draws each scanline span
+ * - PLATFORM_RASTER_DIV: platform_raster_div() for the rasterizer's
+ *   divisions; drawing only, so it may be approximate
+ * - PLATFORM_MAT_MUL_POS: platform_mat_mul_pos() for the vertex transform.
+ *   Auto-aim works on projected positions, so it must give the same result
+ *   as mat_mul_pos() bit for bit
+ * - PLATFORM_OBJ: platform_obj() and platform_obj_life_bar() show the
+ *   screen-space sprites (stars, sun, lens flare, aim, life bar) as
+ *   hardware sprites instead of drawing them; background layers must go
+ *   behind the 3D scene, showing where screen index 0 is left
+ *   (PICO8_DRAWN_BLACK in pico8_api.h keeps drawn black off it)
+ * - PLATFORM_SFX, PLATFORM_CLS (pico8_api.h): sound and screen clear
+ * - GAME_HOT: placement attribute for the transform and rasterizer (fast RAM)
+ * - GAME_SIM, GAME_DRAW: placement attributes for code that only runs
+ *   inside game_update() and game_draw(). Each entry point first calls
+ *   GAME_OVERLAY(GAME_OVERLAY_SIM or GAME_OVERLAY_DRAW), so the two sets
+ *   can share one window of fast RAM, loaded by the platform
+ * Presentation stays in the platform's own frame loop.
  */
 
 #ifndef HYPERSPACE_GAME_H
 #define HYPERSPACE_GAME_H
 
+#include "hyperspace_opcount.h"
+#include "hyperspace_range.h"
+#include "hyperspace_profiler.h"
+#include "hyperspace_trace.h"
+#include "hyperspace_overdraw.h"
+
+// Loader diagnostics; embedders define GAME_LOG(...) empty to silence them
+#ifndef GAME_LOG
+#define GAME_LOG(...) printf(__VA_ARGS__)
+#endif
+
+#ifndef GAME_HOT
+#define GAME_HOT
+#endif
+
+// Code overlays; the helpers both phases call (vectors, matrices, random
+// numbers, pico8_api.h) stay outside them
+enum { GAME_OVERLAY_SIM, GAME_OVERLAY_DRAW };
+#ifndef GAME_SIM
+#define GAME_SIM
+#endif
+#ifndef GAME_DRAW
+#define GAME_DRAW
+#endif
+#ifndef GAME_OVERLAY
+#define GAME_OVERLAY(overlay) ((void)0)
+#endif
+
+// Square screens use one center for both axes
+#ifndef FIX_SCREEN_CENTER_X
+#define FIX_SCREEN_CENTER_X FIX_SCREEN_CENTER
+#define FIX_SCREEN_CENTER_Y FIX_SCREEN_CENTER
+#endif
+
+// Title screen strings; the start prompt is centered on the screen
+#ifndef GAME_PORT_CREDIT
+#define GAME_PORT_CREDIT "PicoSystem Port by itsmeterada"
+#endif
+#ifndef GAME_START_PROMPT
+#define GAME_START_PROMPT "PRESS X TO START"
+#endif
+#define GAME_START_PROMPT_X ((SCREEN_WIDTH - 4 * (int)(sizeof(GAME_START_PROMPT) - 1)) / 2 + 2)
+
+// ============================================================================
+// Game Data Types
+// ============================================================================
+
+typedef struct {
+    scalar_t x, y, z;
+} Vec3;
+
+typedef struct {
+    scalar_t m[12];  // 3x4 matrix
+} Mat34;
+
+typedef struct {
+    Vec3 pos;
+    int tri[3];
+    scalar_t uv[3][2];
+    Vec3 normal;
+    scalar_t z;  // for sorting
+} Triangle;
+
+typedef struct {
+    Vec3* vertices;
+    Triangle* triangles;
+    int num_vertices;
+    int num_triangles;
+} Mesh;
+
+typedef struct {
+    int x, y;
+    int light_x;
+} Texture;
+
+typedef struct {
+    Vec3 pos0, pos1;
+    Vec3 proj0, proj1;
+    Vec3 spd;
+} Laser;
+
+typedef struct {
+    Vec3 pos0, pos1;
+    Vec3 proj0, proj1;
+    scalar_t spd;
+    int col;
+} Trail;
+
+typedef struct {
+    Vec3 pos;
+    scalar_t spd;
+    int index;
+    Vec3 proj;
+} Background;
+
+typedef struct {
+    Vec3 pos;
+    int type;
+    Vec3* proj;
+    int life;
+    Vec3 light_dir;
+    int hit_t;
+    Vec3 hit_pos;
+    scalar_t rot_x, rot_y;
+    scalar_t rot_x_spd, rot_y_spd;
+    Vec3 spd;
+    Vec3 waypoint;
+    scalar_t laser_t;
+    scalar_t stop_laser_t;
+    scalar_t next_laser_t;
+    scalar_t laser_offset_x[2];
+    scalar_t laser_offset_y[2];
+} Enemy;
+
+// ============================================================================
+// Shared Assets
+// ============================================================================
+
+// Decoded once by load_embedded_data() and read-only afterwards, so all
+// game contexts share them.
+
+// Ship mesh
+static Mesh ship_mesh;
+static Texture ship_tex, ship_tex_laser_lit;
+
+// Enemy meshes (4 types)
+static Mesh nme_meshes[4];
+static Texture nme_tex[4];
+static Texture nme_tex_hit;
+
+static scalar_t nme_scale[4] = {SC(1.0), SC(2.5), SC(3.0), SC(5.0)};
+static int nme_life[4] = {1, 3, 10, 80};
+static int nme_score[4] = {1, 10, 10, 100};
+static scalar_t nme_radius[4] = {SC(3.25), SC(6.0), SC(8.0), SC(16.0)};
+static scalar_t nme_bounds[3] = {SC(-50.0), SC(-50.0), SC(-100.0)};
+static scalar_t nme_rot[3] = {SC(0.18), SC(0.24), SC(0.06)};
+static scalar_t nme_spd[3] = {SC(1.0), SC(0.5), SC(0.6)};
+
+#define MAX_TRAILS 32  // Reduced for PicoSystem memory
+#define MAX_BGS 32  // Reduced for PicoSystem memory
+#define MAX_LASERS 50  // Reduced for PicoSystem memory
+#define MAX_ENEMIES 25  // Reduced for PicoSystem memory
+
+static int trail_color[5] = {7, 7, 6, 13, 1};
+static int bg_color[3] = {12, 13, 6};
+
+// Palette animation (engine glow effect)
+// PICO-8 original: ngn_colors = {13,12,7,12}
+static int ngn_colors[4] = {13, 12, 7, 12};  // indigo, blue, white, blue
+// PICO-8 original: laser_ngn_colors = {3,11,7,11}
+static int laser_ngn_colors[4] = {3, 11, 7, 11};  // dark green, green, white, green
+
+// Explosion colors
+static int explosion_color[4] = {9, 10, 15, 7};
+
+// mem_pos for decoding
+static int mem_pos = 0;
+
+// ============================================================================
+// Game State
+// ============================================================================
+
+// Everything one game instance mutates. All update and draw functions take
+// the context, so any number of games can run side by side (one per thread).
+// Scalars come first: Thumb-1 loads only reach 124 bytes past a base register.
+typedef struct GameContext {
+    // Game state
+    int cur_mode;
+    int life;
+    int score;
+    int best_score;
+    scalar_t global_t;
+    scalar_t game_spd;
+    int hit_t;
+    scalar_t barrel_cur_t;
+    int barrel_dir;
+    bool laser_on;
+    bool laser_spawned;
+    bool waiting_nme_clear;
+    bool spawn_asteroids;
+    scalar_t aim_z;
+    Vec3* tgt_pos;
+    scalar_t aim_life_ratio;
+    scalar_t cur_thrust;
+    scalar_t fade_ratio;
+    int manual_fire;
+    int non_inverted_y;
+    int sound_enabled;
+    scalar_t cur_laser_t;
+    int cur_laser_side;
+    scalar_t cur_nme_t;
+    scalar_t asteroid_mul_t;
+    int cur_sequencer_x;
+    int cur_sequencer_y;
+    scalar_t next_sequencer_t;
+
+    // Rendering
+    Texture* cur_tex;
+    Vec3* t_light_dir;
+    scalar_t ngn_col_idx;
+    scalar_t ngn_laser_col_idx;
+    int flare_offset;
+    uint32_t fx_rnd_state;  // effects RNG, only advanced by drawing
+
+    // Camera
+    scalar_t cam_x, cam_y;
+    scalar_t cam_angle_z;
+    scalar_t cam_angle_x;
+    scalar_t cam_depth;
+
+    // Ship state
+    scalar_t ship_x, ship_y;
+    scalar_t ship_spd_x, ship_spd_y;
+    scalar_t roll_angle, roll_spd;
+    scalar_t pitch_angle, pitch_spd;
+    scalar_t roll_f, pitch_f;
+    scalar_t cur_noise_t, tgt_noise_t;
+    scalar_t cur_noise_roll, old_noise_roll;
+    scalar_t cur_noise_pitch, old_noise_pitch;
+
+    // For camera interpolation
+    scalar_t src_cam_angle_z, src_cam_angle_x;
+    scalar_t src_cam_x, src_cam_y;
+    scalar_t dst_cam_angle_z, dst_cam_angle_x;
+    scalar_t dst_cam_x, dst_cam_y;
+    scalar_t interpolation_ratio, interpolation_spd;
+
+    int num_lasers;
+    int num_nme_lasers;
+    int num_enemies;
+    int nb_nme_ship;
+
+    Vec3 hit_pos;
+    Vec3 aim_proj;
+    Vec3 interp_tgt_pos;
+    Vec3 star_proj;
+
+    // Light
+    Vec3 light_dir, ship_light_dir;
+    Mat34 light_mat;
+
+    Mat34 cam_mat;
+    Mat34 ship_mat, inv_ship_mat, ship_pos_mat;
+
+    // Ship triangles are depth sorted in place every frame, so each
+    // context gets its own copy along with the projected vertices
+    Triangle* ship_tris;
+    Vec3* ship_proj;
+
+    Trail trails[MAX_TRAILS];
+    Background bgs[MAX_BGS];
+    Laser lasers[MAX_LASERS];
+    Laser nme_lasers[MAX_LASERS];
+    Enemy enemies[MAX_ENEMIES];
+
+    // PICO-8 machine: framebuffer, palette, RNG, buttons, cart data
+    Pico8 p8;
+} GameContext;
+
 // PICO-8 compatible 3x5 font
 static const uint8_t font_data[96][5] = {
     {0x0,0x0,0x0,0x0,0x0}, // space
@@ -117,65 +412,98 @@ static const uint8_t font_data[96][5] = {
     {0x0,0x0,0x0,0x0,0x0}, // DEL
 };
 
-static void print_char(char c, int x, int y, int col) {
+// A font row's 3 bits (leftmost 0x4) as the bytes of a word
+static const uint32_t font_row_mask[8] = {
+    0x000000, 0xFF0000, 0x00FF00, 0xFFFF00, 0x0000FF, 0xFF00FF, 0x00FFFF, 0xFFFFFF,
+};
+
+// print_char() a pixel at a time; the reference for the word writes
+static void print_char_bytes(GameContext* ctx, char c, int x, int y, int col) {
     if (c < 32 || c > 127) return;
     int idx = c - 32;
     for (int row = 0; row < 5; row++) {
         uint8_t bits = font_data[idx][row];
         for (int col_idx = 0; col_idx < 3; col_idx++) {
             if (bits & (0x4 >> col_idx)) {
-                pset(x + col_idx, y + row, col);
+                pset(&ctx->p8, x + col_idx, y + row, col);
             }
         }
     }
 }
 
-static void print_str(const char* str, int x, int y, int col) {
+static void print_char(GameContext* ctx, char c, int x, int y, int col) {
+    OPC_FUNC();
+#ifdef PICO8_BYTE_WRITES
+    print_char_bytes(ctx, c, x, y, col);
+#else
+    if (c < 32 || c > 127) return;
+    Pico8* p8 = &ctx->p8;
+    int cx1, cy1, cx2, cy2;
+    pico8_clip_bounds(p8, &cx1, &cy1, &cx2, &cy2);
+    uint32_t clip = pico8_range_mask(x, cx1, cx2);
+    if (!clip) return;
+
+    uint32_t pixels = p8->palette_map[col & 15] * 0x01010101u;
+    const uint8_t* rows = font_data[c - 32];
+    for (int row = 0; row < 5; row++) {
+        if (y + row < cy1 || y + row > cy2) continue;
+        uint32_t mask = font_row_mask[rows[row] & 7] & clip;
+        if (mask) pico8_put_word(p8, x, y + row, pixels, mask);
+    }
+#endif
+}
+
+static void print_str(GameContext* ctx, const char* str, int x, int y, int col) {
     int cx = x;
     while (*str) {
         if (*str == '\n') {
             y += 6;
             cx = x;
         } else {
-            print_char(*str, cx, y, col);
+            print_char(ctx, *str, cx, y, col);
             cx += 4;
         }
         str++;
     }
 }
 
-// Fixed-point random function: returns value in [0, max)
-static fix16_t rnd_fix(fix16_t max) {
-    rnd_state = rnd_state * 1103515245 + 12345;
+// Random step: returns value in [0, max)
+static scalar_t rnd_step(uint32_t* state, scalar_t max) {
+    OPC_FUNC();
+    *state = *state * 1103515245 + 12345;
+    OPC_COUNT(OPC_MUL);  // 64-bit multiply below
     // Use upper 16 bits for better randomness, treat as 0.0 to 1.0 fraction
-    uint16_t frac = (rnd_state >> 16) & 0xFFFF;
-    // frac/65536 * max = (frac * max) >> 16
-    // But max is already in 16.16 format, so we need to be careful
-    // Result = max * (frac / 65536) = (max * frac) >> 16
-    int64_t result = ((int64_t)max * frac) >> 16;
-    return (fix16_t)result;
-}
-
-static int flr_fix(fix16_t x) {
-    // floor: round towards negative infinity
-    if (x >= 0) {
-        return x >> 16;
-    } else {
-        // For negative numbers, we need proper floor behavior
-        return (x >> 16) - ((x & 0xFFFF) ? 1 : 0);
-    }
+    uint16_t frac = (*state >> 16) & 0xFFFF;
+    // Result = max * (frac / 65536), the same sequence in either backend
+    return sc_mul_frac16(max, frac);
+}
+
+// Game RNG: everything game_update() depends on
+static scalar_t rnd_fix(GameContext* ctx, scalar_t max) {
+    return rnd_step(&ctx->p8.rnd_state, max);
 }
 
-static fix16_t mid_fix(fix16_t a, fix16_t b, fix16_t c) {
-    if (a > b) { fix16_t t = a; a = b; b = t; }
+// Effects RNG for flicker and explosions. Kept separate so skipping
+// game_draw() on some frames leaves the game itself unchanged.
+static scalar_t rnd_fx(GameContext* ctx, scalar_t max) {
+    return rnd_step(&ctx->fx_rnd_state, max);
+}
+
+// PICO-8's flr(); only ever called with x >= 0
+static int flr_fix(scalar_t x) {
+    return sc_to_int(x);
+}
+
+static scalar_t mid_fix(scalar_t a, scalar_t b, scalar_t c) {
+    if (a > b) { scalar_t t = a; a = b; b = t; }
     if (b > c) { b = c; }
     if (a > b) { b = a; }
     return b;
 }
 
-static fix16_t sgn_fix(fix16_t x) {
-    if (x > 0) return fix16_one;
-    if (x < 0) return -fix16_one;
+static scalar_t sgn_fix(scalar_t x) {
+    if (x > 0) return SC_ONE;
+    if (x < 0) return -SC_ONE;
     return 0;
 }
 
@@ -186,256 +514,66 @@ static uint8_t peek(int addr) {
     return 0;
 }
 
-static bool btn(int n) {
-    return btn_state[n];
+static bool btn(GameContext* ctx, int n) {
+    return ctx->p8.btn_state[n];
 }
 
-static bool btnp(int n) {
-    return btn_state[n] && !btn_prev[n];
+static bool btnp(GameContext* ctx, int n) {
+    Pico8* p8 = &ctx->p8;
+    return p8->btn_state[n] && !p8->btn_prev[n];
 }
 
-static int32_t dget(int n) {
-    if (n >= 0 && n < 64) return cart_data[n];
+static int32_t dget(GameContext* ctx, int n) {
+    if (n >= 0 && n < 64) return ctx->p8.cart_data[n];
     return 0;
 }
 
-static void dset(int n, int32_t v) {
+static void dset(GameContext* ctx, int n, int32_t v) {
+    Pico8* p8 = &ctx->p8;
     if (n >= 0 && n < 64) {
-        if (cart_data[n] != v) {
-            cart_data[n] = v;
-            cart_data_dirty = true;
+        if (p8->cart_data[n] != v) {
+            p8->cart_data[n] = v;
+            p8->cart_data_dirty = true;
         }
     }
 }
 
-// Sound enable flag (must be declared before sfx())
-static int sound_enabled = 1;  // Sound on by default
-
 // Platform-specific sfx implementation
 // Define PLATFORM_SFX before including this header to use custom implementation
 #ifdef PLATFORM_SFX
 extern void platform_sfx(int n, int channel);
-static void sfx(int n, int channel) {
-    if (!sound_enabled) return;
+static void sfx(GameContext* ctx, int n, int channel) {
+    if (!ctx->sound_enabled) return;
     platform_sfx(n, channel);
 }
 #else
-static void sfx(int n, int channel) {
+static void sfx(GameContext* ctx, int n, int channel) {
     // Sound effects not implemented on this platform
+    (void)ctx;
     (void)n;
     (void)channel;
 }
 #endif
 
-static fix16_t sym_random_fix(fix16_t f) {
-    return f - rnd_fix(fix16_mul(f, FIX_TWO));
+static scalar_t sym_random_fix(GameContext* ctx, scalar_t f) {
+    OPC_FUNC();
+    return f - rnd_fix(ctx, sc_mul(f, FIX_TWO));
 }
 
-static int get_random_idx(int max) {
-    return flr_fix(rnd_fix(fix16_from_int(max)));
+static int get_random_idx(GameContext* ctx, int max) {
+    return flr_fix(rnd_fix(ctx, sc_from_int(max)));
 }
 
-// ============================================================================
-// Game Data Types (Fixed-Point)
-// ============================================================================
-
-typedef struct {
-    fix16_t x, y, z;
-} Vec3;
-
-typedef struct {
-    fix16_t m[12];  // 3x4 matrix
-} Mat34;
-
-typedef struct {
-    Vec3 pos;
-    int tri[3];
-    fix16_t uv[3][2];
-    Vec3 normal;
-    fix16_t z;  // for sorting
-} Triangle;
-
-typedef struct {
-    Vec3* vertices;
-    Vec3* projected;
-    Triangle* triangles;
-    int num_vertices;
-    int num_triangles;
-} Mesh;
-
-typedef struct {
-    int x, y;
-    int light_x;
-} Texture;
-
-typedef struct {
-    Vec3 pos0, pos1;
-    Vec3 proj0, proj1;
-    Vec3 spd;
-} Laser;
-
-typedef struct {
-    Vec3 pos0, pos1;
-    Vec3 proj0, proj1;
-    fix16_t spd;
-    int col;
-} Trail;
-
-typedef struct {
-    Vec3 pos;
-    fix16_t spd;
-    int index;
-    Vec3 proj;
-} Background;
-
-typedef struct {
-    Vec3 pos;
-    int type;
-    Vec3* proj;
-    int life;
-    Vec3 light_dir;
-    int hit_t;
-    Vec3 hit_pos;
-    fix16_t rot_x, rot_y;
-    fix16_t rot_x_spd, rot_y_spd;
-    Vec3 spd;
-    Vec3 waypoint;
-    fix16_t laser_t;
-    fix16_t stop_laser_t;
-    fix16_t next_laser_t;
-    fix16_t laser_offset_x[2];
-    fix16_t laser_offset_y[2];
-} Enemy;
-
-// ============================================================================
-// Game State
-// ============================================================================
-
-// Ship mesh
-static Mesh ship_mesh;
-static Texture ship_tex, ship_tex_laser_lit;
-
-// Enemy meshes (4 types)
-static Mesh nme_meshes[4];
-static Texture nme_tex[4];
-static Texture nme_tex_hit;
-
-static fix16_t nme_scale[4] = {F16(1.0), F16(2.5), F16(3.0), F16(5.0)};
-static int nme_life[4] = {1, 3, 10, 80};
-static int nme_score[4] = {1, 10, 10, 100};
-static fix16_t nme_radius[4] = {F16(3.25), F16(6.0), F16(8.0), F16(16.0)};
-static fix16_t nme_bounds[3] = {F16(-50.0), F16(-50.0), F16(-100.0)};
-static fix16_t nme_rot[3] = {F16(0.18), F16(0.24), F16(0.06)};
-static fix16_t nme_spd[3] = {F16(1.0), F16(0.5), F16(0.6)};
-
-// Trails
-#define MAX_TRAILS 32  // Reduced for PicoSystem memory
-static Trail trails[MAX_TRAILS];
-static int trail_color[5] = {7, 7, 6, 13, 1};
-
-// Backgrounds
-#define MAX_BGS 32  // Reduced for PicoSystem memory
-static Background bgs[MAX_BGS];
-static int bg_color[3] = {12, 13, 6};
-
-// Lasers
-#define MAX_LASERS 50  // Reduced for PicoSystem memory
-static Laser lasers[MAX_LASERS];
-static int num_lasers = 0;
-static Laser nme_lasers[MAX_LASERS];
-static int num_nme_lasers = 0;
-
-// Enemies
-#define MAX_ENEMIES 25  // Reduced for PicoSystem memory
-static Enemy enemies[MAX_ENEMIES];
-static int num_enemies = 0;
-static int nb_nme_ship = 0;
-
-// Camera
-static Mat34 cam_mat;
-static fix16_t cam_x = 0, cam_y = 0;
-static fix16_t cam_angle_z = F16(-0.4);
-static fix16_t cam_angle_x = 0;
-static fix16_t cam_depth = F16(22.5);
-
-// Ship state
-static Mat34 ship_mat, inv_ship_mat, ship_pos_mat;
-static fix16_t ship_x = 0, ship_y = 0;
-static fix16_t ship_spd_x = 0, ship_spd_y = 0;
-static fix16_t roll_angle = 0, roll_spd = 0;
-static fix16_t pitch_angle = 0, pitch_spd = 0;
-static fix16_t roll_f = 0, pitch_f = 0;
-static fix16_t cur_noise_t = 0, tgt_noise_t = 0;
-static fix16_t cur_noise_roll = 0, old_noise_roll = 0;
-static fix16_t cur_noise_pitch = 0, old_noise_pitch = 0;
-
-// Light
-static Mat34 light_mat;
-static Vec3 light_dir, ship_light_dir;
-
-// Game state
-static int cur_mode = 0;
-static int life = 4;
-static int score = 0;
-static int best_score = 0;
-static fix16_t global_t = 0;
-static fix16_t game_spd = F16(1.0);
-static int hit_t = -1;
-static Vec3 hit_pos;
-static fix16_t barrel_cur_t = F16(-1.0);
-static int barrel_dir = 0;
-static bool laser_on = false;
-static bool laser_spawned = false;
-static fix16_t aim_z = F16(-200.0);
-static Vec3 aim_proj;
-static Vec3* tgt_pos = NULL;
-static Vec3 interp_tgt_pos;
-static fix16_t aim_life_ratio = F16(-1.0);
-static fix16_t cur_thrust = 0;
-static fix16_t fade_ratio = F16(-1.0);
-static int manual_fire = 1;  // Default to MANUAL mode (AUTO off)
-static int non_inverted_y = 0;
-static fix16_t cur_laser_t = 0;
-static int cur_laser_side = -1;
-static fix16_t cur_nme_t = 0;
-static fix16_t asteroid_mul_t = F16(1.0);
-static int cur_sequencer_x = 96;
-static int cur_sequencer_y = 96;
-static fix16_t next_sequencer_t = 0;
-static bool waiting_nme_clear = false;
-static bool spawn_asteroids = false;
-static Vec3 star_proj;
-
-// For camera interpolation
-static fix16_t src_cam_angle_z, src_cam_angle_x;
-static fix16_t src_cam_x, src_cam_y;
-static fix16_t dst_cam_angle_z, dst_cam_angle_x;
-static fix16_t dst_cam_x, dst_cam_y;
-static fix16_t interpolation_ratio, interpolation_spd;
-
-// Current texture for rendering
-static Texture* cur_tex;
-static Vec3* t_light_dir;
-
-// Palette animation (engine glow effect)
-// PICO-8 original: ngn_colors = {13,12,7,12}
-static int ngn_colors[4] = {13, 12, 7, 12};  // indigo, blue, white, blue
-// PICO-8 original: laser_ngn_colors = {3,11,7,11}
-static int laser_ngn_colors[4] = {3, 11, 7, 11};  // dark green, green, white, green
-static fix16_t ngn_col_idx = 0;
-static fix16_t ngn_laser_col_idx = 0;
-
-// Flare
-static int flare_offset = 0;
-
-// Explosion colors
-static int explosion_color[4] = {9, 10, 15, 7};
+static scalar_t sym_random_fx(GameContext* ctx, scalar_t f) {
+    return f - rnd_fx(ctx, sc_mul(f, FIX_TWO));
+}
 
-// mem_pos for decoding
-static int mem_pos = 0;
+static int get_random_idx_fx(GameContext* ctx, int max) {
+    return flr_fix(rnd_fx(ctx, sc_from_int(max)));
+}
 
 // ============================================================================
-// Fixed-Point Math Functions
+// Vector and Matrix Math
 // ============================================================================
 
 static void vec3_copy(Vec3* dst, const Vec3* src) {
@@ -444,16 +582,17 @@ static void vec3_copy(Vec3* dst, const Vec3* src) {
     dst->z = src->z;
 }
 
-static void vec3_set(Vec3* v, fix16_t x, fix16_t y, fix16_t z) {
+static void vec3_set(Vec3* v, scalar_t x, scalar_t y, scalar_t z) {
     v->x = x;
     v->y = y;
     v->z = z;
 }
 
-static void vec3_mul(Vec3* v, fix16_t f) {
-    v->x = fix16_mul(v->x, f);
-    v->y = fix16_mul(v->y, f);
-    v->z = fix16_mul(v->z, f);
+static void vec3_mul(Vec3* v, scalar_t f) {
+    OPC_FUNC();
+    v->x = sc_mul(v->x, f);
+    v->y = sc_mul(v->y, f);
+    v->z = sc_mul(v->z, f);
 }
 
 static Vec3 vec3_minus(const Vec3* v0, const Vec3* v1) {
@@ -461,86 +600,96 @@ static Vec3 vec3_minus(const Vec3* v0, const Vec3* v1) {
     return res;
 }
 
-static fix16_t vec3_dot(const Vec3* v0, const Vec3* v1) {
-    return fix16_mul(v0->x, v1->x) + fix16_mul(v0->y, v1->y) + fix16_mul(v0->z, v1->z);
+static scalar_t vec3_dot(const Vec3* v0, const Vec3* v1) {
+    OPC_FUNC();
+    return sc_mul(v0->x, v1->x) + sc_mul(v0->y, v1->y) + sc_mul(v0->z, v1->z);
 }
 
-static fix16_t vec3_length(const Vec3* v) {
-    return fix16_sqrt(vec3_dot(v, v));
+static scalar_t vec3_length(const Vec3* v) {
+    OPC_FUNC();
+    return sc_sqrt(vec3_dot(v, v));
 }
 
 static void vec3_normalize(Vec3* v) {
-    vec3_mul(v, F16(0.1));
-    fix16_t len = vec3_length(v);
+    OPC_FUNC();
+    vec3_mul(v, SC(0.1));
+    scalar_t len = vec3_length(v);
     if (len > 0) {
-        fix16_t invl = fix16_div(fix16_one, len);
+        scalar_t invl = sc_div(SC_ONE, len);
         vec3_mul(v, invl);
     }
 }
 
-static void mat_rotx(Mat34* m, fix16_t a) {
-    fix16_t angle = fix16_mul(a, FIX_TWO_PI);
-    fix16_t cos_a = fix16_cos(angle);
-    fix16_t sin_a = fix16_sin(angle);
+static void mat_rotx(Mat34* m, scalar_t a) {
+    OPC_FUNC();
+    scalar_t angle = sc_mul(a, FIX_TWO_PI);
+    scalar_t cos_a = sc_cos(angle);
+    scalar_t sin_a = sc_sin(angle);
     // PICO-8's sin is negative of standard sin, so we negate sin_a
-    m->m[0] = fix16_one; m->m[1] = 0; m->m[2] = 0; m->m[3] = 0;
+    m->m[0] = SC_ONE; m->m[1] = 0; m->m[2] = 0; m->m[3] = 0;
     m->m[4] = 0; m->m[5] = cos_a; m->m[6] = -sin_a; m->m[7] = 0;
     m->m[8] = 0; m->m[9] = sin_a; m->m[10] = cos_a; m->m[11] = 0;
 }
 
-static void mat_roty(Mat34* m, fix16_t a) {
-    fix16_t angle = fix16_mul(a, FIX_TWO_PI);
-    fix16_t cos_a = fix16_cos(angle);
-    fix16_t sin_a = fix16_sin(angle);
+static void mat_roty(Mat34* m, scalar_t a) {
+    OPC_FUNC();
+    scalar_t angle = sc_mul(a, FIX_TWO_PI);
+    scalar_t cos_a = sc_cos(angle);
+    scalar_t sin_a = sc_sin(angle);
     // PICO-8's sin is negative of standard sin, so we negate sin_a
     m->m[0] = cos_a; m->m[1] = 0; m->m[2] = -sin_a; m->m[3] = 0;
-    m->m[4] = 0; m->m[5] = fix16_one; m->m[6] = 0; m->m[7] = 0;
+    m->m[4] = 0; m->m[5] = SC_ONE; m->m[6] = 0; m->m[7] = 0;
     m->m[8] = sin_a; m->m[9] = 0; m->m[10] = cos_a; m->m[11] = 0;
 }
 
-static void mat_rotz(Mat34* m, fix16_t a) {
-    fix16_t angle = fix16_mul(a, FIX_TWO_PI);
-    fix16_t cos_a = fix16_cos(angle);
-    fix16_t sin_a = fix16_sin(angle);
+static void mat_rotz(Mat34* m, scalar_t a) {
+    OPC_FUNC();
+    scalar_t angle = sc_mul(a, FIX_TWO_PI);
+    scalar_t cos_a = sc_cos(angle);
+    scalar_t sin_a = sc_sin(angle);
     // PICO-8's sin is negative of standard sin, so we negate sin_a
     m->m[0] = cos_a; m->m[1] = -sin_a; m->m[2] = 0; m->m[3] = 0;
     m->m[4] = sin_a; m->m[5] = cos_a; m->m[6] = 0; m->m[7] = 0;
-    m->m[8] = 0; m->m[9] = 0; m->m[10] = fix16_one; m->m[11] = 0;
+    m->m[8] = 0; m->m[9] = 0; m->m[10] = SC_ONE; m->m[11] = 0;
 }
 
-static void mat_translation(Mat34* m, fix16_t x, fix16_t y, fix16_t z) {
-    m->m[0] = fix16_one; m->m[1] = 0; m->m[2] = 0; m->m[3] = x;
-    m->m[4] = 0; m->m[5] = fix16_one; m->m[6] = 0; m->m[7] = y;
-    m->m[8] = 0; m->m[9] = 0; m->m[10] = fix16_one; m->m[11] = z;
+static void mat_translation(Mat34* m, scalar_t x, scalar_t y, scalar_t z) {
+    m->m[0] = SC_ONE; m->m[1] = 0; m->m[2] = 0; m->m[3] = x;
+    m->m[4] = 0; m->m[5] = SC_ONE; m->m[6] = 0; m->m[7] = y;
+    m->m[8] = 0; m->m[9] = 0; m->m[10] = SC_ONE; m->m[11] = z;
 }
 
 static void mat_mul(Mat34* res, const Mat34* m0, const Mat34* m1) {
-    fix16_t r[12];
-    r[0] = fix16_mul(m0->m[0], m1->m[0]) + fix16_mul(m0->m[1], m1->m[4]) + fix16_mul(m0->m[2], m1->m[8]);
-    r[1] = fix16_mul(m0->m[0], m1->m[1]) + fix16_mul(m0->m[1], m1->m[5]) + fix16_mul(m0->m[2], m1->m[9]);
-    r[2] = fix16_mul(m0->m[0], m1->m[2]) + fix16_mul(m0->m[1], m1->m[6]) + fix16_mul(m0->m[2], m1->m[10]);
-    r[3] = fix16_mul(m0->m[0], m1->m[3]) + fix16_mul(m0->m[1], m1->m[7]) + fix16_mul(m0->m[2], m1->m[11]) + m0->m[3];
-
-    r[4] = fix16_mul(m0->m[4], m1->m[0]) + fix16_mul(m0->m[5], m1->m[4]) + fix16_mul(m0->m[6], m1->m[8]);
-    r[5] = fix16_mul(m0->m[4], m1->m[1]) + fix16_mul(m0->m[5], m1->m[5]) + fix16_mul(m0->m[6], m1->m[9]);
-    r[6] = fix16_mul(m0->m[4], m1->m[2]) + fix16_mul(m0->m[5], m1->m[6]) + fix16_mul(m0->m[6], m1->m[10]);
-    r[7] = fix16_mul(m0->m[4], m1->m[3]) + fix16_mul(m0->m[5], m1->m[7]) + fix16_mul(m0->m[6], m1->m[11]) + m0->m[7];
-
-    r[8] = fix16_mul(m0->m[8], m1->m[0]) + fix16_mul(m0->m[9], m1->m[4]) + fix16_mul(m0->m[10], m1->m[8]);
-    r[9] = fix16_mul(m0->m[8], m1->m[1]) + fix16_mul(m0->m[9], m1->m[5]) + fix16_mul(m0->m[10], m1->m[9]);
-    r[10] = fix16_mul(m0->m[8], m1->m[2]) + fix16_mul(m0->m[9], m1->m[6]) + fix16_mul(m0->m[10], m1->m[10]);
-    r[11] = fix16_mul(m0->m[8], m1->m[3]) + fix16_mul(m0->m[9], m1->m[7]) + fix16_mul(m0->m[10], m1->m[11]) + m0->m[11];
-
+    OPC_FUNC();
+    scalar_t r[12];
+    r[0] = sc_mul(m0->m[0], m1->m[0]) + sc_mul(m0->m[1], m1->m[4]) + sc_mul(m0->m[2], m1->m[8]);
+    r[1] = sc_mul(m0->m[0], m1->m[1]) + sc_mul(m0->m[1], m1->m[5]) + sc_mul(m0->m[2], m1->m[9]);
+    r[2] = sc_mul(m0->m[0], m1->m[2]) + sc_mul(m0->m[1], m1->m[6]) + sc_mul(m0->m[2], m1->m[10]);
+    r[3] = sc_mul(m0->m[0], m1->m[3]) + sc_mul(m0->m[1], m1->m[7]) + sc_mul(m0->m[2], m1->m[11]) + m0->m[3];
+
+    r[4] = sc_mul(m0->m[4], m1->m[0]) + sc_mul(m0->m[5], m1->m[4]) + sc_mul(m0->m[6], m1->m[8]);
+    r[5] = sc_mul(m0->m[4], m1->m[1]) + sc_mul(m0->m[5], m1->m[5]) + sc_mul(m0->m[6], m1->m[9]);
+    r[6] = sc_mul(m0->m[4], m1->m[2]) + sc_mul(m0->m[5], m1->m[6]) + sc_mul(m0->m[6], m1->m[10]);
+    r[7] = sc_mul(m0->m[4], m1->m[3]) + sc_mul(m0->m[5], m1->m[7]) + sc_mul(m0->m[6], m1->m[11]) + m0->m[7];
+
+    r[8] = sc_mul(m0->m[8], m1->m[0]) + sc_mul(m0->m[9], m1->m[4]) + sc_mul(m0->m[10], m1->m[8]);
+    r[9] = sc_mul(m0->m[8], m1->m[1]) + sc_mul(m0->m[9], m1->m[5]) + sc_mul(m0->m[10], m1->m[9]);
+    r[10] = sc_mul(m0->m[8], m1->m[2]) + sc_mul(m0->m[9], m1->m[6]) + sc_mul(m0->m[10], m1->m[10]);
+    r[11] = sc_mul(m0->m[8], m1->m[3]) + sc_mul(m0->m[9], m1->m[7]) + sc_mul(m0->m[10], m1->m[11]) + m0->m[11];
+
+    OPC_BYTES(sizeof(r));
     memcpy(res->m, r, sizeof(r));
 }
 
 static void mat_mul_vec(Vec3* res, const Mat34* m, const Vec3* v) {
-    res->x = fix16_mul(v->x, m->m[0]) + fix16_mul(v->y, m->m[1]) + fix16_mul(v->z, m->m[2]);
-    res->y = fix16_mul(v->x, m->m[4]) + fix16_mul(v->y, m->m[5]) + fix16_mul(v->z, m->m[6]);
-    res->z = fix16_mul(v->x, m->m[8]) + fix16_mul(v->y, m->m[9]) + fix16_mul(v->z, m->m[10]);
+    OPC_FUNC();
+    res->x = sc_mul(v->x, m->m[0]) + sc_mul(v->y, m->m[1]) + sc_mul(v->z, m->m[2]);
+    res->y = sc_mul(v->x, m->m[4]) + sc_mul(v->y, m->m[5]) + sc_mul(v->z, m->m[6]);
+    res->z = sc_mul(v->x, m->m[8]) + sc_mul(v->y, m->m[9]) + sc_mul(v->z, m->m[10]);
 }
 
 static void mat_mul_pos(Vec3* res, const Mat34* m, const Vec3* v) {
+    OPC_FUNC();
     mat_mul_vec(res, m, v);
     res->x += m->m[3];
     res->y += m->m[7];
@@ -562,18 +711,20 @@ static void mat_transpose_rot(Mat34* res, const Mat34* m) {
     res->m[11] = m->m[11];
 }
 
-static fix16_t normalize_angle(fix16_t a) {
-    a = fix16_mod(a, fix16_one);
-    if (a > FIX_HALF) a -= fix16_one;
-    if (a < -FIX_HALF) a += fix16_one;
+static scalar_t normalize_angle(scalar_t a) {
+    OPC_FUNC();
+    a = sc_mod(a, SC_ONE);
+    if (a > FIX_HALF) a -= SC_ONE;
+    if (a < -FIX_HALF) a += SC_ONE;
     return a;
 }
 
-static fix16_t smoothstep(fix16_t ratio) {
+static scalar_t smoothstep(scalar_t ratio) {
+    OPC_FUNC();
     // ratio * ratio * (3 - 2 * ratio)
-    fix16_t r2 = fix16_mul(ratio, ratio);
-    fix16_t three_minus_2r = F16(3.0) - fix16_mul(FIX_TWO, ratio);
-    return fix16_mul(r2, three_minus_2r);
+    scalar_t r2 = sc_mul(ratio, ratio);
+    scalar_t three_minus_2r = SC(3.0) - sc_mul(FIX_TWO, ratio);
+    return sc_mul(r2, three_minus_2r);
 }
 
 // ============================================================================
@@ -581,12 +732,12 @@ static fix16_t smoothstep(fix16_t ratio) {
 // ============================================================================
 
 // Read a raw byte from map memory and convert to signed value * 0.5
-static fix16_t decode_byte(void) {
+static scalar_t decode_byte(void) {
     int res = map_memory[mem_pos];
     mem_pos++;
     if (res >= 128) res = res - 256;  // Convert to signed (-128 to 127)
-    // Multiply by 0.5: shift right by 1 in fixed point, but we need the fractional part
-    return fix16_from_int(res) >> 1;  // Equivalent to * 0.5
+    // Multiply by 0.5, keeping the fractional part (exact in either backend)
+    return sc_from_int(res) / 2;
 }
 
 // Read a raw byte as integer (for counts and indices)
@@ -597,20 +748,20 @@ static int decode_byte_int(void) {
     return res / 2;  // The original decode_byte multiplies by 0.5, so divide by 2
 }
 
-static void decode_mesh(Mesh* mesh, fix16_t scale) {
+static void decode_mesh(Mesh* mesh, scalar_t scale) {
+    OPC_FUNC();
     int nb_vert = decode_byte_int();
     if (nb_vert < 0) nb_vert = 0;
     if (nb_vert > 256) nb_vert = 256;  // Sanity check
     mesh->num_vertices = nb_vert;
     mesh->vertices = (Vec3*)calloc(nb_vert > 0 ? nb_vert : 1, sizeof(Vec3));
-    mesh->projected = (Vec3*)calloc(nb_vert > 0 ? nb_vert : 1, sizeof(Vec3));
 
-    printf("Decoding mesh: %d vertices at mem_pos=%d\n", nb_vert, mem_pos);
+    GAME_LOG("Decoding mesh: %d vertices at mem_pos=%d\n", nb_vert, mem_pos);
 
     for (int i = 0; i < nb_vert; i++) {
-        mesh->vertices[i].x = fix16_mul(decode_byte(), scale);
-        mesh->vertices[i].y = fix16_mul(decode_byte(), scale);
-        mesh->vertices[i].z = fix16_mul(decode_byte(), scale);
+        mesh->vertices[i].x = RANGE_FIX("vertex", sc_mul(decode_byte(), scale));
+        mesh->vertices[i].y = RANGE_FIX("vertex", sc_mul(decode_byte(), scale));
+        mesh->vertices[i].z = RANGE_FIX("vertex", sc_mul(decode_byte(), scale));
     }
 
     int nb_tri = decode_byte_int();
@@ -619,24 +770,24 @@ static void decode_mesh(Mesh* mesh, fix16_t scale) {
     mesh->num_triangles = nb_tri;
     mesh->triangles = (Triangle*)calloc(nb_tri > 0 ? nb_tri : 1, sizeof(Triangle));
 
-    printf("Decoding mesh: %d triangles\n", nb_tri);
+    GAME_LOG("Decoding mesh: %d triangles\n", nb_tri);
 
     for (int i = 0; i < nb_tri; i++) {
         Triangle* tri = &mesh->triangles[i];
 
         // Vertex index (original is 1-based, convert to 0-based)
         tri->tri[0] = decode_byte_int() - 1;
-        tri->normal.x = fix16_div(decode_byte(), F16(63.5));
+        tri->normal.x = sc_div(decode_byte(), SC(63.5));
         tri->uv[0][0] = decode_byte();
         tri->uv[0][1] = decode_byte();
 
         tri->tri[1] = decode_byte_int() - 1;
-        tri->normal.y = fix16_div(decode_byte(), F16(63.5));
+        tri->normal.y = sc_div(decode_byte(), SC(63.5));
         tri->uv[1][0] = decode_byte();
         tri->uv[1][1] = decode_byte();
 
         tri->tri[2] = decode_byte_int() - 1;
-        tri->normal.z = fix16_div(decode_byte(), F16(63.5));
+        tri->normal.z = sc_div(decode_byte(), SC(63.5));
         tri->uv[2][0] = decode_byte();
         tri->uv[2][1] = decode_byte();
     }
@@ -646,17 +797,26 @@ static void decode_mesh(Mesh* mesh, fix16_t scale) {
 // Projection
 // ============================================================================
 
-static void transform_pos(Vec3* proj, const Mat34* mat, const Vec3* pos) {
+#ifdef PLATFORM_MAT_MUL_POS
+static void platform_mat_mul_pos(Vec3* res, const Mat34* m, const Vec3* v);
+#endif
+
+static GAME_HOT void transform_pos(Vec3* proj, const Mat34* mat, const Vec3* pos) {
+    OPC_FUNC();
+#ifdef PLATFORM_MAT_MUL_POS
+    platform_mat_mul_pos(proj, mat, pos);
+#else
     mat_mul_pos(proj, mat, pos);
+#endif
 
     // c = -80 / z (for 128px screen) or -75 / z (for 120px screen)
     // When z is negative (in front of camera), c will be positive
-    fix16_t c = fix16_div(FIX_PROJ_CONST, proj->z);
+    scalar_t c = RANGE_FIX("inv_z", sc_div(FIX_PROJ_CONST, RANGE_FIX("view_z", proj->z)));
 
-    proj->x = FIX_SCREEN_CENTER + fix16_mul(proj->x, c);
-    proj->y = FIX_SCREEN_CENTER - fix16_mul(proj->y, c);
+    proj->x = RANGE_FIX("screen_x", FIX_SCREEN_CENTER_X + sc_mul(proj->x, c));
+    proj->y = RANGE_FIX("screen_y", FIX_SCREEN_CENTER_Y - sc_mul(proj->y, c));
 
-    if (c > 0 && c <= F16(10.0)) {
+    if (c > 0 && c <= SC(10.0)) {
         proj->z = c;
     } else {
         proj->z = 0;
@@ -667,176 +827,400 @@ static void transform_pos(Vec3* proj, const Mat34* mat, const Vec3* pos) {
 // Rasterization (Simplified for PicoSystem)
 // ============================================================================
 
-static void rasterize_flat_tri(Vec3* v0, Vec3* v1, Vec3* v2,
-                                fix16_t* uv0, fix16_t* uv1, fix16_t* uv2, fix16_t light) {
-    fix16_t y0 = v0->y;
-    fix16_t y1 = v1->y;
+// Per-triangle constants shared by the spans of one flat half
+typedef struct {
+    scalar_t z0, z1, z2;                     // 1/z at the three vertices
+    scalar_t uv0x, uv0y, uv1x, uv1y, uv2x, uv2y;
+    scalar_t light;
+    int tex_x, tex_y, tex_lit_x;
+} RasterTri;
+
+// One scanline: pixel centers xfirst..xlast of row py, with the barycentric
+// weights of vertices 0 and 1 at xfirst and their step per pixel
+typedef struct {
+    int py;
+    scalar_t xfirst, xlast;
+    scalar_t b0, b1;
+    scalar_t db0_dx, db1_dx;
+} RasterSpan;
+
+#ifdef PLATFORM_RASTER_DIV
+static scalar_t platform_raster_div(scalar_t a, scalar_t b);
+#define raster_div(a, b) platform_raster_div((a), (b))
+#else
+#define raster_div(a, b) sc_div((a), (b))
+#endif
 
-    fix16_t firstline, lastline;
+typedef void (*RasterSpanFn)(GameContext* ctx, const RasterTri* t, const RasterSpan* s);
 
-    if (y0 < y1) {
-        firstline = fix16_floor(y0 + FIX_HALF) + FIX_HALF;
-        lastline = fix16_floor(y1 - FIX_HALF) + FIX_HALF;
-    } else if (y0 == y1) {
-        return;
-    } else {
-        firstline = fix16_floor(y1 + FIX_HALF) + FIX_HALF;
-        lastline = fix16_floor(y0 - FIX_HALF) + FIX_HALF;
+#ifdef PLATFORM_RASTER_SPAN
+static void platform_raster_span(GameContext* ctx, const RasterTri* t, const RasterSpan* s);
+#define raster_span_init() ((void)0)
+#define raster_span_select(ctx, t) platform_raster_span
+#else
+enum { RASTER_LIT, RASTER_UNLIT, RASTER_DITHER };
+
+// Light levels at or below which every dither threshold passes, and above
+// which none does; from the 8x8 dither block at sheet (0, 56)
+static scalar_t raster_all_lit, raster_none_lit;
+
+// When set, every span goes through this instead of the selected
+// specialization (rastbench compares against the generic loop)
+static RasterSpanFn raster_span_override;
+
+static const uint8_t raster_identity_pal[16] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15};
+
+// PSET_FAST() without the palette lookup
+#define RASTER_PSET_IDENTITY(p8, x, y, c) (OPC_COUNT(OPC_PIXEL), OVD_PIXEL_AT((x), (y)), (p8)->screen[(y)][(x)] = (c) & 15)
+
+// Texture lookup per pixel, lit or unlit texture by an ordered dither on
+// the light level. Perspective spans divide for the UV of every pixel;
+// affine ones step it linearly from xfirst, with no division and so no
+// degenerate sum to skip, and are only picked for halves whose 1/z hardly
+// varies. light_mode, affine, remap and words are constants in every
+// caller, so each specialization below is a loop without the tests it
+// doesn't need. With words, pixels are gathered into a 32-bit word and
+// stored when the span leaves its aligned group of 4.
+static inline __attribute__((always_inline)) void raster_span_body(GameContext* ctx, const RasterTri* t, const RasterSpan* s,
+                                                                   int light_mode, bool affine, bool remap, bool words) {
+    scalar_t b0_base = s->b0;
+    scalar_t b1_base = s->b1;
+    int py = s->py;
+    int dither_row = 56 + (py & 7);  // bitmask instead of modulo
+    int span_offset_x = light_mode == RASTER_LIT ? t->tex_x + t->tex_lit_x : t->tex_x;
+    int wx = sc_to_int(s->xfirst);
+    uint32_t word = 0, mask = 0;
+
+    // Affine: the UV at xfirst and its step per pixel
+    scalar_t uvx = 0, uvy = 0, duvx = 0, duvy = 0;
+    if (affine) {
+        scalar_t b2 = SC_ONE - b0_base - b1_base;
+        scalar_t db2_dx = -s->db0_dx - s->db1_dx;
+        uvx = sc_mul(b0_base, t->uv0x) + sc_mul(b1_base, t->uv1x) + sc_mul(b2, t->uv2x);
+        uvy = sc_mul(b0_base, t->uv0y) + sc_mul(b1_base, t->uv1y) + sc_mul(b2, t->uv2y);
+        duvx = sc_mul(s->db0_dx, t->uv0x) + sc_mul(s->db1_dx, t->uv1x) + sc_mul(db2_dx, t->uv2x);
+        duvy = sc_mul(s->db0_dx, t->uv0y) + sc_mul(s->db1_dx, t->uv1y) + sc_mul(db2_dx, t->uv2y);
     }
 
-    if (firstline < FIX_HALF) firstline = FIX_HALF;
-    if (lastline > F16(SCREEN_HEIGHT - 0.5)) lastline = F16(SCREEN_HEIGHT - 0.5);
+    for (scalar_t x = s->xfirst; x <= s->xlast; x += SC_ONE, wx++) {
+        if (words && !(wx & 3) && mask) {
+            pico8_store_word(&ctx->p8, wx - 4, py, word, mask);
+            word = mask = 0;
+        }
 
-    fix16_t x0 = v0->x, z0 = v0->z;
-    fix16_t x1 = v1->x, z1 = v1->z;
-    fix16_t x2 = v2->x, y2 = v2->y, z2 = v2->z;
+        scalar_t u, v;
+        if (affine) {
+            u = uvx;
+            v = uvy;
+            uvx += duvx;
+            uvy += duvy;
+        } else {
+            scalar_t b0 = b0_base;
+            scalar_t b1 = b1_base;
+            scalar_t b2 = SC_ONE - b0 - b1;
 
-    fix16_t uv0x = uv0[0], uv0y = uv0[1];
-    fix16_t uv1x = uv1[0], uv1y = uv1[1];
-    fix16_t uv2x = uv2[0], uv2y = uv2[1];
+            b0_base += s->db0_dx;
+            b1_base += s->db1_dx;
 
-    fix16_t cb0 = fix16_mul(x1, y2) - fix16_mul(x2, y1);
-    fix16_t cb1 = fix16_mul(x2, y0) - fix16_mul(x0, y2);
+            b0 = sc_mul(b0, t->z0);
+            b1 = sc_mul(b1, t->z1);
+            b2 = sc_mul(b2, t->z2);
 
-    fix16_t d = cb0 + cb1 + fix16_mul(x0, y1) - fix16_mul(x1, y0);
-    if (fix16_abs(d) < F16(0.001)) return;
+            scalar_t d2 = RANGE_FIX("persp_sum", b0 + b1 + b2);
+            if (sc_abs(d2) < SC(0.001)) continue;
 
-    fix16_t dy = y1 - y0;
-    if (fix16_abs(dy) < F16(0.001)) return;
-    fix16_t invdy = fix16_div(fix16_one, dy);
+            scalar_t inv_d2 = RANGE_FIX("inv_persp_sum", sc_div(SC_ONE, d2));
+            u = RANGE_FIX("uv", sc_mul(sc_mul(b0, t->uv0x) + sc_mul(b1, t->uv1x) + sc_mul(b2, t->uv2x), inv_d2));
+            v = RANGE_FIX("uv", sc_mul(sc_mul(b0, t->uv0y) + sc_mul(b1, t->uv1y) + sc_mul(b2, t->uv2y), inv_d2));
+        }
 
-    int tex_x = cur_tex->x;
-    int tex_y = cur_tex->y;
-    int tex_lit_x = cur_tex->light_x;
+        int px = RANGE_INT("px", sc_to_int(x));
+        int offset_x = span_offset_x;
+        if (light_mode == RASTER_DITHER) {
+            int dither_val = SGET_FAST(px & 7, dither_row);  // bitmask instead of modulo
+            if (t->light <= SC(7.0) + sc_mul(sc_from_int(dither_val), SC(0.125))) {
+                offset_x += t->tex_lit_x;
+            }
+        }
 
-    for (fix16_t y = firstline; y <= lastline; y += fix16_one) {
-        fix16_t coef = fix16_mul(y - y0, invdy);
-        fix16_t xfirst = fix16_floor(x0 + fix16_mul(coef, x1 - x0) + F16(0.48)) + FIX_HALF;
-        fix16_t xlast = fix16_floor(x0 + fix16_mul(coef, x2 - x0) - F16(0.48)) + FIX_HALF;
+        // Wrap to the sheet: UVs of triangles grazing the near plane can overflow
+        uint8_t c = SGET_FAST((sc_to_int(u) + offset_x) & 127, (sc_to_int(v) + t->tex_y) & 127);
+        if (words) {
+            OPC_COUNT(OPC_PIXEL);
+            OVD_PIXEL_AT(px, py);
+            uint32_t pc = remap ? ctx->p8.palette_map[c & 15] : c & 15u;
+            word |= pc << ((px & 3) * 8);
+            mask |= 0xFFu << ((px & 3) * 8);
+        }
+        else if (remap) PSET_FAST(&ctx->p8, px, py, c);
+        else RASTER_PSET_IDENTITY(&ctx->p8, px, py, c);
+    }
+    if (words && mask) pico8_store_word(&ctx->p8, (wx - 1) & ~3, py, word, mask);
+}
 
-        if (xfirst < FIX_HALF) xfirst = FIX_HALF;
-        if (xlast > F16(SCREEN_WIDTH - 0.5)) xlast = F16(SCREEN_WIDTH - 0.5);
+#define RASTER_SPAN_VARIANT(name, light_mode, affine, remap, words) \
+    static GAME_HOT void name(GameContext* ctx, const RasterTri* t, const RasterSpan* s) { \
+        raster_span_body(ctx, t, s, light_mode, affine, remap, words); \
+    }
 
-        fix16_t x0y = fix16_mul(x0, y);
-        fix16_t x1y = fix16_mul(x1, y);
-        fix16_t x2y = fix16_mul(x2, y);
+// Only the dithered perspective loop comes with the palette lookup: it
+// gives a lit or unlit half the same pixels, and remapped halves (the ship
+// with its engine glow, hit flashes) are a small share of the frame
+RASTER_SPAN_VARIANT(raster_span_lit, RASTER_LIT, false, false, false)
+RASTER_SPAN_VARIANT(raster_span_unlit, RASTER_UNLIT, false, false, false)
+RASTER_SPAN_VARIANT(raster_span_dither, RASTER_DITHER, false, false, false)
+RASTER_SPAN_VARIANT(raster_span_generic, RASTER_DITHER, false, true, false)
+RASTER_SPAN_VARIANT(raster_span_affine, RASTER_DITHER, true, false, false)
+RASTER_SPAN_VARIANT(raster_span_lit_words, RASTER_LIT, false, false, true)
+RASTER_SPAN_VARIANT(raster_span_unlit_words, RASTER_UNLIT, false, false, true)
+RASTER_SPAN_VARIANT(raster_span_dither_words, RASTER_DITHER, false, false, true)
+RASTER_SPAN_VARIANT(raster_span_generic_words, RASTER_DITHER, false, true, true)
+RASTER_SPAN_VARIANT(raster_span_affine_words, RASTER_DITHER, true, false, true)
+
+// [word writes][affine][light mode][palette remapped]
+static const RasterSpanFn raster_span_fns[2][2][3][2] = {
+    {
+        {
+            {raster_span_lit, raster_span_generic},
+            {raster_span_unlit, raster_span_generic},
+            {raster_span_dither, raster_span_generic},
+        },
+        {
+            {raster_span_affine, raster_span_generic},
+            {raster_span_affine, raster_span_generic},
+            {raster_span_affine, raster_span_generic},
+        },
+    },
+    {
+        {
+            {raster_span_lit_words, raster_span_generic_words},
+            {raster_span_unlit_words, raster_span_generic_words},
+            {raster_span_dither_words, raster_span_generic_words},
+        },
+        {
+            {raster_span_affine_words, raster_span_generic_words},
+            {raster_span_affine_words, raster_span_generic_words},
+            {raster_span_affine_words, raster_span_generic_words},
+        },
+    },
+};
 
-        // Pre-compute scanline gradients (avoid division in inner loop)
-        fix16_t inv_d = fix16_div(fix16_one, d);
-        fix16_t db0_dx = fix16_mul(y1 - y2, inv_d);
-        fix16_t db1_dx = fix16_mul(y2 - y0, inv_d);
+// Span loops that store words; RASTER_SPAN_WORDS makes them the default,
+// rastbench switches between both
+#ifdef RASTER_SPAN_WORDS
+static bool raster_span_words = true;
+#else
+static bool raster_span_words = false;
+#endif
 
-        fix16_t b0_base = fix16_mul(cb0 + fix16_mul(xfirst, y1) + x2y - fix16_mul(xfirst, y2) - x1y, inv_d);
-        fix16_t b1_base = fix16_mul(cb1 + fix16_mul(xfirst, y2) + x0y - fix16_mul(xfirst, y0) - x2y, inv_d);
+// Affine spans for halves whose 1/z varies by at most 1/16 of its lowest
+// value: in the host game about one texel in eleven lands on its
+// neighbour and the worst case is a few texels off.
+// RASTER_AFFINE_HALVES makes them the default; off, every span is
+// perspective-correct and the frame hashes stay those of the reference.
+// rastbench switches between both
+#ifndef RASTER_AFFINE_DEPTH_RATIO
+#define RASTER_AFFINE_DEPTH_RATIO SC(0.0625)
+#endif
+#ifdef RASTER_AFFINE_HALVES
+static bool raster_affine_halves = true;
+#else
+static bool raster_affine_halves = false;
+#endif
 
-        int py = fix16_to_int(y);
-        int dither_row = 56 + (py & 7);  // bitmask instead of modulo
+// After the spritesheet is loaded: the light levels that make the dither
+// test constant
+static void raster_span_init(void) {
+    int lo = 15, hi = 0;
+    for (int y = 56; y < 64; y++) {
+        for (int x = 0; x < 8; x++) {
+            int v = spritesheet[y][x];
+            if (v < lo) lo = v;
+            if (v > hi) hi = v;
+        }
+    }
+    raster_all_lit = SC(7.0) + sc_mul(sc_from_int(lo), SC(0.125));
+    raster_none_lit = SC(7.0) + sc_mul(sc_from_int(hi), SC(0.125));
+}
 
-        for (fix16_t x = xfirst; x <= xlast; x += fix16_one) {
-            fix16_t b0 = b0_base;
-            fix16_t b1 = b1_base;
-            fix16_t b2 = fix16_one - b0 - b1;
+// 1/z nearly constant across the half, so the UV is nearly linear in x
+static inline bool raster_depth_flat(const RasterTri* t) {
+    scalar_t zmin = sc_min(t->z0, sc_min(t->z1, t->z2));
+    scalar_t zmax = sc_max(t->z0, sc_max(t->z1, t->z2));
+    return zmin > 0 && zmax - zmin <= sc_mul(zmin, RASTER_AFFINE_DEPTH_RATIO);
+}
 
-            b0_base += db0_dx;
-            b1_base += db1_dx;
+// Span loop for one flat half: constant light, depth range and palette
+// across it
+static GAME_HOT RasterSpanFn raster_span_select(GameContext* ctx, const RasterTri* t) {
+    if (raster_span_override) return raster_span_override;
+    int light_mode = t->light <= raster_all_lit ? RASTER_LIT : t->light > raster_none_lit ? RASTER_UNLIT : RASTER_DITHER;
+    bool affine = raster_affine_halves && raster_depth_flat(t);
+    bool remap = memcmp(ctx->p8.palette_map, raster_identity_pal, sizeof(raster_identity_pal)) != 0;
+    return raster_span_fns[raster_span_words][affine][light_mode][remap];
+}
+#endif
 
-            b0 = fix16_mul(b0, z0);
-            b1 = fix16_mul(b1, z1);
-            b2 = fix16_mul(b2, z2);
+static GAME_HOT void rasterize_flat_tri(GameContext* ctx, Vec3* v0, Vec3* v1, Vec3* v2,
+                                         scalar_t* uv0, scalar_t* uv1, scalar_t* uv2, scalar_t light) {
+    OPC_FUNC();
+    scalar_t y0 = v0->y;
+    scalar_t y1 = v1->y;
 
-            fix16_t d2 = b0 + b1 + b2;
-            if (fix16_abs(d2) < F16(0.001)) continue;
+    scalar_t firstline, lastline;
 
-            fix16_t inv_d2 = fix16_div(fix16_one, d2);
-            fix16_t uvx = fix16_mul(fix16_mul(b0, uv0x) + fix16_mul(b1, uv1x) + fix16_mul(b2, uv2x), inv_d2);
-            fix16_t uvy = fix16_mul(fix16_mul(b0, uv0y) + fix16_mul(b1, uv1y) + fix16_mul(b2, uv2y), inv_d2);
+    if (y0 < y1) {
+        firstline = sc_floor(y0 + FIX_HALF) + FIX_HALF;
+        lastline = sc_floor(y1 - FIX_HALF) + FIX_HALF;
+    } else if (y0 == y1) {
+        return;
+    } else {
+        firstline = sc_floor(y1 + FIX_HALF) + FIX_HALF;
+        lastline = sc_floor(y0 - FIX_HALF) + FIX_HALF;
+    }
 
-            int px = fix16_to_int(x);
-            int offset_x = tex_x;
-            int dither_val = SGET_FAST(px & 7, dither_row);  // bitmask instead of modulo
-            if (light <= F16(7.0) + fix16_mul(fix16_from_int(dither_val), F16(0.125))) {
-                offset_x += tex_lit_x;
-            }
+    if (firstline < FIX_HALF) firstline = FIX_HALF;
+    if (lastline > SC(SCREEN_HEIGHT - 0.5)) lastline = SC(SCREEN_HEIGHT - 0.5);
+
+    scalar_t x0 = v0->x;
+    scalar_t x1 = v1->x;
+    scalar_t x2 = v2->x, y2 = v2->y;
+
+    scalar_t cb0 = sc_mul(x1, y2) - sc_mul(x2, y1);
+    scalar_t cb1 = sc_mul(x2, y0) - sc_mul(x0, y2);
+
+    scalar_t d = RANGE_FIX("area", cb0 + cb1 + sc_mul(x0, y1) - sc_mul(x1, y0));
+    if (sc_abs(d) < SC(0.001)) return;
+
+    scalar_t dy = y1 - y0;
+    if (sc_abs(dy) < SC(0.001)) return;
+    scalar_t invdy = raster_div(SC_ONE, dy);
+
+    const RasterTri tri = {
+        v0->z, v1->z, v2->z,
+        // One line per vertex, so each has its own range rows
+        RANGE_FIX("uv_in_x", uv0[0]), RANGE_FIX("uv_in_y", uv0[1]),
+        RANGE_FIX("uv_in_x", uv1[0]), RANGE_FIX("uv_in_y", uv1[1]),
+        RANGE_FIX("uv_in_x", uv2[0]), RANGE_FIX("uv_in_y", uv2[1]),
+        light,
+        ctx->cur_tex->x, ctx->cur_tex->y, ctx->cur_tex->light_x,
+    };
+    RasterSpanFn span_fn = raster_span_select(ctx, &tri);
 
-            PSET_FAST(px, py, SGET_FAST(fix16_to_int(uvx) + offset_x, fix16_to_int(uvy) + tex_y));
-        }
+    for (scalar_t y = firstline; y <= lastline; y += SC_ONE) {
+        scalar_t coef = sc_mul(y - y0, invdy);
+        scalar_t xfirst = sc_floor(x0 + sc_mul(coef, x1 - x0) + SC(0.48)) + FIX_HALF;
+        scalar_t xlast = sc_floor(x0 + sc_mul(coef, x2 - x0) - SC(0.48)) + FIX_HALF;
+
+        if (xfirst < FIX_HALF) xfirst = FIX_HALF;
+        if (xlast > SC(SCREEN_WIDTH - 0.5)) xlast = SC(SCREEN_WIDTH - 0.5);
+        if (xfirst <= xlast) OVD_COUNT(SPAN);
+
+        scalar_t x0y = sc_mul(x0, y);
+        scalar_t x1y = sc_mul(x1, y);
+        scalar_t x2y = sc_mul(x2, y);
+
+        // Pre-compute scanline gradients (avoid division in inner loop)
+        scalar_t inv_d = RANGE_FIX("inv_area", raster_div(SC_ONE, d));
+        scalar_t db0_dx = RANGE_FIX("db_dx", sc_mul(y1 - y2, inv_d));
+        scalar_t db1_dx = RANGE_FIX("db_dx", sc_mul(y2 - y0, inv_d));
+
+        scalar_t b0_base = sc_mul(cb0 + sc_mul(xfirst, y1) + x2y - sc_mul(xfirst, y2) - x1y, inv_d);
+        scalar_t b1_base = sc_mul(cb1 + sc_mul(xfirst, y2) + x0y - sc_mul(xfirst, y0) - x2y, inv_d);
+
+        const RasterSpan span = {sc_to_int(y), xfirst, xlast, b0_base, b1_base, db0_dx, db1_dx};
+        span_fn(ctx, &tri, &span);
     }
 }
 
-static void rasterize_tri(int index, Triangle* tris, Vec3* projs) {
+static GAME_HOT void rasterize_tri(GameContext* ctx, int index, Triangle* tris, Vec3* projs) {
+    OPC_FUNC();
     Triangle* tri = &tris[index];
 
     if (tri->tri[0] < 0 || tri->tri[1] < 0 || tri->tri[2] < 0) return;
-    if (cur_tex == NULL) return;
+    if (ctx->cur_tex == NULL) return;
 
     Vec3* v0 = &projs[tri->tri[0]];
     Vec3* v1 = &projs[tri->tri[1]];
     Vec3* v2 = &projs[tri->tri[2]];
 
     // Early cull: all vertices behind camera
-    if (v0->z <= 0 && v1->z <= 0 && v2->z <= 0) return;
+    if (v0->z <= 0 && v1->z <= 0 && v2->z <= 0) {
+        OVD_COUNT(REJ_BEHIND);
+        return;
+    }
 
-    fix16_t x0 = v0->x, y0 = v0->y;
-    fix16_t x1 = v1->x, y1 = v1->y;
-    fix16_t x2 = v2->x, y2 = v2->y;
+    scalar_t x0 = v0->x, y0 = v0->y;
+    scalar_t x1 = v1->x, y1 = v1->y;
+    scalar_t x2 = v2->x, y2 = v2->y;
 
     // Early cull: completely off-screen
-    fix16_t min_x = x0 < x1 ? (x0 < x2 ? x0 : x2) : (x1 < x2 ? x1 : x2);
-    fix16_t max_x = x0 > x1 ? (x0 > x2 ? x0 : x2) : (x1 > x2 ? x1 : x2);
-    fix16_t min_y = y0 < y1 ? (y0 < y2 ? y0 : y2) : (y1 < y2 ? y1 : y2);
-    fix16_t max_y = y0 > y1 ? (y0 > y2 ? y0 : y2) : (y1 > y2 ? y1 : y2);
+    scalar_t min_x = x0 < x1 ? (x0 < x2 ? x0 : x2) : (x1 < x2 ? x1 : x2);
+    scalar_t max_x = x0 > x1 ? (x0 > x2 ? x0 : x2) : (x1 > x2 ? x1 : x2);
+    scalar_t min_y = y0 < y1 ? (y0 < y2 ? y0 : y2) : (y1 < y2 ? y1 : y2);
+    scalar_t max_y = y0 > y1 ? (y0 > y2 ? y0 : y2) : (y1 > y2 ? y1 : y2);
 
-    if (max_x < 0 || min_x >= F16(SCREEN_WIDTH)) return;
-    if (max_y < 0 || min_y >= F16(SCREEN_HEIGHT)) return;
+    if (max_x < 0 || min_x >= SC(SCREEN_WIDTH) || max_y < 0 || min_y >= SC(SCREEN_HEIGHT)) {
+        OVD_COUNT(REJ_OFFSCREEN);
+        return;
+    }
 
     // Backface cull
-    fix16_t nz = fix16_mul(x1 - x0, y2 - y0) - fix16_mul(y1 - y0, x2 - x0);
-    if (nz < 0) return;
+    scalar_t nz = RANGE_FIX("cross_z", sc_mul(x1 - x0, y2 - y0) - sc_mul(y1 - y0, x2 - x0));
+    if (nz < 0) {
+        OVD_COUNT(REJ_BACKFACE);
+        return;
+    }
 
-    fix16_t* uv0 = tri->uv[0];
-    fix16_t* uv1 = tri->uv[1];
-    fix16_t* uv2 = tri->uv[2];
+    scalar_t* uv0 = tri->uv[0];
+    scalar_t* uv1 = tri->uv[1];
+    scalar_t* uv2 = tri->uv[2];
 
     // Sort by Y
     Vec3 *tv0 = v0, *tv1 = v1, *tv2 = v2;
-    fix16_t *tuv0 = uv0, *tuv1 = uv1, *tuv2 = uv2;
+    scalar_t *tuv0 = uv0, *tuv1 = uv1, *tuv2 = uv2;
 
-    if (tv1->y < tv0->y) { Vec3* t = tv1; tv1 = tv0; tv0 = t; fix16_t* tu = tuv1; tuv1 = tuv0; tuv0 = tu; }
-    if (tv2->y < tv0->y) { Vec3* t = tv2; tv2 = tv0; tv0 = t; fix16_t* tu = tuv2; tuv2 = tuv0; tuv0 = tu; }
-    if (tv2->y < tv1->y) { Vec3* t = tv2; tv2 = tv1; tv1 = t; fix16_t* tu = tuv2; tuv2 = tuv1; tuv1 = tu; }
+    if (tv1->y < tv0->y) { Vec3* t = tv1; tv1 = tv0; tv0 = t; scalar_t* tu = tuv1; tuv1 = tuv0; tuv0 = tu; }
+    if (tv2->y < tv0->y) { Vec3* t = tv2; tv2 = tv0; tv0 = t; scalar_t* tu = tuv2; tuv2 = tuv0; tuv0 = tu; }
+    if (tv2->y < tv1->y) { Vec3* t = tv2; tv2 = tv1; tv1 = t; scalar_t* tu = tuv2; tuv2 = tuv1; tuv1 = tu; }
 
     y0 = tv0->y; y1 = tv1->y; y2 = tv2->y;
     x0 = tv0->x;
-    fix16_t z0 = tv0->z, z2 = tv2->z;
+    scalar_t z0 = tv0->z, z2 = tv2->z;
 
-    if (y0 == y2) return;
+    if (y0 == y2) {
+        OVD_COUNT(REJ_DEGENERATE);
+        return;
+    }
+    OVD_COUNT(TRI_DRAWN);
 
-    fix16_t light = fix16_mul(F16(15.0), vec3_dot(t_light_dir, &tri->normal));
+    scalar_t light = RANGE_FIX("light", sc_mul(SC(15.0), vec3_dot(ctx->t_light_dir, &tri->normal)));
 
-    fix16_t c = fix16_div(y1 - y0, y2 - y0);
-    Vec3 v3 = {x0 + fix16_mul(c, tv2->x - x0), y1, z0 + fix16_mul(c, z2 - z0)};
+    scalar_t c = raster_div(y1 - y0, y2 - y0);
+    Vec3 v3 = {x0 + sc_mul(c, tv2->x - x0), y1, z0 + sc_mul(c, z2 - z0)};
 
-    fix16_t b0 = fix16_mul(fix16_one - c, z0);
-    fix16_t b1 = fix16_mul(c, z2);
-    fix16_t sum = b0 + b1;
-    fix16_t invd = (sum > F16(0.001)) ? fix16_div(fix16_one, sum) : 0;
+    scalar_t b0 = sc_mul(SC_ONE - c, z0);
+    scalar_t b1 = sc_mul(c, z2);
+    scalar_t sum = b0 + b1;
+    scalar_t invd = (sum > SC(0.001)) ? raster_div(SC_ONE, sum) : 0;
 
-    fix16_t uv3[2] = {
-        fix16_mul(fix16_mul(b0, tuv0[0]) + fix16_mul(b1, tuv2[0]), invd),
-        fix16_mul(fix16_mul(b0, tuv0[1]) + fix16_mul(b1, tuv2[1]), invd)
+    scalar_t uv3[2] = {
+        sc_mul(sc_mul(b0, tuv0[0]) + sc_mul(b1, tuv2[0]), invd),
+        sc_mul(sc_mul(b0, tuv0[1]) + sc_mul(b1, tuv2[1]), invd)
     };
 
     if (tv1->x <= v3.x) {
-        rasterize_flat_tri(tv0, tv1, &v3, tuv0, tuv1, uv3, light);
-        rasterize_flat_tri(tv2, tv1, &v3, tuv2, tuv1, uv3, light);
+        rasterize_flat_tri(ctx, tv0, tv1, &v3, tuv0, tuv1, uv3, light);
+        rasterize_flat_tri(ctx, tv2, tv1, &v3, tuv2, tuv1, uv3, light);
     } else {
-        rasterize_flat_tri(tv0, &v3, tv1, tuv0, uv3, tuv1, light);
-        rasterize_flat_tri(tv2, &v3, tv1, tuv2, uv3, tuv1, light);
+        rasterize_flat_tri(ctx, tv0, &v3, tv1, tuv0, uv3, tuv1, light);
+        rasterize_flat_tri(ctx, tv2, &v3, tv1, tuv2, uv3, tuv1, light);
     }
 }
 
 // Insertion sort - faster than qsort for small arrays (typical mesh has <20 tris)
 static void sort_tris(Triangle* tris, int num, Vec3* projs) {
+    OPC_FUNC();
     // First pass: compute z for each triangle
     for (int i = 0; i < num; i++) {
         Triangle* tri = &tris[i];
@@ -847,6 +1231,7 @@ static void sort_tris(Triangle* tris, int num, Vec3* projs) {
         Triangle temp = tris[i];
         int j = i - 1;
         while (j >= 0 && tris[j].z > temp.z) {
+            OPC_BYTES(sizeof(Triangle));
             tris[j + 1] = tris[j];
             j--;
         }
@@ -860,7 +1245,7 @@ static void sort_tris(Triangle* tris, int num, Vec3* projs) {
 
 static void init_ship(void) {
     mem_pos = 0;
-    decode_mesh(&ship_mesh, fix16_one);
+    decode_mesh(&ship_mesh, SC_ONE);
 
     ship_tex.x = 0;
     ship_tex.y = 96;
@@ -884,75 +1269,83 @@ static void init_nme(void) {
     nme_tex_hit.light_x = 16;
 }
 
-static void init_single_trail(Trail* trail, fix16_t z) {
-    vec3_set(&trail->pos0, sym_random_fix(F16(100.0)) + ship_x, sym_random_fix(F16(100.0)) + ship_y, z);
-    trail->spd = fix16_mul(F16(2.5) + rnd_fix(F16(5.0)), game_spd);
-    trail->col = flr_fix(rnd_fix(F16(4.0))) + 1;
+static void init_single_trail(GameContext* ctx, Trail* trail, scalar_t z) {
+    OPC_FUNC();
+    vec3_set(&trail->pos0, sym_random_fix(ctx, SC(100.0)) + ctx->ship_x, sym_random_fix(ctx, SC(100.0)) + ctx->ship_y, z);
+    trail->spd = sc_mul(SC(2.5) + rnd_fix(ctx, SC(5.0)), ctx->game_spd);
+    trail->col = flr_fix(rnd_fix(ctx, SC(4.0))) + 1;
 }
 
-static void init_trail(void) {
+static void init_trail(GameContext* ctx) {
     for (int i = 0; i < MAX_TRAILS; i++) {
-        init_single_trail(&trails[i], sym_random_fix(F16(150.0)));
+        init_single_trail(ctx, &ctx->trails[i], sym_random_fix(ctx, SC(150.0)));
     }
 }
 
-static void init_single_bg(Background* bg, fix16_t z) {
-    fix16_t a = rnd_fix(fix16_one);
-    fix16_t r = F16(150.0) + rnd_fix(F16(150.0));
-    fix16_t angle = fix16_mul(a, FIX_TWO_PI);
+static void init_single_bg(GameContext* ctx, Background* bg, scalar_t z) {
+    OPC_FUNC();
+    scalar_t a = rnd_fix(ctx, SC_ONE);
+    scalar_t r = SC(150.0) + rnd_fix(ctx, SC(150.0));
+    scalar_t angle = sc_mul(a, FIX_TWO_PI);
     // PICO-8's sin is negative of standard sin
-    vec3_set(&bg->pos, fix16_mul(r, fix16_cos(angle)), fix16_mul(r, -fix16_sin(angle)), z);
-    bg->spd = F16(0.05) + rnd_fix(F16(0.05));
-    if (flr_fix(rnd_fix(F16(6.0))) == 0) {
-        bg->index = 8 + (int)rnd_fix(F16(8.0));
+    vec3_set(&bg->pos, sc_mul(r, sc_cos(angle)), sc_mul(r, -sc_sin(angle)), z);
+    bg->spd = SC(0.05) + rnd_fix(ctx, SC(0.05));
+    if (flr_fix(rnd_fix(ctx, SC(6.0))) == 0) {
+        // The Q16.16 value, not the integer part, as it has always been:
+        // spr() finds no such sprite in the sheet
+        bg->index = 8 + sc_to_q16(rnd_fix(ctx, SC(8.0)));
     } else {
-        bg->index = -bg_color[get_random_idx(3)];
+        bg->index = -bg_color[get_random_idx(ctx, 3)];
     }
 }
 
-static void init_bg(void) {
+static void init_bg(GameContext* ctx) {
     for (int i = 0; i < MAX_BGS; i++) {
-        init_single_bg(&bgs[i], sym_random_fix(F16(400.0)));
+        init_single_bg(ctx, &ctx->bgs[i], sym_random_fix(ctx, SC(400.0)));
     }
 }
 
-static void init_main(void) {
+static void init_main(GameContext* ctx) {
+    OPC_FUNC();
     // Save persistent data to flash when returning to title
-    save_cart_data();
-
-    cur_mode = 0;
-    cam_angle_z = F16(-0.4);
-    cam_angle_x = fix16_mul(fix16_from_int(flr_fix(rnd_fix(FIX_TWO)) * 2 - 1), F16(0.03) + rnd_fix(F16(0.1)));
-
-    ship_x = 0;
-    ship_y = 0;
-    cam_x = 0;
-    cam_y = 0;
-    ship_spd_x = 0;
-    ship_spd_y = 0;
-    life = 4;
-    barrel_cur_t = F16(-1.0);
-    num_enemies = 0;
-    num_lasers = 0;
-    num_nme_lasers = 0;
-    hit_t = -1;
-    laser_on = false;
-    nb_nme_ship = 0;
-    aim_z = F16(-200.0);
-    cur_thrust = 0;
-    roll_f = 0;
-    pitch_f = 0;
-    global_t = 0;
-    asteroid_mul_t = fix16_one;
-    cur_sequencer_x = 96;
-    cur_sequencer_y = 96;
-    next_sequencer_t = 0;
-    waiting_nme_clear = false;
-    spawn_asteroids = false;
-    game_spd = fix16_one;
-    cam_depth = F16(22.5);
-    cur_nme_t = 0;
-    best_score = dget(0);
+    save_cart_data(&ctx->p8);
+
+    ctx->cur_mode = 0;
+    ctx->cam_angle_z = SC(-0.4);
+    ctx->cam_angle_x = sc_mul(sc_from_int(flr_fix(rnd_fix(ctx, FIX_TWO)) * 2 - 1), SC(0.03) + rnd_fix(ctx, SC(0.1)));
+
+    ctx->ship_x = 0;
+    ctx->ship_y = 0;
+    ctx->cam_x = 0;
+    ctx->cam_y = 0;
+    ctx->ship_spd_x = 0;
+    ctx->ship_spd_y = 0;
+    ctx->life = 4;
+    ctx->barrel_cur_t = SC(-1.0);
+    for (int i = 0; i < ctx->num_enemies; i++) {
+        free(ctx->enemies[i].proj);
+    }
+    ctx->num_enemies = 0;
+    ctx->num_lasers = 0;
+    ctx->num_nme_lasers = 0;
+    ctx->hit_t = -1;
+    ctx->laser_on = false;
+    ctx->nb_nme_ship = 0;
+    ctx->aim_z = SC(-200.0);
+    ctx->cur_thrust = 0;
+    ctx->roll_f = 0;
+    ctx->pitch_f = 0;
+    ctx->global_t = 0;
+    ctx->asteroid_mul_t = SC_ONE;
+    ctx->cur_sequencer_x = 96;
+    ctx->cur_sequencer_y = 96;
+    ctx->next_sequencer_t = 0;
+    ctx->waiting_nme_clear = false;
+    ctx->spawn_asteroids = false;
+    ctx->game_spd = SC_ONE;
+    ctx->cam_depth = SC(22.5);
+    ctx->cur_nme_t = 0;
+    ctx->best_score = dget(ctx, 0);
 }
 
 // ============================================================================
@@ -969,6 +1362,7 @@ static Laser* spawn_laser(Laser* lasers_arr, int* count, Vec3 pos) {
 
 static void remove_laser(Laser* lasers_arr, int* count, int idx) {
     if (idx < *count - 1) {
+        OPC_BYTES(sizeof(Laser));
         lasers_arr[idx] = lasers_arr[*count - 1];
     }
     (*count)--;
@@ -978,31 +1372,33 @@ static void remove_laser(Laser* lasers_arr, int* count, int idx) {
 // Enemy Management
 // ============================================================================
 
-static Enemy* spawn_nme(int type, Vec3 pos) {
-    if (num_enemies >= MAX_ENEMIES) return NULL;
-    Enemy* nme = &enemies[num_enemies];
+static Enemy* spawn_nme(GameContext* ctx, int type, Vec3 pos) {
+    OPC_FUNC();
+    if (ctx->num_enemies >= MAX_ENEMIES) return NULL;
+    Enemy* nme = &ctx->enemies[ctx->num_enemies];
     memset(nme, 0, sizeof(Enemy));
     vec3_copy(&nme->pos, &pos);
     nme->type = type;
     nme->proj = (Vec3*)calloc(nme_meshes[type - 1].num_vertices, sizeof(Vec3));
     nme->life = nme_life[type - 1];
     nme->hit_t = -1;
-    num_enemies++;
+    ctx->num_enemies++;
     return nme;
 }
 
-static void spawn_nme_ship(int type) {
-    nb_nme_ship++;
-    next_sequencer_t = global_t + F16(0.25);
-    fix16_t desc_bounds = fix16_mul(nme_bounds[type - 2], FIX_TWO);
+static void spawn_nme_ship(GameContext* ctx, int type) {
+    OPC_FUNC();
+    ctx->nb_nme_ship++;
+    ctx->next_sequencer_t = ctx->global_t + SC(0.25);
+    scalar_t desc_bounds = sc_mul(nme_bounds[type - 2], FIX_TWO);
     Vec3 pos = {
-        mid_fix(F16(-100.0), sym_random_fix(F16(50.0)) + ship_x, F16(100.0)),
-        mid_fix(F16(-100.0), sym_random_fix(F16(50.0)) + ship_y, F16(100.0)),
-        desc_bounds - F16(200.0)
+        mid_fix(SC(-100.0), sym_random_fix(ctx, SC(50.0)) + ctx->ship_x, SC(100.0)),
+        mid_fix(SC(-100.0), sym_random_fix(ctx, SC(50.0)) + ctx->ship_y, SC(100.0)),
+        desc_bounds - SC(200.0)
     };
-    Enemy* nme = spawn_nme(type, pos);
+    Enemy* nme = spawn_nme(ctx, type, pos);
     if (nme) {
-        vec3_set(&nme->spd, 0, 0, F16(8.0));
+        vec3_set(&nme->spd, 0, 0, SC(8.0));
         vec3_copy(&nme->waypoint, &nme->pos);
         nme->waypoint.z = desc_bounds;
     }
@@ -1012,24 +1408,25 @@ static void spawn_nme_ship(int type) {
 // Collision
 // ============================================================================
 
-static void hit_ship(Vec3* pos, fix16_t sqr_size) {
-    if (hit_t == -1 && barrel_cur_t < 0) {
-        fix16_t dx = fix16_mul(pos->x - ship_x, F16(0.2));
-        fix16_t dy = fix16_mul(pos->y - ship_y, F16(0.2));
-        fix16_t sqrd = fix16_mul(dx, dx) + fix16_mul(dy, dy);
+static GAME_SIM void hit_ship(GameContext* ctx, Vec3* pos, scalar_t sqr_size) {
+    OPC_FUNC();
+    if (ctx->hit_t == -1 && ctx->barrel_cur_t < 0) {
+        scalar_t dx = sc_mul(pos->x - ctx->ship_x, SC(0.2));
+        scalar_t dy = sc_mul(pos->y - ctx->ship_y, SC(0.2));
+        scalar_t sqrd = sc_mul(dx, dx) + sc_mul(dy, dy);
         if (sqrd < sqr_size) {
-            fix16_t n = fix16_div(fix16_one, fix16_sqrt(sqrd + F16(0.001)));
-            dx = fix16_mul(dx, n);
-            dy = fix16_mul(dy, n);
-            roll_f += fix16_mul(dx, F16(0.05));
-            pitch_f -= fix16_mul(dy, F16(0.02));
-            hit_t = 0;
-            vec3_copy(&hit_pos, pos);
-            life--;
-            sfx(2, 1);
-            if (life == 0) {
-                fade_ratio = 0;
-                sfx(7, 2);
+            scalar_t n = sc_div(SC_ONE, sc_sqrt(sqrd + SC(0.001)));
+            dx = sc_mul(dx, n);
+            dy = sc_mul(dy, n);
+            ctx->roll_f += sc_mul(dx, SC(0.05));
+            ctx->pitch_f -= sc_mul(dy, SC(0.02));
+            ctx->hit_t = 0;
+            vec3_copy(&ctx->hit_pos, pos);
+            ctx->life--;
+            sfx(ctx, 2, 1);
+            if (ctx->life == 0) {
+                ctx->fade_ratio = 0;
+                sfx(ctx, 7, 2);
             }
         }
     }
@@ -1039,12 +1436,13 @@ static void hit_ship(Vec3* pos, fix16_t sqr_size) {
 // Update Functions
 // ============================================================================
 
-static void update_enemies(void) {
-    for (int i = 0; i < num_enemies; i++) {
-        Enemy* nme = &enemies[i];
-        nme->pos.x += fix16_mul(nme->spd.x, game_spd);
-        nme->pos.y += fix16_mul(nme->spd.y, game_spd);
-        nme->pos.z += fix16_mul(nme->spd.z, game_spd);
+static GAME_SIM void update_enemies(GameContext* ctx) {
+    OPC_FUNC();
+    for (int i = 0; i < ctx->num_enemies; i++) {
+        Enemy* nme = &ctx->enemies[i];
+        nme->pos.x = RANGE_FIX("pos", nme->pos.x + sc_mul(nme->spd.x, ctx->game_spd));
+        nme->pos.y = RANGE_FIX("pos", nme->pos.y + sc_mul(nme->spd.y, ctx->game_spd));
+        nme->pos.z = RANGE_FIX("pos", nme->pos.z + sc_mul(nme->spd.z, ctx->game_spd));
         nme->rot_x += nme->rot_x_spd;
         nme->rot_y += nme->rot_y_spd;
 
@@ -1053,30 +1451,30 @@ static void update_enemies(void) {
         if (type > 1) {
             int sub_type = type - 1;
             if (sub_type >= 1 && sub_type <= 3) {
-                fix16_t desc_bounds = nme_bounds[sub_type - 1];
-                fix16_t desc_spd = nme_spd[sub_type - 1];
+                scalar_t desc_bounds = nme_bounds[sub_type - 1];
+                scalar_t desc_spd = nme_spd[sub_type - 1];
 
                 Vec3 dir = vec3_minus(&nme->waypoint, &nme->pos);
-                vec3_mul(&dir, F16(0.1));
-                fix16_t dist = vec3_dot(&dir, &dir);
+                vec3_mul(&dir, SC(0.1));
+                scalar_t dist = RANGE_FIX("waypoint_dist2", vec3_dot(&dir, &dir));
 
-                if (dist < fix16_mul(game_spd, game_spd) || nme->hit_t == 0) {
-                    vec3_set(&nme->waypoint, sym_random_fix(F16(100.0)), sym_random_fix(F16(100.0)),
-                             desc_bounds - rnd_fix(-desc_bounds));
+                if (dist < sc_mul(ctx->game_spd, ctx->game_spd) || nme->hit_t == 0) {
+                    vec3_set(&nme->waypoint, sym_random_fix(ctx, SC(100.0)), sym_random_fix(ctx, SC(100.0)),
+                             desc_bounds - rnd_fix(ctx, -desc_bounds));
                 }
 
                 vec3_normalize(&dir);
-                nme->spd.x += fix16_mul(fix16_mul(dir.x, desc_spd), F16(0.1));
-                nme->spd.y += fix16_mul(fix16_mul(dir.y, desc_spd), F16(0.1));
-                nme->spd.z += fix16_mul(fix16_mul(dir.z, desc_spd), F16(0.1));
+                nme->spd.x += sc_mul(sc_mul(dir.x, desc_spd), SC(0.1));
+                nme->spd.y += sc_mul(sc_mul(dir.y, desc_spd), SC(0.1));
+                nme->spd.z += sc_mul(sc_mul(dir.z, desc_spd), SC(0.1));
 
-                if (nme->pos.z >= fix16_mul(desc_bounds, FIX_TWO)) {
-                    fix16_t spd_len = vec3_length(&nme->spd);
+                if (nme->pos.z >= sc_mul(desc_bounds, FIX_TWO)) {
+                    scalar_t spd_len = vec3_length(&nme->spd);
                     if (spd_len > desc_spd) {
-                        vec3_mul(&nme->spd, fix16_div(desc_spd, spd_len));
+                        vec3_mul(&nme->spd, sc_div(desc_spd, spd_len));
                     }
-                    nme->rot_x = fix16_mul(F16(-0.08), nme->spd.y);
-                    nme->rot_y = fix16_mul(-nme_rot[sub_type - 1], nme->spd.x);
+                    nme->rot_x = sc_mul(SC(-0.08), nme->spd.y);
+                    nme->rot_y = sc_mul(-nme_rot[sub_type - 1], nme->spd.x);
 
                     int nb_lasers = type - 2;
 
@@ -1084,29 +1482,29 @@ static void update_enemies(void) {
                         nme->laser_t = 0;
                     }
 
-                    nme->laser_t += fix16_one;
+                    nme->laser_t += SC_ONE;
 
                     if (nme->laser_t > nme->stop_laser_t) {
-                        nme->laser_t = -fix16_div(F16(60.0) + rnd_fix(F16(60.0)), game_spd);
-                        nme->stop_laser_t = F16(60.0) + rnd_fix(F16(60.0));
-                        fix16_t c = fix16_mul(F16(-0.5), fix16_div(nme->pos.z, game_spd));
+                        nme->laser_t = -sc_div(SC(60.0) + rnd_fix(ctx, SC(60.0)), ctx->game_spd);
+                        nme->stop_laser_t = SC(60.0) + rnd_fix(ctx, SC(60.0));
+                        scalar_t c = sc_mul(SC(-0.5), sc_div(nme->pos.z, ctx->game_spd));
                         for (int j = 0; j < nb_lasers && j < 2; j++) {
-                            nme->laser_offset_x[j] = sym_random_fix(F16(30.0)) + fix16_mul(ship_spd_x, c);
-                            nme->laser_offset_y[j] = sym_random_fix(F16(30.0)) + fix16_mul(ship_spd_y, c);
+                            nme->laser_offset_x[j] = sym_random_fix(ctx, SC(30.0)) + sc_mul(ctx->ship_spd_x, c);
+                            nme->laser_offset_y[j] = sym_random_fix(ctx, SC(30.0)) + sc_mul(ctx->ship_spd_y, c);
                         }
                     }
 
-                    fix16_t laser_t_val = nme->laser_t;
-                    fix16_t t = fix16_div(F16(6.0), game_spd);
+                    scalar_t laser_t_val = nme->laser_t;
+                    scalar_t t = sc_div(SC(6.0), ctx->game_spd);
                     if (laser_t_val > 0) {
-                        nme->next_laser_t += fix16_one;
+                        nme->next_laser_t += SC_ONE;
 
                         if (nme->next_laser_t >= t) {
                             nme->next_laser_t -= t;
 
                             if (type != 2) {
-                                fix16_t angle = fix16_mul(fix16_div(laser_t_val, F16(120.0)), FIX_TWO_PI);
-                                fix16_t ratio = fix16_cos(angle);
+                                scalar_t angle = sc_mul(sc_div(laser_t_val, SC(120.0)), FIX_TWO_PI);
+                                scalar_t ratio = sc_cos(angle);
 
                                 for (int j = 0; j < nb_lasers && j < 2; j++) {
                                     Vec3 laser_pos;
@@ -1119,29 +1517,29 @@ static void update_enemies(void) {
                                         laser_pos = nme->pos;
                                     }
 
-                                    Laser* laser = spawn_laser(nme_lasers, &num_nme_lasers, laser_pos);
+                                    Laser* laser = spawn_laser(ctx->nme_lasers, &ctx->num_nme_lasers, laser_pos);
                                     if (laser) {
                                         Vec3 target = {
-                                            ship_x + fix16_mul(nme->laser_offset_x[j], ratio) + sym_random_fix(F16(5.0)),
-                                            ship_y + fix16_mul(nme->laser_offset_y[j], ratio) + sym_random_fix(F16(5.0)),
+                                            ctx->ship_x + sc_mul(nme->laser_offset_x[j], ratio) + sym_random_fix(ctx, SC(5.0)),
+                                            ctx->ship_y + sc_mul(nme->laser_offset_y[j], ratio) + sym_random_fix(ctx, SC(5.0)),
                                             0
                                         };
                                         Vec3 ldir = vec3_minus(&target, &laser_pos);
-                                        vec3_mul(&ldir, F16(0.1));
-                                        fix16_t len = vec3_length(&ldir);
-                                        fix16_t v = (len > F16(0.001)) ? fix16_div(fix16_mul(FIX_TWO, game_spd), len) : fix16_mul(FIX_TWO, game_spd);
-                                        laser->spd.x = fix16_mul(ldir.x, v);
-                                        laser->spd.y = fix16_mul(ldir.y, v);
-                                        laser->spd.z = fix16_mul(ldir.z, v);
+                                        vec3_mul(&ldir, SC(0.1));
+                                        scalar_t len = vec3_length(&ldir);
+                                        scalar_t v = (len > SC(0.001)) ? sc_div(sc_mul(FIX_TWO, ctx->game_spd), len) : sc_mul(FIX_TWO, ctx->game_spd);
+                                        laser->spd.x = sc_mul(ldir.x, v);
+                                        laser->spd.y = sc_mul(ldir.y, v);
+                                        laser->spd.z = sc_mul(ldir.z, v);
                                     }
                                 }
                             } else {
-                                Vec3 laser_pos = {nme->pos.x, nme->pos.y, nme->pos.z + F16(12.0)};
-                                Laser* laser = spawn_laser(nme_lasers, &num_nme_lasers, laser_pos);
+                                Vec3 laser_pos = {nme->pos.x, nme->pos.y, nme->pos.z + SC(12.0)};
+                                Laser* laser = spawn_laser(ctx->nme_lasers, &ctx->num_nme_lasers, laser_pos);
                                 if (laser) {
-                                    laser->spd.x = sym_random_fix(F16(0.05));
-                                    laser->spd.y = sym_random_fix(F16(0.05));
-                                    laser->spd.z = fix16_mul(FIX_TWO, game_spd);
+                                    laser->spd.x = sym_random_fix(ctx, SC(0.05));
+                                    laser->spd.y = sym_random_fix(ctx, SC(0.05));
+                                    laser->spd.z = sc_mul(FIX_TWO, ctx->game_spd);
                                 }
                             }
                         }
@@ -1152,7 +1550,7 @@ static void update_enemies(void) {
 
         bool del = false;
         if (nme->pos.z > 0) {
-            hit_ship(&nme->pos, F16(2.5));
+            hit_ship(ctx, &nme->pos, SC(2.5));
             del = true;
         }
 
@@ -1167,135 +1565,141 @@ static void update_enemies(void) {
         }
 
         if (del) {
-            if (nme->type > 1) nb_nme_ship--;
+            if (nme->type > 1) ctx->nb_nme_ship--;
             if (nme->proj) free(nme->proj);
-            enemies[i] = enemies[num_enemies - 1];
-            num_enemies--;
+            OPC_BYTES(sizeof(Enemy));
+            ctx->enemies[i] = ctx->enemies[ctx->num_enemies - 1];
+            ctx->num_enemies--;
             i--;
         }
     }
 
-    cur_nme_t -= fix16_one;
-    if (spawn_asteroids && cur_nme_t <= 0) {
-        cur_nme_t = fix16_div(fix16_mul(F16(30.0) + rnd_fix(F16(60.0)), asteroid_mul_t), game_spd);
-        fix16_t posx = mid_fix(F16(-100.0), fix16_mul(F16(10.0), ship_spd_x) + ship_x + sym_random_fix(F16(30.0)), F16(100.0));
-        fix16_t posy = mid_fix(F16(-100.0), fix16_mul(F16(10.0), ship_spd_y) + ship_y + sym_random_fix(F16(30.0)), F16(100.0));
-        Vec3 pos = {posx, posy, F16(-50.0)};
-        Enemy* nme = spawn_nme(1, pos);
+    ctx->cur_nme_t -= SC_ONE;
+    if (ctx->spawn_asteroids && ctx->cur_nme_t <= 0) {
+        ctx->cur_nme_t = sc_div(sc_mul(SC(30.0) + rnd_fix(ctx, SC(60.0)), ctx->asteroid_mul_t), ctx->game_spd);
+        scalar_t posx = mid_fix(SC(-100.0), sc_mul(SC(10.0), ctx->ship_spd_x) + ctx->ship_x + sym_random_fix(ctx, SC(30.0)), SC(100.0));
+        scalar_t posy = mid_fix(SC(-100.0), sc_mul(SC(10.0), ctx->ship_spd_y) + ctx->ship_y + sym_random_fix(ctx, SC(30.0)), SC(100.0));
+        Vec3 pos = {posx, posy, SC(-50.0)};
+        Enemy* nme = spawn_nme(ctx, 1, pos);
         if (nme) {
             vec3_set(&nme->spd,
-                mid_fix(fix16_mul(F16(-100.0) - posx, F16(0.005)), sym_random_fix(F16(0.25)), fix16_mul(F16(100.0) - posx, F16(0.005))),
-                mid_fix(fix16_mul(F16(-100.0) - posy, F16(0.005)), sym_random_fix(F16(0.25)), fix16_mul(F16(100.0) - posy, F16(0.005))),
-                F16(0.25));
-            nme->rot_x_spd = sym_random_fix(F16(0.015));
-            nme->rot_y_spd = sym_random_fix(F16(0.015));
+                mid_fix(sc_mul(SC(-100.0) - posx, SC(0.005)), sym_random_fix(ctx, SC(0.25)), sc_mul(SC(100.0) - posx, SC(0.005))),
+                mid_fix(sc_mul(SC(-100.0) - posy, SC(0.005)), sym_random_fix(ctx, SC(0.25)), sc_mul(SC(100.0) - posy, SC(0.005))),
+                SC(0.25));
+            nme->rot_x_spd = sym_random_fix(ctx, SC(0.015));
+            nme->rot_y_spd = sym_random_fix(ctx, SC(0.015));
         }
     }
 
     // Sort enemies by distance
-    for (int i = 1; i < num_enemies; i++) {
-        Enemy nme_tmp = enemies[i];
+    for (int i = 1; i < ctx->num_enemies; i++) {
+        Enemy nme_tmp = ctx->enemies[i];
         int j = i - 1;
-        while (j >= 0 && nme_tmp.pos.z > enemies[j].pos.z) {
-            enemies[j + 1] = enemies[j];
+        while (j >= 0 && nme_tmp.pos.z > ctx->enemies[j].pos.z) {
+            OPC_BYTES(sizeof(Enemy));
+            ctx->enemies[j + 1] = ctx->enemies[j];
             j--;
         }
-        enemies[j + 1] = nme_tmp;
+        ctx->enemies[j + 1] = nme_tmp;
     }
 }
 
-static void update_nme_lasers(void) {
-    for (int i = 0; i < num_nme_lasers; i++) {
-        Laser* laser = &nme_lasers[i];
+static GAME_SIM void update_nme_lasers(GameContext* ctx) {
+    OPC_FUNC();
+    for (int i = 0; i < ctx->num_nme_lasers; i++) {
+        Laser* laser = &ctx->nme_lasers[i];
         vec3_copy(&laser->pos1, &laser->pos0);
         laser->pos0.x += laser->spd.x;
         laser->pos0.y += laser->spd.y;
         laser->pos0.z += laser->spd.z;
 
         if (laser->pos0.z >= 0) {
-            hit_ship(&laser->pos0, F16(1.5));
-            hit_ship(&laser->pos1, F16(1.5));
-            remove_laser(nme_lasers, &num_nme_lasers, i);
+            hit_ship(ctx, &laser->pos0, SC(1.5));
+            hit_ship(ctx, &laser->pos1, SC(1.5));
+            remove_laser(ctx->nme_lasers, &ctx->num_nme_lasers, i);
             i--;
         }
     }
 }
 
-static void update_lasers(void) {
-    cur_laser_t += fix16_one;
-    laser_spawned = false;
+static GAME_SIM void update_lasers(GameContext* ctx) {
+    OPC_FUNC();
+    ctx->cur_laser_t += SC_ONE;
+    ctx->laser_spawned = false;
 
-    if (laser_on && cur_laser_t > FIX_TWO) {
-        cur_laser_t = 0;
-        laser_spawned = true;
-        Vec3 pos = {fix16_from_int(cur_laser_side), F16(-1.5), F16(-8.0)};
+    if (ctx->laser_on && ctx->cur_laser_t > FIX_TWO) {
+        ctx->cur_laser_t = 0;
+        ctx->laser_spawned = true;
+        Vec3 pos = {sc_from_int(ctx->cur_laser_side), SC(-1.5), SC(-8.0)};
         Vec3 world_pos;
-        mat_mul_pos(&world_pos, &ship_mat, &pos);
-        spawn_laser(lasers, &num_lasers, world_pos);
-        cur_laser_side = -cur_laser_side;
+        mat_mul_pos(&world_pos, &ctx->ship_mat, &pos);
+        spawn_laser(ctx->lasers, &ctx->num_lasers, world_pos);
+        ctx->cur_laser_side = -ctx->cur_laser_side;
     }
 
-    for (int i = 0; i < num_lasers; i++) {
-        Laser* laser = &lasers[i];
+    for (int i = 0; i < ctx->num_lasers; i++) {
+        Laser* laser = &ctx->lasers[i];
         vec3_copy(&laser->pos1, &laser->pos0);
-        laser->pos0.z -= F16(5.0);
+        laser->pos0.z = RANGE_FIX("laser_z", laser->pos0.z - SC(5.0));
 
-        if (laser->pos0.z <= F16(-200.0)) {
-            remove_laser(lasers, &num_lasers, i);
+        if (laser->pos0.z <= SC(-200.0)) {
+            remove_laser(ctx->lasers, &ctx->num_lasers, i);
             i--;
         }
     }
 }
 
-static void update_trail(void) {
+static GAME_SIM void update_trail(GameContext* ctx) {
+    OPC_FUNC();
     for (int i = 0; i < MAX_TRAILS; i++) {
-        Trail* trail = &trails[i];
-        if (trail->pos0.z >= F16(150.0)) {
-            init_single_trail(trail, F16(-150.0));
+        Trail* trail = &ctx->trails[i];
+        if (trail->pos0.z >= SC(150.0)) {
+            init_single_trail(ctx, trail, SC(-150.0));
         }
         vec3_copy(&trail->pos1, &trail->pos0);
-        trail->pos0.z += trail->spd;
+        trail->pos0.z = RANGE_FIX("trail_z", trail->pos0.z + trail->spd);
     }
 
     for (int i = 0; i < MAX_BGS; i++) {
-        Background* bg = &bgs[i];
-        bg->pos.z += fix16_mul(bg->spd, game_spd);
-        if (bg->pos.z >= F16(400.0)) {
-            init_single_bg(bg, F16(-400.0));
+        Background* bg = &ctx->bgs[i];
+        bg->pos.z = RANGE_FIX("bg_z", bg->pos.z + sc_mul(bg->spd, ctx->game_spd));
+        if (bg->pos.z >= SC(400.0)) {
+            init_single_bg(ctx, bg, SC(-400.0));
         }
     }
 }
 
-static void update_collisions(void) {
+static GAME_SIM void update_collisions(GameContext* ctx) {
+    OPC_FUNC();
     int laser_idx = 0;
-    int nme_idx = num_enemies - 1;
+    int nme_idx = ctx->num_enemies - 1;
 
-    while (laser_idx < num_lasers && nme_idx >= 0) {
-        Vec3* laser_pos0 = &lasers[laser_idx].pos0;
-        Vec3* laser_pos1 = &lasers[laser_idx].pos1;
-        Enemy* nme = &enemies[nme_idx];
-        fix16_t nme_z = nme->pos.z;
+    while (laser_idx < ctx->num_lasers && nme_idx >= 0) {
+        Vec3* laser_pos0 = &ctx->lasers[laser_idx].pos0;
+        Vec3* laser_pos1 = &ctx->lasers[laser_idx].pos1;
+        Enemy* nme = &ctx->enemies[nme_idx];
+        scalar_t nme_z = nme->pos.z;
 
         if (nme_z > laser_pos1->z) {
             laser_idx++;
         } else {
             if (nme->life > 0 && nme_z >= laser_pos0->z) {
-                fix16_t dx = fix16_mul(laser_pos0->x - nme->pos.x, F16(0.2));
-                fix16_t dy = fix16_mul(laser_pos0->y - nme->pos.y, F16(0.2));
+                scalar_t dx = sc_mul(laser_pos0->x - nme->pos.x, SC(0.2));
+                scalar_t dy = sc_mul(laser_pos0->y - nme->pos.y, SC(0.2));
 
-                fix16_t radius = nme_radius[nme->type - 1];
-                if (fix16_mul(dx, dx) + fix16_mul(dy, dy) <= fix16_mul(fix16_mul(radius, radius), F16(0.04))) {
+                scalar_t radius = nme_radius[nme->type - 1];
+                if (sc_mul(dx, dx) + sc_mul(dy, dy) <= sc_mul(sc_mul(radius, radius), SC(0.04))) {
                     nme->life--;
                     if (nme->life == 0) {
                         nme->hit_t = -1;
-                        sfx(2, 1);
-                        score += nme_score[nme->type - 1];
+                        sfx(ctx, 2, 1);
+                        ctx->score += nme_score[nme->type - 1];
                     } else {
                         vec3_copy(&nme->hit_pos, laser_pos0);
                         nme->hit_t = 0;
-                        sfx(5, 1);
+                        sfx(ctx, 5, 1);
                     }
-                    remove_laser(lasers, &num_lasers, laser_idx);
+                    remove_laser(ctx->lasers, &ctx->num_lasers, laser_idx);
                     continue;
                 }
             }
@@ -1304,593 +1708,679 @@ static void update_collisions(void) {
     }
 }
 
+// Project the ship and enemies and pick the auto-aim target. Runs at the
+// end of game_update(): aim_z and tgt_pos feed the next frame's lasers, so
+// the simulation must not depend on whether the frame is drawn.
+static GAME_SIM void transform_vert(GameContext* ctx) {
+    OPC_FUNC();
+    PHASE_BEGIN(PHASE_TRANSFORM);
+    for (int i = 0; i < ship_mesh.num_vertices; i++) {
+        transform_pos(&ctx->ship_proj[i], &ctx->ship_mat, &ship_mesh.vertices[i]);
+    }
+
+    Vec3 aim_pos = {ctx->ship_x, ctx->ship_y - SC(1.5), ctx->aim_z};
+    transform_pos(&ctx->aim_proj, &ctx->cam_mat, &aim_pos);
+
+    scalar_t auto_aim_dist = SC(30.0);
+    ctx->tgt_pos = NULL;
+    ctx->aim_life_ratio = SC(-1.0);
+
+    if (ctx->cur_mode == 2) {
+        scalar_t aim_x = ctx->aim_proj.x;
+        scalar_t aim_y = ctx->aim_proj.y;
+
+        for (int i = 0; i < ctx->num_enemies; i++) {
+            Enemy* nme = &ctx->enemies[i];
+
+            Mat34 nme_mat, nme_rot_x, nme_rot_z, inv_nme_mat;
+            mat_translation(&nme_mat, nme->pos.x, nme->pos.y, nme->pos.z);
+            mat_rotx(&nme_rot_x, nme->rot_x);
+            mat_mul(&nme_mat, &nme_mat, &nme_rot_x);
+            mat_rotz(&nme_rot_z, nme->rot_y);
+            mat_mul(&nme_mat, &nme_mat, &nme_rot_z);
+
+            mat_transpose_rot(&inv_nme_mat, &nme_mat);
+            mat_mul_vec(&nme->light_dir, &inv_nme_mat, &ctx->light_dir);
+
+            Mat34 final_nme_mat;
+            mat_mul(&final_nme_mat, &ctx->cam_mat, &nme_mat);
+
+            Mesh* mesh = &nme_meshes[nme->type - 1];
+            for (int j = 0; j < mesh->num_vertices; j++) {
+                transform_pos(&nme->proj[j], &final_nme_mat, &mesh->vertices[j]);
+            }
+
+            if (nme->life > 0) {
+                scalar_t ddx = sc_mul(nme->proj[0].x - aim_x, SC(0.1));
+                scalar_t ddy = sc_mul(nme->proj[0].y - aim_y, SC(0.1));
+                scalar_t sqr_dist = sc_mul(ddx, ddx) + sc_mul(ddy, ddy);
+                if (sqr_dist < auto_aim_dist) {
+                    auto_aim_dist = sqr_dist;
+                    ctx->tgt_pos = &nme->pos;
+                    scalar_t laser_t = sc_mul(-ctx->game_spd, sc_div(nme->pos.z, SC(5.0)));
+                    ctx->interp_tgt_pos.x = nme->pos.x + sc_mul(nme->spd.x, laser_t);
+                    ctx->interp_tgt_pos.y = nme->pos.y + sc_mul(nme->spd.y, laser_t);
+                    ctx->interp_tgt_pos.z = sc_min(0, nme->pos.z + sc_mul(nme->spd.z, laser_t));
+                    if (nme->type != 1) {
+                        ctx->aim_life_ratio = sc_div(sc_from_int(nme->life), sc_from_int(nme_life[nme->type - 1]));
+                    }
+                }
+            }
+        }
+    }
+
+    scalar_t tgt_z = SC(-200.0);
+    if (ctx->tgt_pos) tgt_z = ctx->tgt_pos->z;
+    ctx->aim_z += sc_mul(tgt_z - ctx->aim_z, SC(0.2));
+
+    Vec3 star_pos = {sc_mul(ctx->light_mat.m[2], SC(100.0)), sc_mul(ctx->light_mat.m[6], SC(100.0)), sc_mul(ctx->light_mat.m[10], SC(100.0))};
+    transform_pos(&ctx->star_proj, &ctx->ship_pos_mat, &star_pos);
+    PHASE_END(PHASE_TRANSFORM);
+}
+
 // ============================================================================
 // Main Update
 // ============================================================================
 
-static void game_update(void) {
-    fix16_t dx = 0, dy = 0;
-    if (btn(0)) dx -= fix16_one;
-    if (btn(1)) dx += fix16_one;
-    if (btn(2)) dy -= fix16_one;
-    if (btn(3)) dy += fix16_one;
+// game_update() is split at the trail pass so a batch of contexts can be
+// stepped in lockstep, one stage at a time (host/hyperspace_batch.h).
+
+// Input, mode logic, camera and ship matrices
+static GAME_SIM void update_ship(GameContext* ctx) {
+    OPC_FUNC();
+    scalar_t dx = 0, dy = 0;
+    if (btn(ctx, 0)) dx -= SC_ONE;
+    if (btn(ctx, 1)) dx += SC_ONE;
+    if (btn(ctx, 2)) dy -= SC_ONE;
+    if (btn(ctx, 3)) dy += SC_ONE;
 
-    if (cur_mode == 2) {
-        global_t += F16(0.033);
-        game_spd = fix16_one + fix16_mul(global_t, F16(0.002));
+    if (ctx->cur_mode == 2) {
+        ctx->global_t = RANGE_FIX("global_t", ctx->global_t + SC(0.033));
+        ctx->game_spd = RANGE_FIX("game_spd", SC_ONE + sc_mul(ctx->global_t, SC(0.002)));
 
-        if (dx == 0 && dy == 0) cur_thrust = 0;
-        else cur_thrust = fix16_min(FIX_HALF, cur_thrust + F16(0.1));
-        fix16_t mul_spd = cur_thrust;
+        if (dx == 0 && dy == 0) ctx->cur_thrust = 0;
+        else ctx->cur_thrust = sc_min(FIX_HALF, ctx->cur_thrust + SC(0.1));
+        scalar_t mul_spd = ctx->cur_thrust;
 
-        if (non_inverted_y != 0) dy = -dy;
+        if (ctx->non_inverted_y != 0) dy = -dy;
 
-        if (barrel_cur_t > F16(-1.0) || life <= 0) {
+        if (ctx->barrel_cur_t > SC(-1.0) || ctx->life <= 0) {
             dx = 0;
             dy = 0;
         }
 
-        if (btn(5) && dx != 0 && barrel_cur_t < 0) {
-            sfx(1, 0);
-            barrel_cur_t = 0;
-            barrel_dir = dx > 0 ? 1 : -1;
+        if (btn(ctx, 5) && dx != 0 && ctx->barrel_cur_t < 0) {
+            sfx(ctx, 1, 0);
+            ctx->barrel_cur_t = 0;
+            ctx->barrel_dir = dx > 0 ? 1 : -1;
         }
 
-        if (barrel_cur_t >= 0) {
-            barrel_cur_t += fix16_one;
-            if (barrel_cur_t >= 0) {
-                dx = fix16_from_int(barrel_dir * 9);
+        if (ctx->barrel_cur_t >= 0) {
+            ctx->barrel_cur_t += SC_ONE;
+            if (ctx->barrel_cur_t >= 0) {
+                dx = sc_from_int(ctx->barrel_dir * 9);
                 dy = 0;
-                mul_spd = F16(0.1);
-                if (barrel_cur_t > F16(5.0)) {
-                    barrel_cur_t = F16(-20.0);
+                mul_spd = SC(0.1);
+                if (ctx->barrel_cur_t > SC(5.0)) {
+                    ctx->barrel_cur_t = SC(-20.0);
                 }
             }
         }
 
-        if (fix16_abs(ship_x) > F16(100.0)) dx = fix16_mul(-sgn_fix(ship_x), F16(0.4));
-        if (fix16_abs(ship_y) > F16(100.0)) dy = fix16_mul(-sgn_fix(ship_y), F16(0.4));
+        if (sc_abs(ctx->ship_x) > SC(100.0)) dx = sc_mul(-sgn_fix(ctx->ship_x), SC(0.4));
+        if (sc_abs(ctx->ship_y) > SC(100.0)) dy = sc_mul(-sgn_fix(ctx->ship_y), SC(0.4));
 
-        ship_spd_x += fix16_mul(dx, mul_spd);
-        ship_spd_y += fix16_mul(dy, mul_spd);
+        ctx->ship_spd_x += sc_mul(dx, mul_spd);
+        ctx->ship_spd_y += sc_mul(dy, mul_spd);
 
-        roll_f -= fix16_mul(F16(0.003), dx);
-        pitch_f += fix16_mul(F16(0.0008), dy);
+        ctx->roll_f -= sc_mul(SC(0.003), dx);
+        ctx->pitch_f += sc_mul(SC(0.0008), dy);
 
-        ship_spd_x = fix16_mul(ship_spd_x, F16(0.85));
-        ship_spd_y = fix16_mul(ship_spd_y, F16(0.85));
+        ctx->ship_spd_x = sc_mul(ctx->ship_spd_x, SC(0.85));
+        ctx->ship_spd_y = sc_mul(ctx->ship_spd_y, SC(0.85));
 
-        ship_x += ship_spd_x;
-        ship_y += ship_spd_y;
+        ctx->ship_x = RANGE_FIX("ship_pos", ctx->ship_x + RANGE_FIX("ship_spd", ctx->ship_spd_x));
+        ctx->ship_y = RANGE_FIX("ship_pos", ctx->ship_y + RANGE_FIX("ship_spd", ctx->ship_spd_y));
 
-        cam_x = fix16_mul(F16(1.05), ship_x);
-        cam_y = ship_y + F16(11.5);
+        ctx->cam_x = sc_mul(SC(1.05), ctx->ship_x);
+        ctx->cam_y = ctx->ship_y + SC(11.5);
 
-        if (hit_t != -1) {
-            cam_x += sym_random_fix(FIX_TWO);
-            cam_y += sym_random_fix(FIX_TWO);
-        } else if (life <= 0) {
-            hit_t = 0;
-            vec3_set(&hit_pos, ship_x, ship_y, 0);
-            sfx(2, 1);
+        if (ctx->hit_t != -1) {
+            ctx->cam_x += sym_random_fix(ctx, FIX_TWO);
+            ctx->cam_y += sym_random_fix(ctx, FIX_TWO);
+        } else if (ctx->life <= 0) {
+            ctx->hit_t = 0;
+            vec3_set(&ctx->hit_pos, ctx->ship_x, ctx->ship_y, 0);
+            sfx(ctx, 2, 1);
         }
 
-        cam_angle_z = fix16_mul(cam_x, F16(0.0005));
-        cam_angle_x = fix16_mul(cam_y, F16(0.0003));
+        ctx->cam_angle_z = sc_mul(ctx->cam_x, SC(0.0005));
+        ctx->cam_angle_x = sc_mul(ctx->cam_y, SC(0.0003));
 
         // Sequencer
-        if (waiting_nme_clear) {
-            if (nb_nme_ship == 0) {
-                next_sequencer_t = 0;
-                waiting_nme_clear = false;
+        if (ctx->waiting_nme_clear) {
+            if (ctx->nb_nme_ship == 0) {
+                ctx->next_sequencer_t = 0;
+                ctx->waiting_nme_clear = false;
             } else {
-                next_sequencer_t = F16(32767.0);
+                ctx->next_sequencer_t = SC(32767.0);
             }
         }
 
-        if (global_t >= next_sequencer_t) {
-            int value = sget(cur_sequencer_x, cur_sequencer_y);
-            cur_sequencer_x++;
-            if (cur_sequencer_x > 127) {
-                cur_sequencer_x = 96;
-                cur_sequencer_y++;
+        if (ctx->global_t >= ctx->next_sequencer_t) {
+            int value = sget(ctx->cur_sequencer_x, ctx->cur_sequencer_y);
+            ctx->cur_sequencer_x++;
+            if (ctx->cur_sequencer_x > 127) {
+                ctx->cur_sequencer_x = 96;
+                ctx->cur_sequencer_y++;
             }
 
-            if (value == 1) spawn_nme_ship(3);
-            else if (value == 13) { spawn_nme_ship(4); sfx(6, 2); }
-            else if (value == 2) spawn_nme_ship(2);
-            else if (value == 6) { spawn_asteroids = true; asteroid_mul_t = fix16_one; }
-            else if (value == 7) { spawn_asteroids = true; asteroid_mul_t = FIX_HALF; }
-            else if (value == 5) spawn_asteroids = false;
-            else if (value == 10) next_sequencer_t = global_t + fix16_one;
-            else if (value == 9) next_sequencer_t = global_t + F16(10.0);
-            else if (value == 11) waiting_nme_clear = true;
-            else { cur_sequencer_x = 96; cur_sequencer_y = 96; }
+            if (value == 1) spawn_nme_ship(ctx, 3);
+            else if (value == 13) { spawn_nme_ship(ctx, 4); sfx(ctx, 6, 2); }
+            else if (value == 2) spawn_nme_ship(ctx, 2);
+            else if (value == 6) { ctx->spawn_asteroids = true; ctx->asteroid_mul_t = SC_ONE; }
+            else if (value == 7) { ctx->spawn_asteroids = true; ctx->asteroid_mul_t = FIX_HALF; }
+            else if (value == 5) ctx->spawn_asteroids = false;
+            else if (value == 10) ctx->next_sequencer_t = ctx->global_t + SC_ONE;
+            else if (value == 9) ctx->next_sequencer_t = ctx->global_t + SC(10.0);
+            else if (value == 11) ctx->waiting_nme_clear = true;
+            else { ctx->cur_sequencer_x = 96; ctx->cur_sequencer_y = 96; }
         }
 
-    } else if (cur_mode == 0) {
-        if (dx == 0 && dy == 0) dx = F16(-0.25);
-        cam_angle_z += fix16_mul(dx, F16(0.007));
-        cam_angle_x -= fix16_mul(dy, F16(0.007));
-
-        if (btnp(5)) {
-            cur_mode = 3;
-            manual_fire = dget(1);
-            non_inverted_y = dget(2);
-            sound_enabled = dget(3);
-            if (sound_enabled == 0 && dget(3) == 0) sound_enabled = 1;
+    } else if (ctx->cur_mode == 0) {
+        if (dx == 0 && dy == 0) dx = SC(-0.25);
+        ctx->cam_angle_z += sc_mul(dx, SC(0.007));
+        ctx->cam_angle_x -= sc_mul(dy, SC(0.007));
+
+        if (btnp(ctx, 5)) {
+            ctx->cur_mode = 3;
+            ctx->manual_fire = dget(ctx, 1);
+            ctx->non_inverted_y = dget(ctx, 2);
+            ctx->sound_enabled = dget(ctx, 3);
+            if (ctx->sound_enabled == 0 && dget(ctx, 3) == 0) ctx->sound_enabled = 1;
         }
-    } else if (cur_mode == 3) {
-        cam_angle_z -= F16(0.00175);
+    } else if (ctx->cur_mode == 3) {
+        ctx->cam_angle_z -= SC(0.00175);
 
-        if (btnp(0) || btnp(1)) {
-            manual_fire = 1 - manual_fire;
-            dset(1, manual_fire);
+        if (btnp(ctx, 0) || btnp(ctx, 1)) {
+            ctx->manual_fire = 1 - ctx->manual_fire;
+            dset(ctx, 1, ctx->manual_fire);
         }
-        if (btnp(2) || btnp(3)) {
-            non_inverted_y = 1 - non_inverted_y;
-            dset(2, non_inverted_y);
+        if (btnp(ctx, 2) || btnp(ctx, 3)) {
+            ctx->non_inverted_y = 1 - ctx->non_inverted_y;
+            dset(ctx, 2, ctx->non_inverted_y);
         }
-        if (btnp(4)) {
-            sound_enabled = 1 - sound_enabled;
-            dset(3, sound_enabled);
+        if (btnp(ctx, 4)) {
+            ctx->sound_enabled = 1 - ctx->sound_enabled;
+            dset(ctx, 3, ctx->sound_enabled);
         }
 
-        if (btnp(5)) {
-            src_cam_angle_z = normalize_angle(cam_angle_z);
-            src_cam_angle_x = normalize_angle(cam_angle_x);
-            src_cam_x = cam_x;
-            src_cam_y = cam_y;
+        if (btnp(ctx, 5)) {
+            ctx->src_cam_angle_z = normalize_angle(ctx->cam_angle_z);
+            ctx->src_cam_angle_x = normalize_angle(ctx->cam_angle_x);
+            ctx->src_cam_x = ctx->cam_x;
+            ctx->src_cam_y = ctx->cam_y;
 
-            dst_cam_x = fix16_mul(F16(1.05), ship_x);
-            dst_cam_y = ship_y + F16(11.5);
-            dst_cam_angle_z = fix16_mul(dst_cam_x, F16(0.0005));
-            dst_cam_angle_x = fix16_mul(dst_cam_y, F16(0.0003));
+            ctx->dst_cam_x = sc_mul(SC(1.05), ctx->ship_x);
+            ctx->dst_cam_y = ctx->ship_y + SC(11.5);
+            ctx->dst_cam_angle_z = sc_mul(ctx->dst_cam_x, SC(0.0005));
+            ctx->dst_cam_angle_x = sc_mul(ctx->dst_cam_y, SC(0.0003));
 
-            Vec3 src = {src_cam_x, src_cam_y, F16(26.0)};
-            Vec3 dst = {dst_cam_x, dst_cam_y, F16(22.5)};
+            Vec3 src = {ctx->src_cam_x, ctx->src_cam_y, SC(26.0)};
+            Vec3 dst = {ctx->dst_cam_x, ctx->dst_cam_y, SC(22.5)};
             Vec3 diff = vec3_minus(&src, &dst);
-            fix16_t len = vec3_length(&diff);
-            interpolation_spd = (len > F16(0.01)) ? fix16_div(F16(0.25), len) : fix16_one;
-            interpolation_ratio = 0;
-            cur_mode = 1;
+            scalar_t len = vec3_length(&diff);
+            ctx->interpolation_spd = (len > SC(0.01)) ? sc_div(SC(0.25), len) : SC_ONE;
+            ctx->interpolation_ratio = 0;
+            ctx->cur_mode = 1;
         }
     } else {
-        interpolation_ratio += interpolation_spd;
+        ctx->interpolation_ratio += ctx->interpolation_spd;
 
-        if (interpolation_ratio >= fix16_one) {
-            cur_mode = 2;
-            score = 0;
+        if (ctx->interpolation_ratio >= SC_ONE) {
+            ctx->cur_mode = 2;
+            ctx->score = 0;
         } else {
-            fix16_t smoothed_ratio = smoothstep(interpolation_ratio);
-            cam_x = src_cam_x + fix16_mul(smoothed_ratio, dst_cam_x - src_cam_x);
-            cam_y = src_cam_y + fix16_mul(smoothed_ratio, dst_cam_y - src_cam_y);
-            cam_depth = F16(22.5) + fix16_mul(smoothed_ratio, F16(3.5));
-            cam_angle_z = src_cam_angle_z + fix16_mul(smoothed_ratio, dst_cam_angle_z - src_cam_angle_z);
-            cam_angle_x = src_cam_angle_x + fix16_mul(smoothed_ratio, dst_cam_angle_x - src_cam_angle_x);
+            scalar_t smoothed_ratio = smoothstep(ctx->interpolation_ratio);
+            ctx->cam_x = ctx->src_cam_x + sc_mul(smoothed_ratio, ctx->dst_cam_x - ctx->src_cam_x);
+            ctx->cam_y = ctx->src_cam_y + sc_mul(smoothed_ratio, ctx->dst_cam_y - ctx->src_cam_y);
+            ctx->cam_depth = SC(22.5) + sc_mul(smoothed_ratio, SC(3.5));
+            ctx->cam_angle_z = ctx->src_cam_angle_z + sc_mul(smoothed_ratio, ctx->dst_cam_angle_z - ctx->src_cam_angle_z);
+            ctx->cam_angle_x = ctx->src_cam_angle_x + sc_mul(smoothed_ratio, ctx->dst_cam_angle_x - ctx->src_cam_angle_x);
         }
     }
 
-    bool old_laser_on = laser_on;
-    laser_on = (cur_mode != 2 && btn(4)) ||
-               ((btn(4) || (manual_fire != 1 && tgt_pos)) && barrel_cur_t < 0 && hit_t == -1);
+    bool old_laser_on = ctx->laser_on;
+    ctx->laser_on = (ctx->cur_mode != 2 && btn(ctx, 4)) ||
+               ((btn(ctx, 4) || (ctx->manual_fire != 1 && ctx->tgt_pos)) && ctx->barrel_cur_t < 0 && ctx->hit_t == -1);
 
-    if (laser_on != old_laser_on) {
-        if (laser_on) sfx(0, 0); else sfx(-2, 0);
+    if (ctx->laser_on != old_laser_on) {
+        if (ctx->laser_on) sfx(ctx, 0, 0); else sfx(ctx, -2, 0);
     }
 
     // Build camera matrix
     Mat34 trans, rot;
-    mat_translation(&trans, 0, 0, -cam_depth);
-    mat_rotx(&rot, cam_angle_x);
-    mat_mul(&cam_mat, &trans, &rot);
-    mat_roty(&rot, cam_angle_z);
-    mat_mul(&cam_mat, &cam_mat, &rot);
-    mat_translation(&trans, -cam_x, -cam_y, 0);
-    mat_mul(&cam_mat, &cam_mat, &trans);
+    mat_translation(&trans, 0, 0, -ctx->cam_depth);
+    mat_rotx(&rot, ctx->cam_angle_x);
+    mat_mul(&ctx->cam_mat, &trans, &rot);
+    mat_roty(&rot, ctx->cam_angle_z);
+    mat_mul(&ctx->cam_mat, &ctx->cam_mat, &rot);
+    mat_translation(&trans, -ctx->cam_x, -ctx->cam_y, 0);
+    mat_mul(&ctx->cam_mat, &ctx->cam_mat, &trans);
 
     // Roll/pitch noise
-    cur_noise_t += fix16_one;
-    fix16_t noise_attenuation = fix16_cos(fix16_mul(mid_fix(F16(-0.25), fix16_mul(roll_angle, F16(1.2)), F16(0.25)), FIX_TWO_PI));
+    ctx->cur_noise_t += SC_ONE;
+    scalar_t noise_attenuation = sc_cos(sc_mul(mid_fix(SC(-0.25), sc_mul(ctx->roll_angle, SC(1.2)), SC(0.25)), FIX_TWO_PI));
 
-    if (cur_noise_t > tgt_noise_t) {
-        old_noise_roll = cur_noise_roll;
-        old_noise_pitch = cur_noise_pitch;
-        cur_noise_t = 0;
+    if (ctx->cur_noise_t > ctx->tgt_noise_t) {
+        ctx->old_noise_roll = ctx->cur_noise_roll;
+        ctx->old_noise_pitch = ctx->cur_noise_pitch;
+        ctx->cur_noise_t = 0;
 
-        fix16_t new_roll_sign = -sgn_fix(cur_noise_roll);
-        if (new_roll_sign == 0) new_roll_sign = fix16_one;
+        scalar_t new_roll_sign = -sgn_fix(ctx->cur_noise_roll);
+        if (new_roll_sign == 0) new_roll_sign = SC_ONE;
 
-        cur_noise_roll = fix16_mul(new_roll_sign, F16(0.01) + rnd_fix(F16(0.03)));
-        tgt_noise_t = fix16_mul(fix16_mul(fix16_mul(F16(60.0) + rnd_fix(F16(40.0)), noise_attenuation), fix16_abs(cur_noise_roll - old_noise_roll)), F16(10.0));
-        cur_noise_pitch = sym_random_fix(F16(0.01));
+        ctx->cur_noise_roll = sc_mul(new_roll_sign, SC(0.01) + rnd_fix(ctx, SC(0.03)));
+        ctx->tgt_noise_t = sc_mul(sc_mul(sc_mul(SC(60.0) + rnd_fix(ctx, SC(40.0)), noise_attenuation), sc_abs(ctx->cur_noise_roll - ctx->old_noise_roll)), SC(10.0));
+        ctx->cur_noise_pitch = sym_random_fix(ctx, SC(0.01));
     }
 
-    fix16_t noise_ratio = (tgt_noise_t > 0) ? smoothstep(fix16_div(cur_noise_t, tgt_noise_t)) : 0;
+    scalar_t noise_ratio = (ctx->tgt_noise_t > 0) ? smoothstep(sc_div(ctx->cur_noise_t, RANGE_FIX("tgt_noise_t", ctx->tgt_noise_t))) : 0;
+
+    ctx->roll_f -= sc_mul(ctx->roll_angle, SC(0.02));
+    ctx->roll_spd = sc_mul(ctx->roll_spd, SC(0.8)) + ctx->roll_f;
+    ctx->roll_angle += ctx->roll_spd;
 
-    roll_f -= fix16_mul(roll_angle, F16(0.02));
-    roll_spd = fix16_mul(roll_spd, F16(0.8)) + roll_f;
-    roll_angle += roll_spd;
+    ctx->pitch_f -= sc_mul(ctx->pitch_angle, SC(0.02));
+    ctx->pitch_spd = sc_mul(ctx->pitch_spd, SC(0.8)) + ctx->pitch_f;
+    ctx->pitch_angle += ctx->pitch_spd;
 
-    pitch_f -= fix16_mul(pitch_angle, F16(0.02));
-    pitch_spd = fix16_mul(pitch_spd, F16(0.8)) + pitch_f;
-    pitch_angle += pitch_spd;
+    ctx->roll_f = 0;
+    ctx->pitch_f = 0;
 
-    roll_f = 0;
-    pitch_f = 0;
+    scalar_t noise_roll = sc_mul(noise_attenuation, ctx->old_noise_roll + sc_mul(noise_ratio, ctx->cur_noise_roll - ctx->old_noise_roll));
+    scalar_t noise_pitch = sc_mul(noise_attenuation, ctx->old_noise_pitch + sc_mul(noise_ratio, ctx->cur_noise_pitch - ctx->old_noise_pitch));
 
-    fix16_t noise_roll = fix16_mul(noise_attenuation, old_noise_roll + fix16_mul(noise_ratio, cur_noise_roll - old_noise_roll));
-    fix16_t noise_pitch = fix16_mul(noise_attenuation, old_noise_pitch + fix16_mul(noise_ratio, cur_noise_pitch - old_noise_pitch));
+    ctx->roll_angle = normalize_angle(ctx->roll_angle);
 
-    roll_angle = normalize_angle(roll_angle);
+    mat_translation(&ctx->ship_pos_mat, ctx->ship_x, ctx->ship_y, 0);
+    mat_rotx(&rot, normalize_angle(ctx->pitch_angle + noise_pitch));
+    mat_mul(&ctx->ship_mat, &ctx->ship_pos_mat, &rot);
+    mat_rotz(&rot, normalize_angle(ctx->roll_angle + noise_roll));
+    mat_mul(&ctx->ship_mat, &ctx->ship_mat, &rot);
 
-    mat_translation(&ship_pos_mat, ship_x, ship_y, 0);
-    mat_rotx(&rot, normalize_angle(pitch_angle + noise_pitch));
-    mat_mul(&ship_mat, &ship_pos_mat, &rot);
-    mat_rotz(&rot, normalize_angle(roll_angle + noise_roll));
-    mat_mul(&ship_mat, &ship_mat, &rot);
+    mat_transpose_rot(&ctx->inv_ship_mat, &ctx->ship_mat);
+}
 
-    mat_transpose_rot(&inv_ship_mat, &ship_mat);
+// Enemies, lasers, collisions, light and fade; runs after update_trail()
+static GAME_SIM void update_world(GameContext* ctx) {
+    OPC_FUNC();
+    Mat34 rot;
 
-    update_trail();
-    if (cur_mode == 2) {
-        update_enemies();
+    if (ctx->cur_mode == 2) {
+        update_enemies(ctx);
     }
 
-    update_lasers();
-    update_nme_lasers();
-    update_collisions();
+    update_lasers(ctx);
+    update_nme_lasers(ctx);
+    update_collisions(ctx);
 
-    if (hit_t != -1) {
-        hit_t++;
-        if (hit_t > 15) hit_t = -1;
+    if (ctx->hit_t != -1) {
+        ctx->hit_t++;
+        if (ctx->hit_t > 15) ctx->hit_t = -1;
     }
 
-    mat_mul(&ship_mat, &cam_mat, &ship_mat);
-    mat_mul(&ship_pos_mat, &cam_mat, &ship_pos_mat);
+    mat_mul(&ctx->ship_mat, &ctx->cam_mat, &ctx->ship_mat);
+    mat_mul(&ctx->ship_pos_mat, &ctx->cam_mat, &ctx->ship_pos_mat);
 
-    mat_rotx(&light_mat, F16(0.14));
-    mat_roty(&rot, F16(0.34) + fix16_mul(global_t, F16(0.003)));
-    mat_mul(&light_mat, &light_mat, &rot);
-    Vec3 light_src = {0, 0, -fix16_one};
-    mat_mul_vec(&light_dir, &light_mat, &light_src);
+    mat_rotx(&ctx->light_mat, SC(0.14));
+    mat_roty(&rot, SC(0.34) + sc_mul(ctx->global_t, SC(0.003)));
+    mat_mul(&ctx->light_mat, &ctx->light_mat, &rot);
+    Vec3 light_src = {0, 0, -SC_ONE};
+    mat_mul_vec(&ctx->light_dir, &ctx->light_mat, &light_src);
 
-    mat_mul_vec(&ship_light_dir, &inv_ship_mat, &light_dir);
+    mat_mul_vec(&ctx->ship_light_dir, &ctx->inv_ship_mat, &ctx->light_dir);
 
-    if (fade_ratio >= 0) {
-        if (cur_mode == 2) fade_ratio += FIX_TWO;
-        else fade_ratio -= FIX_TWO;
-        if (fade_ratio >= F16(100.0)) {
-            if (score > best_score) {
-                best_score = score;
-                dset(0, best_score);
+    if (ctx->fade_ratio >= 0) {
+        if (ctx->cur_mode == 2) ctx->fade_ratio += FIX_TWO;
+        else ctx->fade_ratio -= FIX_TWO;
+        if (ctx->fade_ratio >= SC(100.0)) {
+            if (ctx->score > ctx->best_score) {
+                ctx->best_score = ctx->score;
+                dset(ctx, 0, ctx->best_score);
             }
-            init_main();
+            init_main(ctx);
         }
     }
 }
 
+static void game_update(GameContext* ctx) {
+    OPC_FUNC();
+    GAME_OVERLAY(GAME_OVERLAY_SIM);
+    PHASE_BEGIN(PHASE_UPDATE);
+    update_ship(ctx);
+    update_trail(ctx);
+    update_world(ctx);
+    PHASE_END(PHASE_UPDATE);
+    transform_vert(ctx);
+}
+
 // ============================================================================
 // Rendering
 // ============================================================================
 
-static void transform_vert(void) {
-    for (int i = 0; i < ship_mesh.num_vertices; i++) {
-        transform_pos(&ship_mesh.projected[i], &ship_mat, &ship_mesh.vertices[i]);
-    }
-
-    Vec3 aim_pos = {ship_x, ship_y - F16(1.5), aim_z};
-    transform_pos(&aim_proj, &cam_mat, &aim_pos);
+// Screen-space sprites: the background layer is behind the 3D scene, the
+// foreground layer in front of it
+enum { OBJ_LAYER_BG, OBJ_LAYER_FG };
 
-    fix16_t auto_aim_dist = F16(30.0);
-    tgt_pos = NULL;
-    aim_life_ratio = F16(-1.0);
-
-    if (cur_mode == 2) {
-        fix16_t aim_x = aim_proj.x;
-        fix16_t aim_y = aim_proj.y;
-
-        for (int i = 0; i < num_enemies; i++) {
-            Enemy* nme = &enemies[i];
-
-            Mat34 nme_mat, nme_rot_x, nme_rot_z, inv_nme_mat;
-            mat_translation(&nme_mat, nme->pos.x, nme->pos.y, nme->pos.z);
-            mat_rotx(&nme_rot_x, nme->rot_x);
-            mat_mul(&nme_mat, &nme_mat, &nme_rot_x);
-            mat_rotz(&nme_rot_z, nme->rot_y);
-            mat_mul(&nme_mat, &nme_mat, &nme_rot_z);
-
-            mat_transpose_rot(&inv_nme_mat, &nme_mat);
-            mat_mul_vec(&nme->light_dir, &inv_nme_mat, &light_dir);
-
-            Mat34 final_nme_mat;
-            mat_mul(&final_nme_mat, &cam_mat, &nme_mat);
-
-            Mesh* mesh = &nme_meshes[nme->type - 1];
-            for (int j = 0; j < mesh->num_vertices; j++) {
-                transform_pos(&nme->proj[j], &final_nme_mat, &mesh->vertices[j]);
-            }
-
-            if (nme->life > 0) {
-                fix16_t ddx = fix16_mul(nme->proj[0].x - aim_x, F16(0.1));
-                fix16_t ddy = fix16_mul(nme->proj[0].y - aim_y, F16(0.1));
-                fix16_t sqr_dist = fix16_mul(ddx, ddx) + fix16_mul(ddy, ddy);
-                if (sqr_dist < auto_aim_dist) {
-                    auto_aim_dist = sqr_dist;
-                    tgt_pos = &nme->pos;
-                    fix16_t laser_t = fix16_mul(-game_spd, fix16_div(nme->pos.z, F16(5.0)));
-                    interp_tgt_pos.x = nme->pos.x + fix16_mul(nme->spd.x, laser_t);
-                    interp_tgt_pos.y = nme->pos.y + fix16_mul(nme->spd.y, laser_t);
-                    interp_tgt_pos.z = fix16_min(0, nme->pos.z + fix16_mul(nme->spd.z, laser_t));
-                    if (nme->type != 1) {
-                        aim_life_ratio = fix16_div(fix16_from_int(nme->life), fix16_from_int(nme_life[nme->type - 1]));
-                    }
-                }
-            }
-        }
-    }
-
-    fix16_t tgt_z = F16(-200.0);
-    if (tgt_pos) tgt_z = tgt_pos->z;
-    aim_z += fix16_mul(tgt_z - aim_z, F16(0.2));
+#ifdef PLATFORM_OBJ
+static void platform_obj(GameContext* ctx, int layer, int n, int x, int y, int w, int h);
+static void platform_obj_life_bar(GameContext* ctx, int x, int y, int life);
+#define layer_spr(ctx, layer, n, x, y, w, h) platform_obj((ctx), (layer), (n), (x), (y), (w), (h))
+// The sun is not in the framebuffer: it shows where nothing was drawn
+#define SUN_UNCOVERED(p8, x, y) (pget((p8), (x), (y)) == 0)
+#else
+#define layer_spr(ctx, layer, n, x, y, w, h) spr(&(ctx)->p8, (n), (x), (y), (w), (h))
+#define SUN_UNCOVERED(p8, x, y) (pget((p8), (x), (y)) == 7)
+#endif
 
-    Vec3 star_pos = {fix16_mul(light_mat.m[2], F16(100.0)), fix16_mul(light_mat.m[6], F16(100.0)), fix16_mul(light_mat.m[10], F16(100.0))};
-    transform_pos(&star_proj, &ship_pos_mat, &star_pos);
+// Empty bar, then the full one clipped to 15 pixels per life
+static GAME_DRAW void draw_life_bar(GameContext* ctx, int x, int y) {
+#ifdef PLATFORM_OBJ
+    platform_obj_life_bar(ctx, x, y, ctx->life);
+#else
+    Pico8* p8 = &ctx->p8;
+    spr(p8, 16, x, y, 8, 1);
+    clip_set(p8, x, y, ctx->life * 15, 7);
+    spr(p8, 0, x, y, 8, 1);
+    clip_reset(p8);
+#endif
 }
 
-static void draw_explosion(Vec3* proj, fix16_t size) {
-    fix16_t invz = proj->z;
-    int col = explosion_color[get_random_idx(4)];
-    circfill(fix16_to_int(proj->x + fix16_mul(sym_random_fix(fix16_mul(size, FIX_HALF)), invz)),
-             fix16_to_int(proj->y + fix16_mul(sym_random_fix(fix16_mul(size, FIX_HALF)), invz)),
-             fix16_to_int(fix16_mul(invz, size + rnd_fix(size))), col);
+static GAME_DRAW void draw_explosion(GameContext* ctx, Vec3* proj, scalar_t size) {
+    OPC_FUNC();
+    scalar_t invz = proj->z;
+    int col = explosion_color[get_random_idx_fx(ctx, 4)];
+    circfill(&ctx->p8, sc_to_int(proj->x + sc_mul(sym_random_fx(ctx, sc_mul(size, FIX_HALF)), invz)),
+             sc_to_int(proj->y + sc_mul(sym_random_fx(ctx, sc_mul(size, FIX_HALF)), invz)),
+             sc_to_int(sc_mul(invz, size + rnd_fx(ctx, size))), col);
 }
 
-static void print_3d(const char* str, int x, int y) {
-    print_str(str, x + 2, y + 2, 1);
-    print_str(str, x + 1, y + 1, 13);
-    print_str(str, x, y, 7);
+static GAME_DRAW void print_3d(GameContext* ctx, const char* str, int x, int y) {
+    print_str(ctx, str, x + 2, y + 2, 1);
+    print_str(ctx, str, x + 1, y + 1, 13);
+    print_str(ctx, str, x, y, 7);
 }
 
-static void draw_lasers(Laser* in_lasers, int count, int col) {
+static GAME_DRAW void draw_lasers(GameContext* ctx, Laser* in_lasers, int count, int col) {
+    OPC_FUNC();
+    Pico8* p8 = &ctx->p8;
     Vec3 p0, p1;
-    color(col);
+    color(p8, col);
 
     for (int i = 0; i < count; i++) {
         Laser* laser = &in_lasers[i];
-        transform_pos(&p0, &cam_mat, &laser->pos0);
-        transform_pos(&p1, &cam_mat, &laser->pos1);
+        transform_pos(&p0, &ctx->cam_mat, &laser->pos0);
+        transform_pos(&p1, &ctx->cam_mat, &laser->pos1);
 
         if (p0.z > 0 && p1.z > 0) {
-            line(fix16_to_int(p0.x), fix16_to_int(p0.y), fix16_to_int(p1.x), fix16_to_int(p1.y), col);
+            line(p8, sc_to_int(p0.x), sc_to_int(p0.y), sc_to_int(p1.x), sc_to_int(p1.y), col);
         }
     }
 }
 
-static void set_ngn_pal(void) {
+static void set_ngn_pal(GameContext* ctx) {
+    OPC_FUNC();
+    Pico8* p8 = &ctx->p8;
     // Fast wrap-around without division
-    ngn_col_idx += fix16_one;
-    if (ngn_col_idx >= F16(4.0)) ngn_col_idx -= F16(4.0);
-    ngn_laser_col_idx += F16(0.2);
-    if (ngn_laser_col_idx >= F16(4.0)) ngn_laser_col_idx -= F16(4.0);
+    ctx->ngn_col_idx += SC_ONE;
+    if (ctx->ngn_col_idx >= SC(4.0)) ctx->ngn_col_idx -= SC(4.0);
+    ctx->ngn_laser_col_idx += SC(0.2);
+    if (ctx->ngn_laser_col_idx >= SC(4.0)) ctx->ngn_laser_col_idx -= SC(4.0);
 
-    pal(12, ngn_colors[fix16_to_int(ngn_col_idx)]);
+    pal(p8, 12, ngn_colors[sc_to_int(ctx->ngn_col_idx)]);
 
-    int index = fix16_to_int(ngn_laser_col_idx);
-    pal(8, laser_ngn_colors[index]);
-    pal(14, laser_ngn_colors[(index + 1) & 3]);
-    pal(15, laser_ngn_colors[(index + 2) & 3]);
+    int index = sc_to_int(ctx->ngn_laser_col_idx);
+    pal(p8, 8, laser_ngn_colors[index]);
+    pal(p8, 14, laser_ngn_colors[(index + 1) & 3]);
+    pal(p8, 15, laser_ngn_colors[(index + 2) & 3]);
 }
 
-static void draw_lens_flare(void) {
-    int sx = fix16_to_int(star_proj.x);
-    int sy = fix16_to_int(star_proj.y);
+static GAME_DRAW void draw_lens_flare(GameContext* ctx) {
+    OPC_FUNC();
+    Pico8* p8 = &ctx->p8;
+    int sx = sc_to_int(ctx->star_proj.x);
+    int sy = sc_to_int(ctx->star_proj.y);
     if (sx < 0 || sx >= SCREEN_WIDTH || sy < 0 || sy >= SCREEN_HEIGHT) return;
-    if (pget(sx, sy) != 7) return;
+    if (!SUN_UNCOVERED(p8, sx, sy)) return;
 
-    fix16_t vx = FIX_SCREEN_CENTER - star_proj.x;
-    fix16_t vy = FIX_SCREEN_CENTER - star_proj.y;
+    scalar_t vx = FIX_SCREEN_CENTER_X - ctx->star_proj.x;
+    scalar_t vy = FIX_SCREEN_CENTER_Y - ctx->star_proj.y;
 
-    fix16_t factors[] = {F16(-0.3), F16(0.4), F16(0.5), F16(0.9), F16(1.0)};
+    scalar_t factors[] = {SC(-0.3), SC(0.4), SC(0.5), SC(0.9), SC(1.0)};
     // Sprite indices for each flare element (swapped 0 and 1 to match original)
     int sprite_map[] = {1, 0, 2, 3, 2};
 
     // Use flare_offset to alternate between sprite sets 40-43 and 44-47
-    int base_sprite = 40 + flare_offset * 4;
+    int base_sprite = 40 + ctx->flare_offset * 4;
 
     for (int i = 0; i < 5; i++) {
-        int px = fix16_to_int(FIX_SCREEN_CENTER + fix16_mul(vx, factors[i]));
-        int py = fix16_to_int(FIX_SCREEN_CENTER + fix16_mul(vy, factors[i]));
+        int px = sc_to_int(FIX_SCREEN_CENTER_X + sc_mul(vx, factors[i]));
+        int py = sc_to_int(FIX_SCREEN_CENTER_Y + sc_mul(vy, factors[i]));
         // Center the 8x8 sprite by offsetting -4
-        spr(base_sprite + sprite_map[i], px - 4, py - 4, 1, 1);
+        layer_spr(ctx, OBJ_LAYER_FG, base_sprite + sprite_map[i], px - 4, py - 4, 1, 1);
     }
 
-    flare_offset = 1 - flare_offset;
+    ctx->flare_offset = 1 - ctx->flare_offset;
 }
 
-static bool star_visible;
-
-static void game_draw(void) {
+static GAME_DRAW void draw_scene(GameContext* ctx) {
+    Pico8* p8 = &ctx->p8;
     Vec3 p0, p1;
 
-    cls();
-    transform_vert();
+    PHASE_BEGIN(PHASE_DRAW_CLEAR);
+    cls(p8);
+    PHASE_END(PHASE_DRAW_CLEAR);
 
     // Draw backgrounds
+    PHASE_BEGIN(PHASE_DRAW_BG);
     for (int i = 0; i < MAX_BGS; i++) {
-        Background* bg = &bgs[i];
-        transform_pos(&p0, &ship_pos_mat, &bg->pos);
+        Background* bg = &ctx->bgs[i];
+        transform_pos(&p0, &ctx->ship_pos_mat, &bg->pos);
 
         if (p0.z > 0) {
             int index = bg->index;
             if (index > 0) {
-                spr(index + 16 * flr_fix(rnd_fix(FIX_TWO)), fix16_to_int(p0.x), fix16_to_int(p0.y), 1, 1);
+                layer_spr(ctx, OBJ_LAYER_BG, index + 16 * flr_fix(rnd_fx(ctx, FIX_TWO)), sc_to_int(p0.x), sc_to_int(p0.y), 1, 1);
             } else {
                 int col = 7;
-                if (rnd_fix(fix16_one) > FIX_HALF) col = -index;
-                pset(fix16_to_int(p0.x), fix16_to_int(p0.y), col);
+                if (rnd_fx(ctx, SC_ONE) > FIX_HALF) col = -index;
+                pset(p8, sc_to_int(p0.x), sc_to_int(p0.y), col);
             }
         }
     }
 
     // Draw sun
-    star_visible = star_proj.z > 0 && star_proj.x >= 0 && star_proj.x < F16(SCREEN_WIDTH) &&
-                   star_proj.y >= 0 && star_proj.y < F16(SCREEN_HEIGHT);
+    bool star_visible = ctx->star_proj.z > 0 && ctx->star_proj.x >= 0 && ctx->star_proj.x < SC(SCREEN_WIDTH) &&
+                   ctx->star_proj.y >= 0 && ctx->star_proj.y < SC(SCREEN_HEIGHT);
     if (star_visible) {
-        int index = 32 + flr_fix(rnd_fix(F16(4.0))) * 2;
-        spr(index, fix16_to_int(star_proj.x) - 7, fix16_to_int(star_proj.y) - 7, 2, 2);
+        int index = 32 + flr_fix(rnd_fx(ctx, SC(4.0))) * 2;
+        layer_spr(ctx, OBJ_LAYER_BG, index, sc_to_int(ctx->star_proj.x) - 7, sc_to_int(ctx->star_proj.y) - 7, 2, 2);
     }
 
+    PHASE_END(PHASE_DRAW_BG);
+
     // Draw trails
-    fix16_t trail_color_coef = F16(2.25);  // 0.45 * 5
+    PHASE_BEGIN(PHASE_DRAW_TRAILS);
+    scalar_t trail_color_coef = SC(2.25);  // 0.45 * 5
     for (int i = 0; i < MAX_TRAILS; i++) {
-        Trail* trail = &trails[i];
-        transform_pos(&p0, &cam_mat, &trail->pos0);
-        transform_pos(&p1, &cam_mat, &trail->pos1);
+        Trail* trail = &ctx->trails[i];
+        transform_pos(&p0, &ctx->cam_mat, &trail->pos0);
+        transform_pos(&p1, &ctx->cam_mat, &trail->pos1);
 
         if (p0.z > 0 && p1.z > 0) {
-            int index = fix16_to_int(mid_fix(fix16_from_int(trail->col), fix16_div(trail_color_coef, p0.z) + fix16_one, F16(5.0))) - 1;
+            int index = sc_to_int(mid_fix(sc_from_int(trail->col), sc_div(trail_color_coef, p0.z) + SC_ONE, SC(5.0))) - 1;
             if (index < 0) index = 0;
             if (index > 4) index = 4;
-            line(fix16_to_int(p0.x), fix16_to_int(p0.y), fix16_to_int(p1.x), fix16_to_int(p1.y), trail_color[index]);
+            line(p8, sc_to_int(p0.x), sc_to_int(p0.y), sc_to_int(p1.x), sc_to_int(p1.y), trail_color[index]);
         }
     }
 
+    PHASE_END(PHASE_DRAW_TRAILS);
+
     // Draw enemies
-    if (cur_mode == 2) {
-        for (int i = num_enemies - 1; i >= 0; i--) {
-            Enemy* nme = &enemies[i];
+    PHASE_BEGIN(PHASE_DRAW_ENEMIES);
+    if (ctx->cur_mode == 2) {
+        for (int i = ctx->num_enemies - 1; i >= 0; i--) {
+            Enemy* nme = &ctx->enemies[i];
             Mesh* mesh = &nme_meshes[nme->type - 1];
-            cur_tex = &nme_tex[nme->type - 1];
+            ctx->cur_tex = &nme_tex[nme->type - 1];
 
             if (nme->life < 0 || nme->hit_t > -1) {
                 if (nme->life < 0) {
-                    fix16_t ratio = FIX_HALF + fix16_div(F16(15.0) + fix16_from_int(nme->life), F16(30.0));
-                    fix16_t size = fix16_mul(fix16_mul(ratio, nme_radius[nme->type - 1]), F16(0.8));
-                    if (((-nme->life) & 1) == 0) cur_tex = &nme_tex_hit;
+                    scalar_t ratio = FIX_HALF + sc_div(SC(15.0) + sc_from_int(nme->life), SC(30.0));
+                    scalar_t size = sc_mul(sc_mul(ratio, nme_radius[nme->type - 1]), SC(0.8));
+                    if (((-nme->life) & 1) == 0) ctx->cur_tex = &nme_tex_hit;
                     for (int j = 0; j < 3; j++) {
-                        int idx = get_random_idx(mesh->num_vertices);
-                        draw_explosion(&nme->proj[idx], size);
+                        int idx = get_random_idx_fx(ctx, mesh->num_vertices);
+                        draw_explosion(ctx, &nme->proj[idx], size);
                     }
                 } else {
-                    fix16_t ratio = FIX_HALF + fix16_div(F16(6.0) - fix16_from_int(nme->hit_t), F16(12.0));
-                    fix16_t size = fix16_mul(ratio, F16(3.0));
-                    if ((nme->hit_t & 1) == 0) cur_tex = &nme_tex_hit;
-                    transform_pos(&p0, &cam_mat, &nme->hit_pos);
-                    draw_explosion(&p0, size);
+                    scalar_t ratio = FIX_HALF + sc_div(SC(6.0) - sc_from_int(nme->hit_t), SC(12.0));
+                    scalar_t size = sc_mul(ratio, SC(3.0));
+                    if ((nme->hit_t & 1) == 0) ctx->cur_tex = &nme_tex_hit;
+                    transform_pos(&p0, &ctx->cam_mat, &nme->hit_pos);
+                    draw_explosion(ctx, &p0, size);
                 }
             }
 
-            if (cur_tex) {
-                t_light_dir = &nme->light_dir;
+            if (ctx->cur_tex) {
+                ctx->t_light_dir = &nme->light_dir;
+                OVD_MESH(OVD_MESH_NME(nme->type));
                 for (int j = 0; j < mesh->num_triangles; j++) {
-                    rasterize_tri(j, mesh->triangles, nme->proj);
+                    rasterize_tri(ctx, j, mesh->triangles, nme->proj);
                 }
+                OVD_MESH(OVD_MESH_2D);
             }
         }
     }
 
+    PHASE_END(PHASE_DRAW_ENEMIES);
+
     // Draw enemy lasers
-    draw_lasers(nme_lasers, num_nme_lasers, 8);
+    PHASE_BEGIN(PHASE_DRAW_LASERS);
+    draw_lasers(ctx, ctx->nme_lasers, ctx->num_nme_lasers, 8);
 
     // Draw player lasers
-    draw_lasers(lasers, num_lasers, 11);
+    draw_lasers(ctx, ctx->lasers, ctx->num_lasers, 11);
 
     // Draw aim
-    if (cur_mode == 2) {
+    if (ctx->cur_mode == 2) {
         int idx = 97;
-        if (tgt_pos) {
+        if (ctx->tgt_pos) {
             idx = 98;
-            transform_pos(&p0, &cam_mat, tgt_pos);
-            transform_pos(&p1, &cam_mat, &interp_tgt_pos);
+            transform_pos(&p0, &ctx->cam_mat, ctx->tgt_pos);
+            transform_pos(&p1, &ctx->cam_mat, &ctx->interp_tgt_pos);
 
-            int x = fix16_to_int(p0.x) - 2;
-            int y = fix16_to_int(p0.y) - 4;
+            int x = sc_to_int(p0.x) - 2;
+            int y = sc_to_int(p0.y) - 4;
 
-            spr(113, x - 1, y + 1, 1, 1);
-            spr(114, fix16_to_int(p1.x) - 3, fix16_to_int(p1.y) - 3, 1, 1);
+            layer_spr(ctx, OBJ_LAYER_FG, 113, x - 1, y + 1, 1, 1);
+            layer_spr(ctx, OBJ_LAYER_FG, 114, sc_to_int(p1.x) - 3, sc_to_int(p1.y) - 3, 1, 1);
 
-            if (aim_life_ratio >= 0) {
-                rectfill(x, y, x + 4, y, 3);
-                rectfill(x, y, x + fix16_to_int(fix16_mul(aim_life_ratio, F16(4.0))), y, 11);
+            if (ctx->aim_life_ratio >= 0) {
+                rectfill(p8, x, y, x + 4, y, 3);
+                rectfill(p8, x, y, x + sc_to_int(sc_mul(ctx->aim_life_ratio, SC(4.0))), y, 11);
             }
         }
-        spr(idx, fix16_to_int(aim_proj.x) - 3, fix16_to_int(aim_proj.y) - 3, 1, 1);
+        layer_spr(ctx, OBJ_LAYER_FG, idx, sc_to_int(ctx->aim_proj.x) - 3, sc_to_int(ctx->aim_proj.y) - 3, 1, 1);
     }
 
+    PHASE_END(PHASE_DRAW_LASERS);
+
     // Draw ship
-    if (laser_spawned) cur_tex = &ship_tex_laser_lit;
-    else cur_tex = &ship_tex;
-
-    sort_tris(ship_mesh.triangles, ship_mesh.num_triangles, ship_mesh.projected);
-
-    if (hit_t != -1) {
-        transform_pos(&p0, &cam_mat, &hit_pos);
-        draw_explosion(&p0, F16(3.0));
-
-        if ((hit_t & 1) == 0) {
-            pal(0, 2);
-            pal(1, 8);
-            pal(6, 14);
-            pal(9, 8);
-            pal(10, 14);
-            pal(13, 14);
+    PHASE_BEGIN(PHASE_DRAW_SHIP);
+    if (ctx->laser_spawned) ctx->cur_tex = &ship_tex_laser_lit;
+    else ctx->cur_tex = &ship_tex;
+
+    sort_tris(ctx->ship_tris, ship_mesh.num_triangles, ctx->ship_proj);
+
+    if (ctx->hit_t != -1) {
+        transform_pos(&p0, &ctx->cam_mat, &ctx->hit_pos);
+        draw_explosion(ctx, &p0, SC(3.0));
+
+        if ((ctx->hit_t & 1) == 0) {
+            pal(p8, 0, 2);
+            pal(p8, 1, 8);
+            pal(p8, 6, 14);
+            pal(p8, 9, 8);
+            pal(p8, 10, 14);
+            pal(p8, 13, 14);
         }
     }
 
-    t_light_dir = &ship_light_dir;
-    set_ngn_pal();
+    ctx->t_light_dir = &ctx->ship_light_dir;
+    set_ngn_pal(ctx);
 
+    OVD_MESH(OVD_MESH_SHIP);
     for (int i = 0; i < ship_mesh.num_triangles; i++) {
-        rasterize_tri(i, ship_mesh.triangles, ship_mesh.projected);
+        rasterize_tri(ctx, i, ctx->ship_tris, ctx->ship_proj);
     }
+    OVD_MESH(OVD_MESH_2D);
 
-    pal_reset();
+    pal_reset(p8);
+    PHASE_END(PHASE_DRAW_SHIP);
 
     // Draw lens flare
+    PHASE_BEGIN(PHASE_DRAW_HUD);
     if (star_visible) {
-        draw_lens_flare();
+        draw_lens_flare(ctx);
     }
 
     // Draw HUD
-    if (cur_mode == 2) {
+    if (ctx->cur_mode == 2) {
         char buf[32];
-        snprintf(buf, sizeof(buf), "SCORE %d", score);
-        print_3d(buf, 1, 1);
-
-        spr(16, 59, 1, 8, 1);  // Adjusted for 120px
-        clip_set(59, 1, life * 15, 7);  // Adjusted
-        spr(0, 59, 1, 8, 1);
-        clip_reset();
-    } else if (cur_mode != 1) {
-        print_3d("HYPERSPACE by J-Fry", 1, 1);
-        print_3d("PicoSystem Port by itsmeterada", 1, 8);
-        if (cur_mode == 0) {
-            print_3d("PRESS X TO START", 30, 95);
-            if (score > 0) {
+        snprintf(buf, sizeof(buf), "SCORE %d", ctx->score);
+        print_3d(ctx, buf, 1, 1);
+
+        // Life bar, right-aligned
+        draw_life_bar(ctx, SCREEN_WIDTH - 61, 1);
+    } else if (ctx->cur_mode != 1) {
+        print_3d(ctx, "HYPERSPACE by J-Fry", 1, 1);
+        print_3d(ctx, GAME_PORT_CREDIT, 1, 8);
+        if (ctx->cur_mode == 0) {
+            print_3d(ctx, GAME_START_PROMPT, GAME_START_PROMPT_X, SCREEN_HEIGHT - 25);
+            if (ctx->score > 0) {
                 char buf[32];
-                snprintf(buf, sizeof(buf), "LAST %d", score);
-                print_3d(buf, 1, 105);
+                snprintf(buf, sizeof(buf), "LAST %d", ctx->score);
+                print_3d(ctx, buf, 1, SCREEN_HEIGHT - 15);
             }
             char buf[32];
-            snprintf(buf, sizeof(buf), "BEST %d", best_score);
-            print_3d(buf, 1, 112);
+            snprintf(buf, sizeof(buf), "BEST %d", ctx->best_score);
+            print_3d(ctx, buf, 1, SCREEN_HEIGHT - 8);
         } else {
-            print_3d("PRESS X TO START", 30, 50);
-            print_3d("ARROWS:OPT", 30, 60);
+            print_3d(ctx, GAME_START_PROMPT, GAME_START_PROMPT_X, SCREEN_HEIGHT / 2 - 10);
+            print_3d(ctx, "ARROWS:OPT", GAME_START_PROMPT_X, SCREEN_HEIGHT / 2);
             const char* option_str[] = {"AUTO", "MANUAL", "INV Y", "NORM Y", "SND OFF", "SND ON"};
-            spr(99, 1, 98, 1, 2);
-            print_3d(option_str[manual_fire], 9, 98);
-            print_3d(option_str[non_inverted_y + 2], 9, 105);
-            print_3d(option_str[sound_enabled + 4], 9, 112);
+            spr(p8, 99, 1, SCREEN_HEIGHT - 22, 1, 2);
+            print_3d(ctx, option_str[ctx->manual_fire], 9, SCREEN_HEIGHT - 22);
+            print_3d(ctx, option_str[ctx->non_inverted_y + 2], 9, SCREEN_HEIGHT - 15);
+            print_3d(ctx, option_str[ctx->sound_enabled + 4], 9, SCREEN_HEIGHT - 8);
         }
     }
 
     // Fade effect
-    if (fade_ratio > 0) {
-        Vec3 center = {FIX_SCREEN_CENTER, FIX_SCREEN_CENTER, fix16_one};
-        draw_explosion(&center, fade_ratio);
+    if (ctx->fade_ratio > 0) {
+        Vec3 center = {FIX_SCREEN_CENTER_X, FIX_SCREEN_CENTER_Y, SC_ONE};
+        draw_explosion(ctx, &center, ctx->fade_ratio);
     }
+    PHASE_END(PHASE_DRAW_HUD);
+}
+
+static void game_draw(GameContext* ctx) {
+    OPC_FUNC();
+    GAME_OVERLAY(GAME_OVERLAY_DRAW);
+    draw_scene(ctx);
 }
 
 // ============================================================================
@@ -1908,6 +2398,11 @@ static void load_embedded_data(void) {
     memcpy(spritesheet, hyperspace_spritesheet, sizeof(spritesheet));
     // Copy embedded map data (mesh definitions)
     memcpy(map_memory, hyperspace_map, sizeof(map_memory));
+    raster_span_init();
+
+    // Meshes and textures are shared by every game context
+    init_ship();
+    init_nme();
 }
 
 // ============================================================================
@@ -1915,19 +2410,55 @@ static void load_embedded_data(void) {
 // ============================================================================
 
 // Note: update_buttons() should be implemented by the platform
-// Note: Platform should set rnd_state before calling game_init()
-
-static void game_init(void) {
-    pal_reset();
+// Note: load_embedded_data() must run once before the first game_init()
+
+// Start a game in ctx with the RNG seeded from seed
+static void game_init(GameContext* ctx, uint32_t seed) {
+    Pico8* p8 = &ctx->p8;
+    memset(ctx, 0, sizeof(GameContext));
+    pico8_init(p8, seed);
+    ctx->fx_rnd_state = ~seed;
+
+    ctx->cam_angle_z = SC(-0.4);
+    ctx->cam_depth = SC(22.5);
+    ctx->life = 4;
+    ctx->game_spd = SC_ONE;
+    ctx->hit_t = -1;
+    ctx->barrel_cur_t = SC(-1.0);
+    ctx->aim_z = SC(-200.0);
+    ctx->aim_life_ratio = SC(-1.0);
+    ctx->fade_ratio = SC(-1.0);
+    ctx->manual_fire = 1;  // Default to MANUAL mode (AUTO off)
+    ctx->sound_enabled = 1;  // Sound on by default
+    ctx->cur_laser_side = -1;
+    ctx->asteroid_mul_t = SC_ONE;
+    ctx->cur_sequencer_x = 96;
+    ctx->cur_sequencer_y = 96;
+
+    ctx->ship_tris = (Triangle*)malloc(ship_mesh.num_triangles * sizeof(Triangle));
+    memcpy(ctx->ship_tris, ship_mesh.triangles, ship_mesh.num_triangles * sizeof(Triangle));
+    ctx->ship_proj = (Vec3*)calloc(ship_mesh.num_vertices, sizeof(Vec3));
+
+    pal_reset(p8);
 
     // Load persistent data from flash
-    load_cart_data();
+    load_cart_data(p8);
 
-    init_main();
-    init_ship();
-    init_nme();
-    init_trail();
-    init_bg();
+    init_main(ctx);
+    init_trail(ctx);
+    init_bg(ctx);
+}
+
+// Release the buffers owned by ctx
+static void game_destroy(GameContext* ctx) {
+    for (int i = 0; i < ctx->num_enemies; i++) {
+        free(ctx->enemies[i].proj);
+    }
+    ctx->num_enemies = 0;
+    free(ctx->ship_tris);
+    free(ctx->ship_proj);
+    ctx->ship_tris = NULL;
+    ctx->ship_proj = NULL;
 }
 
 #endif // HYPERSPACE_GAME_H
@@ -0,0 +1,131 @@
+/*
+ * Hyperspace Math Backend
+ *
+ * The core computes in scalar_t, through the macros and functions below,
+ * so the number format is a compile-time choice:
+ * - default: Q16.16 fixed point (libfixmath). Bit-exact everywhere; the
+ *   GBA backends, the batch stepper (host/hyperspace_batch.h) and the
+ *   OPCOUNT_BUILD/RANGE_BUILD instrumentation are written for it.
+ * - MATH_FLOAT: single-precision float, for targets with an FPU such as
+ *   the RP2350's Cortex-M33, where a multiply is one cycle and a divide
+ *   14 instead of a libfixmath call. Without an FPU (RP2040, the RP2350's
+ *   Hazard3 cores) it runs on soft-float and is slower than fixed point.
+ *
+ * Either backend is deterministic within a target. The float build must
+ * not use -ffast-math and is compiled with -ffp-contract=off, so every
+ * build of a target rounds alike whatever the compiler inlines or fuses.
+ * The two backends differ in the low bits, so games diverge after a while;
+ * `make -C host check-math` checks that the math itself agrees within
+ * tolerance.
+ *
+ * SC(x) is a constant, SC_ONE and SC_PI are 1 and pi, and sc_*() mirror
+ * the libfixmath function of the same name, including the edge cases the
+ * core relies on: sc_to_int() rounds down, division by zero gives -32768,
+ * and conversions to int stay within the Q16.16 range. sc_to_bits() and
+ * sc_from_bits() give the 32-bit pattern for snapshots. The FIX_*
+ * constants of hyperspace_target.h are scalars in either backend.
+ */
+
+#ifndef HYPERSPACE_MATH_H
+#define HYPERSPACE_MATH_H
+
+#include <stdint.h>
+#include <string.h>
+#include "libfixmath/fixmath.h"
+
+#ifdef MATH_FLOAT
+
+#include <math.h>
+
+#define MATH_BACKEND_NAME "float"
+
+typedef float scalar_t;
+
+#define SC(x) ((float)(x))
+#define SC_ONE 1.0f
+#define SC_PI 3.14159265358979f
+
+#define sc_mul(a, b) ((a) * (b))
+#define sc_mod(a, b) fmodf((a), (b))
+#define sc_sqrt(a) sqrtf(a)
+#define sc_sin(a) sinf(a)
+#define sc_cos(a) cosf(a)
+#define sc_abs(a) fabsf(a)
+#define sc_floor(a) floorf(a)
+#define sc_from_int(i) ((float)(i))
+
+static inline scalar_t sc_div(scalar_t a, scalar_t b) {
+    return b != 0 ? a / b : -32768.0f;
+}
+
+static inline scalar_t sc_min(scalar_t a, scalar_t b) { return a < b ? a : b; }
+static inline scalar_t sc_max(scalar_t a, scalar_t b) { return a > b ? a : b; }
+
+// floor(x), clamped to the Q16.16 range; NaN gives -32768
+static inline int sc_to_int(scalar_t x) {
+    if (!(x >= -32768.0f)) return -32768;
+    if (x >= 32767.0f) return 32767;
+    int i = (int)x;
+    return i - (x < (float)i);
+}
+
+// a * frac / 65536 for a 16-bit fraction (random numbers)
+static inline scalar_t sc_mul_frac16(scalar_t a, uint32_t frac) {
+    return a * (float)frac * (1.0f / 65536.0f);
+}
+
+// x as a Q16.16 integer
+static inline int32_t sc_to_q16(scalar_t x) {
+    return (int32_t)(x * 65536.0f);
+}
+
+static inline uint32_t sc_to_bits(scalar_t x) {
+    uint32_t w;
+    memcpy(&w, &x, sizeof(w));
+    return w;
+}
+
+static inline scalar_t sc_from_bits(uint32_t w) {
+    scalar_t x;
+    memcpy(&x, &w, sizeof(x));
+    return x;
+}
+
+static inline double sc_to_double(scalar_t x) { return x; }
+
+#else
+
+#define MATH_BACKEND_NAME "fix16"
+
+typedef fix16_t scalar_t;
+
+#define SC(x) F16(x)
+#define SC_ONE fix16_one
+#define SC_PI fix16_pi
+
+// Through the fix16_* names, which the instrumentation builds wrap
+#define sc_mul(a, b) fix16_mul((a), (b))
+#define sc_div(a, b) fix16_div((a), (b))
+#define sc_mod(a, b) fix16_mod((a), (b))
+#define sc_sqrt(a) fix16_sqrt(a)
+#define sc_sin(a) fix16_sin(a)
+#define sc_cos(a) fix16_cos(a)
+#define sc_abs(a) fix16_abs(a)
+#define sc_floor(a) fix16_floor(a)
+#define sc_min(a, b) fix16_min((a), (b))
+#define sc_max(a, b) fix16_max((a), (b))
+#define sc_from_int(i) fix16_from_int(i)
+#define sc_to_int(a) fix16_to_int(a)
+
+static inline scalar_t sc_mul_frac16(scalar_t a, uint32_t frac) {
+    return (scalar_t)(((int64_t)a * frac) >> 16);
+}
+
+#define sc_to_q16(a) ((int32_t)(a))
+#define sc_to_bits(a) ((uint32_t)(a))
+#define sc_from_bits(w) ((scalar_t)(int32_t)(w))
+#define sc_to_double(a) fix16_to_dbl(a)
+
+#endif // MATH_FLOAT
+
+#endif // HYPERSPACE_MATH_H
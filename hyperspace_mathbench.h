@@ -0,0 +1,195 @@
+/*
+ * Hyperspace Math Backend Check and Benchmark
+ *
+ * mathbench_check() prints the results of the core's math on a fixed set
+ * of inputs, one "mathcheck <kind> <index> <value>" line each: the scalar
+ * operations, camera matrices built like update_ship(), every vertex of
+ * every mesh through transform_pos() at 16 placements, normalized vectors
+ * and the random sequence. The inputs are multiples of 1/256, exact in
+ * either backend, so the fixed-point and float builds can be compared line
+ * by line (`make -C host check-math`).
+ *
+ * mathbench_run() times the same operations and the rasterizer on the
+ * ship, per operation, vertex or render, for comparison between builds.
+ */
+
+#ifndef HYPERSPACE_MATHBENCH_H
+#define HYPERSPACE_MATHBENCH_H
+
+#include <stdio.h>
+
+#define MATHBENCH_FORMAT_VERSION 1
+#define MATHBENCH_VALUES 64
+#define MATHBENCH_MATS 16
+#define MATHBENCH_MESHES 5
+#define MATHBENCH_SEED 0x4D415448  // "MATH"
+
+typedef struct {
+    uint32_t (*now_us)(void);
+    int reps;               // timed passes over each operation's inputs
+} MathBenchPlatform;
+
+static Mesh* const mathbench_meshes[MATHBENCH_MESHES] = {
+    &ship_mesh, &nme_meshes[0], &nme_meshes[1], &nme_meshes[2], &nme_meshes[3],
+};
+
+// n / 256
+#define MATHBENCH_VAL(n) (sc_from_int(n) / 256)
+
+static scalar_t mathbench_a[MATHBENCH_VALUES], mathbench_b[MATHBENCH_VALUES];
+static Mat34 mathbench_cam[MATHBENCH_MATS], mathbench_obj[MATHBENCH_MATS];
+
+// Operands in about +-39 and +-7.8 (never 0), camera matrices as
+// update_ship() builds them and object placements 40 to 115 units ahead
+static void mathbench_setup(void) {
+    for (int i = 0; i < MATHBENCH_VALUES; i++) {
+        mathbench_a[i] = MATHBENCH_VAL((i * 7919) % 20001 - 10000);
+        int b = (i * 104729) % 4001 - 2000;
+        mathbench_b[i] = MATHBENCH_VAL(b ? b : 1);
+    }
+    for (int k = 0; k < MATHBENCH_MATS; k++) {
+        scalar_t ax = MATHBENCH_VAL(k * 16 - 128);
+        scalar_t az = MATHBENCH_VAL((k * 37) % 256 - 128);
+        scalar_t x = MATHBENCH_VAL((k * 389) % 5121 - 2560);
+        scalar_t y = MATHBENCH_VAL((k * 877) % 5121 - 2560);
+        Mat34 trans, rot;
+
+        mat_translation(&trans, 0, 0, -SC(22.5));
+        mat_rotx(&rot, ax);
+        mat_mul(&mathbench_cam[k], &trans, &rot);
+        mat_roty(&rot, az);
+        mat_mul(&mathbench_cam[k], &mathbench_cam[k], &rot);
+        mat_translation(&trans, -x, -y, 0);
+        mat_mul(&mathbench_cam[k], &mathbench_cam[k], &trans);
+
+        mat_translation(&mathbench_obj[k], x, y, -sc_from_int(40 + 5 * k));
+        mat_rotx(&rot, az);
+        mat_mul(&mathbench_obj[k], &mathbench_obj[k], &rot);
+        mat_rotz(&rot, ax);
+        mat_mul(&mathbench_obj[k], &mathbench_obj[k], &rot);
+    }
+}
+
+static void mathbench_print(FILE* out, const char* kind, int index, scalar_t v) {
+    fprintf(out, "mathcheck %s %d %.6f\n", kind, index, sc_to_double(v));
+}
+
+// Print every checked value; load_embedded_data() must have run
+static void mathbench_check(FILE* out) {
+    mathbench_setup();
+    fprintf(out, "mathcheck %d %s\n", MATHBENCH_FORMAT_VERSION, MATH_BACKEND_NAME);
+
+    for (int i = 0; i < MATHBENCH_VALUES; i++) {
+        scalar_t a = mathbench_a[i], b = mathbench_b[i];
+        mathbench_print(out, "mul", i, sc_mul(a, b));
+        mathbench_print(out, "div", i, sc_div(a, b));
+        mathbench_print(out, "sqrt", i, sc_sqrt(sc_abs(a)));
+        mathbench_print(out, "sin", i, sc_sin(b));
+        mathbench_print(out, "cos", i, sc_cos(b));
+        mathbench_print(out, "angle", i, normalize_angle(sc_div(a, SC(8.0))));
+        mathbench_print(out, "smooth", i, smoothstep(MATHBENCH_VAL(i * 4)));
+    }
+
+    for (int k = 0; k < MATHBENCH_MATS; k++) {
+        for (int e = 0; e < 12; e++) {
+            mathbench_print(out, "cam", k * 12 + e, mathbench_cam[k].m[e]);
+        }
+    }
+
+    int n = 0;
+    for (int m = 0; m < MATHBENCH_MESHES; m++) {
+        const Mesh* mesh = mathbench_meshes[m];
+        for (int k = 0; k < MATHBENCH_MATS; k++) {
+            for (int v = 0; v < mesh->num_vertices; v++, n++) {
+                Vec3 proj;
+                transform_pos(&proj, &mathbench_obj[k], &mesh->vertices[v]);
+                mathbench_print(out, "proj_x", n, proj.x);
+                mathbench_print(out, "proj_y", n, proj.y);
+                mathbench_print(out, "proj_z", n, proj.z);
+            }
+        }
+    }
+
+    for (int i = 0; i + 2 < MATHBENCH_VALUES; i++) {
+        Vec3 v = {mathbench_a[i], mathbench_a[i + 1], mathbench_b[i + 2]};
+        vec3_normalize(&v);
+        mathbench_print(out, "norm_x", i, v.x);
+        mathbench_print(out, "norm_y", i, v.y);
+        mathbench_print(out, "norm_z", i, v.z);
+    }
+
+    uint32_t state = MATHBENCH_SEED;
+    for (int i = 0; i < MATHBENCH_VALUES; i++) {
+        mathbench_print(out, "rnd", i, rnd_step(&state, SC(100.0)));
+    }
+}
+
+// ============================================================================
+// Timing
+// ============================================================================
+
+static volatile scalar_t mathbench_sink;
+
+// Time the statements over every input index i, plat->reps times; ns per operation
+#define MATHBENCH_TIME(plat, name, ops_per_index, ...) do { \
+        scalar_t acc_ = 0; \
+        uint32_t t0_ = (plat)->now_us(); \
+        for (int rep_ = 0; rep_ < (plat)->reps; rep_++) { \
+            for (int i = 0; i < MATHBENCH_VALUES; i++) { __VA_ARGS__; } \
+        } \
+        uint32_t us_ = (plat)->now_us() - t0_; \
+        mathbench_sink = acc_; \
+        printf("%-14s %9.2f\r\n", name, \
+               us_ * 1000.0 / ((double)(plat)->reps * MATHBENCH_VALUES * (ops_per_index))); \
+    } while (0)
+
+// Time the operations and the ship's rasterization in ctx (which is left
+// destroyed) and print ns per operation
+static void mathbench_run(GameContext* ctx, const MathBenchPlatform* plat) {
+    mathbench_setup();
+    printf("\r\nmathbench %d: backend %s, %d reps\r\n", MATHBENCH_FORMAT_VERSION, MATH_BACKEND_NAME, plat->reps);
+    printf("%-14s %9s\r\n", "operation", "ns/op");
+
+    const scalar_t* a = mathbench_a;
+    const scalar_t* b = mathbench_b;
+    MATHBENCH_TIME(plat, "mul", 1, acc_ += sc_mul(a[i], b[i]));
+    MATHBENCH_TIME(plat, "div", 1, acc_ += sc_div(a[i], b[i]));
+    MATHBENCH_TIME(plat, "sqrt", 1, acc_ += sc_sqrt(sc_abs(a[i])));
+    MATHBENCH_TIME(plat, "sin", 1, acc_ += sc_sin(b[i]));
+
+    Mat34 mat;
+    MATHBENCH_TIME(plat, "mat_mul", 1,
+                   mat_mul(&mat, &mathbench_cam[i % MATHBENCH_MATS], &mathbench_obj[i % MATHBENCH_MATS]);
+                   acc_ += mat.m[i % 12]);
+
+    // Every vertex of every mesh per index
+    int verts = 0;
+    for (int m = 0; m < MATHBENCH_MESHES; m++) verts += mathbench_meshes[m]->num_vertices;
+    MATHBENCH_TIME(plat, "transform_pos", verts,
+        for (int m = 0; m < MATHBENCH_MESHES; m++) {
+            const Mesh* mesh = mathbench_meshes[m];
+            for (int v = 0; v < mesh->num_vertices; v++) {
+                Vec3 proj;
+                transform_pos(&proj, &mathbench_obj[i % MATHBENCH_MATS], &mesh->vertices[v]);
+                acc_ += proj.x;
+            }
+        });
+
+    // The ship at each placement, lit from the camera, triangles sorted
+    // like game_draw(); ns per render
+    game_init(ctx, MATHBENCH_SEED);
+    Vec3 light = {0, 0, SC_ONE};
+    ctx->cur_tex = &ship_tex;
+    ctx->t_light_dir = &light;
+    MATHBENCH_TIME(plat, "raster ship", 1,
+        for (int v = 0; v < ship_mesh.num_vertices; v++) {
+            transform_pos(&ctx->ship_proj[v], &mathbench_obj[i % MATHBENCH_MATS], &ship_mesh.vertices[v]);
+        }
+        sort_tris(ctx->ship_tris, ship_mesh.num_triangles, ctx->ship_proj);
+        for (int t = 0; t < ship_mesh.num_triangles; t++) {
+            rasterize_tri(ctx, t, ctx->ship_tris, ctx->ship_proj);
+        });
+    game_destroy(ctx);
+}
+
+#endif // HYPERSPACE_MATHBENCH_H
@@ -0,0 +1,306 @@
+/*
+ * Hyperspace Operation Counters
+ *
+ * Host wall-clock timings say little about RP2040 cost: a 64-bit multiply
+ * is one instruction on x86 and a libgcc call on the Cortex-M0+. When
+ * built with OPCOUNT_BUILD, the game core counts the operations that
+ * dominate on the device (fix16 multiply/divide/sqrt/trig, texel fetches,
+ * pixel writes, bytes moved) per frame, per phase and per function.
+ * Multiplying the counts by a cycle table measured on the device with
+ * opc_calibrate() predicts frame time from a host run.
+ *
+ * Without OPCOUNT_BUILD every macro here compiles to nothing.
+ *
+ * This file expects libfixmath to be available; it must be included
+ * before any code that should be counted.
+ */
+
+#ifndef HYPERSPACE_OPCOUNT_H
+#define HYPERSPACE_OPCOUNT_H
+
+#include "hyperspace_phases.h"
+
+#ifdef OPCOUNT_BUILD
+
+#ifdef MATH_FLOAT
+#error "OPCOUNT_BUILD counts libfixmath calls; build it without MATH_FLOAT"
+#endif
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include "libfixmath/fixmath.h"
+
+// X(id, name, default cycles on RP2040 incl. call overhead)
+// Defaults are estimates; replace them with the table printed by
+// opc_calibrate() on the device.
+#define OPC_OPS(X) \
+    X(OPC_MUL,   "fix16_mul",  42.0f) \
+    X(OPC_DIV,   "fix16_div", 190.0f) \
+    X(OPC_SQRT,  "fix16_sqrt", 420.0f) \
+    X(OPC_TRIG,  "sin/cos",   330.0f) \
+    X(OPC_MOD,   "fix16_mod",  40.0f) \
+    X(OPC_TEXEL, "texel",       3.0f) \
+    X(OPC_PIXEL, "pixel",       4.0f) \
+    X(OPC_BYTE,  "bytes",       0.3f)
+
+#define OPC_ENUM_ENTRY(id, name, cycles) id,
+enum {
+    OPC_OPS(OPC_ENUM_ENTRY)
+    OPC_NUM_OPS
+};
+#undef OPC_ENUM_ENTRY
+
+#define OPC_MAX_FUNCS 64
+#define OPC_MAX_DEPTH 16
+#define OPC_PHASE_OTHER PHASE_COUNT  // work outside any marked phase
+
+#define OPC_NAME_ENTRY(id, name, cycles) name,
+static const char* const opc_op_names[OPC_NUM_OPS] = { OPC_OPS(OPC_NAME_ENTRY) };
+#undef OPC_NAME_ENTRY
+
+#define OPC_CYCLES_ENTRY(id, name, cycles) cycles,
+static float opc_cycles[OPC_NUM_OPS] = { OPC_OPS(OPC_CYCLES_ENTRY) };
+#undef OPC_CYCLES_ENTRY
+
+static uint32_t opc_frame_counts[OPC_NUM_OPS];
+static uint64_t opc_phase_counts[PHASE_COUNT + 1][OPC_NUM_OPS];
+static uint64_t opc_self_counts[OPC_MAX_FUNCS][OPC_NUM_OPS];
+static uint64_t opc_incl_counts[OPC_MAX_FUNCS][OPC_NUM_OPS];
+static const char* opc_func_names[OPC_MAX_FUNCS] = {"(platform)"};
+static int opc_num_funcs = 1;
+static int opc_stack[OPC_MAX_DEPTH];
+static int opc_depth = 0;
+static int opc_cur_phase = OPC_PHASE_OTHER;
+static uint32_t opc_frames = 0;
+static float opc_max_frame_cycles = 0;
+
+// Calls nested deeper than OPC_MAX_DEPTH count towards the deepest tracked one
+static inline void opc_count(int op, uint32_t n) {
+    int depth = opc_depth < OPC_MAX_DEPTH ? opc_depth : OPC_MAX_DEPTH;
+    opc_frame_counts[op] += n;
+    opc_phase_counts[opc_cur_phase][op] += n;
+    opc_self_counts[depth ? opc_stack[depth - 1] : 0][op] += n;
+    for (int i = 0; i < depth; i++) {
+        opc_incl_counts[opc_stack[i]][op] += n;
+    }
+}
+
+static inline int opc_enter(int* id, const char* name) {
+    if (*id < 0) {
+        *id = opc_num_funcs < OPC_MAX_FUNCS ? opc_num_funcs++ : 0;
+        opc_func_names[*id] = name;
+    }
+    if (opc_depth < OPC_MAX_DEPTH) opc_stack[opc_depth] = *id;
+    return opc_depth++;
+}
+
+static inline void opc_leave(int* depth) {
+    opc_depth = *depth;
+}
+
+#define OPC_COUNT(op) opc_count((op), 1)
+#define OPC_BYTES(n) opc_count(OPC_BYTE, (uint32_t)(n))
+#define OPC_PHASE_BEGIN(p) (opc_cur_phase = (p))
+#define OPC_PHASE_END(p) (opc_cur_phase = OPC_PHASE_OTHER)
+
+// Attribute everything counted until the enclosing function returns
+#define OPC_FUNC() \
+    static int opc_func_id_ = -1; \
+    int opc_saved_depth_ __attribute__((cleanup(opc_leave))) = opc_enter(&opc_func_id_, __func__)
+
+// ============================================================================
+// Counted libfixmath wrappers
+// ============================================================================
+
+static inline fix16_t opc_fix16_mul(fix16_t a, fix16_t b) { OPC_COUNT(OPC_MUL); return fix16_mul(a, b); }
+static inline fix16_t opc_fix16_div(fix16_t a, fix16_t b) { OPC_COUNT(OPC_DIV); return fix16_div(a, b); }
+static inline fix16_t opc_fix16_sqrt(fix16_t a) { OPC_COUNT(OPC_SQRT); return fix16_sqrt(a); }
+static inline fix16_t opc_fix16_sin(fix16_t a) { OPC_COUNT(OPC_TRIG); return fix16_sin(a); }
+static inline fix16_t opc_fix16_cos(fix16_t a) { OPC_COUNT(OPC_TRIG); return fix16_cos(a); }
+static inline fix16_t opc_fix16_mod(fix16_t a, fix16_t b) { OPC_COUNT(OPC_MOD); return fix16_mod(a, b); }
+
+#define fix16_mul(a, b) opc_fix16_mul(a, b)
+#define fix16_div(a, b) opc_fix16_div(a, b)
+#define fix16_sqrt(a) opc_fix16_sqrt(a)
+#define fix16_sin(a) opc_fix16_sin(a)
+#define fix16_cos(a) opc_fix16_cos(a)
+#define fix16_mod(a, b) opc_fix16_mod(a, b)
+
+// ============================================================================
+// Frames and Reporting
+// ============================================================================
+
+static float opc_predict(const uint64_t* counts, uint32_t frames) {
+    float cycles = 0;
+    for (int op = 0; op < OPC_NUM_OPS; op++) {
+        cycles += (float)counts[op] * opc_cycles[op];
+    }
+    return frames ? cycles / frames : cycles;
+}
+
+static void opc_frame_begin(void) {
+    for (int op = 0; op < OPC_NUM_OPS; op++) opc_frame_counts[op] = 0;
+}
+
+static void opc_frame_end(void) {
+    uint64_t counts[OPC_NUM_OPS];
+    for (int op = 0; op < OPC_NUM_OPS; op++) counts[op] = opc_frame_counts[op];
+    float cycles = opc_predict(counts, 1);
+    if (cycles > opc_max_frame_cycles) opc_max_frame_cycles = cycles;
+    opc_frames++;
+}
+
+static void opc_reset(void) {
+    for (int op = 0; op < OPC_NUM_OPS; op++) {
+        for (int p = 0; p <= PHASE_COUNT; p++) opc_phase_counts[p][op] = 0;
+        for (int f = 0; f < OPC_MAX_FUNCS; f++) {
+            opc_self_counts[f][op] = 0;
+            opc_incl_counts[f][op] = 0;
+        }
+    }
+    opc_frames = 0;
+    opc_max_frame_cycles = 0;
+}
+
+// Parse "mul=40,div=180,..." (op names without the fix16_ prefix also match)
+static int opc_parse_cycles(const char* spec) {
+    while (*spec) {
+        char name[16];
+        float value;
+        int len = 0;
+        if (sscanf(spec, "%15[^=]=%f%n", name, &value, &len) != 2) return -1;
+        int found = 0;
+        for (int op = 0; op < OPC_NUM_OPS; op++) {
+            const char* op_name = opc_op_names[op];
+            if (strcmp(name, op_name) == 0 ||
+                (strncmp(op_name, "fix16_", 6) == 0 && strcmp(name, op_name + 6) == 0) ||
+                (op == OPC_TRIG && strcmp(name, "trig") == 0)) {
+                opc_cycles[op] = value;
+                found = 1;
+            }
+        }
+        if (!found) return -1;
+        spec += len;
+        if (*spec == ',') spec++;
+    }
+    return 0;
+}
+
+static void opc_print_row(const char* name, const uint64_t* counts, uint32_t frames) {
+    printf("%-22s", name);
+    for (int op = 0; op < OPC_NUM_OPS; op++) {
+        printf(" %10.1f", frames ? (double)counts[op] / frames : 0.0);
+    }
+    printf(" %12.0f\r\n", opc_predict(counts, frames));
+}
+
+static void opc_print_header(const char* title) {
+    printf("%-22s", title);
+    for (int op = 0; op < OPC_NUM_OPS; op++) printf(" %10s", opc_op_names[op]);
+    printf(" %12s\r\n", "cycles");
+}
+
+// Functions sorted by predicted cycles, most expensive first
+static void opc_print_funcs(const char* title, uint64_t (*counts)[OPC_NUM_OPS], uint32_t frames) {
+    int order[OPC_MAX_FUNCS];
+    for (int i = 0; i < opc_num_funcs; i++) {
+        float cost = opc_predict(counts[i], frames);
+        int j = i - 1;
+        while (j >= 0 && opc_predict(counts[order[j]], frames) < cost) {
+            order[j + 1] = order[j];
+            j--;
+        }
+        order[j + 1] = i;
+    }
+
+    printf("\r\n");
+    opc_print_header(title);
+    for (int i = 0; i < opc_num_funcs; i++) {
+        if (opc_predict(counts[order[i]], frames) <= 0) break;
+        opc_print_row(opc_func_names[order[i]], counts[order[i]], frames);
+    }
+}
+
+// Per-frame averages by phase and by function, plus the predicted frame time
+static void opc_report(uint32_t clock_mhz) {
+    uint32_t frames = opc_frames ? opc_frames : 1;
+    uint64_t total[OPC_NUM_OPS] = {0};
+
+    printf("\r\nOperation counts: %lu frames, averages per frame\r\n", (unsigned long)opc_frames);
+    opc_print_header("phase");
+    for (int p = 0; p <= PHASE_COUNT; p++) {
+        for (int op = 0; op < OPC_NUM_OPS; op++) total[op] += opc_phase_counts[p][op];
+        opc_print_row(p < PHASE_COUNT ? phase_names[p] : "(other)", opc_phase_counts[p], frames);
+    }
+    opc_print_row("total", total, frames);
+
+    opc_print_funcs("function (self)", opc_self_counts, frames);
+    opc_print_funcs("function (inclusive)", opc_incl_counts, frames);
+
+    float avg = opc_predict(total, frames);
+    printf("\r\nCycle table:");
+    for (int op = 0; op < OPC_NUM_OPS; op++) printf(" %s=%.2f", opc_op_names[op], (double)opc_cycles[op]);
+    printf("\r\nPredicted @ %luMHz: avg %.2f ms, max %.2f ms per frame (counted ops only)\r\n",
+           (unsigned long)clock_mhz,
+           (double)(avg / (clock_mhz * 1000.0f)),
+           (double)(opc_max_frame_cycles / (clock_mhz * 1000.0f)));
+}
+
+// Measure the cycle table on the target. now_us() must be a microsecond
+// clock; the loop overhead is measured separately and subtracted.
+static void opc_calibrate(uint32_t (*now_us)(void), uint32_t clock_mhz) {
+    enum { N = 4096 };
+    static uint8_t buf[2048];
+    volatile fix16_t sink = 0;
+    volatile fix16_t a = F16(12.345), b = F16(-3.21);
+    uint32_t t0, t_loop, t;
+
+    t0 = now_us();
+    for (int i = 0; i < N; i++) sink = a + i;
+    t_loop = now_us() - t0;
+
+#define OPC_MEASURE(op, expr) \
+    t0 = now_us(); \
+    for (int i = 0; i < N; i++) sink = (expr); \
+    t = now_us() - t0; \
+    opc_cycles[op] = (float)(t > t_loop ? t - t_loop : 0) * clock_mhz / N;
+
+    OPC_MEASURE(OPC_MUL, fix16_mul(a + i, b));
+    OPC_MEASURE(OPC_DIV, fix16_div(a + i, b));
+    OPC_MEASURE(OPC_SQRT, fix16_sqrt(a + i));
+    OPC_MEASURE(OPC_TRIG, fix16_sin(a + (i << 4)));
+    OPC_MEASURE(OPC_MOD, fix16_mod(a + i, b));
+    OPC_MEASURE(OPC_TEXEL, buf[(a + i) & 2047]);
+    OPC_MEASURE(OPC_PIXEL, (buf[(a + i) & 2047] = (uint8_t)i, 0));
+#undef OPC_MEASURE
+
+    t0 = now_us();
+    for (int i = 0; i < N / 64; i++) memset(buf, i, sizeof(buf));
+    t = now_us() - t0;
+    opc_cycles[OPC_BYTE] = (float)t * clock_mhz / ((N / 64) * sizeof(buf));
+    (void)sink;
+
+    // Calibration itself must not show up in the counts
+    opc_reset();
+    printf("opc cycles:");
+    for (int op = 0; op < OPC_NUM_OPS; op++) {
+        const char* name = opc_op_names[op];
+        if (strncmp(name, "fix16_", 6) == 0) name += 6;
+        if (op == OPC_TRIG) name = "trig";
+        printf("%s%s=%.2f", op ? "," : " ", name, (double)opc_cycles[op]);
+    }
+    printf("\r\n");
+}
+
+#else
+
+#define OPC_COUNT(op) ((void)0)
+#define OPC_BYTES(n) ((void)0)
+#define OPC_PHASE_BEGIN(p) ((void)0)
+#define OPC_PHASE_END(p) ((void)0)
+#define OPC_FUNC() ((void)0)
+
+#endif // OPCOUNT_BUILD
+
+#endif // HYPERSPACE_OPCOUNT_H
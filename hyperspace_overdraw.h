@@ -0,0 +1,199 @@
+/*
+ * Hyperspace Overdraw and Fill-Rate Counters
+ *
+ * When built with OVERDRAW_BUILD, the drawing primitives count per frame
+ * and per mesh kind:
+ * - pixels written, and how many of them overwrote a pixel already drawn
+ *   since the last cls();
+ * - texels fetched and scanline spans started;
+ * - triangles drawn, and rejected at each stage of rasterize_tri(): all
+ *   vertices behind the camera, off-screen, backfacing, degenerate.
+ * Mesh kinds are set with OVD_MESH() around the triangle loops; everything
+ * else (sprites, lines, explosions, HUD) counts as "2d".
+ *
+ * With OVD_HEATMAP as well (host builds), the writes per pixel are summed
+ * over all frames and ovd_write_heatmap() saves the average as a PPM.
+ *
+ * Without OVERDRAW_BUILD every macro here compiles to nothing.
+ */
+
+#ifndef HYPERSPACE_OVERDRAW_H
+#define HYPERSPACE_OVERDRAW_H
+
+#ifdef OVERDRAW_BUILD
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#define OVD_COUNTERS(X) \
+    X(PIXEL,        "pixels")     \
+    X(OVERWRITE,    "overwrite")  \
+    X(TEXEL,        "texels")     \
+    X(SPAN,         "spans")      \
+    X(TRI_DRAWN,    "tris")       \
+    X(REJ_BEHIND,   "behind")     \
+    X(REJ_OFFSCREEN,"offscreen")  \
+    X(REJ_BACKFACE, "backface")   \
+    X(REJ_DEGENERATE,"degenerate")
+
+#define OVD_MESHES(X) \
+    X(2D,       "2d")       \
+    X(SHIP,     "ship")     \
+    X(ASTEROID, "asteroid") \
+    X(SMALL,    "small")    \
+    X(MEDIUM,   "medium")   \
+    X(BOSS,     "boss")
+
+#define OVD_ENUM(id, name) OVD_##id,
+enum { OVD_COUNTERS(OVD_ENUM) OVD_NUM_COUNTERS };
+#undef OVD_ENUM
+#define OVD_MESH_ENUM(id, name) OVD_MESH_##id,
+enum { OVD_MESHES(OVD_MESH_ENUM) OVD_NUM_MESHES };
+#undef OVD_MESH_ENUM
+
+#define OVD_NAME(id, name) name,
+static const char* const ovd_counter_names[OVD_NUM_COUNTERS] = { OVD_COUNTERS(OVD_NAME) };
+static const char* const ovd_mesh_names[OVD_NUM_MESHES] = { OVD_MESHES(OVD_NAME) };
+#undef OVD_NAME
+
+// Enemy type 1-4 to mesh kind
+#define OVD_MESH_NME(type) (OVD_MESH_ASTEROID + (type) - 1)
+
+static uint32_t ovd_frame[OVD_NUM_MESHES][OVD_NUM_COUNTERS];
+static uint64_t ovd_total[OVD_NUM_MESHES][OVD_NUM_COUNTERS];
+static uint32_t ovd_peak[OVD_NUM_MESHES][OVD_NUM_COUNTERS];
+static uint32_t ovd_frames;
+static int ovd_mesh;
+
+// Writes per pixel since the last cls()
+static uint8_t ovd_depth[SCREEN_HEIGHT][SCREEN_WIDTH];
+#ifdef OVD_HEATMAP
+static uint32_t ovd_heat[SCREEN_HEIGHT][SCREEN_WIDTH];
+#endif
+
+static inline void ovd_count(int counter) {
+    ovd_frame[ovd_mesh][counter]++;
+}
+
+static inline void ovd_pixel(int x, int y) {
+    uint8_t* d = &ovd_depth[y][x];
+    ovd_frame[ovd_mesh][OVD_PIXEL]++;
+    if (*d) ovd_frame[ovd_mesh][OVD_OVERWRITE]++;
+    if (*d < 255) (*d)++;
+}
+
+static void ovd_clear(void) {
+    memset(ovd_depth, 0, sizeof(ovd_depth));
+}
+
+#define OVD_COUNT(c) ovd_count(OVD_##c)
+#define OVD_PIXEL_AT(x, y) ovd_pixel((x), (y))
+#define OVD_CLEAR() ovd_clear()
+#define OVD_MESH(m) (ovd_mesh = (m))
+
+static void ovd_reset(void) {
+    memset(ovd_frame, 0, sizeof(ovd_frame));
+    memset(ovd_total, 0, sizeof(ovd_total));
+    memset(ovd_peak, 0, sizeof(ovd_peak));
+    memset(ovd_depth, 0, sizeof(ovd_depth));
+#ifdef OVD_HEATMAP
+    memset(ovd_heat, 0, sizeof(ovd_heat));
+#endif
+    ovd_frames = 0;
+    ovd_mesh = OVD_MESH_2D;
+}
+
+static void ovd_frame_end(void) {
+    for (int m = 0; m < OVD_NUM_MESHES; m++) {
+        for (int c = 0; c < OVD_NUM_COUNTERS; c++) {
+            uint32_t v = ovd_frame[m][c];
+            ovd_total[m][c] += v;
+            if (v > ovd_peak[m][c]) ovd_peak[m][c] = v;
+        }
+    }
+    memset(ovd_frame, 0, sizeof(ovd_frame));
+#ifdef OVD_HEATMAP
+    for (int y = 0; y < SCREEN_HEIGHT; y++) {
+        for (int x = 0; x < SCREEN_WIDTH; x++) {
+            ovd_heat[y][x] += ovd_depth[y][x];
+        }
+    }
+#endif
+    ovd_frames++;
+}
+
+// Average and peak per frame, one row per mesh kind plus the total. The
+// overdraw ratio is pixels written per pixel covered.
+static void ovd_report(FILE* out) {
+    if (!ovd_frames) return;
+    fprintf(out, "\r\noverdraw: %u frames, average (peak) per frame\r\n", (unsigned)ovd_frames);
+    fprintf(out, "%-9s", "mesh");
+    for (int c = 0; c < OVD_NUM_COUNTERS; c++) {
+        fprintf(out, " %15s", ovd_counter_names[c]);
+    }
+    fprintf(out, "\r\n");
+
+    uint64_t sum[OVD_NUM_COUNTERS] = {0};
+    for (int m = 0; m <= OVD_NUM_MESHES; m++) {
+        bool total = m == OVD_NUM_MESHES;
+        fprintf(out, "%-9s", total ? "total" : ovd_mesh_names[m]);
+        for (int c = 0; c < OVD_NUM_COUNTERS; c++) {
+            uint64_t v = total ? sum[c] : ovd_total[m][c];
+            if (!total) sum[c] += v;
+            char cell[24];
+            if (total) snprintf(cell, sizeof(cell), "%u", (unsigned)(v / ovd_frames));
+            else snprintf(cell, sizeof(cell), "%u (%u)", (unsigned)(v / ovd_frames), (unsigned)ovd_peak[m][c]);
+            fprintf(out, " %15s", cell);
+        }
+        fprintf(out, "\r\n");
+    }
+
+    uint64_t written = sum[OVD_PIXEL];
+    uint64_t covered = written - sum[OVD_OVERWRITE];
+    if (covered) {
+        fprintf(out, "overdraw %u.%02u (pixels written per pixel covered)\r\n",
+                (unsigned)(written / covered), (unsigned)(written * 100 / covered % 100));
+    }
+}
+
+#ifdef OVD_HEATMAP
+// Average writes per pixel over all frames as a binary PPM: black for none,
+// then blue, green, yellow, red at 1, 2, 3 and 4 or more writes
+static int ovd_write_heatmap(const char* path) {
+    static const uint8_t ramp[5][3] = {{0, 0, 0}, {0, 0, 255}, {0, 255, 0}, {255, 255, 0}, {255, 0, 0}};
+    FILE* f = fopen(path, "wb");
+    if (!f || !ovd_frames) {
+        if (f) fclose(f);
+        return -1;
+    }
+    fprintf(f, "P6\n%d %d\n255\n", SCREEN_WIDTH, SCREEN_HEIGHT);
+    for (int y = 0; y < SCREEN_HEIGHT; y++) {
+        for (int x = 0; x < SCREEN_WIDTH; x++) {
+            // Writes in 1/256 steps, blended between neighbouring ramp entries
+            uint32_t v = (uint32_t)((uint64_t)ovd_heat[y][x] * 256 / ovd_frames);
+            if (v > 4 * 256) v = 4 * 256;
+            int i = v >> 8, t = v & 255;
+            const uint8_t* a = ramp[i];
+            const uint8_t* b = ramp[i < 4 ? i + 1 : 4];
+            for (int k = 0; k < 3; k++) {
+                fputc((a[k] * (256 - t) + b[k] * t) >> 8, f);
+            }
+        }
+    }
+    fclose(f);
+    return 0;
+}
+#endif
+
+#else
+
+#define OVD_COUNT(c) ((void)0)
+#define OVD_PIXEL_AT(x, y) ((void)0)
+#define OVD_CLEAR() ((void)0)
+#define OVD_MESH(m) ((void)0)
+
+#endif // OVERDRAW_BUILD
+
+#endif // HYPERSPACE_OVERDRAW_H
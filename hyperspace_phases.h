@@ -0,0 +1,45 @@
+/*
+ * Hyperspace Frame Phases
+ *
+ * The frame is split into named phases so the optional instrumentation
+ * builds can attribute work to them. PHASE_BEGIN()/PHASE_END() mark a
+ * phase in the game core and the platform main loop; each instrumentation
+ * feature hooks in here, and in a normal build they compile to nothing.
+ */
+
+#ifndef HYPERSPACE_PHASES_H
+#define HYPERSPACE_PHASES_H
+
+// X(id, name)
+#define HYPERSPACE_PHASES(X) \
+    X(PHASE_INPUT,        "input") \
+    X(PHASE_UPDATE,       "update") \
+    X(PHASE_TRANSFORM,    "transform") \
+    X(PHASE_DRAW_CLEAR,   "clear") \
+    X(PHASE_DRAW_BG,      "backgrounds") \
+    X(PHASE_DRAW_TRAILS,  "trails") \
+    X(PHASE_DRAW_ENEMIES, "enemies") \
+    X(PHASE_DRAW_LASERS,  "lasers") \
+    X(PHASE_DRAW_SHIP,    "ship") \
+    X(PHASE_DRAW_HUD,     "hud") \
+    X(PHASE_FLIP,         "flip") \
+    X(PHASE_WAIT_FLIP,    "wait_flip") \
+    X(PHASE_AUDIO,        "audio")
+
+#define PHASE_ENUM_ENTRY(id, name) id,
+enum {
+    HYPERSPACE_PHASES(PHASE_ENUM_ENTRY)
+    PHASE_COUNT
+};
+#undef PHASE_ENUM_ENTRY
+
+#define PHASE_NAME_ENTRY(id, name) name,
+static const char* const phase_names[PHASE_COUNT] = {
+    HYPERSPACE_PHASES(PHASE_NAME_ENTRY)
+};
+#undef PHASE_NAME_ENTRY
+
+#define PHASE_BEGIN(p) do { OPC_PHASE_BEGIN(p); PROF_PHASE_BEGIN(p); TRACE_PHASE_BEGIN(p); } while (0)
+#define PHASE_END(p)   do { TRACE_PHASE_END(p); PROF_PHASE_END(p); OPC_PHASE_END(p); } while (0)
+
+#endif // HYPERSPACE_PHASES_H
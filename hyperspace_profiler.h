@@ -0,0 +1,215 @@
+/*
+ * Hyperspace Frame Profiler
+ *
+ * When built with PROFILE_BUILD, every PHASE_BEGIN()/PHASE_END() pair is
+ * timestamped with the platform's microsecond timer (prof_init()). For
+ * each phase, the whole frame and the profiler itself it keeps:
+ * - min/avg/max over the last PROF_WINDOW_FRAMES, shown as a bar overlay
+ *   (prof_draw_overlay());
+ * - min/avg/max and a log2 histogram over PROF_REPORT_FRAMES, printed by
+ *   prof_report() (over UART on the device).
+ *
+ * prof_toggle() switches collection and overlay at run time; while off,
+ * each marker costs one branch. The platform wraps each frame in
+ * prof_frame_begin()/prof_frame_end().
+ *
+ * Without PROFILE_BUILD every macro here compiles to nothing.
+ */
+
+#ifndef HYPERSPACE_PROFILER_H
+#define HYPERSPACE_PROFILER_H
+
+#include "hyperspace_phases.h"
+
+#ifdef PROFILE_BUILD
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#define PROF_WINDOW_FRAMES 30
+#define PROF_REPORT_FRAMES 300
+// Bucket 0 counts 0-1 us, bucket b > 0 [2^b, 2^(b+1)) us; the last is open-ended
+#define PROF_HIST_BUCKETS 16
+
+// Rows after the phases: whole frame and profiler overhead
+#define PROF_FRAME PHASE_COUNT
+#define PROF_SELF (PHASE_COUNT + 1)
+#define PROF_ROWS (PHASE_COUNT + 2)
+
+typedef struct {
+    uint32_t start;
+    uint32_t cur;           // accumulated this frame
+    uint32_t win_min, win_max, win_sum;
+    uint32_t min, avg, max; // last completed window
+    uint32_t rep_min, rep_max;
+    uint64_t rep_sum;
+    uint16_t hist[PROF_HIST_BUCKETS];
+} ProfRow;
+
+static ProfRow prof_rows[PROF_ROWS];
+static uint32_t (*prof_now)(void);
+static bool prof_enabled;
+static uint32_t prof_frame_start;
+static uint32_t prof_win_frames;
+static uint32_t prof_rep_frames;
+
+// Overlay colors per row, cycling through the PICO-8 palette
+static const uint8_t prof_colors[8] = {8, 9, 10, 11, 12, 14, 15, 6};
+
+#define PROF_PHASE_BEGIN(p) do { if (prof_enabled) prof_rows[p].start = prof_now(); } while (0)
+#define PROF_PHASE_END(p) do { if (prof_enabled) prof_rows[p].cur += prof_now() - prof_rows[p].start; } while (0)
+
+static void prof_reset_window(void) {
+    for (int i = 0; i < PROF_ROWS; i++) {
+        prof_rows[i].win_min = UINT32_MAX;
+        prof_rows[i].win_max = 0;
+        prof_rows[i].win_sum = 0;
+    }
+    prof_win_frames = 0;
+}
+
+static void prof_reset_report(void) {
+    for (int i = 0; i < PROF_ROWS; i++) {
+        ProfRow* r = &prof_rows[i];
+        r->rep_min = UINT32_MAX;
+        r->rep_max = 0;
+        r->rep_sum = 0;
+        memset(r->hist, 0, sizeof(r->hist));
+    }
+    prof_rep_frames = 0;
+}
+
+static void prof_init(uint32_t (*now_us)(void)) {
+    prof_now = now_us;
+    memset(prof_rows, 0, sizeof(prof_rows));
+    prof_reset_window();
+    prof_reset_report();
+}
+
+// Safe to call mid-frame: the frame being toggled on starts counting here
+static void prof_toggle(void) {
+    prof_enabled = !prof_enabled;
+    for (int i = 0; i < PROF_ROWS; i++) {
+        prof_rows[i].cur = 0;
+    }
+    prof_reset_window();
+    prof_reset_report();
+    prof_frame_start = prof_now();
+}
+
+static void prof_frame_begin(void) {
+    if (!prof_enabled) return;
+    prof_frame_start = prof_now();
+}
+
+static int prof_bucket(uint32_t us) {
+    int b = 0;
+    while (us > 1 && b < PROF_HIST_BUCKETS - 1) {
+        us >>= 1;
+        b++;
+    }
+    return b;
+}
+
+static void prof_record(ProfRow* r, uint32_t us) {
+    if (us < r->win_min) r->win_min = us;
+    if (us > r->win_max) r->win_max = us;
+    r->win_sum += us;
+    if (us < r->rep_min) r->rep_min = us;
+    if (us > r->rep_max) r->rep_max = us;
+    r->rep_sum += us;
+    r->hist[prof_bucket(us)]++;
+}
+
+// Close the frame: fold this frame's times into the window and report
+// statistics. Returns true when a report period is complete.
+static bool prof_frame_end(void) {
+    if (!prof_enabled) return false;
+    uint32_t t0 = prof_now();
+    prof_rows[PROF_FRAME].cur = t0 - prof_frame_start;
+
+    for (int i = 0; i < PROF_ROWS; i++) {
+        prof_record(&prof_rows[i], prof_rows[i].cur);
+        prof_rows[i].cur = 0;
+    }
+    if (++prof_win_frames == PROF_WINDOW_FRAMES) {
+        for (int i = 0; i < PROF_ROWS; i++) {
+            ProfRow* r = &prof_rows[i];
+            r->min = r->win_min;
+            r->avg = r->win_sum / PROF_WINDOW_FRAMES;
+            r->max = r->win_max;
+        }
+        prof_reset_window();
+    }
+
+    // Counted into the next frame's profiler row
+    prof_rows[PROF_SELF].cur += prof_now() - t0;
+    return ++prof_rep_frames == PROF_REPORT_FRAMES;
+}
+
+static const char* prof_row_name(int i) {
+    if (i == PROF_FRAME) return "frame";
+    if (i == PROF_SELF) return "profiler";
+    return phase_names[i];
+}
+
+// Summary of the report period, then start a new one
+static void prof_report(void) {
+    if (!prof_rep_frames) return;
+    uint64_t frame_sum = prof_rows[PROF_FRAME].rep_sum;
+
+    printf("\r\nprofile: %u frames, us (min/avg/max), %% of frame, log2 histogram (<2, 2-3, 4-7 ... us)\r\n",
+           (unsigned)prof_rep_frames);
+    for (int i = 0; i < PROF_ROWS; i++) {
+        const ProfRow* r = &prof_rows[i];
+        if (r->rep_max == 0) continue;
+        uint32_t permille = frame_sum ? (uint32_t)(r->rep_sum * 1000 / frame_sum) : 0;
+        printf("%-12s %6u %6u %6u %3u.%u%%  ", prof_row_name(i), (unsigned)r->rep_min,
+               (unsigned)(r->rep_sum / prof_rep_frames), (unsigned)r->rep_max,
+               (unsigned)(permille / 10), (unsigned)(permille % 10));
+        for (int b = 0; b < PROF_HIST_BUCKETS; b++) {
+            printf(r->hist[b] ? "%u " : ". ", (unsigned)r->hist[b]);
+        }
+        printf("\r\n");
+    }
+    prof_reset_report();
+}
+
+// One 2-pixel bar per row, scaled so the full width is PROF_BAR_SCALE_US:
+// average as the bar, min and max as white ticks. Drawn straight into the
+// framebuffer, bypassing the palette, after game_draw().
+#define PROF_BAR_SCALE_US 33333
+static void prof_draw_overlay(Pico8* p8) {
+    if (!prof_enabled) return;
+    uint32_t t0 = prof_now();
+    for (int i = 0; i < PROF_ROWS; i++) {
+        const ProfRow* r = &prof_rows[i];
+        int y = 1 + i * 3;
+        if (y + 1 >= SCREEN_HEIGHT) break;
+        int avg = (int)((uint64_t)r->avg * SCREEN_WIDTH / PROF_BAR_SCALE_US);
+        int lo = (int)((uint64_t)r->min * SCREEN_WIDTH / PROF_BAR_SCALE_US);
+        int hi = (int)((uint64_t)r->max * SCREEN_WIDTH / PROF_BAR_SCALE_US);
+        if (avg >= SCREEN_WIDTH) avg = SCREEN_WIDTH - 1;
+        if (hi >= SCREEN_WIDTH) hi = SCREEN_WIDTH - 1;
+        if (lo > hi) lo = hi;
+        uint8_t col = i == PROF_FRAME ? 7 : i == PROF_SELF ? 5 : prof_colors[i & 7];
+        for (int x = 0; x <= avg; x++) {
+            p8->screen[y][x] = col;
+            p8->screen[y + 1][x] = col;
+        }
+        p8->screen[y][lo] = 7;
+        p8->screen[y + 1][hi] = 7;
+    }
+    prof_rows[PROF_SELF].cur += prof_now() - t0;
+}
+
+#else
+
+#define PROF_PHASE_BEGIN(p) ((void)0)
+#define PROF_PHASE_END(p) ((void)0)
+
+#endif // PROFILE_BUILD
+
+#endif // HYPERSPACE_PROFILER_H
@@ -0,0 +1,208 @@
+/*
+ * Hyperspace Value-Range Profiler
+ *
+ * Everything in the core is Q16.16 fix16_t, but most values live in much
+ * smaller ranges (UVs 0-32, screen coordinates 0-120, 1/z 0-10). When
+ * built with RANGE_BUILD (host only), RANGE_FIX()/RANGE_INT() wrap a value
+ * at a variable site and record its min, max and the fractional bits it
+ * actually uses. fix16_mul/fix16_div are checked against an exact 64-bit
+ * result so real overflows are caught and attributed to the calling
+ * function. range_report() then recommends the narrowest format (int16,
+ * Q8.8, Q24.8) that holds each site losslessly, and the narrowest one
+ * that only drops fractional bits.
+ *
+ * Without RANGE_BUILD the wrappers return their argument unchanged.
+ */
+
+#ifndef HYPERSPACE_RANGE_H
+#define HYPERSPACE_RANGE_H
+
+#ifdef RANGE_BUILD
+
+#ifdef OPCOUNT_BUILD
+#error "RANGE_BUILD and OPCOUNT_BUILD both wrap libfixmath; enable only one"
+#endif
+#ifdef MATH_FLOAT
+#error "RANGE_BUILD profiles Q16.16 values; build it without MATH_FLOAT"
+#endif
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "libfixmath/fixmath.h"
+
+typedef struct RangeSite {
+    const char* name;
+    const char* func;
+    int line;
+    int is_int;
+    int32_t min, max;       // raw values (fix16 or int)
+    uint32_t frac_or;       // OR of all fractional parts
+    uint64_t samples;
+    struct RangeSite* next;
+} RangeSite;
+
+typedef struct RangeOverflow {
+    const char* func;
+    const char* op;
+    uint64_t count;
+    fix16_t a, b;           // operands of the first overflow
+    struct RangeOverflow* next;
+} RangeOverflow;
+
+static RangeSite* range_sites = NULL;
+static RangeOverflow* range_overflows = NULL;
+
+static inline int32_t range_record(RangeSite* s, int32_t v) {
+    if (s->samples++ == 0) {
+        s->min = s->max = v;
+        s->next = range_sites;
+        range_sites = s;
+    }
+    if (v < s->min) s->min = v;
+    if (v > s->max) s->max = v;
+    s->frac_or |= (uint32_t)v & 0xFFFF;
+    return v;
+}
+
+#define RANGE_SITE_(name, v, is_int) ({ \
+    static RangeSite range_site_ = {name, __func__, __LINE__, is_int, 0, 0, 0, 0, NULL}; \
+    range_record(&range_site_, (v)); })
+
+// Record a fix16_t value at this site and pass it through
+#define RANGE_FIX(name, v) ((fix16_t)RANGE_SITE_(name, v, 0))
+// Record an integer value at this site and pass it through
+#define RANGE_INT(name, v) ((int)RANGE_SITE_(name, v, 1))
+
+// ============================================================================
+// Overflow-checked libfixmath wrappers
+// ============================================================================
+
+static void range_overflow(const char* func, const char* op, fix16_t a, fix16_t b) {
+    RangeOverflow* o;
+    for (o = range_overflows; o; o = o->next) {
+        if (o->func == func && o->op == op) break;
+    }
+    if (!o) {
+        o = (RangeOverflow*)calloc(1, sizeof(RangeOverflow));
+        o->func = func;
+        o->op = op;
+        o->a = a;
+        o->b = b;
+        o->next = range_overflows;
+        range_overflows = o;
+    }
+    o->count++;
+}
+
+static inline fix16_t range_fix16_mul(fix16_t a, fix16_t b, const char* func) {
+    int64_t product = ((int64_t)a * b) >> 16;
+    if (product > INT32_MAX || product < INT32_MIN) range_overflow(func, "fix16_mul", a, b);
+    return fix16_mul(a, b);
+}
+
+static inline fix16_t range_fix16_div(fix16_t a, fix16_t b, const char* func) {
+    if (b == 0) {
+        range_overflow(func, "fix16_div by 0", a, b);
+    } else {
+        int64_t quotient = ((int64_t)a * 65536) / b;
+        if (quotient > INT32_MAX || quotient < INT32_MIN) range_overflow(func, "fix16_div", a, b);
+    }
+    return fix16_div(a, b);
+}
+
+#define fix16_mul(a, b) range_fix16_mul(a, b, __func__)
+#define fix16_div(a, b) range_fix16_div(a, b, __func__)
+
+// ============================================================================
+// Report
+// ============================================================================
+
+// Integer bits (excluding sign) needed to hold [min, max]
+static int range_int_bits(int32_t min, int32_t max, int is_int) {
+    int64_t lo = is_int ? min : (int64_t)min >> 16;   // floor
+    int64_t hi = is_int ? max : (int64_t)max >> 16;
+    int bits = 0;
+    while (bits < 32 && (lo < -((int64_t)1 << bits) || hi >= ((int64_t)1 << bits))) bits++;
+    return bits;
+}
+
+static int range_frac_bits(const RangeSite* s) {
+    if (s->is_int || s->frac_or == 0) return 0;
+    int bits = 16;
+    while (!(s->frac_or & (1u << (16 - bits)))) bits--;
+    return bits;
+}
+
+// Narrowest of int16 / Q8.8 / Q24.8 that holds the range; lossless
+// also requires the fractional bits in use to fit
+static const char* range_format(int int_bits, int frac_bits, int lossless) {
+    if (frac_bits == 0 && int_bits <= 15) return "int16";
+    if ((!lossless || frac_bits <= 8) && int_bits <= 7) return "Q8.8";
+    if ((!lossless || frac_bits <= 8) && int_bits <= 23) return "Q24.8";
+    return "Q16.16";
+}
+
+static double range_value(int32_t v, int is_int) {
+    return is_int ? (double)v : v / 65536.0;
+}
+
+static void range_report(FILE* out) {
+    int num_sites = 0;
+    for (RangeSite* s = range_sites; s; s = s->next) num_sites++;
+
+    // Sort by function then source line
+    RangeSite** sorted = (RangeSite**)calloc(num_sites ? num_sites : 1, sizeof(RangeSite*));
+    int n = 0;
+    for (RangeSite* s = range_sites; s; s = s->next) {
+        int j = n++;
+        while (j > 0) {
+            RangeSite* p = sorted[j - 1];
+            int c = strcmp(p->func, s->func);
+            if (c < 0 || (c == 0 && p->line <= s->line)) break;
+            sorted[j] = p;
+            j--;
+        }
+        sorted[j] = s;
+    }
+
+    fprintf(out, "\nValue ranges (%d sites)\n", num_sites);
+    fprintf(out, "%-40s %10s %12s %12s %4s %4s  %-8s %-8s %s\n",
+            "site", "samples", "min", "max", "int", "frac", "lossless", "by range", "note");
+    for (int i = 0; i < n; i++) {
+        RangeSite* s = sorted[i];
+        char site[64];
+        snprintf(site, sizeof(site), "%s.%s:%d", s->func, s->name, s->line);
+        int int_bits = range_int_bits(s->min, s->max, s->is_int);
+        int frac_bits = range_frac_bits(s);
+        const char* note = "";
+        if (!s->is_int && int_bits >= 14) note = "near Q16.16 limit";
+        else if (s->is_int && int_bits >= 30) note = "near int32 limit";
+        fprintf(out, "%-40s %10llu %12.4f %12.4f %4d %4d  %-8s %-8s %s\n",
+                site, (unsigned long long)s->samples,
+                range_value(s->min, s->is_int), range_value(s->max, s->is_int),
+                int_bits, frac_bits,
+                range_format(int_bits, frac_bits, 1),
+                s->is_int ? range_format(int_bits, 0, 1) : range_format(int_bits, frac_bits, 0),
+                note);
+    }
+    free(sorted);
+
+    fprintf(out, "\nOverflows (exact result outside Q16.16)\n");
+    if (!range_overflows) fprintf(out, "  none\n");
+    for (RangeOverflow* o = range_overflows; o; o = o->next) {
+        fprintf(out, "  %-24s %-16s %10llu  first: a=%.4f b=%.4f\n",
+                o->func, o->op, (unsigned long long)o->count,
+                o->a / 65536.0, o->b / 65536.0);
+    }
+}
+
+#else
+
+#define RANGE_FIX(name, v) (v)
+#define RANGE_INT(name, v) (v)
+
+#endif // RANGE_BUILD
+
+#endif // HYPERSPACE_RANGE_H
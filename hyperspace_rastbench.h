@@ -0,0 +1,518 @@
+/*
+ * Hyperspace Rasterizer Microbenchmark
+ *
+ * Rasterizes each decoded mesh (the ship and the four enemy types) on its
+ * own, over a grid of
+ * - distances: the mesh's bounding radius times 1.5, 3, 6 and 12, kept
+ *   beyond the near plane of transform_pos();
+ * - orientations: 4 x-rotations times 3 z-rotations;
+ * - lights: from the camera, from the side and from behind,
+ * with the texture and palette the game uses for that mesh (the ship with
+ * set_ngn_pal() and its triangles sorted like game_draw()).
+ *
+ * Every rasterizer variant registered in rastbench_variants[] runs the
+ * same grid. The first entry is the reference: an untimed pass counts the
+ * pixels each triangle writes and hashes its output, and the other
+ * variants are checked against that hash, or against the variant they
+ * must match (same_as); approximations (approx) are timed only. The
+ * affine and subdivided spans of raster_thumb.h, when included, are such
+ * approximations, and their Thumb-1 loops must match their C loops. The
+ * timed pass then renders the
+ * grid back to back without clearing, so the numbers are rasterization
+ * alone. For each variant a least-squares fit over all cells splits the
+ * time into a per-triangle (setup) and a per-pixel (span) cost.
+ *
+ * Per cell the table lists the projected radius, the triangles that wrote
+ * at least one pixel and the pixels written over all 36 renders, the time
+ * per render, and that time divided by triangles and by pixels.
+ *
+ * A second table compares the word writes of rectfill(), spr() and
+ * print_char() with their byte-at-a-time references over a fixed set of
+ * calls: every position, size and sprite mix, partly off-screen, with
+ * and without a clip rectangle and a remapped palette. Each call is
+ * checked into a screen of 0xff as above, then the set is timed.
+ */
+
+#ifndef HYPERSPACE_RASTBENCH_H
+#define HYPERSPACE_RASTBENCH_H
+
+#include <stdio.h>
+
+#define RASTBENCH_SEED 0x52415354  // "RAST"
+#define RASTBENCH_FORMAT_VERSION 1
+#define RASTBENCH_MAX_VERTS 16
+#define RASTBENCH_MAX_TRIS 16
+#define RASTBENCH_MESHES 5
+#define RASTBENCH_DISTS 4
+#define RASTBENCH_ROT_X 4
+#define RASTBENCH_ROT_Z 3
+#define RASTBENCH_ORIENTS (RASTBENCH_ROT_X * RASTBENCH_ROT_Z)
+#define RASTBENCH_LIGHTS 3
+#define RASTBENCH_RENDERS (RASTBENCH_ORIENTS * RASTBENCH_LIGHTS)
+#define RASTBENCH_PRIMS 3
+#define RASTBENCH_PRIM_CALLS 512
+
+typedef struct {
+    uint32_t (*now_us)(void);
+    uint32_t clock_mhz;     // 0 when unknown; adds a cycles per pixel column
+    int reps;               // timed passes over each cell's renders
+} RastBenchPlatform;
+
+// A whole-triangle rasterizer with the signature of rasterize_tri()
+typedef void (*RastTriFn)(GameContext* ctx, int index, Triangle* tris, Vec3* projs);
+
+typedef struct {
+    const char* name;
+    RastTriFn tri;
+    bool approx;            // not the reference's pixels; timed, not checked
+    RastTriFn same_as;      // checked against this variant, not the reference
+} RastVariant;
+
+#ifndef PLATFORM_RASTER_SPAN
+// rasterize_tri() with every span through fn
+#define RASTBENCH_SPAN_VARIANT(name, fn) \
+    static void name(GameContext* ctx, int index, Triangle* tris, Vec3* projs) { \
+        raster_span_override = fn; \
+        rasterize_tri(ctx, index, tris, projs); \
+        raster_span_override = NULL; \
+    }
+
+// The unspecialized loop, to measure what the span specializations save
+RASTBENCH_SPAN_VARIANT(rastbench_tri_generic, raster_span_generic)
+
+#ifdef RASTER_THUMB_H
+RASTBENCH_SPAN_VARIANT(rastbench_tri_affine_c, raster_span_affine_c)
+RASTBENCH_SPAN_VARIANT(rastbench_tri_subdiv_c, raster_span_subdiv_c)
+#ifdef RASTER_THUMB_PIXELS_ASM
+RASTBENCH_SPAN_VARIANT(rastbench_tri_affine_thumb, raster_span_affine_thumb)
+RASTBENCH_SPAN_VARIANT(rastbench_tri_subdiv_thumb, raster_span_subdiv_thumb)
+#endif
+#endif
+
+// rasterize_tri() with the other choice of span stores
+static void rastbench_tri_stores(GameContext* ctx, int index, Triangle* tris, Vec3* projs) {
+    raster_span_words = !raster_span_words;
+    rasterize_tri(ctx, index, tris, projs);
+    raster_span_words = !raster_span_words;
+}
+
+// rasterize_tri() with affine spans for flat-depth halves (the grid runs
+// with them off, so that the reference stays perspective-correct)
+static void rastbench_tri_affine_halves(GameContext* ctx, int index, Triangle* tris, Vec3* projs) {
+    raster_affine_halves = true;
+    rasterize_tri(ctx, index, tris, projs);
+    raster_affine_halves = false;
+}
+#endif
+
+// Rasterizers compiled into this build; the first is the reference
+static const RastVariant rastbench_variants[] = {
+    {"reference", rasterize_tri},
+#ifndef PLATFORM_RASTER_SPAN
+    {"generic spans", rastbench_tri_generic},
+#ifdef RASTER_SPAN_WORDS
+    {"byte spans", rastbench_tri_stores},
+#else
+    {"word spans", rastbench_tri_stores},
+#endif
+    {"affine halves", rastbench_tri_affine_halves, true},
+#ifdef RASTER_THUMB_H
+    {"affine spans", rastbench_tri_affine_c, true},
+    {"subdiv spans", rastbench_tri_subdiv_c, true},
+#ifdef RASTER_THUMB_PIXELS_ASM
+    {"affine thumb", rastbench_tri_affine_thumb, false, rastbench_tri_affine_c},
+    {"subdiv thumb", rastbench_tri_subdiv_thumb, false, rastbench_tri_subdiv_c},
+#endif
+#endif
+#endif
+};
+#define RASTBENCH_NUM_VARIANTS ((int)(sizeof(rastbench_variants) / sizeof(rastbench_variants[0])))
+
+static const char* const rastbench_mesh_names[RASTBENCH_MESHES] = {"ship", "asteroid", "small", "medium", "boss"};
+static const scalar_t rastbench_dist_mul[RASTBENCH_DISTS] = {SC(1.5), SC(3.0), SC(6.0), SC(12.0)};
+
+// World-space light directions, transformed into each orientation's
+// object space as transform_vert() does for enemies
+static const Vec3 rastbench_lights[RASTBENCH_LIGHTS] = {
+    {0, 0, SC(1.0)},
+    {SC(1.0), 0, 0},
+    {0, 0, SC(-1.0)},
+};
+
+// One mesh at one distance: everything the renders need, set up untimed
+typedef struct {
+    Mesh* mesh;
+    Texture* tex;
+    bool ship;
+    int radius_px;                                      // projected bounding radius
+    Vec3 proj[RASTBENCH_ORIENTS][RASTBENCH_MAX_VERTS];
+    Triangle tris[RASTBENCH_ORIENTS][RASTBENCH_MAX_TRIS];
+    Vec3 light[RASTBENCH_ORIENTS][RASTBENCH_LIGHTS];
+} RastCell;
+
+typedef struct {
+    int radius_px;
+    uint32_t tris, pixels;                              // over all renders of one pass
+    uint32_t us[RASTBENCH_NUM_VARIANTS];                // all reps
+    bool match[RASTBENCH_NUM_VARIANTS];
+} RastResult;
+
+static RastCell rastbench_cell;
+static RastResult rastbench_results[RASTBENCH_MESHES][RASTBENCH_DISTS];
+
+// Call i of a 2D primitive, through the byte reference or the word writes
+typedef void (*RastPrimFn)(GameContext* ctx, int i, bool bytes);
+
+typedef struct {
+    const char* name;
+    RastPrimFn draw;
+} RastPrim;
+
+typedef struct {
+    uint32_t pixels;                                    // over all calls of one pass
+    uint32_t us[2];                                     // bytes, words; all reps
+    bool match;
+} RastPrimResult;
+
+static RastPrimResult rastbench_prim_results[RASTBENCH_PRIMS];
+
+static Mesh* rastbench_mesh(int m) {
+    return m == 0 ? &ship_mesh : &nme_meshes[m - 1];
+}
+
+static scalar_t rastbench_radius(const Mesh* mesh) {
+    scalar_t r = 0;
+    for (int i = 0; i < mesh->num_vertices; i++) {
+        scalar_t len = vec3_length(&mesh->vertices[i]);
+        if (len > r) r = len;
+    }
+    return r;
+}
+
+static void rastbench_setup(RastCell* cell, int m, int d) {
+    Mesh* mesh = rastbench_mesh(m);
+    cell->mesh = mesh;
+    cell->ship = m == 0;
+    cell->tex = cell->ship ? &ship_tex : &nme_tex[m - 1];
+
+    // transform_pos() drops vertices nearer than |FIX_PROJ_CONST| / 10
+    scalar_t radius = rastbench_radius(mesh);
+    scalar_t near = sc_div(sc_abs(FIX_PROJ_CONST), SC(10.0));
+    scalar_t dist = sc_max(sc_mul(radius, rastbench_dist_mul[d]), radius + near + SC_ONE);
+    cell->radius_px = sc_to_int(sc_div(sc_mul(sc_abs(FIX_PROJ_CONST), radius), dist));
+
+    for (int o = 0; o < RASTBENCH_ORIENTS; o++) {
+        Mat34 mat, rot_x, rot_z, inv_mat;
+        mat_translation(&mat, 0, 0, -dist);
+        mat_rotx(&rot_x, sc_div(sc_from_int(o / RASTBENCH_ROT_Z), sc_from_int(2 * RASTBENCH_ROT_X)));
+        mat_mul(&mat, &mat, &rot_x);
+        mat_rotz(&rot_z, sc_div(sc_from_int(o % RASTBENCH_ROT_Z), sc_from_int(RASTBENCH_ROT_Z)));
+        mat_mul(&mat, &mat, &rot_z);
+
+        for (int i = 0; i < mesh->num_vertices; i++) {
+            transform_pos(&cell->proj[o][i], &mat, &mesh->vertices[i]);
+        }
+        memcpy(cell->tris[o], mesh->triangles, mesh->num_triangles * sizeof(Triangle));
+        if (cell->ship) sort_tris(cell->tris[o], mesh->num_triangles, cell->proj[o]);
+
+        mat_transpose_rot(&inv_mat, &mat);
+        for (int l = 0; l < RASTBENCH_LIGHTS; l++) {
+            mat_mul_vec(&cell->light[o][l], &inv_mat, &rastbench_lights[l]);
+        }
+    }
+}
+
+// Texture and palette for render r, as game_draw() sets them
+static void rastbench_prepare(GameContext* ctx, RastCell* cell, int r) {
+    ctx->cur_tex = cell->tex;
+    ctx->t_light_dir = &cell->light[r / RASTBENCH_LIGHTS][r % RASTBENCH_LIGHTS];
+    pal_reset(&ctx->p8);
+    if (cell->ship) set_ngn_pal(ctx);
+}
+
+static void rastbench_start(GameContext* ctx) {
+    ctx->ngn_col_idx = 0;
+    ctx->ngn_laser_col_idx = 0;
+}
+
+// Each triangle alone into a screen of 0xff (no palette entry), counting
+// the pixels it wrote and hashing the result. Only the reference's counts
+// are kept; every variant's hash is compared with the reference's.
+static uint32_t rastbench_check(GameContext* ctx, RastCell* cell, RastTriFn tri, RastResult* res) {
+    uint8_t (*screen)[SCREEN_WIDTH] = ctx->p8.screen;
+    uint32_t h = 2166136261u;
+    rastbench_start(ctx);
+    for (int r = 0; r < RASTBENCH_RENDERS; r++) {
+        int o = r / RASTBENCH_LIGHTS;
+        rastbench_prepare(ctx, cell, r);
+        for (int t = 0; t < cell->mesh->num_triangles; t++) {
+            memset(ctx->p8.screen, 0xff, sizeof(ctx->p8.screen));
+            tri(ctx, t, cell->tris[o], cell->proj[o]);
+
+            uint32_t written = 0;
+            for (int y = 0; y < SCREEN_HEIGHT; y++) {
+                for (int x = 0; x < SCREEN_WIDTH; x++) {
+                    if (screen[y][x] == 0xff) continue;
+                    written++;
+                    h = (h ^ (uint32_t)(y * SCREEN_WIDTH + x)) * 16777619u;
+                    h = (h ^ screen[y][x]) * 16777619u;
+                }
+            }
+            if (res && written) {
+                res->tris++;
+                res->pixels += written;
+            }
+        }
+    }
+    return h;
+}
+
+static uint32_t rastbench_time(GameContext* ctx, RastCell* cell, RastTriFn tri, const RastBenchPlatform* plat) {
+    rastbench_start(ctx);
+    uint32_t t0 = plat->now_us();
+    for (int rep = 0; rep < plat->reps; rep++) {
+        for (int r = 0; r < RASTBENCH_RENDERS; r++) {
+            int o = r / RASTBENCH_LIGHTS;
+            rastbench_prepare(ctx, cell, r);
+            for (int t = 0; t < cell->mesh->num_triangles; t++) {
+                tri(ctx, t, cell->tris[o], cell->proj[o]);
+            }
+        }
+    }
+    return plat->now_us() - t0;
+}
+
+// Least-squares fit of time = a * tris + b * pixels over all cells, in ns
+static void rastbench_fit(int v, int reps, double* per_tri, double* per_px) {
+    double nn = 0, np = 0, pp = 0, nt = 0, pt = 0;
+    for (int m = 0; m < RASTBENCH_MESHES; m++) {
+        for (int d = 0; d < RASTBENCH_DISTS; d++) {
+            const RastResult* r = &rastbench_results[m][d];
+            double n = r->tris, p = r->pixels, t = r->us[v] * 1000.0 / reps;
+            nn += n * n; np += n * p; pp += p * p;
+            nt += n * t; pt += p * t;
+        }
+    }
+    double det = nn * pp - np * np;
+    *per_tri = det != 0 ? (nt * pp - pt * np) / det : 0;
+    *per_px = det != 0 ? (pt * nn - nt * np) / det : 0;
+}
+
+static void rastbench_report(const RastBenchPlatform* plat) {
+    printf("\r\nrastbench %d: %d variants, %d renders per cell, %d reps, %u MHz\r\n",
+           RASTBENCH_FORMAT_VERSION, RASTBENCH_NUM_VARIANTS, RASTBENCH_RENDERS, plat->reps,
+           (unsigned)plat->clock_mhz);
+    for (int v = 0; v < RASTBENCH_NUM_VARIANTS; v++) {
+        printf("\r\nvariant %s\r\n", rastbench_variants[v].name);
+        printf("%-9s %6s %6s %8s %10s %9s %8s %7s  %s\r\n",
+               "mesh", "radius", "tris", "pixels", "us/render", "ns/tri", "ns/px",
+               plat->clock_mhz ? "cyc/px" : "", "check");
+        for (int m = 0; m < RASTBENCH_MESHES; m++) {
+            for (int d = 0; d < RASTBENCH_DISTS; d++) {
+                const RastResult* r = &rastbench_results[m][d];
+                double ns = r->us[v] * 1000.0 / plat->reps;
+                char cycles[16] = "";
+                if (plat->clock_mhz && r->pixels) {
+                    snprintf(cycles, sizeof(cycles), "%.1f", ns * plat->clock_mhz / 1000.0 / r->pixels);
+                }
+                printf("%-9s %6d %6u %8u %10.1f %9.1f %8.2f %7s  %s\r\n",
+                       rastbench_mesh_names[m], r->radius_px, (unsigned)r->tris, (unsigned)r->pixels,
+                       ns / 1000.0 / RASTBENCH_RENDERS,
+                       r->tris ? ns / r->tris : 0.0,
+                       r->pixels ? ns / r->pixels : 0.0,
+                       cycles, v == 0 ? "ref" : rastbench_variants[v].approx ? "approx" :
+                       r->match[v] ? "ok" : "DIFFERS");
+            }
+        }
+        double per_tri, per_px;
+        rastbench_fit(v, plat->reps, &per_tri, &per_px);
+        printf("fit: %.1f ns/tri + %.2f ns/px", per_tri, per_px);
+        if (plat->clock_mhz) {
+            printf(" (%.0f cycles/tri + %.1f cycles/px)", per_tri * plat->clock_mhz / 1000.0,
+                   per_px * plat->clock_mhz / 1000.0);
+        }
+        printf("\r\n");
+    }
+}
+
+// ============================================================================
+// 2D Primitives
+// ============================================================================
+
+// Argument stream of call i
+static int rastbench_arg(uint32_t* state, int lo, int hi) {
+    *state = *state * 1664525u + 1013904223u;
+    return lo + (int)((*state >> 8) % (uint32_t)(hi - lo));
+}
+
+// Palette and clip rectangle of call i: a quarter of the calls remap the
+// palette, a quarter clip
+static uint32_t rastbench_prim_state(GameContext* ctx, int i) {
+    Pico8* p8 = &ctx->p8;
+    uint32_t state = 0x9E3779B9u * (uint32_t)(i + 1);
+    pal_reset(p8);
+    clip_reset(p8);
+    if ((i & 3) == 1) {
+        for (int c = 1; c < 16; c += 3) pal(p8, c, rastbench_arg(&state, 0, 16));
+    }
+    if ((i & 3) == 2) {
+        int x = rastbench_arg(&state, -8, SCREEN_WIDTH - 8);
+        int y = rastbench_arg(&state, -8, SCREEN_HEIGHT - 8);
+        clip_set(p8, x, y, rastbench_arg(&state, 1, SCREEN_WIDTH), rastbench_arg(&state, 1, SCREEN_HEIGHT));
+    }
+    return state;
+}
+
+// Up to screen-wide rectangles, half of them rows a few pixels high
+static void rastbench_prim_rect(GameContext* ctx, int i, bool bytes) {
+    uint32_t state = rastbench_prim_state(ctx, i);
+    int x0 = rastbench_arg(&state, -16, SCREEN_WIDTH + 16);
+    int y0 = rastbench_arg(&state, -8, SCREEN_HEIGHT + 8);
+    int x1 = x0 + rastbench_arg(&state, -SCREEN_WIDTH / 2, SCREEN_WIDTH);
+    int y1 = y0 + rastbench_arg(&state, -4, i & 1 ? 5 : SCREEN_HEIGHT / 2);
+    int c = rastbench_arg(&state, 0, 16);
+    if (bytes) rectfill_bytes(&ctx->p8, x0, y0, x1, y1, c);
+    else rectfill(&ctx->p8, x0, y0, x1, y1, c);
+}
+
+// Any sprite of the sheet at the sizes the game draws
+static void rastbench_prim_spr(GameContext* ctx, int i, bool bytes) {
+    static const uint8_t sizes[][2] = {{1, 1}, {1, 1}, {2, 2}, {1, 2}, {8, 1}};
+    uint32_t state = rastbench_prim_state(ctx, i);
+    int s = rastbench_arg(&state, 0, 5);
+    int n = rastbench_arg(&state, 0, 256);
+    int x = rastbench_arg(&state, -16, SCREEN_WIDTH + 4);
+    int y = rastbench_arg(&state, -16, SCREEN_HEIGHT + 4);
+    if (bytes) spr_bytes(&ctx->p8, n, x, y, sizes[s][0], sizes[s][1]);
+    else spr(&ctx->p8, n, x, y, sizes[s][0], sizes[s][1]);
+}
+
+// Every printable character at every alignment
+static void rastbench_prim_print(GameContext* ctx, int i, bool bytes) {
+    uint32_t state = rastbench_prim_state(ctx, i);
+    char c = (char)(32 + i % 96);
+    int x = rastbench_arg(&state, -4, SCREEN_WIDTH + 2);
+    int y = rastbench_arg(&state, -6, SCREEN_HEIGHT + 2);
+    int col = rastbench_arg(&state, 0, 16);
+    if (bytes) print_char_bytes(ctx, c, x, y, col);
+    else print_char(ctx, c, x, y, col);
+}
+
+static const RastPrim rastbench_prims[RASTBENCH_PRIMS] = {
+    {"rectfill", rastbench_prim_rect},
+    {"spr", rastbench_prim_spr},
+    {"print_char", rastbench_prim_print},
+};
+
+// Each call alone into a screen of 0xff, hashing what it wrote; the
+// pixel count is kept from the byte pass
+static uint32_t rastbench_prim_check(GameContext* ctx, RastPrimFn draw, bool bytes, RastPrimResult* res) {
+    uint8_t (*screen)[SCREEN_WIDTH] = ctx->p8.screen;
+    uint32_t h = 2166136261u;
+    for (int i = 0; i < RASTBENCH_PRIM_CALLS; i++) {
+        memset(ctx->p8.screen, 0xff, sizeof(ctx->p8.screen));
+        draw(ctx, i, bytes);
+        for (int y = 0; y < SCREEN_HEIGHT; y++) {
+            for (int x = 0; x < SCREEN_WIDTH; x++) {
+                if (screen[y][x] == 0xff) continue;
+                if (res) res->pixels++;
+                h = (h ^ (uint32_t)(y * SCREEN_WIDTH + x)) * 16777619u;
+                h = (h ^ screen[y][x]) * 16777619u;
+            }
+        }
+    }
+    return h;
+}
+
+static uint32_t rastbench_prim_time(GameContext* ctx, RastPrimFn draw, bool bytes, const RastBenchPlatform* plat) {
+    uint32_t t0 = plat->now_us();
+    for (int rep = 0; rep < plat->reps; rep++) {
+        for (int i = 0; i < RASTBENCH_PRIM_CALLS; i++) {
+            draw(ctx, i, bytes);
+        }
+    }
+    return plat->now_us() - t0;
+}
+
+static void rastbench_prim_report(const RastBenchPlatform* plat) {
+    printf("\r\nprimitives: %d calls each, bytes vs words\r\n", RASTBENCH_PRIM_CALLS);
+    printf("%-10s %8s %10s %10s %8s %8s %7s %7s %8s  %s\r\n",
+           "primitive", "pixels", "bytes ns", "words ns", "b ns/px", "w ns/px",
+           plat->clock_mhz ? "b cyc" : "", plat->clock_mhz ? "w cyc" : "", "speedup", "check");
+    for (int p = 0; p < RASTBENCH_PRIMS; p++) {
+        const RastPrimResult* r = &rastbench_prim_results[p];
+        double ns[2], per_px[2];
+        char cycles[2][16] = {"", ""};
+        for (int k = 0; k < 2; k++) {
+            ns[k] = r->us[k] * 1000.0 / plat->reps;
+            per_px[k] = r->pixels ? ns[k] / r->pixels : 0.0;
+            if (plat->clock_mhz) snprintf(cycles[k], sizeof(cycles[k]), "%.1f", per_px[k] * plat->clock_mhz / 1000.0);
+        }
+        printf("%-10s %8u %10.1f %10.1f %8.2f %8.2f %7s %7s %7.2fx  %s\r\n",
+               rastbench_prims[p].name, (unsigned)r->pixels,
+               ns[0] / RASTBENCH_PRIM_CALLS, ns[1] / RASTBENCH_PRIM_CALLS, per_px[0], per_px[1],
+               cycles[0], cycles[1], r->us[1] ? (double)r->us[0] / r->us[1] : 0.0,
+               r->match ? "ok" : "DIFFERS");
+    }
+}
+
+// Both paths of every primitive; ctx must be initialized
+static void rastbench_prims_run(GameContext* ctx, const RastBenchPlatform* plat) {
+    for (int p = 0; p < RASTBENCH_PRIMS; p++) {
+        RastPrimResult* res = &rastbench_prim_results[p];
+        memset(res, 0, sizeof(*res));
+        uint32_t ref_hash = rastbench_prim_check(ctx, rastbench_prims[p].draw, true, res);
+        res->match = rastbench_prim_check(ctx, rastbench_prims[p].draw, false, NULL) == ref_hash;
+        res->us[0] = rastbench_prim_time(ctx, rastbench_prims[p].draw, true, plat);
+        res->us[1] = rastbench_prim_time(ctx, rastbench_prims[p].draw, false, plat);
+    }
+    pal_reset(&ctx->p8);
+    clip_reset(&ctx->p8);
+}
+
+// Index of the variant v is checked against: same_as, or the reference
+static int rastbench_check_against(int v) {
+    for (int i = 0; i < v; i++) {
+        if (rastbench_variants[i].tri == rastbench_variants[v].same_as) return i;
+    }
+    return 0;
+}
+
+// Run the grid for every variant in ctx (which is left destroyed) and
+// print the tables
+static void rastbench_run(GameContext* ctx, const RastBenchPlatform* plat) {
+    game_init(ctx, RASTBENCH_SEED);
+#ifndef PLATFORM_RASTER_SPAN
+    bool affine_halves = raster_affine_halves;
+    raster_affine_halves = false;
+#endif
+    RastCell* cell = &rastbench_cell;
+    for (int m = 0; m < RASTBENCH_MESHES; m++) {
+        const Mesh* mesh = rastbench_mesh(m);
+        if (mesh->num_vertices > RASTBENCH_MAX_VERTS || mesh->num_triangles > RASTBENCH_MAX_TRIS) {
+            printf("rastbench: mesh %s too large, skipped\r\n", rastbench_mesh_names[m]);
+            continue;
+        }
+        for (int d = 0; d < RASTBENCH_DISTS; d++) {
+            RastResult* res = &rastbench_results[m][d];
+            memset(res, 0, sizeof(*res));
+            rastbench_setup(cell, m, d);
+            res->radius_px = cell->radius_px;
+            uint32_t hash[RASTBENCH_NUM_VARIANTS];
+            for (int v = 0; v < RASTBENCH_NUM_VARIANTS; v++) {
+                hash[v] = rastbench_check(ctx, cell, rastbench_variants[v].tri, v == 0 ? res : NULL);
+                res->match[v] = hash[v] == hash[rastbench_check_against(v)];
+                res->us[v] = rastbench_time(ctx, cell, rastbench_variants[v].tri, plat);
+            }
+        }
+    }
+#ifndef PLATFORM_RASTER_SPAN
+    raster_affine_halves = affine_halves;
+#endif
+    rastbench_prims_run(ctx, plat);
+    game_destroy(ctx);
+    rastbench_report(plat);
+    rastbench_prim_report(plat);
+}
+
+#endif // HYPERSPACE_RASTBENCH_H
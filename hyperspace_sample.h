@@ -0,0 +1,151 @@
+/*
+ * Hyperspace PC Sampler (RP2040 only)
+ *
+ * With SAMPLE_BUILD, a timer interrupt fires SAMPLE_HZ times a second and
+ * records the program counter it interrupted, so the profile covers code
+ * nobody marked: libfixmath, the libgcc/SDK helpers (__aeabi_lmul,
+ * __aeabi_ldivmod, ...), the bootrom and the other interrupt handlers.
+ *
+ * Samples are counted per PC in an open-addressed table; PCs that find no
+ * free slot within SAMPLE_PROBES are counted as dropped. Each core that
+ * calls sample_start() gets its own timer alarm (core 0 alarm 2, core 1
+ * alarm 1; alarm 3 belongs to the SDK's default alarm pool). The game only
+ * runs on core 0, but core 1 code can join with the same call.
+ *
+ * sample_dump() prints the table over UART (main.c does it on 'p') and
+ * sample_profile.py symbolizes it against the ELF into a flat profile.
+ */
+
+#ifndef HYPERSPACE_SAMPLE_H
+#define HYPERSPACE_SAMPLE_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "hardware/irq.h"
+#include "hardware/sync.h"
+#include "hardware/timer.h"
+
+#ifndef SAMPLE_HZ
+#define SAMPLE_HZ 4000
+#endif
+#define SAMPLE_PERIOD_US (1000000 / SAMPLE_HZ)
+
+#define SAMPLE_SLOTS 2048    // power of two
+#define SAMPLE_PROBES 16
+#define SAMPLE_FORMAT_VERSION 1
+
+typedef struct {
+    uint32_t pc;            // 0 = free
+    uint32_t count;
+} SampleSlot;
+
+static SampleSlot sample_table[SAMPLE_SLOTS];
+static volatile uint32_t sample_total[2];   // per core
+static volatile uint32_t sample_dropped;
+static volatile bool sample_paused;
+static spin_lock_t* sample_lock;
+
+static uint sample_alarm(uint core) {
+    return core == 0 ? 2 : 1;
+}
+
+// Slot counting pc, or NULL when the probe sequence is full
+static inline SampleSlot* sample_slot(uint32_t pc) {
+    uint32_t h = (pc >> 1) * 2654435761u;
+    for (int i = 0; i < SAMPLE_PROBES; i++) {
+        SampleSlot* s = &sample_table[(h + i) & (SAMPLE_SLOTS - 1)];
+        if (s->pc == pc || s->pc == 0) return s;
+    }
+    return NULL;
+}
+
+// Called from sample_isr with the interrupted PC, still in handler mode
+void __not_in_flash_func(sample_record)(uint32_t pc) {
+    uint core = get_core_num();
+    uint alarm = sample_alarm(core);
+    timer_hw->intr = 1u << alarm;
+
+    // Next alarm one period after the previous one, or from now if this
+    // handler was held off for longer than a period
+    uint32_t next = timer_hw->alarm[alarm] + SAMPLE_PERIOD_US;
+    if ((int32_t)(next - timer_hw->timerawl) <= 0) {
+        next = timer_hw->timerawl + SAMPLE_PERIOD_US;
+    }
+    timer_hw->alarm[alarm] = next;
+
+    if (sample_paused) return;
+    sample_total[core]++;
+
+    // Both cores may record at once; the table is only touched with the
+    // hardware spin lock held
+    uint32_t save = spin_lock_blocking(sample_lock);
+    SampleSlot* s = sample_slot(pc);
+    if (s) {
+        s->pc = pc;
+        s->count++;
+    } else {
+        sample_dropped++;
+    }
+    spin_unlock(sample_lock, save);
+}
+
+// Exception entry pushed r0-r3, r12, lr, pc, xpsr on the stack that was
+// active; bit 2 of EXC_RETURN in lr says which. Fetch the stacked pc and
+// tail-call sample_record(), which returns straight from the exception.
+static void __attribute__((naked)) __not_in_flash_func(sample_isr)(void) {
+    __asm volatile (
+        "movs r1, #4\n\t"
+        "mov r0, lr\n\t"
+        "tst r0, r1\n\t"
+        "bne 1f\n\t"
+        "mrs r0, msp\n\t"
+        "b 2f\n"
+        "1:\n\t"
+        "mrs r0, psp\n"
+        "2:\n\t"
+        "ldr r0, [r0, #24]\n\t"
+        "ldr r1, 3f\n\t"
+        "bx r1\n\t"
+        ".align 2\n"
+        "3:\n\t"
+        ".word sample_record\n"
+    );
+}
+
+// Start sampling on the calling core. Highest priority, so other handlers
+// are sampled too; code running with interrupts masked (flash writes) is not.
+static void sample_start(void) {
+    uint alarm = sample_alarm(get_core_num());
+    if (!sample_lock) sample_lock = spin_lock_init(spin_lock_claim_unused(true));
+    hardware_alarm_claim(alarm);
+    irq_set_exclusive_handler(TIMER_IRQ_0 + alarm, sample_isr);
+    irq_set_priority(TIMER_IRQ_0 + alarm, 0);
+    hw_set_bits(&timer_hw->inte, 1u << alarm);
+    irq_set_enabled(TIMER_IRQ_0 + alarm, true);
+    timer_hw->alarm[alarm] = timer_hw->timerawl + SAMPLE_PERIOD_US;
+}
+
+// Print the table and start a new profile. Format:
+//   samples <version> hz <n> core0 <n> core1 <n> dropped <n>
+//   <pc hex> <count>
+//   end
+static void sample_dump(void) {
+    sample_paused = true;
+    printf("samples %d hz %d core0 %u core1 %u dropped %u\r\n", SAMPLE_FORMAT_VERSION, SAMPLE_HZ,
+           (unsigned)sample_total[0], (unsigned)sample_total[1], (unsigned)sample_dropped);
+    for (int i = 0; i < SAMPLE_SLOTS; i++) {
+        if (sample_table[i].pc) {
+            printf("%08x %u\r\n", (unsigned)sample_table[i].pc, (unsigned)sample_table[i].count);
+        }
+    }
+    printf("end\r\n");
+
+    memset(sample_table, 0, sizeof(sample_table));
+    sample_total[0] = sample_total[1] = 0;
+    sample_dropped = 0;
+    sample_paused = false;
+}
+
+#endif // HYPERSPACE_SAMPLE_H
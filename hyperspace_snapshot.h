@@ -0,0 +1,347 @@
+/*
+ * Hyperspace Game-State Snapshots
+ *
+ * game_snapshot() serializes everything a GameContext carries from one
+ * frame to the next into a little-endian, position-independent blob, and
+ * game_restore() loads it back so stepping continues bit-identically.
+ * Used for replay seeking, rewinding and A/B runs from one mid-game state.
+ *
+ * Pointers are stored as indices: tgt_pos as an enemy index and the
+ * depth-sorted ship triangles as their order in ship_mesh. Projections
+ * (ship_proj, Enemy::proj) are not stored; game_update() recomputes them
+ * at its end, so restore, then step, then draw. The framebuffer is not
+ * stored either: game_draw() clears it every frame.
+ *
+ * Only live lasers and enemies are written, so a blob is usually well
+ * under SNAPSHOT_MAX_SIZE. A buffer of that size always fits, on the
+ * device too.
+ *
+ * Scalars are stored as their 32-bit pattern, so a blob only loads into a
+ * build with the same math backend; MATH_FLOAT blobs carry another version.
+ *
+ * Include after hyperspace_game.h.
+ */
+
+#ifndef HYPERSPACE_SNAPSHOT_H
+#define HYPERSPACE_SNAPSHOT_H
+
+#define SNAPSHOT_MAGIC 0x504E5348u  // "HSNP"
+#ifdef MATH_FLOAT
+#define SNAPSHOT_VERSION 0x101
+#else
+#define SNAPSHOT_VERSION 1
+#endif
+
+// Ship triangle order is kept in a 32-bit mask while encoding
+#define SNAPSHOT_MAX_SHIP_TRIS 32
+
+// X(field): 32-bit GameContext fields, in blob order
+#define SNAPSHOT_CTX_WORDS(X) \
+    X(cur_mode) X(life) X(score) X(best_score) X(global_t) X(game_spd) \
+    X(hit_t) X(barrel_cur_t) X(barrel_dir) X(aim_z) X(aim_life_ratio) \
+    X(cur_thrust) X(fade_ratio) X(manual_fire) X(non_inverted_y) X(sound_enabled) \
+    X(cur_laser_t) X(cur_laser_side) X(cur_nme_t) X(asteroid_mul_t) \
+    X(cur_sequencer_x) X(cur_sequencer_y) X(next_sequencer_t) X(nb_nme_ship) \
+    X(ngn_col_idx) X(ngn_laser_col_idx) X(flare_offset) X(fx_rnd_state) \
+    X(cam_x) X(cam_y) X(cam_angle_z) X(cam_angle_x) X(cam_depth) \
+    X(ship_x) X(ship_y) X(ship_spd_x) X(ship_spd_y) \
+    X(roll_angle) X(roll_spd) X(pitch_angle) X(pitch_spd) X(roll_f) X(pitch_f) \
+    X(cur_noise_t) X(tgt_noise_t) X(cur_noise_roll) X(old_noise_roll) \
+    X(cur_noise_pitch) X(old_noise_pitch) \
+    X(src_cam_angle_z) X(src_cam_angle_x) X(src_cam_x) X(src_cam_y) \
+    X(dst_cam_angle_z) X(dst_cam_angle_x) X(dst_cam_x) X(dst_cam_y) \
+    X(interpolation_ratio) X(interpolation_spd)
+
+#define SNAPSHOT_CTX_BOOLS(X) \
+    X(laser_on) X(laser_spawned) X(waiting_nme_clear) X(spawn_asteroids)
+
+#define SNAPSHOT_CTX_VEC3S(X) \
+    X(hit_pos) X(aim_proj) X(interp_tgt_pos) X(star_proj) X(light_dir) X(ship_light_dir)
+
+#define SNAPSHOT_CTX_MATS(X) \
+    X(light_mat) X(cam_mat) X(ship_mat) X(inv_ship_mat) X(ship_pos_mat)
+
+#define SNAPSHOT_ENEMY_WORDS(X) \
+    X(type) X(life) X(hit_t) X(rot_x) X(rot_y) X(rot_x_spd) X(rot_y_spd) \
+    X(laser_t) X(stop_laser_t) X(next_laser_t) \
+    X(laser_offset_x[0]) X(laser_offset_x[1]) X(laser_offset_y[0]) X(laser_offset_y[1])
+
+#define SNAPSHOT_ENEMY_VEC3S(X) \
+    X(pos) X(hit_pos) X(light_dir) X(spd) X(waypoint)
+
+#define SNAPSHOT_COUNT_(f) + 1
+
+// Header: magic, version, checksum, ship triangle/laser/enemy counts
+#define SNAPSHOT_HEADER_SIZE 14
+// Pico8: palette_map, draw_color, clip, rnd_state, buttons, cart data
+#define SNAPSHOT_PICO8_SIZE (16 + 1 + 4 * 4 + 4 + 6 + 6 + 64 * 4 + 1)
+#define SNAPSHOT_FIXED_SIZE (SNAPSHOT_HEADER_SIZE + SNAPSHOT_PICO8_SIZE + \
+    4 * (0 SNAPSHOT_CTX_WORDS(SNAPSHOT_COUNT_)) + (0 SNAPSHOT_CTX_BOOLS(SNAPSHOT_COUNT_)) + \
+    12 * (0 SNAPSHOT_CTX_VEC3S(SNAPSHOT_COUNT_)) + 48 * (0 SNAPSHOT_CTX_MATS(SNAPSHOT_COUNT_)) + \
+    1 /* tgt_pos */ + MAX_TRAILS * 32 + MAX_BGS * 20)
+#define SNAPSHOT_LASER_SIZE 36
+#define SNAPSHOT_ENEMY_SIZE (4 * (0 SNAPSHOT_ENEMY_WORDS(SNAPSHOT_COUNT_)) + \
+    12 * (0 SNAPSHOT_ENEMY_VEC3S(SNAPSHOT_COUNT_)))
+
+#define SNAPSHOT_MAX_SIZE (SNAPSHOT_FIXED_SIZE + SNAPSHOT_MAX_SHIP_TRIS + \
+    2 * MAX_LASERS * SNAPSHOT_LASER_SIZE + MAX_ENEMIES * SNAPSHOT_ENEMY_SIZE)
+
+// Every word field must really be 32 bits
+#define SNAPSHOT_CHECK_CTX_(f) _Static_assert(sizeof(((GameContext*)0)->f) == 4, "snapshot: " #f);
+#define SNAPSHOT_CHECK_ENEMY_(f) _Static_assert(sizeof(((Enemy*)0)->f) == 4, "snapshot: " #f);
+SNAPSHOT_CTX_WORDS(SNAPSHOT_CHECK_CTX_)
+SNAPSHOT_ENEMY_WORDS(SNAPSHOT_CHECK_ENEMY_)
+
+// ============================================================================
+// Encoding
+// ============================================================================
+
+static inline void snap_put8(uint8_t** p, uint32_t v) {
+    *(*p)++ = (uint8_t)v;
+}
+
+static inline void snap_put32(uint8_t** p, uint32_t v) {
+    uint8_t* d = *p;
+    d[0] = (uint8_t)v;
+    d[1] = (uint8_t)(v >> 8);
+    d[2] = (uint8_t)(v >> 16);
+    d[3] = (uint8_t)(v >> 24);
+    *p += 4;
+}
+
+static inline uint32_t snap_get8(const uint8_t** p) {
+    return *(*p)++;
+}
+
+static inline uint32_t snap_get32(const uint8_t** p) {
+    const uint8_t* s = *p;
+    *p += 4;
+    return s[0] | ((uint32_t)s[1] << 8) | ((uint32_t)s[2] << 16) | ((uint32_t)s[3] << 24);
+}
+
+// Word fields are ints or scalars; scalars go through their bit pattern
+#define SNAP_WORD(v) _Generic((v), scalar_t: sc_to_bits(v), default: (uint32_t)(v))
+#define SNAP_SET_WORD(lv, w) ((lv) = _Generic((lv), scalar_t: sc_from_bits(w), default: (int32_t)(w)))
+
+static void snap_put_vec3(uint8_t** p, const Vec3* v) {
+    snap_put32(p, sc_to_bits(v->x));
+    snap_put32(p, sc_to_bits(v->y));
+    snap_put32(p, sc_to_bits(v->z));
+}
+
+static void snap_get_vec3(const uint8_t** p, Vec3* v) {
+    v->x = sc_from_bits(snap_get32(p));
+    v->y = sc_from_bits(snap_get32(p));
+    v->z = sc_from_bits(snap_get32(p));
+}
+
+static void snap_put_laser(uint8_t** p, const Laser* laser) {
+    snap_put_vec3(p, &laser->pos0);
+    snap_put_vec3(p, &laser->pos1);
+    snap_put_vec3(p, &laser->spd);
+}
+
+static void snap_get_laser(const uint8_t** p, Laser* laser) {
+    memset(laser, 0, sizeof(Laser));
+    snap_get_vec3(p, &laser->pos0);
+    snap_get_vec3(p, &laser->pos1);
+    snap_get_vec3(p, &laser->spd);
+}
+
+// FNV-1a over the blob after the header
+static uint32_t snap_checksum(const uint8_t* data, size_t size) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < size; i++) {
+        h = (h ^ data[i]) * 16777619u;
+    }
+    return h;
+}
+
+static size_t snap_size(int ship_tris, int num_lasers, int num_nme_lasers, int num_enemies) {
+    return SNAPSHOT_FIXED_SIZE + ship_tris + (num_lasers + num_nme_lasers) * SNAPSHOT_LASER_SIZE +
+           num_enemies * SNAPSHOT_ENEMY_SIZE;
+}
+
+static size_t game_snapshot_size(const GameContext* ctx) {
+    return snap_size(ship_mesh.num_triangles, ctx->num_lasers, ctx->num_nme_lasers, ctx->num_enemies);
+}
+
+// Write ctx into buf; returns the blob size, or 0 if it does not fit
+static size_t game_snapshot(const GameContext* ctx, uint8_t* buf, size_t cap) {
+    OPC_FUNC();
+    size_t size = game_snapshot_size(ctx);
+    if (size > cap || ship_mesh.num_triangles > SNAPSHOT_MAX_SHIP_TRIS) return 0;
+    uint8_t* p = buf;
+
+    snap_put32(&p, SNAPSHOT_MAGIC);
+    snap_put8(&p, SNAPSHOT_VERSION);
+    snap_put8(&p, SNAPSHOT_VERSION >> 8);
+    snap_put32(&p, 0);  // checksum, filled in below
+    snap_put8(&p, ship_mesh.num_triangles);
+    snap_put8(&p, ctx->num_lasers);
+    snap_put8(&p, ctx->num_nme_lasers);
+    snap_put8(&p, ctx->num_enemies);
+
+    const Pico8* p8 = &ctx->p8;
+    for (int i = 0; i < 16; i++) snap_put8(&p, p8->palette_map[i]);
+    snap_put8(&p, p8->draw_color);
+    snap_put32(&p, p8->clip_x1);
+    snap_put32(&p, p8->clip_y1);
+    snap_put32(&p, p8->clip_x2);
+    snap_put32(&p, p8->clip_y2);
+    snap_put32(&p, p8->rnd_state);
+    for (int i = 0; i < 6; i++) snap_put8(&p, p8->btn_state[i]);
+    for (int i = 0; i < 6; i++) snap_put8(&p, p8->btn_prev[i]);
+    for (int i = 0; i < 64; i++) snap_put32(&p, p8->cart_data[i]);
+    snap_put8(&p, p8->cart_data_dirty);
+
+#define SNAPSHOT_PUT_WORD_(f) snap_put32(&p, SNAP_WORD(ctx->f));
+#define SNAPSHOT_PUT_BOOL_(f) snap_put8(&p, ctx->f);
+#define SNAPSHOT_PUT_VEC3_(f) snap_put_vec3(&p, &ctx->f);
+#define SNAPSHOT_PUT_MAT_(f) for (int i = 0; i < 12; i++) snap_put32(&p, sc_to_bits(ctx->f.m[i]));
+    SNAPSHOT_CTX_WORDS(SNAPSHOT_PUT_WORD_)
+    SNAPSHOT_CTX_BOOLS(SNAPSHOT_PUT_BOOL_)
+    SNAPSHOT_CTX_VEC3S(SNAPSHOT_PUT_VEC3_)
+    SNAPSHOT_CTX_MATS(SNAPSHOT_PUT_MAT_)
+
+    // tgt_pos points at an enemy's pos (its first member)
+    snap_put8(&p, ctx->tgt_pos ? (uint32_t)((const Enemy*)ctx->tgt_pos - ctx->enemies) : 0xFF);
+
+    // Ship triangles as indices into ship_mesh, in their current sorted order
+    uint32_t used = 0;
+    for (int i = 0; i < ship_mesh.num_triangles; i++) {
+        const int* tri = ctx->ship_tris[i].tri;
+        int j = 0;
+        for (; j < ship_mesh.num_triangles; j++) {
+            const int* src = ship_mesh.triangles[j].tri;
+            if (!(used & (1u << j)) && src[0] == tri[0] && src[1] == tri[1] && src[2] == tri[2]) break;
+        }
+        if (j == ship_mesh.num_triangles) return 0;
+        used |= 1u << j;
+        snap_put8(&p, j);
+    }
+
+    for (int i = 0; i < MAX_TRAILS; i++) {
+        const Trail* trail = &ctx->trails[i];
+        snap_put_vec3(&p, &trail->pos0);
+        snap_put_vec3(&p, &trail->pos1);
+        snap_put32(&p, sc_to_bits(trail->spd));
+        snap_put32(&p, trail->col);
+    }
+    for (int i = 0; i < MAX_BGS; i++) {
+        const Background* bg = &ctx->bgs[i];
+        snap_put_vec3(&p, &bg->pos);
+        snap_put32(&p, sc_to_bits(bg->spd));
+        snap_put32(&p, bg->index);
+    }
+    for (int i = 0; i < ctx->num_lasers; i++) snap_put_laser(&p, &ctx->lasers[i]);
+    for (int i = 0; i < ctx->num_nme_lasers; i++) snap_put_laser(&p, &ctx->nme_lasers[i]);
+
+#define SNAPSHOT_PUT_NME_WORD_(f) snap_put32(&p, SNAP_WORD(nme->f));
+#define SNAPSHOT_PUT_NME_VEC3_(f) snap_put_vec3(&p, &nme->f);
+    for (int i = 0; i < ctx->num_enemies; i++) {
+        const Enemy* nme = &ctx->enemies[i];
+        SNAPSHOT_ENEMY_WORDS(SNAPSHOT_PUT_NME_WORD_)
+        SNAPSHOT_ENEMY_VEC3S(SNAPSHOT_PUT_NME_VEC3_)
+    }
+
+    uint8_t* sum = buf + 6;
+    snap_put32(&sum, snap_checksum(buf + SNAPSHOT_HEADER_SIZE, size - SNAPSHOT_HEADER_SIZE));
+    OPC_BYTES(size);
+    return size;
+}
+
+// ============================================================================
+// Decoding
+// ============================================================================
+
+// Load a blob into ctx, which must have been set up by game_init(). Returns
+// false, leaving ctx untouched, if buf is not an intact snapshot of this
+// version for the loaded meshes.
+static bool game_restore(GameContext* ctx, const uint8_t* buf, size_t len) {
+    OPC_FUNC();
+    if (len < SNAPSHOT_HEADER_SIZE) return false;
+    const uint8_t* p = buf;
+    if (snap_get32(&p) != SNAPSHOT_MAGIC) return false;
+    uint32_t version = snap_get8(&p);
+    version |= snap_get8(&p) << 8;
+    if (version != SNAPSHOT_VERSION) return false;
+    uint32_t checksum = snap_get32(&p);
+    int ship_tris = snap_get8(&p);
+    int num_lasers = snap_get8(&p);
+    int num_nme_lasers = snap_get8(&p);
+    int num_enemies = snap_get8(&p);
+
+    if (ship_tris != ship_mesh.num_triangles || num_lasers > MAX_LASERS ||
+        num_nme_lasers > MAX_LASERS || num_enemies > MAX_ENEMIES) return false;
+    if (len != snap_size(ship_tris, num_lasers, num_nme_lasers, num_enemies)) return false;
+    if (snap_checksum(p, len - SNAPSHOT_HEADER_SIZE) != checksum) return false;
+
+    Pico8* p8 = &ctx->p8;
+    for (int i = 0; i < 16; i++) p8->palette_map[i] = snap_get8(&p);
+    p8->draw_color = snap_get8(&p);
+    p8->clip_x1 = (int32_t)snap_get32(&p);
+    p8->clip_y1 = (int32_t)snap_get32(&p);
+    p8->clip_x2 = (int32_t)snap_get32(&p);
+    p8->clip_y2 = (int32_t)snap_get32(&p);
+    p8->rnd_state = snap_get32(&p);
+    for (int i = 0; i < 6; i++) p8->btn_state[i] = snap_get8(&p);
+    for (int i = 0; i < 6; i++) p8->btn_prev[i] = snap_get8(&p);
+    for (int i = 0; i < 64; i++) p8->cart_data[i] = (int32_t)snap_get32(&p);
+    p8->cart_data_dirty = snap_get8(&p);
+
+#define SNAPSHOT_GET_WORD_(f) SNAP_SET_WORD(ctx->f, snap_get32(&p));
+#define SNAPSHOT_GET_BOOL_(f) ctx->f = snap_get8(&p);
+#define SNAPSHOT_GET_VEC3_(f) snap_get_vec3(&p, &ctx->f);
+#define SNAPSHOT_GET_MAT_(f) for (int i = 0; i < 12; i++) ctx->f.m[i] = sc_from_bits(snap_get32(&p));
+    SNAPSHOT_CTX_WORDS(SNAPSHOT_GET_WORD_)
+    SNAPSHOT_CTX_BOOLS(SNAPSHOT_GET_BOOL_)
+    SNAPSHOT_CTX_VEC3S(SNAPSHOT_GET_VEC3_)
+    SNAPSHOT_CTX_MATS(SNAPSHOT_GET_MAT_)
+
+    int tgt = snap_get8(&p);
+    ctx->tgt_pos = tgt < num_enemies ? &ctx->enemies[tgt].pos : NULL;
+
+    for (int i = 0; i < ship_tris; i++) {
+        int j = snap_get8(&p);
+        ctx->ship_tris[i] = ship_mesh.triangles[j < ship_tris ? j : i];
+    }
+
+    for (int i = 0; i < MAX_TRAILS; i++) {
+        Trail* trail = &ctx->trails[i];
+        snap_get_vec3(&p, &trail->pos0);
+        snap_get_vec3(&p, &trail->pos1);
+        trail->spd = sc_from_bits(snap_get32(&p));
+        trail->col = (int32_t)snap_get32(&p);
+    }
+    for (int i = 0; i < MAX_BGS; i++) {
+        Background* bg = &ctx->bgs[i];
+        snap_get_vec3(&p, &bg->pos);
+        bg->spd = sc_from_bits(snap_get32(&p));
+        bg->index = (int32_t)snap_get32(&p);
+    }
+    ctx->num_lasers = num_lasers;
+    ctx->num_nme_lasers = num_nme_lasers;
+    for (int i = 0; i < num_lasers; i++) snap_get_laser(&p, &ctx->lasers[i]);
+    for (int i = 0; i < num_nme_lasers; i++) snap_get_laser(&p, &ctx->nme_lasers[i]);
+
+    // Projection buffers are sized by enemy type; game_update() fills them
+    for (int i = 0; i < ctx->num_enemies; i++) {
+        free(ctx->enemies[i].proj);
+    }
+#define SNAPSHOT_GET_NME_WORD_(f) SNAP_SET_WORD(nme->f, snap_get32(&p));
+#define SNAPSHOT_GET_NME_VEC3_(f) snap_get_vec3(&p, &nme->f);
+    ctx->num_enemies = num_enemies;
+    for (int i = 0; i < num_enemies; i++) {
+        Enemy* nme = &ctx->enemies[i];
+        memset(nme, 0, sizeof(Enemy));
+        SNAPSHOT_ENEMY_WORDS(SNAPSHOT_GET_NME_WORD_)
+        SNAPSHOT_ENEMY_VEC3S(SNAPSHOT_GET_NME_VEC3_)
+        if (nme->type < 1 || nme->type > 4) nme->type = 1;
+        nme->proj = (Vec3*)calloc(nme_meshes[nme->type - 1].num_vertices, sizeof(Vec3));
+    }
+    OPC_BYTES(len);
+    return true;
+}
+
+#endif // HYPERSPACE_SNAPSHOT_H
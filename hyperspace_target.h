@@ -0,0 +1,129 @@
+/*
+ * Hyperspace Target Traits
+ *
+ * Everything that differs between the targets at compile time, in one
+ * place: screen size, projection, the framebuffer's pixel format and
+ * layout, and the tables derived from them. Define one of
+ * - TARGET_GBA:          160x128, RGB555 (Mode 5, scaled by BG2)
+ * - TARGET_THUMBY_COLOR: 128x128, RGB565
+ * before including this; without either it is the PicoSystem, 120x120
+ * RGBA4444, which the host builds share.
+ *
+ * All of it is constant expressions, so the clip limits, centres and row
+ * strides fold into immediates in the rasterizer, and the tables are
+ * generated by the compiler instead of copied by hand into each port:
+ * - TARGET_PICO8_PALETTE: the 16 colours in the target's pixel format,
+ *   rounded from the PICO-8 RGB values
+ * - TARGET_RECIP_LUT: 65536 / i in Q16.16 for i = 0..512 (0 unused)
+ * TARGET_GEN_n(f, i) expands f(i) .. f(i + n - 1) for other tables.
+ * The projection and screen-centre constants are scalars of the math
+ * backend chosen in hyperspace_math.h.
+ */
+
+#ifndef HYPERSPACE_TARGET_H
+#define HYPERSPACE_TARGET_H
+
+#include "hyperspace_math.h"
+
+// ============================================================================
+// Traits
+// ============================================================================
+
+#if defined(TARGET_GBA)
+#define SCREEN_WIDTH 160
+#define SCREEN_HEIGHT 128
+#define TARGET_PIXEL_RGB555
+// Same scale as the PicoSystem: auto-aim measures screen distances, so the
+// wider screen shows more of the field instead of changing the game
+#define FIX_PROJ_CONST SC(-75.0)
+#elif defined(TARGET_THUMBY_COLOR)
+#define SCREEN_WIDTH 128
+#define SCREEN_HEIGHT 128
+#define TARGET_PIXEL_RGB565
+#define FIX_PROJ_CONST SC(-80.0)   // the PICO-8 original's
+#else
+// PicoSystem: 120x120 with pixel doubling
+#define SCREEN_WIDTH 120
+#define SCREEN_HEIGHT 120
+#define TARGET_PIXEL_RGBA4444
+#define FIX_PROJ_CONST SC(-75.0)   // adjusted for 120px (-80 for 128px)
+#endif
+
+// Pixels per row of the target framebuffer; the present loops write it
+// row by row from the 8-bit screen
+#ifndef TARGET_FB_STRIDE
+#define TARGET_FB_STRIDE SCREEN_WIDTH
+#endif
+
+// ============================================================================
+// Scalar Constants
+// ============================================================================
+
+#define FIX_HALF SC(0.5)
+#define FIX_TWO SC(2.0)
+#define FIX_PI SC_PI
+#define FIX_TWO_PI SC(6.28318530718)
+#define FIX_SCREEN_CENTER_X SC(SCREEN_WIDTH / 2.0)
+#define FIX_SCREEN_CENTER_Y SC(SCREEN_HEIGHT / 2.0)
+
+// ============================================================================
+// Pixel Format and Palette
+// ============================================================================
+
+// 8-bit channel to n bits, rounded: (v * max + 127) / 255
+#define TARGET_CH(v, max) (((v) * (max) + 127) / 255)
+
+#if defined(TARGET_PIXEL_RGBA4444)
+// ggggbbbbaaaarrrr, alpha opaque
+#define TARGET_RGB(r, g, b) \
+    ((TARGET_CH(g, 15) << 12) | (TARGET_CH(b, 15) << 8) | 0x00F0 | TARGET_CH(r, 15))
+#elif defined(TARGET_PIXEL_RGB555)
+// xbbbbbgggggrrrrr
+#define TARGET_RGB(r, g, b) \
+    (TARGET_CH(r, 31) | (TARGET_CH(g, 31) << 5) | (TARGET_CH(b, 31) << 10))
+#elif defined(TARGET_PIXEL_RGB565)
+// rrrrrggggggbbbbb
+#define TARGET_RGB(r, g, b) \
+    ((TARGET_CH(r, 31) << 11) | (TARGET_CH(g, 63) << 5) | TARGET_CH(b, 31))
+#endif
+
+#define TARGET_PICO8_PALETTE { \
+    TARGET_RGB(0x00, 0x00, 0x00),  /*  0: black       */ \
+    TARGET_RGB(0x1D, 0x2B, 0x53),  /*  1: dark blue   */ \
+    TARGET_RGB(0x7E, 0x25, 0x53),  /*  2: dark purple */ \
+    TARGET_RGB(0x00, 0x87, 0x51),  /*  3: dark green  */ \
+    TARGET_RGB(0xAB, 0x52, 0x36),  /*  4: brown       */ \
+    TARGET_RGB(0x5F, 0x57, 0x4F),  /*  5: dark gray   */ \
+    TARGET_RGB(0xC2, 0xC3, 0xC7),  /*  6: light gray  */ \
+    TARGET_RGB(0xFF, 0xF1, 0xE8),  /*  7: white       */ \
+    TARGET_RGB(0xFF, 0x00, 0x4D),  /*  8: red         */ \
+    TARGET_RGB(0xFF, 0xA3, 0x00),  /*  9: orange      */ \
+    TARGET_RGB(0xFF, 0xEC, 0x27),  /* 10: yellow      */ \
+    TARGET_RGB(0x00, 0xE4, 0x36),  /* 11: green       */ \
+    TARGET_RGB(0x29, 0xAD, 0xFF),  /* 12: blue        */ \
+    TARGET_RGB(0x83, 0x76, 0x9C),  /* 13: indigo      */ \
+    TARGET_RGB(0xFF, 0x77, 0xA8),  /* 14: pink        */ \
+    TARGET_RGB(0xFF, 0xCC, 0xAA),  /* 15: peach       */ \
+}
+
+// ============================================================================
+// Reciprocal Table
+// ============================================================================
+
+// Entries f(i) .. f(i + n - 1), doubled up to 512
+#define TARGET_GEN_1(f, i) f(i)
+#define TARGET_GEN_2(f, i) TARGET_GEN_1(f, i), TARGET_GEN_1(f, (i) + 1)
+#define TARGET_GEN_4(f, i) TARGET_GEN_2(f, i), TARGET_GEN_2(f, (i) + 2)
+#define TARGET_GEN_8(f, i) TARGET_GEN_4(f, i), TARGET_GEN_4(f, (i) + 4)
+#define TARGET_GEN_16(f, i) TARGET_GEN_8(f, i), TARGET_GEN_8(f, (i) + 8)
+#define TARGET_GEN_32(f, i) TARGET_GEN_16(f, i), TARGET_GEN_16(f, (i) + 16)
+#define TARGET_GEN_64(f, i) TARGET_GEN_32(f, i), TARGET_GEN_32(f, (i) + 32)
+#define TARGET_GEN_128(f, i) TARGET_GEN_64(f, i), TARGET_GEN_64(f, (i) + 64)
+#define TARGET_GEN_256(f, i) TARGET_GEN_128(f, i), TARGET_GEN_128(f, (i) + 128)
+#define TARGET_GEN_512(f, i) TARGET_GEN_256(f, i), TARGET_GEN_256(f, (i) + 256)
+
+#define TARGET_RECIP(i) ((i) ? 65536u / (i) : 0xFFFFFFFFu)
+#define TARGET_RECIP_LUT_SIZE 513
+#define TARGET_RECIP_LUT { TARGET_GEN_512(TARGET_RECIP, 0), TARGET_RECIP(512) }
+
+#endif // HYPERSPACE_TARGET_H
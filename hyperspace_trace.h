@@ -0,0 +1,173 @@
+/*
+ * Hyperspace Event Trace
+ *
+ * With TRACE_BUILD, begin/end/instant events go into a fixed ring buffer
+ * of TRACE_CAPACITY 8-byte records: a 32-bit microsecond timestamp, the
+ * event kind, a track (the main loop, the display DMA interrupt, the
+ * audio timer) and a name. Every PHASE_BEGIN()/PHASE_END() is an event on
+ * the main track; TRACE_BEGIN()/TRACE_END()/TRACE_INSTANT() add others.
+ * Once the ring is full the oldest events are overwritten.
+ *
+ * trace_dump() writes the ring as text; trace_to_chrome.py turns that
+ * into Chrome trace JSON for chrome://tracing or ui.perfetto.dev. The
+ * device dumps over UART when it receives 't', the host build with
+ * --trace FILE, so both produce the same format.
+ *
+ * The buffer is shared by several translation units (the main loop and
+ * picosystem_hardware.c): exactly one of them defines TRACE_IMPLEMENTATION
+ * before including this header. Without TRACE_BUILD every macro compiles
+ * to nothing.
+ */
+
+#ifndef HYPERSPACE_TRACE_H
+#define HYPERSPACE_TRACE_H
+
+#include "hyperspace_phases.h"
+
+#ifdef TRACE_BUILD
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifndef TRACE_CAPACITY
+#define TRACE_CAPACITY 4096  // power of two
+#endif
+_Static_assert((TRACE_CAPACITY & (TRACE_CAPACITY - 1)) == 0, "TRACE_CAPACITY must be a power of two");
+
+#define TRACE_FORMAT_VERSION 1
+
+// Event names after the frame phases, which keep their PHASE_* ids
+#define TRACE_EXTRA_NAMES(X) \
+    X(FRAME,       "frame")       \
+    X(DMA_IRQ,     "dma_irq")     \
+    X(AUDIO_TIMER, "audio_timer") \
+    X(FLASH_SAVE,  "flash_save")
+
+#define TRACE_NAME_ENUM(id, name) TRACE_##id,
+enum {
+    TRACE_FIRST_EXTRA = PHASE_COUNT - 1,
+    TRACE_EXTRA_NAMES(TRACE_NAME_ENUM)
+    TRACE_NAME_COUNT
+};
+#undef TRACE_NAME_ENUM
+
+// Tracks become threads in the timeline view
+#define TRACE_TRACKS(X) \
+    X(MAIN,  "main")    \
+    X(DMA,   "dma_isr") \
+    X(AUDIO, "audio_timer")
+
+#define TRACE_TRACK_ENUM(id, name) TRACE_TRACK_##id,
+enum { TRACE_TRACKS(TRACE_TRACK_ENUM) TRACE_TRACK_COUNT };
+#undef TRACE_TRACK_ENUM
+
+enum { TRACE_KIND_BEGIN = 'B', TRACE_KIND_END = 'E', TRACE_KIND_INSTANT = 'i' };
+
+typedef struct {
+    uint32_t ts;        // microseconds, wraps
+    uint8_t kind;       // TRACE_KIND_*
+    uint8_t track;      // TRACE_TRACK_*
+    uint16_t name;      // PHASE_* or TRACE_*
+} TraceEvent;
+
+typedef struct {
+    TraceEvent events[TRACE_CAPACITY];
+    uint32_t head;      // total events written
+    uint32_t (*now_us)(void);
+    volatile bool enabled;
+} TraceBuffer;
+
+#ifdef TRACE_IMPLEMENTATION
+TraceBuffer trace_buf;
+#else
+extern TraceBuffer trace_buf;
+#endif
+
+// Interrupt handlers record too, so claiming a slot must not be split by
+// one. On the Cortex-M0+ that means masking interrupts for a few cycles;
+// the host build is single threaded.
+#if defined(__ARM_ARCH_6M__)
+static inline uint32_t trace_lock(void) {
+    uint32_t primask;
+    __asm volatile ("mrs %0, primask\n\tcpsid i" : "=r" (primask) :: "memory");
+    return primask;
+}
+static inline void trace_unlock(uint32_t primask) {
+    __asm volatile ("msr primask, %0" :: "r" (primask) : "memory");
+}
+#else
+static inline uint32_t trace_lock(void) { return 0; }
+static inline void trace_unlock(uint32_t primask) { (void)primask; }
+#endif
+
+static inline void trace_emit(int kind, int track, int name) {
+    if (!trace_buf.enabled) return;
+    uint32_t primask = trace_lock();
+    TraceEvent* e = &trace_buf.events[trace_buf.head++ & (TRACE_CAPACITY - 1)];
+    e->ts = trace_buf.now_us();
+    e->kind = (uint8_t)kind;
+    e->track = (uint8_t)track;
+    e->name = (uint16_t)name;
+    trace_unlock(primask);
+}
+
+#define TRACE_BEGIN(track, name) trace_emit(TRACE_KIND_BEGIN, TRACE_TRACK_##track, name)
+#define TRACE_END(track, name) trace_emit(TRACE_KIND_END, TRACE_TRACK_##track, name)
+#define TRACE_INSTANT(track, name) trace_emit(TRACE_KIND_INSTANT, TRACE_TRACK_##track, name)
+#define TRACE_PHASE_BEGIN(p) TRACE_BEGIN(MAIN, p)
+#define TRACE_PHASE_END(p) TRACE_END(MAIN, p)
+
+static inline void trace_init(uint32_t (*now_us)(void)) {
+    trace_buf.now_us = now_us;
+    trace_buf.head = 0;
+    trace_buf.enabled = true;
+}
+
+static inline const char* trace_name(int name) {
+    #define TRACE_NAME_STR(id, str) str,
+    static const char* const extra[] = { TRACE_EXTRA_NAMES(TRACE_NAME_STR) };
+    #undef TRACE_NAME_STR
+    return name < PHASE_COUNT ? phase_names[name] : extra[name - PHASE_COUNT];
+}
+
+// Write the ring, oldest event first, and start a new recording. Format:
+//   trace <version> events <n> dropped <n>
+//   name <id> <string>      (one per event name)
+//   track <id> <string>     (one per track)
+//   <ts hex> <kind> <track> <name>
+//   end
+static void trace_dump(FILE* out) {
+    trace_buf.enabled = false;
+    uint32_t head = trace_buf.head;
+    uint32_t count = head < TRACE_CAPACITY ? head : TRACE_CAPACITY;
+
+    fprintf(out, "trace %d events %u dropped %u\r\n", TRACE_FORMAT_VERSION,
+            (unsigned)count, (unsigned)(head - count));
+    for (int i = 0; i < TRACE_NAME_COUNT; i++) {
+        fprintf(out, "name %d %s\r\n", i, trace_name(i));
+    }
+    #define TRACE_TRACK_DUMP(id, str) fprintf(out, "track %d %s\r\n", TRACE_TRACK_##id, str);
+    TRACE_TRACKS(TRACE_TRACK_DUMP)
+    #undef TRACE_TRACK_DUMP
+    for (uint32_t i = head - count; i != head; i++) {
+        const TraceEvent* e = &trace_buf.events[i & (TRACE_CAPACITY - 1)];
+        fprintf(out, "%08x %c %u %u\r\n", (unsigned)e->ts, e->kind, e->track, e->name);
+    }
+    fprintf(out, "end\r\n");
+
+    trace_buf.head = 0;
+    trace_buf.enabled = true;
+}
+
+#else
+
+#define TRACE_BEGIN(track, name) ((void)0)
+#define TRACE_END(track, name) ((void)0)
+#define TRACE_INSTANT(track, name) ((void)0)
+#define TRACE_PHASE_BEGIN(p) ((void)0)
+#define TRACE_PHASE_END(p) ((void)0)
+
+#endif // TRACE_BUILD
+
+#endif // HYPERSPACE_TRACE_H
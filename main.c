@@ -14,96 +14,63 @@
 #include <stdbool.h>
 
 #include "pico/stdlib.h"
+#include "hardware/clocks.h"
 #include "hardware/flash.h"
 #include "hardware/sync.h"
 #include "picosystem_hardware.h"
 #include "libfixmath/fixmath.h"
 
+// TRACE_BUILD: this file owns the event ring that picosystem_hardware.c
+// also records into
+#define TRACE_IMPLEMENTATION
+#include "hyperspace_trace.h"
+
+#ifdef SAMPLE_BUILD
+#include "hyperspace_sample.h"
+#endif
+
 // Flash storage for persistent data (use last sector of flash)
 // RP2040 has 2MB flash, sector size is 4KB
 #define FLASH_TARGET_OFFSET (PICO_FLASH_SIZE_BYTES - FLASH_SECTOR_SIZE)
 #define FLASH_MAGIC 0x48595045  // "HYPE" in hex
 
-extern struct picosystem_hw pshw;
+// OPCOUNT_BUILD: print the operation count report every N frames
+#define OPC_REPORT_FRAMES 300
 
-// ============================================================================
-// Screen and Fixed-Point Constants
-// ============================================================================
+// OVERDRAW_BUILD: print the fill-rate report every N frames
+#define OVD_REPORT_FRAMES 300
 
-// Screen dimensions (PicoSystem uses 120x120 with pixel doubling)
-#define SCREEN_WIDTH 120
-#define SCREEN_HEIGHT 120
+// Holding A and B at power-on runs the benchmark (hyperspace_bench.h)
+#define BENCH_CHORD_MASK ((1 << PICOSYSTEM_INPUT_A) | (1 << PICOSYSTEM_INPUT_B))
+#define ALL_BUTTONS_MASK ((1 << PICOSYSTEM_INPUT_UP) | (1 << PICOSYSTEM_INPUT_DOWN) | \
+                          (1 << PICOSYSTEM_INPUT_LEFT) | (1 << PICOSYSTEM_INPUT_RIGHT) | \
+                          (1 << PICOSYSTEM_INPUT_A) | (1 << PICOSYSTEM_INPUT_B) | \
+                          (1 << PICOSYSTEM_INPUT_X) | (1 << PICOSYSTEM_INPUT_Y))
 
-// Fixed-point constants
-#define FIX_HALF F16(0.5)
-#define FIX_TWO F16(2.0)
-#define FIX_PI fix16_pi
-#define FIX_TWO_PI F16(6.28318530718)
-#define FIX_SCREEN_CENTER F16(60.0)  // 120/2 for PicoSystem
-#define FIX_PROJ_CONST F16(-75.0)    // Adjusted for 120px screen (was -80 for 128px)
+// PROFILE_BUILD: X and Y pressed together toggle the profiler
+#define PROF_TOGGLE_MASK ((1 << PICOSYSTEM_INPUT_X) | (1 << PICOSYSTEM_INPUT_Y))
 
-// ============================================================================
-// Pico-8 Color Palette for PicoSystem
-// ============================================================================
-
-// Format: ggggbbbbaaaarrrr
-// Pre-calculated using (value * 15 + 127) / 255 for accurate 8-bit to 4-bit conversion
-// This provides proper rounding instead of truncation (>> 4)
-static const color_t PICO8_PALETTE[16] = {
-    0x00F0,  //  0: black        #000000 → ( 0,  0,  0)
-    0x35F2,  //  1: dark blue    #1D2B53 → ( 2,  3,  5)
-    0x25F7,  //  2: dark purple  #7E2553 → ( 7,  2,  5)
-    0x85F0,  //  3: dark green   #008751 → ( 0,  8,  5)
-    0x53FA,  //  4: brown        #AB5236 → (10,  5,  3)
-    0x55F6,  //  5: dark gray    #5F574F → ( 6,  5,  5)
-    0xBCFB,  //  6: light gray   #C2C3C7 → (11, 11, 12)
-    0xEEFF,  //  7: white        #FFF1E8 → (15, 14, 14)
-    0x05FF,  //  8: red          #FF004D → (15,  0,  5)
-    0xA0FF,  //  9: orange       #FFA300 → (15, 10,  0)
-    0xE2FF,  // 10: yellow       #FFEC27 → (15, 14,  2)
-    0xD3F0,  // 11: green        #00E436 → ( 0, 13,  3)
-    0xAFF2,  // 12: blue         #29ADFF → ( 2, 10, 15)
-    0x79F8,  // 13: indigo       #83769C → ( 8,  7,  9)
-    0x7AFF,  // 14: pink         #FF77A8 → (15,  7, 10)
-    0xCAFF,  // 15: peach        #FFCCAA → (15, 12, 10)
-};
+extern struct picosystem_hw pshw;
 
 // ============================================================================
-// Buffers and State (required by hyperspace_game.h)
+// Screen, Fixed-Point Constants and Palette (hyperspace_target.h)
 // ============================================================================
 
-// Virtual screen buffer (120x120)
-static uint8_t screen[SCREEN_HEIGHT][SCREEN_WIDTH];
-
-// Sprite sheet (128x128 pixels)
-static uint8_t spritesheet[128][128];
-
-// Map memory (for mesh data)
-static uint8_t map_memory[0x1000];
-
-// Palette mapping for pal()
-static uint8_t palette_map[16];
+// PicoSystem traits: 120x120 with pixel doubling, RGBA4444 (ggggbbbbaaaarrrr)
+#include "hyperspace_target.h"
 
-// Drawing color
-static uint8_t draw_color = 7;
+static const color_t PICO8_PALETTE[16] = TARGET_PICO8_PALETTE;
 
-// Clip region
-static int clip_x1 = 0, clip_y1 = 0, clip_x2 = SCREEN_WIDTH - 1, clip_y2 = SCREEN_HEIGHT - 1;
+// ============================================================================
+// Buffers, State and Pico-8 API (required by hyperspace_game.h)
+// ============================================================================
 
-// Random seed
-static uint32_t rnd_state = 1;
+#include "pico8_api.h"
 
-// Button states
-static bool btn_state[6] = {false};
-static bool btn_prev[6] = {false};
 #ifdef DEBUG_BUILD
 static bool btn_y_held = false;  // Y button for palette display
 #endif
 
-// Cart data (persistent storage)
-static int32_t cart_data[64] = {0};
-static bool cart_data_dirty = false;
-
 // ============================================================================
 // Flash Storage
 // ============================================================================
@@ -113,19 +80,19 @@ typedef struct {
     int32_t data[64];
 } FlashSaveData;
 
-static void load_cart_data(void) {
+static void load_cart_data(Pico8* p8) {
     const FlashSaveData* flash_data = (const FlashSaveData*)(XIP_BASE + FLASH_TARGET_OFFSET);
     if (flash_data->magic == FLASH_MAGIC) {
-        memcpy(cart_data, flash_data->data, sizeof(cart_data));
+        memcpy(p8->cart_data, flash_data->data, sizeof(p8->cart_data));
     }
 }
 
-static void save_cart_data(void) {
-    if (!cart_data_dirty) return;
+static void save_cart_data(Pico8* p8) {
+    if (!p8->cart_data_dirty) return;
 
     FlashSaveData save_data;
     save_data.magic = FLASH_MAGIC;
-    memcpy(save_data.data, cart_data, sizeof(cart_data));
+    memcpy(save_data.data, p8->cart_data, sizeof(p8->cart_data));
 
     // Pad to flash page size (minimum write size is 256 bytes)
     // save_data is 260 bytes (4 + 64*4), so we need 512 bytes
@@ -133,123 +100,14 @@ static void save_cart_data(void) {
     memset(buffer, 0xFF, sizeof(buffer));
     memcpy(buffer, &save_data, sizeof(save_data));
 
+    TRACE_BEGIN(MAIN, TRACE_FLASH_SAVE);
     uint32_t ints = save_and_disable_interrupts();
     flash_range_erase(FLASH_TARGET_OFFSET, FLASH_SECTOR_SIZE);
     flash_range_program(FLASH_TARGET_OFFSET, buffer, sizeof(buffer));
     restore_interrupts(ints);
+    TRACE_END(MAIN, TRACE_FLASH_SAVE);
 
-    cart_data_dirty = false;
-}
-
-// ============================================================================
-// Pico-8 API Implementation (required by hyperspace_game.h)
-// ============================================================================
-
-static void cls(void) {
-    memset(screen, 0, sizeof(screen));
-}
-
-static void pset(int x, int y, int c) {
-    if (x >= clip_x1 && x <= clip_x2 && y >= clip_y1 && y <= clip_y2 &&
-        x >= 0 && x < SCREEN_WIDTH && y >= 0 && y < SCREEN_HEIGHT) {
-        screen[y][x] = palette_map[c & 15];
-    }
-}
-
-// Fast pset - no clipping, no bounds check (for rasterizer inner loop)
-// Still uses palette_map for palette animation to work
-#define PSET_FAST(x, y, c) (screen[(y)][(x)] = palette_map[(c) & 15])
-
-static uint8_t pget(int x, int y) {
-    if (x >= 0 && x < SCREEN_WIDTH && y >= 0 && y < SCREEN_HEIGHT) {
-        return screen[y][x];
-    }
-    return 0;
-}
-
-static uint8_t sget(int x, int y) {
-    if (x >= 0 && x < 128 && y >= 0 && y < 128) {
-        return spritesheet[y][x];
-    }
-    return 0;
-}
-
-// Fast texture fetch - no bounds checking (caller must ensure valid coords)
-#define SGET_FAST(x, y) (spritesheet[(y)][(x)])
-
-static void line(int x0, int y0, int x1, int y1, int c) {
-    int dx = abs(x1 - x0);
-    int dy = abs(y1 - y0);
-    int sx = x0 < x1 ? 1 : -1;
-    int sy = y0 < y1 ? 1 : -1;
-    int err = dx - dy;
-
-    while (1) {
-        pset(x0, y0, c);
-        if (x0 == x1 && y0 == y1) break;
-        int e2 = 2 * err;
-        if (e2 > -dy) { err -= dy; x0 += sx; }
-        if (e2 < dx) { err += dx; y0 += sy; }
-    }
-}
-
-static void rectfill(int x0, int y0, int x1, int y1, int c) {
-    if (x0 > x1) { int t = x0; x0 = x1; x1 = t; }
-    if (y0 > y1) { int t = y0; y0 = y1; y1 = t; }
-    for (int y = y0; y <= y1; y++) {
-        for (int x = x0; x <= x1; x++) {
-            pset(x, y, c);
-        }
-    }
-}
-
-static void circfill(int cx, int cy, int r, int c) {
-    for (int y = -r; y <= r; y++) {
-        for (int x = -r; x <= r; x++) {
-            if (x*x + y*y <= r*r) {
-                pset(cx + x, cy + y, c);
-            }
-        }
-    }
-}
-
-static void spr(int n, int x, int y, int w, int h) {
-    int sx = (n & 15) * 8;  // bitmask instead of modulo
-    int sy = (n / 16) * 8;
-    for (int py = 0; py < h * 8; py++) {
-        for (int px = 0; px < w * 8; px++) {
-            uint8_t c = sget(sx + px, sy + py);
-            if (c != 0) {
-                pset(x + px, y + py, palette_map[c]);
-            }
-        }
-    }
-}
-
-static void pal_reset(void) {
-    for (int i = 0; i < 16; i++) palette_map[i] = i;
-}
-
-static void pal(int c0, int c1) {
-    palette_map[c0 & 15] = c1 & 15;
-}
-
-static void clip_set(int x, int y, int w, int h) {
-    clip_x1 = x;
-    clip_y1 = y;
-    clip_x2 = x + w - 1;
-    clip_y2 = y + h - 1;
-}
-
-static void clip_reset(void) {
-    clip_x1 = 0;
-    clip_y1 = 0;
-    clip_x2 = SCREEN_WIDTH - 1;
-    clip_y2 = SCREEN_HEIGHT - 1;
-}
-
-static void color(int c) {
-    draw_color = c & 15;
+    p8->cart_data_dirty = false;
 }
 
 // ============================================================================
@@ -265,25 +123,36 @@ void platform_sfx(int n, int channel) {
 // Include Shared Game Logic
 // ============================================================================
 
+// The game's span loop from raster_thumb.h instead of the core's
+#if defined(RASTER_SPAN_AFFINE) || defined(RASTER_SPAN_SUBDIV)
+#define PLATFORM_RASTER_SPAN
+#endif
+
 #include "hyperspace_game.h"
+#include "raster_thumb.h"
+#include "hyperspace_bench.h"
+#include "hyperspace_rastbench.h"
+
+// The single game instance on the device
+static GameContext game;
 
 // ============================================================================
 // Input Handling
 // ============================================================================
 
-static void update_input(void) {
-    memcpy(btn_prev, btn_state, sizeof(btn_prev));
+static void update_input(Pico8* p8) {
+    memcpy(p8->btn_prev, p8->btn_state, sizeof(p8->btn_prev));
 
     uint32_t io = pshw.io;
 
     // Map PicoSystem buttons to PICO-8 style
-    btn_state[0] = !(io & (1 << PICOSYSTEM_INPUT_LEFT));   // Left
-    btn_state[1] = !(io & (1 << PICOSYSTEM_INPUT_RIGHT));  // Right
-    btn_state[2] = !(io & (1 << PICOSYSTEM_INPUT_UP));     // Up
-    btn_state[3] = !(io & (1 << PICOSYSTEM_INPUT_DOWN));   // Down
+    p8->btn_state[0] = !(io & (1 << PICOSYSTEM_INPUT_LEFT));   // Left
+    p8->btn_state[1] = !(io & (1 << PICOSYSTEM_INPUT_RIGHT));  // Right
+    p8->btn_state[2] = !(io & (1 << PICOSYSTEM_INPUT_UP));     // Up
+    p8->btn_state[3] = !(io & (1 << PICOSYSTEM_INPUT_DOWN));   // Down
     // A and B both fire, X and Y both do barrel roll
-    btn_state[4] = !(io & (1 << PICOSYSTEM_INPUT_A)) || !(io & (1 << PICOSYSTEM_INPUT_B));  // A/B = fire
-    btn_state[5] = !(io & (1 << PICOSYSTEM_INPUT_X)) || !(io & (1 << PICOSYSTEM_INPUT_Y));  // X/Y = barrel roll
+    p8->btn_state[4] = !(io & (1 << PICOSYSTEM_INPUT_A)) || !(io & (1 << PICOSYSTEM_INPUT_B));  // A/B = fire
+    p8->btn_state[5] = !(io & (1 << PICOSYSTEM_INPUT_X)) || !(io & (1 << PICOSYSTEM_INPUT_Y));  // X/Y = barrel roll
 
 #ifdef DEBUG_BUILD
     // Y button alone for palette display
@@ -296,7 +165,7 @@ static void update_input(void) {
 // Palette Display (for PICO-8 color comparison)
 // ============================================================================
 
-static void draw_palette_display(void) {
+static void draw_palette_display(Pico8* p8) {
     // 4x4 grid of 16 colors
     // Each cell is 30x30 pixels (120/4 = 30)
     const int cell_size = 30;
@@ -310,19 +179,19 @@ static void draw_palette_display(void) {
         // Fill rectangle with color i (bypass palette_map to show true colors)
         for (int y = y0; y < y0 + cell_size; y++) {
             for (int x = x0; x < x0 + cell_size; x++) {
-                screen[y][x] = i;
+                p8->screen[y][x] = i;
             }
         }
 
         // Draw border (color 0 or 7 for contrast)
         int border_color = (i == 0 || i == 1 || i == 2 || i == 5) ? 7 : 0;
         for (int x = x0; x < x0 + cell_size; x++) {
-            screen[y0][x] = border_color;
-            screen[y0 + cell_size - 1][x] = border_color;
+            p8->screen[y0][x] = border_color;
+            p8->screen[y0 + cell_size - 1][x] = border_color;
         }
         for (int y = y0; y < y0 + cell_size; y++) {
-            screen[y][x0] = border_color;
-            screen[y][x0 + cell_size - 1] = border_color;
+            p8->screen[y][x0] = border_color;
+            p8->screen[y][x0 + cell_size - 1] = border_color;
         }
     }
 }
@@ -332,20 +201,61 @@ static void draw_palette_display(void) {
 // Screen Flip
 // ============================================================================
 
-static void flip_screen(void) {
+static void flip_screen(const Pico8* p8) {
     // Convert screen buffer to PicoSystem framebuffer
     buffer_t* fb = pshw.screen;
     if (!fb || !fb->data) return;
 
+    OPC_BYTES(sizeof(p8->screen) + SCREEN_WIDTH * SCREEN_HEIGHT * sizeof(color_t));
     for (int y = 0; y < SCREEN_HEIGHT; y++) {
         for (int x = 0; x < SCREEN_WIDTH; x++) {
-            fb->data[y * SCREEN_WIDTH + x] = PICO8_PALETTE[screen[y][x] & 15];
+            fb->data[y * TARGET_FB_STRIDE + x] = PICO8_PALETTE[p8->screen[y][x] & 15];
         }
     }
 
     picosystem_flip();
 }
 
+// ============================================================================
+// Benchmark
+// ============================================================================
+
+static void bench_present(GameContext* ctx) {
+    while (picosystem_is_flipping()) {}
+    picosystem_audio_update();
+    flip_screen(&ctx->p8);
+}
+
+// Run the scenarios unthrottled, then show the results; any button turns
+// the page, and after the last page the game starts
+static void run_benchmark(void) {
+    const BenchPlatform plat = {picosystem_time_us, bench_present, clock_get_hz(clk_sys) / 1000000, 0};
+    game_destroy(&game);
+    bench_run(&game, &plat);
+
+    for (int page = 0; page < BENCH_PAGES; page++) {
+        bench_draw_results(&game, page);
+        bench_present(&game);
+        // Wait for all buttons released, then for a press
+        while ((picosystem_gpio_get() & ALL_BUTTONS_MASK) != ALL_BUTTONS_MASK) { sleep_ms(10); }
+        while ((picosystem_gpio_get() & ALL_BUTTONS_MASK) == ALL_BUTTONS_MASK) { sleep_ms(10); }
+    }
+
+    game_init(&game, picosystem_time());
+}
+
+#ifdef RASTBENCH_BUILD
+// Rasterizer microbenchmark (hyperspace_rastbench.h), results over UART
+#define RASTBENCH_DEVICE_REPS 3
+
+static void run_rastbench(void) {
+    const RastBenchPlatform plat = {picosystem_time_us, clock_get_hz(clk_sys) / 1000000, RASTBENCH_DEVICE_REPS};
+    game_destroy(&game);
+    rastbench_run(&game, &plat);
+    game_init(&game, picosystem_time());
+}
+#endif
+
 // ============================================================================
 // Main
 // ============================================================================
@@ -369,14 +279,35 @@ int main()
     // Load sprite and map data
     load_embedded_data();
 
+#ifdef OPCOUNT_BUILD
+    // Print the measured cycle table for the host-side prediction
+    opc_calibrate(picosystem_time_us, clock_get_hz(clk_sys) / 1000000);
+#endif
+#ifdef PROFILE_BUILD
+    prof_init(picosystem_time_us);
+#endif
+#ifdef TRACE_BUILD
+    trace_init(picosystem_time_us);
+#endif
+#ifdef SAMPLE_BUILD
+    sample_start();
+#endif
+
     // Initialize game
-    rnd_state = picosystem_time();
-    game_init();
+    game_init(&game, picosystem_time());
+
+#ifdef RASTBENCH_BUILD
+    run_rastbench();
+#endif
 
     // Turn on backlight
     picosystem_backlight(75);
 
     pshw.io = picosystem_gpio_get();
+    if (!(pshw.io & BENCH_CHORD_MASK)) {
+        run_benchmark();
+        pshw.io = picosystem_gpio_get();
+    }
 
     uint32_t last_frame_time = picosystem_time();
     const uint32_t frame_duration = 33;  // ~30 FPS
@@ -388,31 +319,92 @@ int main()
         if (current_time - last_frame_time >= frame_duration) {
             last_frame_time = current_time;
 
+#ifdef OPCOUNT_BUILD
+            opc_frame_begin();
+#endif
+#ifdef PROFILE_BUILD
+            prof_frame_begin();
+#endif
+            TRACE_INSTANT(MAIN, TRACE_FRAME);
+
             // Update input
+            PHASE_BEGIN(PHASE_INPUT);
             pshw.lio = pshw.io;
             pshw.io = picosystem_gpio_get();
-            update_input();
+            update_input(&game.p8);
+            PHASE_END(PHASE_INPUT);
+#ifdef PROFILE_BUILD
+            // Buttons are active low; toggle on the frame both become held
+            if (!(pshw.io & PROF_TOGGLE_MASK) && (pshw.lio & PROF_TOGGLE_MASK)) {
+                prof_toggle();
+            }
+#endif
 
             // Wait for previous flip to complete
+            PHASE_BEGIN(PHASE_WAIT_FLIP);
             while(picosystem_is_flipping()) {}
+            PHASE_END(PHASE_WAIT_FLIP);
 
             // Update and render
 #ifdef DEBUG_BUILD
             if (btn_y_held) {
                 // Show palette display when Y is held
-                draw_palette_display();
+                draw_palette_display(&game.p8);
             } else
 #endif
             {
-                game_update();
-                game_draw();
+                game_update(&game);
+                game_draw(&game);
             }
 
             // Update audio system
+            PHASE_BEGIN(PHASE_AUDIO);
             picosystem_audio_update();
+            PHASE_END(PHASE_AUDIO);
+
+#ifdef PROFILE_BUILD
+            prof_draw_overlay(&game.p8);
+#endif
 
             // Flip to screen
-            flip_screen();
+            PHASE_BEGIN(PHASE_FLIP);
+            flip_screen(&game.p8);
+            PHASE_END(PHASE_FLIP);
+
+#ifdef OPCOUNT_BUILD
+            opc_frame_end();
+            if (opc_frames >= OPC_REPORT_FRAMES) {
+                opc_report(clock_get_hz(clk_sys) / 1000000);
+                opc_reset();
+            }
+#endif
+#ifdef PROFILE_BUILD
+            if (prof_frame_end()) {
+                prof_report();
+            }
+#endif
+#ifdef OVERDRAW_BUILD
+            ovd_frame_end();
+            if (ovd_frames >= OVD_REPORT_FRAMES) {
+                ovd_report(stdout);
+                ovd_reset();
+            }
+#endif
+#if defined(TRACE_BUILD) || defined(SAMPLE_BUILD)
+            // Serial console commands: 't' dumps the trace ring for
+            // trace_to_chrome.py, 'p' the PC samples for sample_profile.py
+            int cmd = getchar_timeout_us(0);
+#endif
+#ifdef TRACE_BUILD
+            if (cmd == 't') {
+                trace_dump(stdout);
+            }
+#endif
+#ifdef SAMPLE_BUILD
+            if (cmd == 'p') {
+                sample_dump();
+            }
+#endif
         }
 
         sleep_ms(1);
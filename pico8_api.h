@@ -0,0 +1,366 @@
+/*
+ * PICO-8 API for 8-bit indexed framebuffers
+ * Shared between the PicoSystem firmware and the host build
+ *
+ * This file expects the following to be defined before inclusion:
+ * - SCREEN_WIDTH, SCREEN_HEIGHT
+ *
+ * It provides the Pico8 machine state that hyperspace_game.h needs
+ * (screen, palette_map, clip, rnd_state, buttons, cart data), the shared
+ * spritesheet and map_memory, and the drawing primitives that operate on
+ * them. Every primitive takes the Pico8 it draws into, so several
+ * machines can exist at once. Platforms still provide
+ * load_cart_data()/save_cart_data() and the code that turns
+ * screen[][] into pixels.
+ *
+ * Optional platform hooks, defined before inclusion:
+ * - PICO8_BSS: placement attribute for the spritesheet and map memory
+ *   (the GBA keeps them out of its 32 KB IWRAM)
+ * - PLATFORM_CLS: cls() calls platform_cls(p8) instead of memset()
+ * - PICO8_DRAWN_BLACK: the screen index pal() and pal_reset() give colour
+ *   0, so that index 0 only ever marks pixels cls() cleared (the GBA shows
+ *   background sprites through them). It must display as colour 0
+ * - PICO8_BYTE_WRITES: rectfill(), spr() and print_char() write one
+ *   pixel at a time through pset() instead of in 32-bit words (implied by
+ *   OPCOUNT_BUILD and OVERDRAW_BUILD, which count every pixel)
+ *
+ * The word writes gather 4 pixels into a 32-bit word and store aligned
+ * words, merging under a byte mask where some pixels are clipped or
+ * transparent: on the M0+ a word store costs what a byte store does. Byte
+ * i of a word is pixel x + i, so they assume a little-endian target and a
+ * screen width that is a multiple of 4.
+ */
+
+#ifndef PICO8_API_H
+#define PICO8_API_H
+
+#include "hyperspace_opcount.h"
+#include "hyperspace_overdraw.h"
+
+#if defined(OPCOUNT_BUILD) || defined(OVERDRAW_BUILD)
+#define PICO8_BYTE_WRITES
+#endif
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "pico8_api.h: the word writes need a little-endian target"
+#endif
+_Static_assert(SCREEN_WIDTH % 4 == 0, "pico8_api.h: screen rows must be whole words");
+
+// ============================================================================
+// Buffers and State (required by hyperspace_game.h)
+// ============================================================================
+
+#ifndef PICO8_BSS
+#define PICO8_BSS
+#endif
+
+// Sprite sheet (128x128 pixels of 0..15), shared and read-only after
+// loading; word-aligned so spr() can read 4 pixels at once
+static PICO8_BSS uint8_t spritesheet[128][128] __attribute__((aligned(4)));
+
+// Map memory (for mesh data), shared and read-only after loading
+static PICO8_BSS uint8_t map_memory[0x1000];
+
+typedef struct {
+    // Palette mapping for pal()
+    uint8_t palette_map[16];
+
+    // Drawing color
+    uint8_t draw_color;
+
+    // Clip region
+    int clip_x1, clip_y1, clip_x2, clip_y2;
+
+    // Random seed
+    uint32_t rnd_state;
+
+    // Button states
+    bool btn_state[6];
+    bool btn_prev[6];
+
+    // Cart data (persistent storage)
+    int32_t cart_data[64];
+    bool cart_data_dirty;
+
+    // Virtual screen buffer, word-aligned for the platforms' block copies
+    uint8_t screen[SCREEN_HEIGHT][SCREEN_WIDTH] __attribute__((aligned(4)));
+} Pico8;
+
+// ============================================================================
+// Word Writes
+// ============================================================================
+
+// The screen index drawing colour c writes before any pal() remap
+#ifdef PICO8_DRAWN_BLACK
+#define PICO8_SCREEN_INDEX(c) ((c) ? (c) : PICO8_DRAWN_BLACK)
+#else
+#define PICO8_SCREEN_INDEX(c) (c)
+#endif
+
+// A word of the screen or spritesheet, which are byte arrays
+typedef uint32_t __attribute__((may_alias)) pico8_word_t;
+
+// Bytes 0..n-1 of a word
+static const uint32_t pico8_lead_mask[5] = {0, 0x000000FF, 0x0000FFFF, 0x00FFFFFF, 0xFFFFFFFF};
+
+// Bytes of the word at x whose pixels lie in x1..x2
+static inline uint32_t pico8_range_mask(int x, int x1, int x2) {
+    int start = x1 - x, end = x2 - x + 1;
+    if (start < 0) start = 0;
+    if (end > 4) end = 4;
+    return start < end ? pico8_lead_mask[end] & ~pico8_lead_mask[start] : 0;
+}
+
+// 0xFF for every non-zero byte; bytes must be below 0x80 (palette indices)
+static inline uint32_t pico8_opaque_mask(uint32_t pixels) {
+    uint32_t high = (pixels + 0x7F7F7F7F) & 0x80808080;
+    return high | (high - (high >> 7));
+}
+
+// The clip rectangle within the screen; empty when x1 > x2 or y1 > y2
+static inline void pico8_clip_bounds(const Pico8* p8, int* x1, int* y1, int* x2, int* y2) {
+    *x1 = p8->clip_x1 > 0 ? p8->clip_x1 : 0;
+    *y1 = p8->clip_y1 > 0 ? p8->clip_y1 : 0;
+    *x2 = p8->clip_x2 < SCREEN_WIDTH - 1 ? p8->clip_x2 : SCREEN_WIDTH - 1;
+    *y2 = p8->clip_y2 < SCREEN_HEIGHT - 1 ? p8->clip_y2 : SCREEN_HEIGHT - 1;
+}
+
+// Store the bytes of pixels selected by mask into the word at x, a
+// multiple of 4
+static inline void pico8_store_word(Pico8* p8, int x, int y, uint32_t pixels, uint32_t mask) {
+    pico8_word_t* w = (pico8_word_t*)&p8->screen[y][x];
+    *w = mask == 0xFFFFFFFF ? pixels : (*w & ~mask) | (pixels & mask);
+}
+
+// The same for pixels x..x+3 at any x, split over the words they touch;
+// mask must only select pixels on the screen
+static inline void pico8_put_word(Pico8* p8, int x, int y, uint32_t pixels, uint32_t mask) {
+    int shift = (x & 3) * 8;
+    int ax = x & ~3;
+    if (mask << shift) pico8_store_word(p8, ax, y, pixels << shift, mask << shift);
+    if (shift && mask >> (32 - shift)) {
+        pico8_store_word(p8, ax + 4, y, pixels >> (32 - shift), mask >> (32 - shift));
+    }
+}
+
+// Pixels x1..x2 of row y, all on the screen, set to the color in every
+// byte of pixels
+static inline void pico8_fill_row(Pico8* p8, int x1, int x2, int y, uint32_t pixels) {
+    int x = x1 & ~3;
+    if (x < x1) {
+        pico8_store_word(p8, x, y, pixels, pico8_range_mask(x, x1, x2));
+        x += 4;
+    }
+    pico8_word_t* w = (pico8_word_t*)&p8->screen[y][x];
+    for (; x + 3 <= x2; x += 4) *w++ = pixels;
+    if (x <= x2) pico8_store_word(p8, x, y, pixels, pico8_range_mask(x, x1, x2));
+}
+
+// ============================================================================
+// Pico-8 API Implementation (required by hyperspace_game.h)
+// ============================================================================
+
+static void clip_reset(Pico8* p8);
+
+#ifdef PLATFORM_CLS
+static void platform_cls(Pico8* p8);
+#endif
+
+// Power-on state: blank screen, no clipping, RNG seeded with seed
+static void pico8_init(Pico8* p8, uint32_t seed) {
+    memset(p8, 0, sizeof(Pico8));
+    p8->draw_color = 7;
+    clip_reset(p8);
+    p8->rnd_state = seed;
+}
+
+static void cls(Pico8* p8) {
+    OPC_FUNC();
+    OPC_BYTES(sizeof(p8->screen));
+    OVD_CLEAR();
+#ifdef PLATFORM_CLS
+    platform_cls(p8);
+#else
+    memset(p8->screen, 0, sizeof(p8->screen));
+#endif
+}
+
+static void pset(Pico8* p8, int x, int y, int c) {
+    if (x >= p8->clip_x1 && x <= p8->clip_x2 && y >= p8->clip_y1 && y <= p8->clip_y2 &&
+        x >= 0 && x < SCREEN_WIDTH && y >= 0 && y < SCREEN_HEIGHT) {
+        OPC_COUNT(OPC_PIXEL);
+        OVD_PIXEL_AT(x, y);
+        p8->screen[y][x] = p8->palette_map[c & 15];
+    }
+}
+
+// Fast pset - no clipping, no bounds check (for rasterizer inner loop)
+// Still uses palette_map for palette animation to work
+#define PSET_FAST(p8, x, y, c) (OPC_COUNT(OPC_PIXEL), OVD_PIXEL_AT((x), (y)), (p8)->screen[(y)][(x)] = (p8)->palette_map[(c) & 15])
+
+static uint8_t pget(Pico8* p8, int x, int y) {
+    if (x >= 0 && x < SCREEN_WIDTH && y >= 0 && y < SCREEN_HEIGHT) {
+        return p8->screen[y][x];
+    }
+    return 0;
+}
+
+static uint8_t sget(int x, int y) {
+    if (x >= 0 && x < 128 && y >= 0 && y < 128) {
+        OPC_COUNT(OPC_TEXEL);
+        OVD_COUNT(TEXEL);
+        return spritesheet[y][x];
+    }
+    return 0;
+}
+
+// Fast texture fetch - no bounds checking (caller must ensure valid coords)
+#define SGET_FAST(x, y) (OPC_COUNT(OPC_TEXEL), OVD_COUNT(TEXEL), spritesheet[(y)][(x)])
+
+static void line(Pico8* p8, int x0, int y0, int x1, int y1, int c) {
+    OPC_FUNC();
+    int dx = abs(x1 - x0);
+    int dy = abs(y1 - y0);
+    int sx = x0 < x1 ? 1 : -1;
+    int sy = y0 < y1 ? 1 : -1;
+    int err = dx - dy;
+
+    while (1) {
+        pset(p8, x0, y0, c);
+        if (x0 == x1 && y0 == y1) break;
+        int e2 = 2 * err;
+        if (e2 > -dy) { err -= dy; x0 += sx; }
+        if (e2 < dx) { err += dx; y0 += sy; }
+    }
+}
+
+// rectfill() a pixel at a time; the reference for the word writes
+static void rectfill_bytes(Pico8* p8, int x0, int y0, int x1, int y1, int c) {
+    if (x0 > x1) { int t = x0; x0 = x1; x1 = t; }
+    if (y0 > y1) { int t = y0; y0 = y1; y1 = t; }
+    for (int y = y0; y <= y1; y++) {
+        for (int x = x0; x <= x1; x++) {
+            pset(p8, x, y, c);
+        }
+    }
+}
+
+static void rectfill(Pico8* p8, int x0, int y0, int x1, int y1, int c) {
+    OPC_FUNC();
+#ifdef PICO8_BYTE_WRITES
+    rectfill_bytes(p8, x0, y0, x1, y1, c);
+#else
+    if (x0 > x1) { int t = x0; x0 = x1; x1 = t; }
+    if (y0 > y1) { int t = y0; y0 = y1; y1 = t; }
+    int cx1, cy1, cx2, cy2;
+    pico8_clip_bounds(p8, &cx1, &cy1, &cx2, &cy2);
+    if (x0 < cx1) x0 = cx1;
+    if (x1 > cx2) x1 = cx2;
+    if (y0 < cy1) y0 = cy1;
+    if (y1 > cy2) y1 = cy2;
+    if (x0 > x1) return;
+
+    uint32_t pixels = p8->palette_map[c & 15] * 0x01010101u;
+    for (int y = y0; y <= y1; y++) {
+        pico8_fill_row(p8, x0, x1, y, pixels);
+    }
+#endif
+}
+
+static void circfill(Pico8* p8, int cx, int cy, int r, int c) {
+    OPC_FUNC();
+    for (int y = -r; y <= r; y++) {
+        for (int x = -r; x <= r; x++) {
+            if (x*x + y*y <= r*r) {
+                pset(p8, cx + x, cy + y, c);
+            }
+        }
+    }
+}
+
+// spr() a pixel at a time; the reference for the word writes
+static void spr_bytes(Pico8* p8, int n, int x, int y, int w, int h) {
+    int sx = (n & 15) * 8;  // bitmask instead of modulo
+    int sy = (n / 16) * 8;
+    for (int py = 0; py < h * 8; py++) {
+        for (int px = 0; px < w * 8; px++) {
+            uint8_t c = sget(sx + px, sy + py);
+            if (c != 0) {
+                pset(p8, x + px, y + py, p8->palette_map[c]);
+            }
+        }
+    }
+}
+
+static void spr(Pico8* p8, int n, int x, int y, int w, int h) {
+    OPC_FUNC();
+#ifdef PICO8_BYTE_WRITES
+    spr_bytes(p8, n, x, y, w, h);
+#else
+    int sx = (n & 15) * 8;
+    int sy = (n / 16) * 8;
+    int cx1, cy1, cx2, cy2;
+    pico8_clip_bounds(p8, &cx1, &cy1, &cx2, &cy2);
+
+    // Off the sheet is transparent, as sget() makes it; both stay
+    // multiples of 8, so every word read is within a sheet row
+    int cols = w * 8, rows = h * 8, first_row = sy < 0 ? -sy : 0;
+    if (sx + cols > 128) cols = 128 - sx;
+    if (sy + rows > 128) rows = 128 - sy;
+
+    // The colors pset(palette_map[c]) ends up writing; colour 0 is
+    // transparent, so its entry never reaches the screen
+    uint8_t map[16];
+    bool identity = true;
+    for (int i = 0; i < 16; i++) {
+        map[i] = p8->palette_map[p8->palette_map[i] & 15];
+        identity &= i == 0 || map[i] == i;
+    }
+
+    for (int py = first_row; py < rows; py++) {
+        int dy = y + py;
+        if (dy < cy1 || dy > cy2) continue;
+        const uint8_t* src = &spritesheet[sy + py][sx];
+        for (int px = 0; px < cols; px += 4) {
+            uint32_t mask = pico8_range_mask(x + px, cx1, cx2);
+            if (!mask) continue;
+            uint32_t pixels = *(const pico8_word_t*)&src[px];
+            mask &= pico8_opaque_mask(pixels);
+            if (!mask) continue;
+            if (!identity) {
+                pixels = map[pixels & 15] | map[(pixels >> 8) & 15] << 8 |
+                         map[(pixels >> 16) & 15] << 16 | (uint32_t)map[pixels >> 24 & 15] << 24;
+            }
+            pico8_put_word(p8, x + px, dy, pixels, mask);
+        }
+    }
+#endif
+}
+
+static void pal_reset(Pico8* p8) {
+    for (int i = 0; i < 16; i++) p8->palette_map[i] = PICO8_SCREEN_INDEX(i);
+}
+
+static void pal(Pico8* p8, int c0, int c1) {
+    p8->palette_map[c0 & 15] = PICO8_SCREEN_INDEX(c1 & 15);
+}
+
+static void clip_set(Pico8* p8, int x, int y, int w, int h) {
+    p8->clip_x1 = x;
+    p8->clip_y1 = y;
+    p8->clip_x2 = x + w - 1;
+    p8->clip_y2 = y + h - 1;
+}
+
+static void clip_reset(Pico8* p8) {
+    p8->clip_x1 = 0;
+    p8->clip_y1 = 0;
+    p8->clip_x2 = SCREEN_WIDTH - 1;
+    p8->clip_y2 = SCREEN_HEIGHT - 1;
+}
+
+static void color(Pico8* p8, int c) {
+    p8->draw_color = c & 15;
+}
+
+#endif // PICO8_API_H
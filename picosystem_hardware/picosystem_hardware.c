@@ -8,6 +8,7 @@
 
 #include "picosystem_hardware.h"
 #include "hardware/timer.h"
+#include "../hyperspace_trace.h"
 
 
 #ifdef PIXEL_DOUBLE
@@ -148,18 +149,21 @@ void picosystem_transmit_scanline()
 void __isr picosystem_dma_complete() {
   if(dma_channel_get_irq0_status(pshw.dma_channel)) {
     dma_channel_acknowledge_irq0(pshw.dma_channel); // clear irq flag
+    TRACE_BEGIN(DMA, TRACE_DMA_IRQ);
 
     #ifdef PIXEL_DOUBLE
       if(++pshw.dma_scanline > 120) {
         // all scanlines done. reset counter and exit
         pshw.dma_scanline = -1;
         pshw.in_flip = false;
-        return;
+      } else {
+        picosystem_transmit_scanline();
       }
-      picosystem_transmit_scanline();
     #else
       pshw.in_flip = false;
     #endif
+
+    TRACE_END(DMA, TRACE_DMA_IRQ);
   }
 }
 
@@ -646,7 +650,9 @@ static struct repeating_timer ps_audio_timer;
 
 static bool ps_audio_timer_callback(struct repeating_timer *t) {
     (void)t;
+    TRACE_BEGIN(AUDIO, TRACE_AUDIO_TIMER);
     ps_update_piezo_frequency();
+    TRACE_END(AUDIO, TRACE_AUDIO_TIMER);
     return true;
 }
 
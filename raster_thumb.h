@@ -0,0 +1,221 @@
+/*
+ * Hyperspace - Affine and Subdivided Spans
+ * Shared by the PicoSystem build (main.c) and the host build
+ *
+ * Cheaper replacements for the core's textured span (raster_span_body() in
+ * hyperspace_game.h), which divides for the perspective-correct UV of
+ * every pixel. These resolve the UV exactly as the core does at a few
+ * points and step it linearly in between:
+ * - raster_span_affine_*(): at both ends of the span
+ * - raster_span_subdiv_*(): every RASTER_SUBDIV pixels and at the last
+ *   one, which keeps close boss and ship faces straight
+ * The light dither is still chosen per pixel from the 8x8 block at sheet
+ * (0, 56), so lighting matches the core; only the texel positions move.
+ *
+ * The *_thumb spans run the pixel loop in render_span_thumb (raster_thumb.s,
+ * built with RASTER_THUMB_ASM): Thumb-1 for the M0+, in SRAM, every value
+ * in a register. The *_c spans run the C loop below, which writes the same
+ * pixels and counts them for OPCOUNT_BUILD and OVERDRAW_BUILD.
+ *
+ * With RASTER_SPAN_AFFINE or RASTER_SPAN_SUBDIV, defined together with
+ * PLATFORM_RASTER_SPAN before hyperspace_game.h, the game draws with one of
+ * them. Either way rastbench times them against the core's spans.
+ *
+ * Include after hyperspace_game.h.
+ */
+
+#ifndef RASTER_THUMB_H
+#define RASTER_THUMB_H
+
+#include <stddef.h>
+
+// Perspective every 2^RASTER_SUBDIV_SHIFT pixels in raster_span_subdiv_*()
+#ifndef RASTER_SUBDIV_SHIFT
+#define RASTER_SUBDIV_SHIFT 4
+#endif
+#define RASTER_SUBDIV (1 << RASTER_SUBDIV_SHIFT)
+
+// 65536 / n (Q16.16) for the last segment's length n < RASTER_SUBDIV
+_Static_assert(RASTER_SUBDIV_SHIFT <= 6, "raster_thumb_recip covers segments up to 64 pixels");
+static const uint32_t raster_thumb_recip[64] = { TARGET_GEN_64(TARGET_RECIP, 0) };
+
+// The asm counts nothing, so the instrumentation builds keep the C loop
+#if defined(RASTER_THUMB_ASM) && !defined(OPCOUNT_BUILD) && !defined(OVERDRAW_BUILD)
+#define RASTER_THUMB_PIXELS_ASM
+#endif
+
+// One run of pixels. U and V are Q16.16 texel coordinates with the texture
+// offset added, shifted left 9, so the texel (mod 128) is the top 7 bits
+// and stepping wraps by itself. raster_thumb.s reads the fields by offset.
+typedef struct {
+    uint32_t u, v;
+    uint32_t du, dv;        // per pixel
+    uint32_t lit_u;         // the lit texture's offset, added to u on lit pixels
+    uint32_t lit_mask;      // raster_thumb_lit_mask()
+    const uint8_t* tex;     // spritesheet
+    const uint8_t* pal;     // palette map
+} ThumbSpan;
+
+#ifdef RASTER_THUMB_ASM
+_Static_assert(offsetof(ThumbSpan, lit_u) == 16 && offsetof(ThumbSpan, lit_mask) == 20 &&
+               offsetof(ThumbSpan, tex) == 24 && offsetof(ThumbSpan, pal) == 28,
+               "ThumbSpan layout is fixed in raster_thumb.s");
+
+// raster_thumb.s: count pixels ending just before end
+extern void render_span_thumb(uint8_t* end, int count, const ThumbSpan* p);
+#endif
+
+// The lit pattern for pixels ending before x_end: pixel x_end + i (i < 0)
+// is lit when bit (i - 1) & 31 is set, which is the carry of rotating the
+// mask right by i. lit8 has bit k set where x & 7 == k is lit.
+static inline uint32_t raster_thumb_lit_mask(unsigned lit8, int x_end) {
+    int r = (x_end + 1) & 7;
+    uint32_t rot = ((lit8 >> r) | (lit8 << (8 - r))) & 0xFF;
+    return rot * 0x01010101u;
+}
+
+// render_span_thumb in C
+static void raster_thumb_pixels_c(GameContext* ctx, int py, int x_end, int count, const ThumbSpan* p) {
+    uint8_t* end = &ctx->p8.screen[py][x_end];
+    uint32_t u = p->u, v = p->v;
+    for (int i = -count; i < 0; i++) {
+        uint32_t tu = (p->lit_mask >> ((i - 1) & 31)) & 1 ? u + p->lit_u : u;
+        OPC_COUNT(OPC_TEXEL);
+        OVD_COUNT(TEXEL);
+        OPC_COUNT(OPC_PIXEL);
+        OVD_PIXEL_AT(x_end + i, py);
+        end[i] = p->pal[p->tex[(v >> 25) * 128 + (tu >> 25)]];
+        u += p->du;
+        v += p->dv;
+    }
+}
+
+// U and V (Q16.16) at barycentric weights b0, b1, exactly as the core's
+// span computes them; false where the perspective sum degenerates
+static inline bool raster_thumb_uv(const RasterTri* t, scalar_t b0, scalar_t b1, int32_t* u, int32_t* v) {
+    scalar_t b2 = SC_ONE - b0 - b1;
+    b0 = sc_mul(b0, t->z0);
+    b1 = sc_mul(b1, t->z1);
+    b2 = sc_mul(b2, t->z2);
+    scalar_t d2 = b0 + b1 + b2;
+    if (sc_abs(d2) < SC(0.001)) return false;
+    scalar_t inv_d2 = sc_div(SC_ONE, d2);
+    *u = sc_to_q16(sc_mul(sc_mul(b0, t->uv0x) + sc_mul(b1, t->uv1x) + sc_mul(b2, t->uv2x), inv_d2));
+    *v = sc_to_q16(sc_mul(sc_mul(b0, t->uv0y) + sc_mul(b1, t->uv1y) + sc_mul(b2, t->uv2y), inv_d2));
+    return true;
+}
+
+// The UV n pixels into span s
+static inline bool raster_thumb_uv_at(const RasterTri* t, const RasterSpan* s, int n, int32_t* u, int32_t* v) {
+    return raster_thumb_uv(t, s->b0 + s->db0_dx * n, s->b1 + s->db1_dx * n, u, v);
+}
+
+// Pixels x..x_end-1 stepping from (u0, v0) by (du, dv)
+static inline __attribute__((always_inline)) void raster_thumb_run(GameContext* ctx, ThumbSpan* p, unsigned lit8, int py,
+                                                                   int x_end, int count, int32_t u0, int32_t v0,
+                                                                   int32_t du, int32_t dv, bool use_asm) {
+    p->u = (uint32_t)u0 << 9;
+    p->v = (uint32_t)v0 << 9;
+    p->du = (uint32_t)du << 9;
+    p->dv = (uint32_t)dv << 9;
+    p->lit_mask = raster_thumb_lit_mask(lit8, x_end);
+#ifdef RASTER_THUMB_PIXELS_ASM
+    if (use_asm) {
+        render_span_thumb(&ctx->p8.screen[py][x_end], count, p);
+        return;
+    }
+#endif
+    (void)use_asm;
+    raster_thumb_pixels_c(ctx, py, x_end, count, p);
+}
+
+// The span, resolving perspective every 2^subdiv_shift pixels, or at its
+// ends with subdiv_shift 0
+static inline __attribute__((always_inline)) void raster_thumb_span(GameContext* ctx, const RasterTri* t, const RasterSpan* s,
+                                                                    int subdiv_shift, bool use_asm) {
+    int xl = sc_to_int(s->xfirst);
+    int xr = sc_to_int(s->xlast);
+    if (xl > xr) return;
+
+    ThumbSpan p;
+    p.lit_u = (uint32_t)t->tex_lit_x << 25;
+    p.tex = &spritesheet[0][0];
+    p.pal = ctx->p8.palette_map;
+
+    // The core's dither test for each x & 7 of this row (d / 8 is exact,
+    // as the core's multiply by 0.125)
+    const uint8_t* dither = spritesheet[56 + (s->py & 7)];
+    unsigned lit8 = 0;
+    for (int k = 0; k < 8; k++) {
+        if (t->light <= SC(7.0) + sc_from_int(dither[k]) / 8) lit8 |= 1u << k;
+    }
+
+    int32_t off_u = t->tex_x * 65536, off_v = t->tex_y * 65536;
+    int32_t u, v;
+    if (!raster_thumb_uv_at(t, s, 0, &u, &v)) return;
+
+    if (!subdiv_shift) {
+        int n = xr - xl;
+        int32_t u1 = u, v1 = v;
+        if (n) raster_thumb_uv_at(t, s, n, &u1, &v1);
+        raster_thumb_run(ctx, &p, lit8, s->py, xr + 1, n + 1, u + off_u, v + off_v,
+                         n ? (u1 - u) / n : 0, n ? (v1 - v) / n : 0, use_asm);
+        return;
+    }
+
+    int seg = 1 << subdiv_shift;
+    for (int x = xl; x <= xr; x += seg) {
+        int count = xr - x + 1 < seg ? xr - x + 1 : seg;
+        int32_t u1 = u, v1 = v, du = 0, dv = 0;
+        if (xr - x + 1 > seg) {
+            raster_thumb_uv_at(t, s, x - xl + seg, &u1, &v1);
+            du = (u1 - u) >> subdiv_shift;
+            dv = (v1 - v) >> subdiv_shift;
+        } else if (count > 1) {
+            // The last segment ends on xr, n pixels on: resolving the next
+            // subdivision point instead could land past the horizon
+            int n = count - 1;
+            raster_thumb_uv_at(t, s, x - xl + n, &u1, &v1);
+            du = (int32_t)(((int64_t)(u1 - u) * raster_thumb_recip[n]) >> 16);
+            dv = (int32_t)(((int64_t)(v1 - v) * raster_thumb_recip[n]) >> 16);
+        }
+        raster_thumb_run(ctx, &p, lit8, s->py, x + count, count, u + off_u, v + off_v, du, dv, use_asm);
+        u = u1;
+        v = v1;
+    }
+}
+
+static GAME_HOT void raster_span_affine_c(GameContext* ctx, const RasterTri* t, const RasterSpan* s) {
+    raster_thumb_span(ctx, t, s, 0, false);
+}
+
+static GAME_HOT void raster_span_subdiv_c(GameContext* ctx, const RasterTri* t, const RasterSpan* s) {
+    raster_thumb_span(ctx, t, s, RASTER_SUBDIV_SHIFT, false);
+}
+
+#ifdef RASTER_THUMB_PIXELS_ASM
+static GAME_HOT void raster_span_affine_thumb(GameContext* ctx, const RasterTri* t, const RasterSpan* s) {
+    raster_thumb_span(ctx, t, s, 0, true);
+}
+
+static GAME_HOT void raster_span_subdiv_thumb(GameContext* ctx, const RasterTri* t, const RasterSpan* s) {
+    raster_thumb_span(ctx, t, s, RASTER_SUBDIV_SHIFT, true);
+}
+#define raster_span_affine raster_span_affine_thumb
+#define raster_span_subdiv raster_span_subdiv_thumb
+#else
+#define raster_span_affine raster_span_affine_c
+#define raster_span_subdiv raster_span_subdiv_c
+#endif
+
+#if defined(RASTER_SPAN_AFFINE) && defined(PLATFORM_RASTER_SPAN)
+static GAME_HOT void platform_raster_span(GameContext* ctx, const RasterTri* t, const RasterSpan* s) {
+    raster_span_affine(ctx, t, s);
+}
+#elif defined(RASTER_SPAN_SUBDIV) && defined(PLATFORM_RASTER_SPAN)
+static GAME_HOT void platform_raster_span(GameContext* ctx, const RasterTri* t, const RasterSpan* s) {
+    raster_span_subdiv(ctx, t, s);
+}
+#endif
+
+#endif // RASTER_THUMB_H
@@ -0,0 +1,112 @@
+@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+@
+@  raster_thumb.s - hand-tuned Thumb-1 span loop for Hyperspace PicoSystem
+@
+@  the RP2040's Cortex-M0+ only has Thumb-1 (ARMv6-M): no shifted
+@  operands, no post-increment, 8 low regs for most things. the loop lives
+@  in SRAM (.time_critical, copied at boot) so XIP cache misses can't stall it
+@
+@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+
+    .syntax unified
+    .cpu    cortex-m0plus
+    .thumb
+    .section .time_critical.render_span_thumb, "ax", %progbits
+    .align  2
+
+
+@-----------------------------------------------------------------------------
+@  render_span_thumb
+@
+@  draws one horizontal span of affine textured pixels
+@  (called by raster_thumb_run in raster_thumb.h, which has the same loop
+@  in C for the host and the instrumentation builds)
+@
+@  u and v come pre-shifted left 9 with the texture offset in, so the
+@  texel column and row are just the top 7 bits. lit pixels add lit_u
+@  to u; which pixels are lit comes out of rotating lit_mask by the
+@  (negative) index, the carry being bit (i - 1) & 31
+@
+@  texel = tex[v >> 25][(u [+ lit_u]) >> 25], written through the palette map
+@
+@  args:
+@    r0 = end of span (one past its last pixel), r1 = count
+@    r2 = ThumbSpan*: u, v, du, dv, lit_u, lit_mask, tex, pal
+@
+@  cycles per pixel: 20 (ldrb/strb 2, taken branches 2, the rest 1),
+@  lit or not
+@-----------------------------------------------------------------------------
+    .global render_span_thumb
+    .type   render_span_thumb, %function
+    .thumb_func
+
+render_span_thumb:
+    push    {r4-r7, lr}
+    mov     r4, r8
+    mov     r5, r9
+    mov     r6, r10
+    mov     r7, r11
+    push    {r4-r7}
+
+    cmp     r1, #0
+    ble     9f                  @ bail if span is empty
+
+    @ the per-span constants go high, only mov/add/cmp reach them
+    ldr     r4, [r2, #20]       @ lit_mask
+    mov     r8, r4
+    ldr     r4, [r2, #16]       @ lit_u
+    mov     r9, r4
+    ldr     r4, [r2, #8]        @ du
+    mov     r10, r4
+    ldr     r4, [r2, #12]       @ dv
+    mov     r11, r4
+    ldr     r4, [r2, #24]       @ tex ptr (128x128 bytes)
+    ldr     r5, [r2, #28]       @ palette map (16 bytes)
+    ldr     r6, [r2, #0]        @ u
+    ldr     r7, [r2, #4]        @ v
+
+    @ count up from -count to 0 off the end pointer: the index is the
+    @ store offset and the loop test in one
+    rsbs    r1, r1, #0
+
+    @ register map at this point:
+    @   r0  = end of span, r1 = -pixels left
+    @   r4  = texture base, r5 = palette map
+    @   r6  = u, r7 = v (top 7 bits are the texel)
+    @   r8  = lit_mask, r9 = lit_u, r10 = du, r11 = dv
+    @   r2, r3 = scratch
+
+1:  @ --- pixel loop ---
+    mov     r3, r8              @ carry = lit?
+    rors    r3, r1
+    mov     r2, r6
+    bcc     2f
+    add     r2, r9              @ lit texture
+2:  lsrs    r2, r2, #25         @ tu
+    lsrs    r3, r7, #25         @ tv
+
+    @ tex is 128 wide
+    lsls    r3, r3, #7
+    adds    r2, r2, r3
+
+    ldrb    r2, [r4, r2]        @ fetch texel (palette index, 0-15)
+    ldrb    r2, [r5, r2]        @ palette map
+    strb    r2, [r0, r1]        @ store
+
+    add     r6, r10             @ u += du
+    add     r7, r11             @ v += dv
+
+    adds    r1, r1, #1
+    bne     1b
+
+9:  @ done
+    pop     {r4-r7}
+    mov     r8, r4
+    mov     r9, r5
+    mov     r10, r6
+    mov     r11, r7
+    pop     {r4-r7, pc}
+
+    .size   render_span_thumb, . - render_span_thumb
+
+    .end
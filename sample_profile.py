@@ -0,0 +1,132 @@
+#!/usr/bin/env python3
+"""Flat profile from a SAMPLE_BUILD dump (hyperspace_sample.h).
+
+Reads the serial console log (the last "samples" ... "end" block) and
+attributes each sampled PC to a function using the symbol table of the
+ELF (through nm) or, without an ELF, the GNU ld map file. PCs below
+0x4000 are the RP2040 bootrom (its float/divide routines).
+
+usage: sample_profile.py dump.txt (--elf hyperspace.elf | --map hyperspace.elf.map)
+                         [--nm arm-none-eabi-nm] [--top N]
+"""
+
+import argparse
+import bisect
+import re
+import subprocess
+import sys
+
+SUPPORTED_VERSION = 1
+BOOTROM_END = 0x4000
+
+
+def parse_dump(path):
+    block = None
+    with open(path, 'r', errors='replace') as f:
+        for line in f:
+            line = line.strip()
+            if line.startswith('samples '):
+                fields = line.split()
+                version = int(fields[1])
+                if version != SUPPORTED_VERSION:
+                    sys.exit(f"Error: sample format {version}, expected {SUPPORTED_VERSION}")
+                info = dict(zip(fields[2::2], (int(v) for v in fields[3::2])))
+                block = {'info': info, 'pcs': {}, 'done': False}
+            elif block is None or block['done']:
+                continue
+            elif line == 'end':
+                block['done'] = True
+            else:
+                fields = line.split()
+                if len(fields) == 2:
+                    block['pcs'][int(fields[0], 16)] = int(fields[1])
+    if block is None or not block['done']:
+        sys.exit("Error: no complete samples block found")
+    return block
+
+
+def symbols_from_elf(elf, nm):
+    out = subprocess.run([nm, '-n', '-S', '--defined-only', elf],
+                         capture_output=True, text=True, check=True).stdout
+    syms = []
+    for line in out.splitlines():
+        fields = line.split()
+        # addr size type name (size is missing for some symbols)
+        if len(fields) == 4 and fields[2] in 'tTwW':
+            syms.append((int(fields[0], 16) & ~1, int(fields[1], 16), fields[3]))
+        elif len(fields) == 3 and fields[1] in 'tTwW':
+            syms.append((int(fields[0], 16) & ~1, 0, fields[2]))
+    return syms
+
+
+def symbols_from_map(path):
+    # Function symbols appear as "<spaces>0x<addr><spaces><name>" inside the
+    # .text and .data (time_critical code) output sections
+    sym_re = re.compile(r'^\s+0x([0-9a-fA-F]+)\s+([A-Za-z_][\w.$]*)\s*$')
+    syms = []
+    with open(path, 'r', errors='replace') as f:
+        for line in f:
+            m = sym_re.match(line)
+            if m:
+                syms.append((int(m.group(1), 16) & ~1, 0, m.group(2)))
+    return sorted(set(syms))
+
+
+def symbolizer(syms):
+    syms.sort()
+    starts = [s[0] for s in syms]
+
+    def lookup(pc):
+        if pc < BOOTROM_END:
+            return '[bootrom]'
+        i = bisect.bisect_right(starts, pc) - 1
+        if i < 0:
+            return f'[unknown {pc:08x}]'
+        addr, size, name = syms[i]
+        # Without a size (map files), the next symbol ends the function
+        if size and pc >= addr + size:
+            return f'[unknown {pc:08x}]'
+        return name
+
+    return lookup
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Flat profile from a SAMPLE_BUILD dump')
+    parser.add_argument('dump')
+    parser.add_argument('--elf')
+    parser.add_argument('--map')
+    parser.add_argument('--nm', default='arm-none-eabi-nm')
+    parser.add_argument('--top', type=int, default=40)
+    args = parser.parse_args()
+    if not args.elf and not args.map:
+        parser.error('one of --elf or --map is required')
+
+    block = parse_dump(args.dump)
+    syms = symbols_from_elf(args.elf, args.nm) if args.elf else symbols_from_map(args.map)
+    lookup = symbolizer(syms)
+
+    per_func = {}
+    for pc, count in block['pcs'].items():
+        name = lookup(pc)
+        per_func[name] = per_func.get(name, 0) + count
+    recorded = sum(per_func.values())
+    if recorded == 0:
+        sys.exit("Error: no samples in the dump")
+
+    info = block['info']
+    hz = info.get('hz', 0)
+    print(f"{recorded} samples at {hz} Hz ({recorded / hz if hz else 0:.1f} s), "
+          f"core0 {info.get('core0', 0)}, core1 {info.get('core1', 0)}, dropped {info.get('dropped', 0)}")
+    print(f"{'samples':>8} {'%':>6} {'cum %':>6}  function")
+    cum = 0
+    ranked = sorted(per_func.items(), key=lambda kv: kv[1], reverse=True)
+    for name, count in ranked[:args.top]:
+        cum += count
+        print(f"{count:8d} {100.0 * count / recorded:6.2f} {100.0 * cum / recorded:6.2f}  {name}")
+    if len(ranked) > args.top:
+        print(f"... {len(ranked) - args.top} more functions")
+
+
+if __name__ == '__main__':
+    main()
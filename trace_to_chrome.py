@@ -0,0 +1,98 @@
+#!/usr/bin/env python3
+"""Convert a TRACE_BUILD dump (hyperspace_trace.h) to Chrome trace JSON.
+
+The input is a serial console log or a file written by
+hyperspace_trace --trace; anything outside the "trace" ... "end" block is
+ignored, and the last block wins. Open the output in chrome://tracing or
+https://ui.perfetto.dev.
+
+usage: trace_to_chrome.py dump.txt [trace.json]
+"""
+
+import json
+import sys
+
+SUPPORTED_VERSION = 1
+
+
+def parse_dump(lines):
+    block = None
+    for line in lines:
+        line = line.strip()
+        if line.startswith('trace '):
+            fields = line.split()
+            version = int(fields[1])
+            if version != SUPPORTED_VERSION:
+                sys.exit(f"Error: trace format {version}, expected {SUPPORTED_VERSION}")
+            block = {'dropped': int(fields[5]), 'names': {}, 'tracks': {}, 'events': [], 'done': False}
+        elif block is None or block['done']:
+            continue
+        elif line == 'end':
+            block['done'] = True
+        elif line.startswith('name '):
+            _, idx, name = line.split(None, 2)
+            block['names'][int(idx)] = name
+        elif line.startswith('track '):
+            _, idx, name = line.split(None, 2)
+            block['tracks'][int(idx)] = name
+        else:
+            fields = line.split()
+            if len(fields) != 4:
+                continue
+            ts, kind, track, name = fields
+            block['events'].append((int(ts, 16), kind, int(track), int(name)))
+    if block is None or not block['done']:
+        sys.exit("Error: no complete trace block found")
+    return block
+
+
+def to_chrome(block):
+    out = []
+    for idx, name in block['tracks'].items():
+        out.append({'name': 'thread_name', 'ph': 'M', 'pid': 0, 'tid': idx, 'args': {'name': name}})
+
+    # Timestamps are 32-bit microseconds; events are stored in time order,
+    # so unwrap by accumulating the difference to the previous event
+    now = 0
+    prev = None
+    open_spans = {}
+    for ts, kind, track, name in block['events']:
+        if prev is not None:
+            now += (ts - prev) & 0xFFFFFFFF
+        prev = ts
+
+        # The ring may start in the middle of a span; drop its end
+        stack = open_spans.setdefault(track, [])
+        if kind == 'B':
+            stack.append(name)
+        elif kind == 'E':
+            if name not in stack:
+                continue
+            while stack.pop() != name:
+                pass
+
+        event = {'name': block['names'].get(name, str(name)), 'ph': kind, 'ts': now, 'pid': 0, 'tid': track}
+        if kind == 'i':
+            event['s'] = 't'
+        out.append(event)
+    return {'traceEvents': out, 'displayTimeUnit': 'ms',
+            'otherData': {'dropped_events': block['dropped']}}
+
+
+def main():
+    if len(sys.argv) < 2:
+        print(__doc__.strip().splitlines()[-1])
+        sys.exit(1)
+
+    with open(sys.argv[1], 'r', errors='replace') as f:
+        block = parse_dump(f)
+    trace = to_chrome(block)
+
+    output = sys.argv[2] if len(sys.argv) > 2 else 'trace.json'
+    with open(output, 'w') as f:
+        json.dump(trace, f)
+    print(f"Wrote {output}: {len(block['events'])} events ({block['dropped']} older events overwritten)")
+
+
+if __name__ == '__main__':
+    main()